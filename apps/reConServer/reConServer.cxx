@@ -55,6 +55,7 @@ int _kbhit() {
 #include <rutil/Log.hxx>
 #include <rutil/Logger.hxx>
 #include <rutil/DnsUtil.hxx>
+#include <rutil/Timer.hxx>
 #include <rutil/BaseException.hxx>
 #include <rutil/WinLeakCheck.hxx>
 
@@ -92,7 +93,9 @@ int main(int argc, char** argv)
 
 
 
-ReConServerProcess::ReConServerProcess()
+ReConServerProcess::ReConServerProcess() :
+   mMediaFifoStatisticsLogIntervalMs(0),
+   mNextMediaFifoStatisticsLog(0)
 {
 }
 
@@ -802,6 +805,8 @@ ReConServerProcess::main (int argc, char** argv)
    Data stunPassword = reConServerConfig.getConfigData("StunPassword", "", true);
    bool addViaRport = reConServerConfig.getConfigBool("AddViaRport", true);
    unsigned int maxReceiveFifoSize = reConServerConfig.getConfigInt("MaxReceiveFifoSize", 1000);
+   unsigned int maxReceiveFifoWaitTime = reConServerConfig.getConfigUnsignedLong("MaxReceiveFifoWaitTimeMs", 0);
+   unsigned long mediaFifoStatisticsLogInterval = reConServerConfig.getConfigUnsignedLong("MediaFifoStatisticsLogInterval", 0);
    unsigned short tcpPort = reConServerConfig.getConfigUnsignedShort("TCPPort", 5062);
    unsigned short udpPort = reConServerConfig.getConfigUnsignedShort("UDPPort", 5062);
    unsigned short tlsPort = reConServerConfig.getConfigUnsignedShort("TLSPort", 5063);
@@ -822,6 +827,7 @@ ReConServerProcess::main (int argc, char** argv)
    Data captureHost = reConServerConfig.getConfigData("CaptureHost", "");
    int capturePort = reConServerConfig.getConfigInt("CapturePort", 9060);
    int captureAgentID = reConServerConfig.getConfigInt("CaptureAgentID", 2002);
+   unsigned int captureQueueSize = reConServerConfig.getConfigUnsignedLong("CaptureQueueSize", HepAgent::DefaultQueueSize);
    bool localAudioEnabled = reConServerConfig.getConfigBool("EnableLocalAudio", !daemonize); // Defaults to false for daemon process
    Data runAsUser = reConServerConfig.getConfigData("RunAsUser", "", true);
    Data runAsGroup = reConServerConfig.getConfigData("RunAsGroup", "", true);
@@ -884,6 +890,8 @@ ReConServerProcess::main (int argc, char** argv)
    InfoLog( << "  NAT Traversal Mode = " << natTraversalMode);
    InfoLog( << "  NAT Server = " << natTraversalServerHostname << ":" << natTraversalServerPort);
    InfoLog( << "  Max RTP receive FIFO size = " << maxReceiveFifoSize);
+   InfoLog( << "  Max RTP receive FIFO wait time (ms) = " << maxReceiveFifoWaitTime);
+   InfoLog( << "  Media FIFO statistics log interval (s) = " << mediaFifoStatisticsLogInterval);
    InfoLog( << "  STUN/TURN user = " << stunUsername);
    InfoLog( << "  STUN/TURN password = " << stunPassword);
    InfoLog( << "  TCP Port = " << tcpPort);
@@ -938,7 +946,7 @@ ReConServerProcess::main (int argc, char** argv)
 
    if(!captureHost.empty())
    {
-      const auto agent = std::make_shared<HepAgent>(captureHost, capturePort, captureAgentID);
+      const auto agent = std::make_shared<HepAgent>(captureHost, capturePort, captureAgentID, captureQueueSize);
       profile->setTransportSipMessageLoggingHandler(std::make_shared<HEPSipMessageLoggingHandler>(agent));
       profile->setRTCPEventLoggingHandler(std::make_shared<HEPRTCPEventLoggingHandler>(agent));
    }
@@ -1285,6 +1293,13 @@ ReConServerProcess::main (int argc, char** argv)
    conversationProfile->secureMediaDefaultCryptoSuite() = ConversationProfile::SRTP_AES_CM_128_HMAC_SHA1_80;
 
    Flow::maxReceiveFifoSize = maxReceiveFifoSize;
+   if(maxReceiveFifoWaitTime > 0)
+   {
+      mMediaCongestionManager.reset(new GeneralCongestionManager(GeneralCongestionManager::WAIT_TIME, maxReceiveFifoWaitTime));
+      Flow::congestionManager = mMediaCongestionManager.get();
+      mMediaFifoStatisticsLogIntervalMs = (UInt64)mediaFifoStatisticsLogInterval * 1000;
+      mNextMediaFifoStatisticsLog = Timer::getTimeMs() + mMediaFifoStatisticsLogIntervalMs;
+   }
 
    //////////////////////////////////////////////////////////////////////////////
    // Create ConverationManager and UserAgent
@@ -1383,6 +1398,16 @@ ReConServerProcess::doWait()
 void
 ReConServerProcess::onLoop()
 {
+   if(mMediaFifoStatisticsLogIntervalMs)
+   {
+      UInt64 now = Timer::getTimeMs();
+      if(now >= mNextMediaFifoStatisticsLog)
+      {
+         mMediaCongestionManager->logCurrentState();
+         mNextMediaFifoStatisticsLog = now + mMediaFifoStatisticsLogIntervalMs;
+      }
+   }
+
    if(mKeyboardInput)
    {
       int input;
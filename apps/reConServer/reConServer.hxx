@@ -6,6 +6,7 @@
 #endif
 
 #include "rutil/Data.hxx"
+#include "rutil/GeneralCongestionManager.hxx"
 #include "resip/recon/UserAgent.hxx"
 #include "rutil/ServerProcess.hxx"
 
@@ -34,6 +35,10 @@ protected:
 private:
    std::shared_ptr<CDRFile> mCDRFile;
    bool mKeyboardInput;
+   // Declared ahead of the UserAgent so that it outlives every Flow
+   std::unique_ptr<resip::GeneralCongestionManager> mMediaCongestionManager;
+   UInt64 mMediaFifoStatisticsLogIntervalMs;
+   UInt64 mNextMediaFifoStatisticsLog;
    std::shared_ptr<MyUserAgent> mUserAgent;
    std::unique_ptr<MyConversationManager> mConversationManager;
 };
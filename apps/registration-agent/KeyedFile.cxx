@@ -1,6 +1,7 @@
 
 #include <stdexcept>
 #include <fstream>
+#include <sys/stat.h>
 
 #include "rutil/Logger.hxx"
 #include "rutil/ParseBuffer.hxx"
@@ -76,7 +77,12 @@ KeyedFile::KeyedFile(const Data& filename, std::shared_ptr<KeyedFileRowHandler>
     : mFilename(filename),
       mRowHandler(std::move(rowHandler)),
       mMinimumColumns(minimumColumns),
-      mMaximumColumns(maximumColumns)
+      mMaximumColumns(maximumColumns),
+      mLoaded(false),
+      mLoadTime(0),
+      mModified(0),
+      mSize(0),
+      mInode(0)
 {
 }
 
@@ -87,9 +93,34 @@ KeyedFile::~KeyedFile()
 void
 KeyedFile::doReload()
 {
+   if(!fileChanged())
+   {
+      InfoLog(<< mFilename << " is unchanged, not reloading");
+      return;
+   }
    readFile();
 }
 
+bool
+KeyedFile::fileChanged()
+{
+   struct stat st;
+   if(stat(mFilename.c_str(), &st) != 0)
+   {
+      // let readFile() report the error
+      return true;
+   }
+   const bool changed = !mLoaded ||
+      st.st_mtime != mModified ||
+      (UInt64)st.st_size != mSize ||
+      (UInt64)st.st_ino != mInode ||
+      st.st_mtime >= mLoadTime;  // modified in the same second it was read
+   mModified = st.st_mtime;
+   mSize = st.st_size;
+   mInode = st.st_ino;
+   return changed;
+}
+
 std::shared_ptr<KeyedFileLine>
 KeyedFile::getByKey(const Data& key)
 {
@@ -115,9 +146,10 @@ KeyedFile::readFile()
       throw runtime_error("Error opening/reading file");
    }
 
+   const time_t loadTime = time(0);
    string sline;
    int lineNo = 0;
-   set<Data> keys;
+   map<Data, vector<Data> > rows;
    while(getline(f, sline))
    {
       lineNo++;
@@ -133,7 +165,7 @@ KeyedFile::readFile()
       // Look for end of key
       pb.skipToOneOf("\r\n\t");
       pb.data(key, anchor);
-      if(keys.find(key) != keys.end())
+      if(rows.find(key) != rows.end())
       {
          ErrLog(<< "Key '" << key << "' repeated in file " << mFilename);
          throw runtime_error("Key repeated");
@@ -167,27 +199,37 @@ KeyedFile::readFile()
          throw runtime_error("too many columns");
       }
 
-      if(mLines.find(key) == mLines.end())
+      rows[key].swap(columns);
+   }
+
+   // The file is valid, now apply the differences
+   std::size_t added = 0;
+   std::size_t removed = 0;
+   for (auto row = std::begin(rows); row != std::end(rows); ++row)
+   {
+      const auto it = mLines.find(row->first);
+      if(it == mLines.end())
       {
-         StackLog(<< " key '" << key << "' is new");
-         mLines[key] = mRowHandler->onNewLine(mSharedPtr, key, columns);
+         StackLog(<< " key '" << row->first << "' is new");
+         mLines[row->first] = mRowHandler->onNewLine(mSharedPtr, row->first, row->second);
+         added++;
       }
       else
       {
-         StackLog(<< " key '" << key << "' already known");
-         mLines[key]->onFileReload(columns);
+         StackLog(<< " key '" << row->first << "' already known");
+         it->second->onFileReload(row->second);
       }
-      keys.insert(key);
    }
 
    // Process removed lines
    for (auto it = std::begin(mLines); it != std::end(mLines);)
    {
-      if (keys.find(it->first) == std::end(keys))
+      if (rows.find(it->first) == std::end(rows))
       {
          StackLog(<< mFilename << " removing key '" << it->first << "'");
          it->second->onLineRemoved(it->second);
          it = mLines.erase(it);
+         removed++;
       }
       else
       {
@@ -195,7 +237,10 @@ KeyedFile::readFile()
       }
    }
 
-   InfoLog(<<"Processed " << lineNo << " lines");
+   mLoaded = true;
+   mLoadTime = loadTime;
+
+   InfoLog(<<"Processed " << lineNo << " lines, " << added << " added, " << removed << " removed");
 }
 
 std::size_t
@@ -5,6 +5,7 @@
 #include <rutil/Data.hxx>
 #include <rutil/Lock.hxx>
 
+#include <ctime>
 #include <memory>
 
 namespace registrationagent {
@@ -57,6 +58,9 @@ public:
    virtual ~KeyedFile();
    void setSharedPtr(std::shared_ptr<KeyedFile> sp) { mSharedPtr = sp; };
 
+   // Reads the file again unless it is unchanged since the last load.
+   // The whole file is parsed and checked before any line is added,
+   // changed or removed, so a bad file leaves the current lines in place.
    virtual void doReload();
 
    std::shared_ptr<KeyedFileLine> getByKey(const resip::Data& key);
@@ -64,6 +68,7 @@ public:
    std::size_t getLineCount();
 
 private:
+   bool fileChanged();
    void readFile();
 
    resip::Data mFilename;
@@ -71,6 +76,12 @@ private:
    int mMinimumColumns, mMaximumColumns;
    std::shared_ptr<KeyedFile> mSharedPtr;
 
+   bool mLoaded;
+   time_t mLoadTime;
+   time_t mModified;
+   UInt64 mSize;
+   UInt64 mInode;
+
    resip::Mutex mLinesMutex;
    std::map<resip::Data, std::shared_ptr<KeyedFileLine> > mLines;
 };
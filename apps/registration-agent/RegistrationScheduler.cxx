@@ -0,0 +1,260 @@
+
+#include "rutil/Logger.hxx"
+#include "rutil/Random.hxx"
+#include "rutil/Timer.hxx"
+#include "AppSubsystem.hxx"
+#include "RegistrationScheduler.hxx"
+
+#define RESIPROCATE_SUBSYSTEM AppSubsystem::REGISTRATIONAGENT
+
+using namespace registrationagent;
+using namespace resip;
+using namespace std;
+
+// A request still waiting for a response after this long has timed out in
+// the transaction layer, so it no longer counts as outstanding
+static const UInt64 OutstandingTimeoutMs = 64*500;
+
+RegistrationScheduler::RegistrationScheduler(unsigned int rate,
+                                             unsigned int maxOutstanding,
+                                             unsigned int startupJitter,
+                                             unsigned int retryInterval,
+                                             unsigned int maxRetryInterval)
+   : mMaxRate(rate),
+     mMinRate(rate > 0 ? resipMax(1.0, rate / 20.0) : 0),
+     mMaxOutstanding(maxOutstanding),
+     mStartupJitter(startupJitter),
+     mRetryInterval(resipMax(1U, retryInterval)),
+     mMaxRetryInterval(resipMax(resipMax(1U, retryInterval), maxRetryInterval)),
+     mCurrentRate(rate),
+     mTokens(1.0),
+     mLastRefill(0),
+     mLastDecrease(0),
+     mLastExpireCheck(0),
+     mHoldUntil(0)
+{
+}
+
+void
+RegistrationScheduler::scheduleRegistration(const Uri& aor)
+{
+   schedule(aor, Register, jitter(mStartupJitter * 1000ULL));
+}
+
+void
+RegistrationScheduler::scheduleRefresh(const Uri& aor, UInt32 expires)
+{
+   // Refresh somewhere between 55% and 80% of the way through the
+   // registration, which is always before DUM's own refresh timer
+   // (Helper::aBitSmallerThan) would fire.
+   const UInt64 expiresMs = expires * 1000ULL;
+   UInt64 delayMs;
+   if(expires >= 25)
+   {
+      delayMs = expiresMs * 55 / 100 + jitter(expiresMs / 4);
+   }
+   else
+   {
+      delayMs = expiresMs / 2;
+   }
+   schedule(aor, Refresh, delayMs);
+}
+
+void
+RegistrationScheduler::scheduleRetry(const Uri& aor, unsigned int failures, UInt32 retryAfter)
+{
+   UInt64 secs;
+   if(retryAfter > 0)
+   {
+      secs = resipMin((UInt64)retryAfter, (UInt64)mMaxRetryInterval);
+   }
+   else
+   {
+      // exponential backoff from the retry interval
+      secs = mRetryInterval;
+      for(unsigned int i = 1; i < failures && secs < mMaxRetryInterval; i++)
+      {
+         secs *= 2;
+      }
+      secs = resipMin(secs, (UInt64)mMaxRetryInterval);
+   }
+   DebugLog(<<"retrying " << aor << " in about " << secs << "s after " << failures << " failure(s)");
+   schedule(aor, Register, secs * 1000 + jitter(secs * 500));
+}
+
+void
+RegistrationScheduler::cancel(const Uri& aor)
+{
+   EntryMap::iterator it = mEntries.find(aor);
+   if(it != mEntries.end())
+   {
+      mDue.erase(it->second.mDue);
+      mEntries.erase(it);
+   }
+}
+
+void
+RegistrationScheduler::schedule(const Uri& aor, Action action, UInt64 delayMs)
+{
+   cancel(aor);
+   Entry& entry = mEntries[aor];
+   entry.mAction = action;
+   entry.mDue = mDue.insert(DueMap::value_type(Timer::getTimeMs() + delayMs, aor));
+}
+
+bool
+RegistrationScheduler::next(UInt64 nowMs, Uri& aor, Action& action)
+{
+   if(nowMs < mHoldUntil)
+   {
+      return false;
+   }
+   if(mMaxOutstanding > 0 && mOutstanding.size() >= mMaxOutstanding)
+   {
+      expireOutstanding(nowMs);
+      if(mOutstanding.size() >= mMaxOutstanding)
+      {
+         return false;
+      }
+   }
+   if(mDue.empty() || mDue.begin()->first > nowMs)
+   {
+      return false;
+   }
+   if(mMaxRate > 0)
+   {
+      refill(nowMs);
+      if(mTokens < 1.0)
+      {
+         return false;
+      }
+   }
+
+   DueMap::iterator due = mDue.begin();
+   aor = due->second;
+   EntryMap::iterator it = mEntries.find(aor);
+   resip_assert(it != mEntries.end());
+   action = it->second.mAction;
+   mEntries.erase(it);
+   mDue.erase(due);
+   return true;
+}
+
+void
+RegistrationScheduler::onSent(UInt64 nowMs, const Uri& aor)
+{
+   if(mMaxRate > 0)
+   {
+      mTokens -= 1.0;
+   }
+   mOutstanding[aor] = nowMs;
+   if(nowMs - mLastExpireCheck > OutstandingTimeoutMs)
+   {
+      expireOutstanding(nowMs);
+   }
+}
+
+void
+RegistrationScheduler::onResponse(UInt64 nowMs, const Uri& aor, int code, UInt32 retryAfter, bool fromWire)
+{
+   mOutstanding.erase(aor);
+
+   if(code == 503 || code == 408)
+   {
+      if(mMaxRate > 0 && nowMs - mLastDecrease >= 1000 && mCurrentRate > mMinRate)
+      {
+         mCurrentRate = resipMax(mMinRate, mCurrentRate / 2);
+         mLastDecrease = nowMs;
+         WarningLog(<<"received " << code << ", reducing registration rate to " << mCurrentRate << "/s");
+      }
+      if(code == 503 && fromWire && retryAfter > 0)
+      {
+         UInt64 holdUntil = nowMs + resipMin((UInt64)retryAfter, (UInt64)mMaxRetryInterval) * 1000;
+         if(holdUntil > mHoldUntil)
+         {
+            WarningLog(<<"server asked for Retry-After " << retryAfter << "s, holding back all registrations");
+            mHoldUntil = holdUntil;
+         }
+      }
+   }
+   else if(code >= 200 && code < 300 && mCurrentRate < mMaxRate)
+   {
+      mCurrentRate = resipMin(mMaxRate, mCurrentRate + mMaxRate / 100);
+   }
+}
+
+void
+RegistrationScheduler::refill(UInt64 nowMs)
+{
+   if(mLastRefill > 0 && nowMs > mLastRefill)
+   {
+      // allow a burst of no more than a tenth of a second worth of requests
+      const double burst = resipMax(1.0, mCurrentRate / 10);
+      mTokens = resipMin(burst, mTokens + (nowMs - mLastRefill) * mCurrentRate / 1000);
+   }
+   mLastRefill = nowMs;
+}
+
+void
+RegistrationScheduler::expireOutstanding(UInt64 nowMs)
+{
+   mLastExpireCheck = nowMs;
+   for(std::map<Uri, UInt64>::iterator it = mOutstanding.begin(); it != mOutstanding.end();)
+   {
+      if(nowMs - it->second > OutstandingTimeoutMs)
+      {
+         mOutstanding.erase(it++);
+      }
+      else
+      {
+         ++it;
+      }
+   }
+}
+
+UInt64
+RegistrationScheduler::jitter(UInt64 maxMs)
+{
+   if(maxMs == 0)
+   {
+      return 0;
+   }
+   return (UInt64)(unsigned int)Random::getRandom() % (maxMs + 1);
+}
+
+/* ====================================================================
+ *
+ * Copyright 2012 Daniel Pocock http://danielpocock.com  All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * 3. Neither the name of the author(s) nor the names of any contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR(S) AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR(S) OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * ====================================================================
+ *
+ *
+ */
@@ -0,0 +1,133 @@
+#ifndef REGISTRATIONSCHEDULER_HXX
+#define REGISTRATIONSCHEDULER_HXX
+
+#include "rutil/compat.hxx"
+#include "resip/stack/Uri.hxx"
+
+#include <map>
+
+namespace registrationagent {
+
+/*
+  Decides when each account sends its REGISTER requests.
+
+  Initial registrations, refreshes and retries are not sent from DUM
+  timers but queued here with a due time and released by process() at no
+  more than the configured number of requests per second.  Due times are
+  jittered so that accounts loaded together, or refreshed with the same
+  expiry, drift apart instead of staying synchronised.
+
+  The rate is halved (at most once per second) when the server or the
+  transport reports congestion (503, 408) and grows back as successful
+  responses arrive.  A 503 with Retry-After from the wire holds back all
+  requests until the Retry-After time has passed.
+*/
+class RegistrationScheduler
+{
+public:
+   typedef enum {
+      Register,      // send an initial REGISTER for the account
+      Refresh        // refresh the account's current registration
+   } Action;
+
+   // rate is in requests per second, 0 means unlimited
+   // maxOutstanding limits requests awaiting a response, 0 means unlimited
+   // startupJitter, retryInterval and maxRetryInterval are in seconds
+   RegistrationScheduler(unsigned int rate,
+                         unsigned int maxOutstanding,
+                         unsigned int startupJitter,
+                         unsigned int retryInterval,
+                         unsigned int maxRetryInterval);
+
+   // Each of these replaces anything already queued for aor
+   void scheduleRegistration(const resip::Uri& aor);
+   void scheduleRefresh(const resip::Uri& aor, UInt32 expires);
+   void scheduleRetry(const resip::Uri& aor, unsigned int failures, UInt32 retryAfter);
+   void cancel(const resip::Uri& aor);
+
+   // Returns true and sets aor and action if a request may be sent now.
+   // The caller must call onSent() if it actually sends a request; work
+   // that turns out to be unnecessary does not use up the rate.
+   bool next(UInt64 nowMs, resip::Uri& aor, Action& action);
+   void onSent(UInt64 nowMs, const resip::Uri& aor);
+
+   // Called for every final response to a REGISTER
+   void onResponse(UInt64 nowMs, const resip::Uri& aor, int code, UInt32 retryAfter, bool fromWire);
+
+   std::size_t getQueued() const { return mEntries.size(); }
+   std::size_t getOutstanding() const { return mOutstanding.size(); }
+   double getCurrentRate() const { return mCurrentRate; }
+
+private:
+   void schedule(const resip::Uri& aor, Action action, UInt64 delayMs);
+   void refill(UInt64 nowMs);
+   void expireOutstanding(UInt64 nowMs);
+   static UInt64 jitter(UInt64 maxMs);
+
+   typedef std::multimap<UInt64, resip::Uri> DueMap;
+   struct Entry
+   {
+      Action mAction;
+      DueMap::iterator mDue;
+   };
+   typedef std::map<resip::Uri, Entry> EntryMap;
+
+   const double mMaxRate;
+   const double mMinRate;
+   const unsigned int mMaxOutstanding;
+   const unsigned int mStartupJitter;
+   const unsigned int mRetryInterval;
+   const unsigned int mMaxRetryInterval;
+
+   DueMap mDue;
+   EntryMap mEntries;
+   std::map<resip::Uri, UInt64> mOutstanding;   // request sent time
+
+   double mCurrentRate;
+   double mTokens;
+   UInt64 mLastRefill;
+   UInt64 mLastDecrease;
+   UInt64 mLastExpireCheck;
+   UInt64 mHoldUntil;
+};
+
+} // namespace
+
+#endif
+
+/* ====================================================================
+ *
+ * Copyright 2012 Daniel Pocock http://danielpocock.com  All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * 3. Neither the name of the author(s) nor the names of any contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR(S) AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR(S) OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * ====================================================================
+ *
+ *
+ */
@@ -42,7 +42,10 @@ UserAccount::UserAccount(std::shared_ptr<KeyedFile> keyedFile, const Uri& aor, c
    mAor(aor),
    mContactOverride(false),
    mExpires(0),
-   mState(UserAccount::Inactive)
+   mState(UserAccount::Inactive),
+   mRegistrationPending(false),
+   mFailures(0),
+   mGrantedExpires(0)
 {
    readColumns();
 }
@@ -107,7 +110,8 @@ UserAccount::activate()
          return;
       }
       mState = Active;
-      doRegistration();
+      mFailures = 0;
+      mUserRegistrationClient->getScheduler().scheduleRegistration(mAor.uri());
    }
 }
 
@@ -117,6 +121,7 @@ UserAccount::deactivate()
    if(mState == Active)
    {
       mState = Inactive;
+      mUserRegistrationClient->getScheduler().cancel(mAor.uri());
       removeAllActive();
    }
 }
@@ -152,6 +157,47 @@ UserAccount::unSetContact()
    mContact.clear();
 }
 
+bool
+UserAccount::onScheduled(RegistrationScheduler::Action action)
+{
+   if(mState != Active)
+   {
+      return false;
+   }
+
+   if(action == RegistrationScheduler::Register)
+   {
+      if(mRegistrationPending || !mHandles.empty())
+      {
+         return false;
+      }
+      mRegistrationPending = true;
+      doRegistration();
+      return true;
+   }
+
+   if(mHandles.empty())
+   {
+      return false;
+   }
+   ClientRegistrationHandle h = mHandles.front();
+   if(!h.isValid())
+   {
+      mHandles.erase(mHandles.begin());
+      mUserRegistrationClient->getScheduler().scheduleRegistration(mAor.uri());
+      return false;
+   }
+   const UInt32 remaining = h->whenExpires();
+   if(remaining > mGrantedExpires / 2)
+   {
+      // DUM's own refresh timer fired while this refresh was queued
+      mUserRegistrationClient->getScheduler().scheduleRefresh(mAor.uri(), remaining);
+      return false;
+   }
+   h->requestRefresh();
+   return true;
+}
+
 void
 UserAccount::doRegistration()
 {
@@ -176,10 +222,25 @@ void
 UserAccount::onSuccess(ClientRegistrationHandle h, const SipMessage& response)
 {
    InfoLog( << "ClientHandler::onSuccess: " << endl );
+   mRegistrationPending = false;
+   mFailures = 0;
+   if(mState != Active)
+   {
+      // the account was deactivated while this registration was in progress
+      if(find(mHandles.begin(), mHandles.end(), h) == mHandles.end() &&
+         find(mEndingHandles.begin(), mEndingHandles.end(), h) == mEndingHandles.end())
+      {
+         mEndingHandles.push_back(h);
+         h->endCommand();
+      }
+      return;
+   }
    if(find(mHandles.begin(), mHandles.end(), h) == mHandles.end())
    {
       mHandles.insert(mHandles.begin(), h);
    }
+   mGrantedExpires = h->whenExpires();
+   mUserRegistrationClient->getScheduler().scheduleRefresh(mAor.uri(), mGrantedExpires);
 }
 
 void
@@ -191,7 +252,18 @@ UserAccount::onRemoved(ClientRegistrationHandle h, const SipMessage& response)
    {
       mHandles.erase(it);
    }
-   if(mState == Ending && mHandles.size() == 0)
+   it = find(mEndingHandles.begin(), mEndingHandles.end(), h);
+   if(it != mEndingHandles.end())
+   {
+      mEndingHandles.erase(it);
+   }
+   checkEnded();
+}
+
+void
+UserAccount::checkEnded()
+{
+   if(mState == Ending && mHandles.empty() && mEndingHandles.empty() && !mRegistrationPending)
    {
       doCleanup();
    }
@@ -211,6 +283,36 @@ void
 UserAccount::onFailure(ClientRegistrationHandle h, const SipMessage& response)
 {
    InfoLog ( << "ClientHandler::onFailure - check the configuration.  Peer response: " << response );
+   if(find(mEndingHandles.begin(), mEndingHandles.end(), h) != mEndingHandles.end())
+   {
+      // removal failed, DUM follows up with onRemoved()
+      return;
+   }
+   // The profile has no retry time, so DUM has given up on this
+   // registration and the scheduler decides when to try again
+   vector<ClientRegistrationHandle>::iterator it = find(mHandles.begin(), mHandles.end(), h);
+   if(it != mHandles.end())
+   {
+      mHandles.erase(it);
+   }
+   mRegistrationPending = false;
+   if(mState == Active)
+   {
+      scheduleRetry(response);
+   }
+   checkEnded();
+}
+
+void
+UserAccount::scheduleRetry(const SipMessage& response)
+{
+   mFailures++;
+   UInt32 retryAfter = 0;
+   if(response.exists(h_RetryAfter))
+   {
+      retryAfter = response.header(h_RetryAfter).value();
+   }
+   mUserRegistrationClient->getScheduler().scheduleRetry(mAor.uri(), mFailures, retryAfter);
 }
 
 /// From resip/dum/RegistrationHandler.hxx
@@ -220,26 +322,32 @@ int
 UserAccount::onRequestRetry(ClientRegistrationHandle h, int retrySeconds, const SipMessage& response)
 {
    WarningLog ( << "ClientHandler:onRequestRetry, want to retry");
-   return 30;
+   // fail now, onFailure() hands the retry to the scheduler
+   return -1;
 }
 
 bool
 UserAccount::onRefreshRequired(resip::ClientRegistrationHandle h, const resip::SipMessage& lastRequest)
 {
    StackLog(<<"UserAccount::onRefreshRequired mExpires == " << mExpires);
-   if(mExpires == 0)
+   if(mExpires != 0)
    {
-      return true;
-   }
-   UInt64 now = Timer::getTimeSecs();
-   if(now > mExpires)
-   {
-      DebugLog(<<"now = " << now << " and contact expired at " << mExpires);
-      if(mState == Active)
+      UInt64 now = Timer::getTimeSecs();
+      if(now > mExpires)
       {
-         mState = Inactive;
+         DebugLog(<<"now = " << now << " and contact expired at " << mExpires);
+         if(mState == Active)
+         {
+            mState = Inactive;
+         }
+         return false;
       }
-      return false;
+   }
+   if(mState == Active && mGrantedExpires > 0)
+   {
+      // DUM may be refreshing on its own timer, keep a refresh queued
+      // in case no onSuccess() follows
+      mUserRegistrationClient->getScheduler().scheduleRefresh(mAor.uri(), mGrantedExpires);
    }
    return true;
 }
@@ -251,7 +359,9 @@ UserAccount::removeAllActive()
           it != mHandles.end(); it++)
    {
       (*it)->endCommand();
+      mEndingHandles.push_back(*it);
    }
+   mHandles.clear();
 }
 
 void
@@ -259,15 +369,9 @@ UserAccount::onLineRemoved(std::shared_ptr<KeyedFileLine> sp)
 {
    BasicKeyedFileLine::onLineRemoved(std::move(sp));
    InfoLog( << "Removing registration(s)");
-   if(mHandles.size() > 0)
-   {
-      mState = Ending;
-      removeAllActive();
-   }
-   else
-   {
-      doCleanup();
-   }
+   mState = Ending;
+   removeAllActive();
+   checkEnded();
 }
 
 void
@@ -9,6 +9,7 @@
 #include "resip/dum/UserProfile.hxx"
 
 #include "KeyedFile.hxx"
+#include "RegistrationScheduler.hxx"
 
 namespace registrationagent {
 
@@ -41,6 +42,10 @@ public:
    void setContact(const resip::Data& newContact, const time_t expires = 0, const std::vector<resip::Data>& route = std::vector<resip::Data>());
    void unSetContact();
 
+   // Called when the scheduler releases work for this account, returns
+   // true if a request was sent
+   bool onScheduled(RegistrationScheduler::Action action);
+
    virtual void onSuccess(resip::ClientRegistrationHandle h, const resip::SipMessage& response);
    virtual void onRemoved(resip::ClientRegistrationHandle, const resip::SipMessage& response);
    virtual void onFailure(resip::ClientRegistrationHandle, const resip::SipMessage& response);
@@ -53,7 +58,9 @@ public:
 private:
    void readColumns();
    void doRegistration();
+   void scheduleRetry(const resip::SipMessage& response);
    void removeAllActive();
+   void checkEnded();
    void doCleanup();
 
    resip::DialogUsageManager& mDum;
@@ -84,6 +91,11 @@ private:
    resip::NameAddrs mRoute;
 
    std::vector<resip::ClientRegistrationHandle> mHandles;
+   std::vector<resip::ClientRegistrationHandle> mEndingHandles;   // being removed
+
+   bool mRegistrationPending;     // initial REGISTER sent, no final response yet
+   unsigned int mFailures;        // consecutive failures, for backoff
+   UInt32 mGrantedExpires;        // expiry granted by the last 2xx
 };
 
 } // namespace
@@ -1,5 +1,6 @@
 
 #include "rutil/Logger.hxx"
+#include "rutil/Timer.hxx"
 #include "AppSubsystem.hxx"
 #include "UserRegistrationClient.hxx"
 
@@ -11,8 +12,9 @@ using namespace registrationagent;
 using namespace resip;
 using namespace std;
 
-UserRegistrationClient::UserRegistrationClient(std::shared_ptr<KeyedFile> keyedFile) :
-   mKeyedFile(std::move(keyedFile))
+UserRegistrationClient::UserRegistrationClient(std::shared_ptr<KeyedFile> keyedFile, std::shared_ptr<RegistrationScheduler> scheduler) :
+   mKeyedFile(std::move(keyedFile)),
+   mScheduler(std::move(scheduler))
 {
 }
 
@@ -26,6 +28,7 @@ void
 UserRegistrationClient::removeUserAccount(const Uri& aor)
 {
    StackLog(<<"Removing UserAccount " << aor);
+   mScheduler->cancel(aor);
    mAccounts.erase(aor);
 }
 
@@ -49,10 +52,27 @@ UserRegistrationClient::unSetContact(const Uri& aor)
    }
 }
 
+void
+UserRegistrationClient::process()
+{
+   const UInt64 now = Timer::getTimeMs();
+   Uri aor;
+   RegistrationScheduler::Action action;
+   while(mScheduler->next(now, aor, action))
+   {
+      const auto it = mAccounts.find(aor);
+      if(it != std::end(mAccounts) && it->second->onScheduled(action))
+      {
+         mScheduler->onSent(now, aor);
+      }
+   }
+}
+
 void
 UserRegistrationClient::onSuccess(ClientRegistrationHandle h, const SipMessage& response)
 {
    InfoLog( << "ClientHandler::onSuccess: " << endl );
+   onResponse(response);
    const auto userAccount = userAccountForMessage(response);
    if (userAccount)
    {
@@ -65,6 +85,7 @@ void
 UserRegistrationClient::onRemoved(ClientRegistrationHandle h, const SipMessage& response)
 {
    InfoLog ( << "ClientHandler::onRemoved ");
+   onResponse(response);
    const auto userAccount = userAccountForMessage(response);
    if (userAccount)
    {
@@ -77,6 +98,7 @@ void
 UserRegistrationClient::onFailure(ClientRegistrationHandle h, const SipMessage& response)
 {
    InfoLog ( << "ClientHandler::onFailure - check the configuration.  Peer response: " << response );
+   onResponse(response);
    const auto userAccount = userAccountForMessage(response);
    if (userAccount)
    {
@@ -111,6 +133,21 @@ UserRegistrationClient::onRefreshRequired(ClientRegistrationHandle h, const resi
    return true;
 }
 
+void
+UserRegistrationClient::onResponse(const SipMessage& response)
+{
+   UInt32 retryAfter = 0;
+   if(response.exists(h_RetryAfter))
+   {
+      retryAfter = response.header(h_RetryAfter).value();
+   }
+   mScheduler->onResponse(Timer::getTimeMs(),
+                          response.header(h_To).uri(),
+                          response.header(h_StatusLine).statusCode(),
+                          retryAfter,
+                          response.isFromWire());
+}
+
 std::shared_ptr<UserAccount>
 UserRegistrationClient::userAccountForMessage(const resip::SipMessage& m)
 {
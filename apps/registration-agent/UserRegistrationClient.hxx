@@ -8,6 +8,7 @@
 #include "resip/dum/UserProfile.hxx"
 
 #include "KeyedFile.hxx"
+#include "RegistrationScheduler.hxx"
 #include "UserAccount.hxx"
 
 namespace registrationagent {
@@ -16,7 +17,7 @@ class UserRegistrationClient : public resip::ClientRegistrationHandler
 {
 
 public:
-   UserRegistrationClient(std::shared_ptr<KeyedFile> keyedFile);
+   UserRegistrationClient(std::shared_ptr<KeyedFile> keyedFile, std::shared_ptr<RegistrationScheduler> scheduler);
 
    void addUserAccount(const resip::Uri& aor, std::shared_ptr<UserAccount> userAccount);
    void removeUserAccount(const resip::Uri& aor);
@@ -24,6 +25,10 @@ public:
    void setContact(const resip::Uri& aor, const resip::Data& newContact, const time_t expires = 0, const std::vector<resip::Data>& route = std::vector<resip::Data>());
    void unSetContact(const resip::Uri& aor);
 
+   // Sends whatever the scheduler releases, call from the main loop
+   void process();
+   RegistrationScheduler& getScheduler() { return *mScheduler; };
+
    virtual void onSuccess(resip::ClientRegistrationHandle h, const resip::SipMessage& response);
    virtual void onRemoved(resip::ClientRegistrationHandle, const resip::SipMessage& response);
    virtual void onFailure(resip::ClientRegistrationHandle, const resip::SipMessage& response);
@@ -36,9 +41,11 @@ public:
 protected:
    std::shared_ptr<UserAccount> userAccountForMessage(const resip::SipMessage& m);
    std::shared_ptr<UserAccount> userAccountForAoR(const resip::Uri& aor);
+   void onResponse(const resip::SipMessage& response);
 
 private:
    std::shared_ptr<KeyedFile> mKeyedFile;
+   std::shared_ptr<RegistrationScheduler> mScheduler;
    std::map<resip::Uri, std::shared_ptr<UserAccount> > mAccounts;
    std::set<std::shared_ptr<UserAccount> > mFailedAccounts;
 };
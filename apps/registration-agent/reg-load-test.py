@@ -0,0 +1,187 @@
+#!/usr/bin/python3
+
+#
+# Rate controlled load test for registrationAgent
+#
+# Generates a UserAccountFile with many accounts and a configuration
+# that sends them through a UDP relay in this script to a local repro.
+# The relay counts the REGISTER requests passing through each second
+# and fails the test if the agent sends faster than RegistrationRate
+# allows.  It can also answer a fraction of the requests itself with
+# 503 and Retry-After to check that the agent backs off.
+#
+# repro must accept registrations for the test domain without
+# authentication, for example:
+#
+#   repro --DisableAuth=true --Domains=localhost
+#
+# then:
+#
+#   ./reg-load-test.py --agent ./registrationAgent --accounts 5000 --rate 100
+#
+
+from __future__ import print_function
+
+import optparse
+import os
+import random
+import select
+import socket
+import subprocess
+import sys
+import tempfile
+import time
+
+def parse_args():
+    parser = optparse.OptionParser()
+    parser.add_option("--agent", default="./registrationAgent",
+                      help="registrationAgent binary (default %default)")
+    parser.add_option("--repro", default="127.0.0.1:5060",
+                      help="repro UDP address (default %default)")
+    parser.add_option("--relay-port", type="int", default=5070,
+                      help="local port for the relay (default %default)")
+    parser.add_option("--domain", default="localhost",
+                      help="domain of the test accounts (default %default)")
+    parser.add_option("--accounts", type="int", default=1000,
+                      help="number of accounts (default %default)")
+    parser.add_option("--rate", type="int", default=50,
+                      help="RegistrationRate for the agent (default %default)")
+    parser.add_option("--expiry", type="int", default=120,
+                      help="RegistrationExpiry, short to exercise refreshes (default %default)")
+    parser.add_option("--duration", type="int", default=0,
+                      help="test duration in seconds (default: long enough to register every account twice)")
+    parser.add_option("--inject-503", type="float", default=0.0, dest="inject_503",
+                      help="fraction of REGISTER requests answered with 503 by the relay (default %default)")
+    parser.add_option("--retry-after", type="int", default=5, dest="retry_after",
+                      help="Retry-After sent with injected 503 responses (default %default)")
+    (options, args) = parser.parse_args()
+    if options.duration == 0:
+        options.duration = max(2 * options.accounts // options.rate, options.expiry) + 10
+    return options
+
+def write_files(options, workdir):
+    users = os.path.join(workdir, "users.txt")
+    with open(users, "w") as f:
+        for n in range(options.accounts):
+            f.write("sip:load%d@%s\tsip:load%d@127.0.0.1:5099\n" % (n, options.domain, n))
+    config = os.path.join(workdir, "registrationAgent.config")
+    with open(config, "w") as f:
+        f.write("Daemonize = false\n")
+        f.write("LoggingType = file\n")
+        f.write("LogLevel = WARNING\n")
+        f.write("LogFilename = %s\n" % os.path.join(workdir, "registrationAgent.log"))
+        f.write("CertificatePath =\n")
+        f.write("RegistrationExpiry = %d\n" % options.expiry)
+        f.write("RegistrationRate = %d\n" % options.rate)
+        f.write("RegistrationStartupJitter = 2\n")
+        f.write("RegistrationRetryInterval = 5\n")
+        f.write("OutboundProxy = sip:127.0.0.1:%d\n" % options.relay_port)
+        f.write("UserAccountFile = %s\n" % users)
+    return config
+
+def header(lines, name):
+    for line in lines:
+        if line.lower().startswith(name.lower() + ":"):
+            return line
+    return None
+
+def make_503(request, retry_after):
+    lines = request.split("\r\n")
+    response = ["SIP/2.0 503 Service Unavailable"]
+    for line in lines[1:]:
+        if line == "":
+            break
+        lower = line.lower()
+        if lower.startswith("via:") or lower.startswith("from:") or \
+           lower.startswith("call-id:") or lower.startswith("cseq:"):
+            response.append(line)
+        elif lower.startswith("to:"):
+            response.append(line + ";tag=%08x" % random.getrandbits(32))
+    response.append("Retry-After: %d" % retry_after)
+    response.append("Content-Length: 0")
+    return "\r\n".join(response) + "\r\n\r\n"
+
+def run_relay(options, agent):
+    repro_host, repro_port = options.repro.split(":")
+    repro = (repro_host, int(repro_port))
+
+    downstream = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+    downstream.bind(("127.0.0.1", options.relay_port))
+    upstream = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+    upstream.bind(("127.0.0.1", 0))
+
+    agent_address = None
+    start = time.time()
+    per_second = {}
+    responses = {}
+    registered = set()
+    injected = 0
+
+    while time.time() - start < options.duration and agent.poll() is None:
+        readable, _, _ = select.select([downstream, upstream], [], [], 0.5)
+        for sock in readable:
+            data, address = sock.recvfrom(65535)
+            text = data.decode("utf-8", "replace")
+            if sock is downstream:
+                agent_address = address
+                if not text.startswith("REGISTER "):
+                    upstream.sendto(data, repro)
+                    continue
+                second = int(time.time() - start)
+                per_second[second] = per_second.get(second, 0) + 1
+                if random.random() < options.inject_503:
+                    injected += 1
+                    downstream.sendto(make_503(text, options.retry_after).encode("utf-8"), address)
+                else:
+                    upstream.sendto(data, repro)
+            elif agent_address is not None:
+                if text.startswith("SIP/2.0 "):
+                    code = int(text.split(" ")[1])
+                    responses[code] = responses.get(code, 0) + 1
+                    if code == 200:
+                        to = header(text.split("\r\n"), "To")
+                        if to is not None:
+                            registered.add(to.split(";")[0])
+                downstream.sendto(data, agent_address)
+
+    return per_second, responses, registered, injected
+
+def main():
+    options = parse_args()
+    workdir = tempfile.mkdtemp(prefix="reg-load-test-")
+    config = write_files(options, workdir)
+    print("Registering %d accounts at %d/s through 127.0.0.1:%d to %s for %ds (files in %s)" %
+          (options.accounts, options.rate, options.relay_port, options.repro, options.duration, workdir))
+
+    agent = subprocess.Popen([options.agent, config])
+    try:
+        per_second, responses, registered, injected = run_relay(options, agent)
+    finally:
+        if agent.poll() is None:
+            agent.terminate()
+            agent.wait()
+
+    counts = [per_second.get(s, 0) for s in range(options.duration)]
+    total = sum(counts)
+    # each second may also use the burst allowance of a tenth of a second
+    limit = options.rate + max(1, options.rate // 10)
+    exceeded = [s for s, c in enumerate(counts) if c > limit]
+
+    print("REGISTER requests: %d, peak %d/s, limit %d/s" % (total, max(counts or [0]), limit))
+    print("Responses: %s" % ", ".join("%d x %d" % (n, c) for c, n in sorted(responses.items())))
+    print("Injected 503: %d" % injected)
+    print("Accounts registered: %d of %d" % (len(registered), options.accounts))
+
+    failed = False
+    if exceeded:
+        print("FAIL: rate exceeded in seconds %s" % exceeded[:10])
+        failed = True
+    if options.inject_503 == 0 and len(registered) < options.accounts:
+        print("FAIL: not every account registered")
+        failed = True
+    if not failed:
+        print("PASS")
+    sys.exit(1 if failed else 0)
+
+if __name__ == "__main__":
+    main()
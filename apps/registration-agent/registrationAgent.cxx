@@ -33,6 +33,7 @@
 #include "AppSubsystem.hxx"
 #include "CommandThread.hxx"
 #include "RegConfig.hxx"
+#include "RegistrationScheduler.hxx"
 #include "SNMPThread.hxx"
 #include "UserRegistrationClient.hxx"
 #include "KeyedFile.hxx"
@@ -148,8 +149,9 @@ class MyClientRegistrationAgent : public ServerProcess
          mClientDum->setMasterProfile(profile);
          mClientDum->setClientAuthManager(std::move(clientAuth));
          mClientDum->getMasterProfile()->setDefaultRegistrationTime(cfg.getConfigInt("RegistrationExpiry", 3600));
-         // Retry every 60 seconds after a hard failure:
-         mClientDum->getMasterProfile()->setDefaultRegistrationRetryTime(60);
+         // DUM does not retry failed registrations itself, the
+         // RegistrationScheduler paces retries with backoff instead
+         mClientDum->getMasterProfile()->setDefaultRegistrationRetryTime(0);
          mClientDum->getMasterProfile()->setUserAgent("reSIProcate registrationAgent");
 
          // keep alive test.
@@ -171,7 +173,13 @@ class MyClientRegistrationAgent : public ServerProcess
          const auto rowHandler = std::make_shared<UserAccountFileRowHandler>(*mClientDum);
          mKeyedFile = std::make_shared<KeyedFile>(cfg.getConfigData("UserAccountFile", "users.txt", false), rowHandler);
          mKeyedFile->setSharedPtr(mKeyedFile);
-         mClientHandler = std::make_shared<UserRegistrationClient>(mKeyedFile);
+         const auto scheduler = std::make_shared<RegistrationScheduler>(
+            cfg.getConfigUnsignedLong("RegistrationRate", 50),
+            cfg.getConfigUnsignedLong("RegistrationMaxOutstanding", 200),
+            cfg.getConfigUnsignedLong("RegistrationStartupJitter", 10),
+            cfg.getConfigUnsignedLong("RegistrationRetryInterval", 60),
+            cfg.getConfigUnsignedLong("RegistrationMaxRetryInterval", 1800));
+         mClientHandler = std::make_shared<UserRegistrationClient>(mKeyedFile, scheduler);
          mClientDum->setClientRegistrationHandler(mClientHandler.get());
          rowHandler->setUserRegistrationClient(mClientHandler);
          mKeyedFile->doReload();
@@ -214,6 +222,7 @@ class MyClientRegistrationAgent : public ServerProcess
       void onLoop()
       {
          while(mClientDum->process());
+         mClientHandler->process();
          if(mCmd.get())
          {
             mCmd->processQueue(*mClientHandler);
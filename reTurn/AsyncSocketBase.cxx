@@ -2,6 +2,7 @@
 #include "AsyncSocketBaseHandler.hxx"
 #include <rutil/WinLeakCheck.hxx>
 #include <rutil/Logger.hxx>
+#include <rutil/Timer.hxx>
 #include "ReTurnSubsystem.hxx"
 
 #include <boost/bind.hpp>
@@ -18,15 +19,60 @@ AsyncSocketBase::AsyncSocketBase(asio::io_service& ioService) :
   mIOService(ioService),
   mReceiving(false),
   mConnected(false),
-  mAsyncSocketBaseHandler(nullptr)
+  mAsyncSocketBaseHandler(nullptr),
+  mSendQueueStats(mSendDataQueue),
+  mCongestionManager(nullptr),
+  mSendQueueBehavior(resip::CongestionManager::NORMAL),
+  mSendQueueCheckCount(0)
 {
 }
 
 AsyncSocketBase::~AsyncSocketBase()
 {
+   setCongestionManager(nullptr);
    if(mAsyncSocketBaseHandler) mAsyncSocketBaseHandler->onSocketDestroyed();
 }
 
+void
+AsyncSocketBase::setCongestionManager(resip::CongestionManager* congestionManager)
+{
+   if(congestionManager == mCongestionManager)
+   {
+      return;
+   }
+   if(mCongestionManager)
+   {
+      mCongestionManager->unregisterFifo(&mSendQueueStats);
+   }
+   mCongestionManager = congestionManager;
+   mSendQueueBehavior = resip::CongestionManager::NORMAL;
+   mSendQueueCheckCount = 0;
+   if(mCongestionManager)
+   {
+      mCongestionManager->registerFifo(&mSendQueueStats);
+   }
+}
+
+resip::CongestionManager::RejectionBehavior
+AsyncSocketBase::getSendQueueRejectionBehavior() const
+{
+   if(mCongestionManager)
+   {
+      return mCongestionManager->getRejectionBehavior(&mSendQueueStats);
+   }
+   return resip::CongestionManager::NORMAL;
+}
+
+bool
+AsyncSocketBase::isSendQueueCongested() const
+{
+   if(mCongestionManager && mSendQueueCheckCount++ % CongestionCheckInterval == 0)
+   {
+      mSendQueueBehavior = getSendQueueRejectionBehavior();
+   }
+   return mSendQueueBehavior != resip::CongestionManager::NORMAL;
+}
+
 void 
 AsyncSocketBase::send(const StunTuple& destination, const std::shared_ptr<DataBuffer>& data)
 {
@@ -64,6 +110,8 @@ AsyncSocketBase::doSend(const StunTuple& destination, unsigned short channel, co
 
       mSendDataQueue.push_back(SendData(destination, frame, data, bufferStartPos));
    }
+   mSendDataQueue.back().mQueuedTimeMs = resip::Timer::getTimeMs();
+   mSendQueueStats.onQueueChanged();
    if (!writeInProgress)
    {
       sendFirstQueuedData();
@@ -86,6 +134,7 @@ AsyncSocketBase::handleSend(const asio::error_code& e)
    // TODO - check if closed here, and if so don't try and send more
    // Clear this data from the queue and see if there is more data to send
    mSendDataQueue.pop_front();
+   mSendQueueStats.onSendCompleted();
    if (!mSendDataQueue.empty())
    {
       sendFirstQueuedData();
@@ -101,6 +150,7 @@ AsyncSocketBase::sendFirstQueuedData()
       bufs.push_back(asio::buffer(mSendDataQueue.front().mFrameData->data(), mSendDataQueue.front().mFrameData->size()));
    }
    bufs.push_back(asio::buffer(mSendDataQueue.front().mData->data()+mSendDataQueue.front().mBufferStartPos, mSendDataQueue.front().mData->size()-mSendDataQueue.front().mBufferStartPos));
+   mSendQueueStats.onSendStarted();
    transportSend(mSendDataQueue.front().mDestination, bufs);
 }
 
@@ -168,6 +218,71 @@ AsyncSocketBase::allocateBuffer(const size_t size)
    return std::make_shared<DataBuffer>(size);
 }
 
+AsyncSocketBase::SendQueueStats::SendQueueStats(const SendDataQueue& queue) :
+   mQueue(queue),
+   mSize(0),
+   mOldestQueuedTimeMs(0),
+   mSendStartedMicroSec(0),
+   mAverageServiceTimeMicroSec(0)
+{
+   setDescription("AsyncSocketBase::mSendDataQueue");
+}
+
+void
+AsyncSocketBase::SendQueueStats::onQueueChanged()
+{
+   mSize = mQueue.size();
+   mOldestQueuedTimeMs = mQueue.empty() ? 0 : mQueue.front().mQueuedTimeMs;
+}
+
+void
+AsyncSocketBase::SendQueueStats::onSendStarted()
+{
+   mSendStartedMicroSec = resip::Timer::getTimeMicroSec();
+}
+
+void
+AsyncSocketBase::SendQueueStats::onSendCompleted()
+{
+   if(mSendStartedMicroSec)
+   {
+      // Moving average with period 64, same weighting as AbstractFifo
+      UInt64 serviceTime = resip::Timer::getTimeMicroSec() - mSendStartedMicroSec;
+      mAverageServiceTimeMicroSec = (UInt32)((serviceTime + 63 * (UInt64)mAverageServiceTimeMicroSec) / 64);
+      mSendStartedMicroSec = 0;
+   }
+   onQueueChanged();
+}
+
+time_t
+AsyncSocketBase::SendQueueStats::expectedWaitTimeMilliSec() const
+{
+   return (time_t)((mAverageServiceTimeMicroSec * (UInt64)mSize + 500) / 1000);
+}
+
+time_t
+AsyncSocketBase::SendQueueStats::getTimeDepth() const
+{
+   UInt64 oldest = mOldestQueuedTimeMs;
+   if(oldest == 0)
+   {
+      return 0;
+   }
+   return (time_t)((resip::Timer::getTimeMs() - oldest) / 1000);
+}
+
+size_t
+AsyncSocketBase::SendQueueStats::getCountDepth() const
+{
+   return mSize;
+}
+
+time_t
+AsyncSocketBase::SendQueueStats::averageServiceTimeMicroSec() const
+{
+   return mAverageServiceTimeMicroSec;
+}
+
 } // namespace
 
 
@@ -9,6 +9,9 @@
 #include "DataBuffer.hxx"
 #include "StunTuple.hxx"
 
+#include <rutil/AbstractFifo.hxx>
+#include <rutil/CongestionManager.hxx>
+
 #include <cstddef>
 #include <deque>
 #include <functional>
@@ -53,6 +56,16 @@ public:
 
    virtual void setOnBeforeSocketClosedFp(BeforeClosedHandler fp) { mOnBeforeSocketCloseFp = std::move(fp); }
 
+   /// Registers the send queue of this socket with a congestion manager (0 to clear).  Must be
+   /// called from within the ioService thread.  Registering with the same manager twice is a no-op.
+   void setCongestionManager(resip::CongestionManager* congestionManager);
+   /// Returns the congestion state of the send queue, NORMAL if no congestion manager is set
+   resip::CongestionManager::RejectionBehavior getSendQueueRejectionBehavior() const;
+   /// Returns true if relayed media should be discarded rather than queued for sending.  The
+   /// congestion manager is only asked every CongestionCheckInterval calls, since it takes a
+   /// lock shared by all fifos; call from within the ioService thread.
+   bool isSendQueueCongested() const;
+
    /// Use these if you already operating within the ioService thread
    virtual void doSend(const StunTuple& destination, unsigned short channel, const std::shared_ptr<DataBuffer>& data, size_t bufferStartPos = 0);
    virtual void doSend(const StunTuple& destination, const std::shared_ptr<DataBuffer>& data, size_t bufferStartPos = 0);
@@ -119,15 +132,47 @@ private:
    {
    public:
       SendData(const StunTuple& destination, std::shared_ptr<DataBuffer> frameData, std::shared_ptr<DataBuffer> data, size_t bufferStartPos = 0) :
-         mDestination(destination), mFrameData(std::move(frameData)), mData(std::move(data)), mBufferStartPos(bufferStartPos) {}
+         mDestination(destination), mFrameData(std::move(frameData)), mData(std::move(data)), mBufferStartPos(bufferStartPos), mQueuedTimeMs(0) {}
       StunTuple mDestination;
       std::shared_ptr<DataBuffer> mFrameData;
       std::shared_ptr<DataBuffer> mData;
       size_t mBufferStartPos;
+      UInt64 mQueuedTimeMs;
    };
    /// Queue of data to send
    typedef std::deque<SendData> SendDataQueue;
    SendDataQueue mSendDataQueue;
+
+   /// Exposes the state of mSendDataQueue to a resip::CongestionManager, so that the 
+   /// relay/media paths can use the same WAIT_TIME based metrics as the SIP stack fifos.
+   /// Only updated from the ioService thread; the congestion manager may read it from
+   /// other threads (ie. logging), where slightly stale values are acceptable.
+   class SendQueueStats : public resip::FifoStatsInterface
+   {
+   public:
+      explicit SendQueueStats(const SendDataQueue& queue);
+
+      void onQueueChanged();
+      void onSendStarted();
+      void onSendCompleted();
+
+      virtual time_t expectedWaitTimeMilliSec() const;
+      virtual time_t getTimeDepth() const;
+      virtual size_t getCountDepth() const;
+      virtual time_t averageServiceTimeMicroSec() const;
+
+   private:
+      const SendDataQueue& mQueue;
+      volatile size_t mSize;
+      volatile UInt64 mOldestQueuedTimeMs;
+      UInt64 mSendStartedMicroSec;
+      volatile UInt32 mAverageServiceTimeMicroSec;
+   };
+   SendQueueStats mSendQueueStats;
+   resip::CongestionManager* mCongestionManager;
+   static const unsigned int CongestionCheckInterval = 16;
+   mutable resip::CongestionManager::RejectionBehavior mSendQueueBehavior;
+   mutable unsigned int mSendQueueCheckCount;
 };
 
 typedef std::shared_ptr<AsyncSocketBase> ConnectionPtr;
@@ -54,6 +54,8 @@ ReTurnConfig::ReTurnConfig() :
    mDefaultAllocationLifetime(600), // 10 minutes
    mMaxAllocationLifetime(3600),    // 1 hour
    mMaxAllocationsPerUser(0),       // 0 - no max
+   mRelayQueueMaxWaitTime(0),       // 0 - disabled
+   mRelayQueueStatisticsLogInterval(0),
    mTlsServerCertificateFilename("server.pem"),
    mTlsServerPrivateKeyFilename(""),
    mTlsTempDhFilename("dh2048.pem"),
@@ -92,6 +94,8 @@ void ReTurnConfig::parseConfig(int argc, char** argv, const resip::Data& default
    mDefaultAllocationLifetime = getConfigUnsignedLong("DefaultAllocationLifetime", mDefaultAllocationLifetime);
    mMaxAllocationLifetime = getConfigUnsignedLong("MaxAllocationLifetime", mMaxAllocationLifetime);
    mMaxAllocationsPerUser = getConfigUnsignedLong("MaxAllocationsPerUser", mMaxAllocationsPerUser);
+   mRelayQueueMaxWaitTime = getConfigUnsignedLong("RelayQueueMaxWaitTime", mRelayQueueMaxWaitTime);
+   mRelayQueueStatisticsLogInterval = getConfigUnsignedLong("RelayQueueStatisticsLogInterval", mRelayQueueStatisticsLogInterval);
    mTlsServerCertificateFilename = getConfigData("TlsServerCertificateFilename", mTlsServerCertificateFilename);
    mTlsServerPrivateKeyFilename = getConfigData("TlsServerPrivateKeyFilename", mTlsServerPrivateKeyFilename);
    mTlsTempDhFilename = getConfigData("TlsTempDhFilename", mTlsTempDhFilename);
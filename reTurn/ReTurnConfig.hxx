@@ -69,6 +69,8 @@ public:
    unsigned long mDefaultAllocationLifetime;
    unsigned long mMaxAllocationLifetime;
    unsigned long mMaxAllocationsPerUser;  // TODO - enforcement needs to be implemented
+   unsigned long mRelayQueueMaxWaitTime;  // milliseconds, 0 disables relay congestion management
+   unsigned long mRelayQueueStatisticsLogInterval;  // seconds
 
    resip::Data mTlsServerCertificateFilename;
    resip::Data mTlsServerPrivateKeyFilename;
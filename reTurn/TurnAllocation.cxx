@@ -45,7 +45,10 @@ TurnAllocation::TurnAllocation(TurnManager& turnManager,
    mLocalTurnSocket(localTurnSocket),
    mBadChannelErrorLogged(false),
    mNoPermissionToPeerLogged(false),
-   mNoPermissionFromPeerLogged(false)
+   mNoPermissionFromPeerLogged(false),
+   mCongestionDiscardLogged(false),
+   mDiscardedToPeerCount(0),
+   mDiscardedToClientCount(0)
 {
    InfoLog(<< "TurnAllocation created: clientLocal=" << clientLocalTuple << " clientRemote=" << 
            clientRemoteTuple << " allocation=" << requestedTuple << " lifetime=" << lifetime);
@@ -54,12 +57,20 @@ TurnAllocation::TurnAllocation(TurnManager& turnManager,
 
    // Register for Turn Transport onDestroyed notification
    mLocalTurnSocket->registerAsyncSocketBaseHandler(this);
+
+   // Monitor the client side send queue - sockets may be shared by many allocations, registering again is a no-op
+   mLocalTurnSocket->setCongestionManager(mTurnManager.getCongestionManager());
 }
 
 TurnAllocation::~TurnAllocation()
 {
    InfoLog(<< "TurnAllocation destroyed: clientLocal=" << mKey.getClientLocalTuple() << " clientRemote=" << 
            mKey.getClientRemoteTuple() << " allocation=" << mRequestedTuple);
+   if(mDiscardedToPeerCount || mDiscardedToClientCount)
+   {
+      InfoLog(<< "TurnAllocation discarded relay data due to congestion: allocation=" << mRequestedTuple <<
+              " toPeer=" << mDiscardedToPeerCount << " toClient=" << mDiscardedToClientCount);
+   }
 
    stopRelay();
 
@@ -86,6 +97,7 @@ TurnAllocation::startRelay()
    if(mRequestedTuple.getTransportType() == StunTuple::UDP)
    {
       mUdpRelayServer = std::make_shared<UdpRelayServer>(mTurnManager.getIOService(), *this);
+      mUdpRelayServer->setCongestionManager(mTurnManager.getCongestionManager());
       if(!mUdpRelayServer->startReceiving())
       {
          stopRelay();  // Ensure allocation timer is stopped
@@ -108,6 +120,7 @@ TurnAllocation::stopRelay()
    // Stop and detach Relay Server
    if (mUdpRelayServer)
    {
+      mUdpRelayServer->setCongestionManager(nullptr);
       mUdpRelayServer->stop();
       mUdpRelayServer = nullptr;
    }
@@ -225,6 +238,11 @@ TurnAllocation::sendDataToPeer(const StunTuple& peerAddress, const std::shared_p
    if(mRequestedTuple.getTransportType() == StunTuple::UDP)
    {
       resip_assert(mUdpRelayServer);
+      if(mUdpRelayServer->isSendQueueCongested())
+      {
+         onCongestionDiscard(mDiscardedToPeerCount);
+         return;
+      }
       mUdpRelayServer->doSend(peerAddress, data, isFramed ? 4 /* bufferStartPos is 4 so that framing is skipped */ : 0);
    }
    else
@@ -257,6 +275,12 @@ TurnAllocation::sendDataToClient(const StunTuple& peerAddress, const std::shared
       }
       return;
    }
+   // Early discard of media if the client send queue is overloaded, rather than growing the queue
+   if(mLocalTurnSocket->isSendQueueCongested())
+   {
+      onCongestionDiscard(mDiscardedToClientCount);
+      return;
+   }
    // See if a channel binding exists - if so, use it
    RemotePeer* remotePeer = mChannelManager.findRemotePeerByPeerAddress(peerAddress);
    if(remotePeer)
@@ -290,6 +314,23 @@ TurnAllocation::sendDataToClient(const StunTuple& peerAddress, const std::shared
    }
 }
 
+void
+TurnAllocation::onCongestionDiscard(UInt64& discardCounter)
+{
+   ++discardCounter;
+   // Log at Warning level first time only
+   if(mCongestionDiscardLogged)
+   {
+      DebugLog(<< "Relay send queue congested, discarding data: allocation=" << mRequestedTuple);
+   }
+   else
+   {
+      mCongestionDiscardLogged = true;
+      WarningLog(<< "Relay send queue congested, discarding data: clientLocal=" << mKey.getClientLocalTuple() << " clientRemote=" << 
+                 mKey.getClientRemoteTuple() << " allocation=" << mRequestedTuple);
+   }
+}
+
 bool 
 TurnAllocation::addChannelBinding(const StunTuple& peerAddress, unsigned short channelNumber)
 {
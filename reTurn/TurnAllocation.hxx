@@ -98,6 +98,12 @@ private:
    bool mBadChannelErrorLogged;
    bool mNoPermissionToPeerLogged;
    bool mNoPermissionFromPeerLogged;
+
+   // Relay data discarded because the destination send queue was congested
+   void onCongestionDiscard(UInt64& discardCounter);
+   bool mCongestionDiscardLogged;
+   UInt64 mDiscardedToPeerCount;
+   UInt64 mDiscardedToClientCount;
 };
 
 } 
@@ -1,21 +1,33 @@
 #include <rutil/Lock.hxx>
+#include <rutil/GeneralCongestionManager.hxx>
 
 #include "TurnManager.hxx"
 #include "TurnAllocation.hxx"
 #include <rutil/Logger.hxx>
 #include "ReTurnSubsystem.hxx"
 
+#include <asio/placeholders.hpp>
+#include <boost/bind.hpp>
+
 #define RESIPROCATE_SUBSYSTEM ReTurnSubsystem::RETURN
 
 using namespace std;
 
+#ifdef BOOST_ASIO_HAS_STD_CHRONO
+using namespace std::chrono;
+#else
+#include <boost/chrono.hpp>
+using namespace boost::chrono;
+#endif
+
 namespace reTurn {
 
 TurnManager::TurnManager(asio::io_service& ioService, const ReTurnConfig& config) : 
    mLastAllocatedUdpPort(config.mAllocationPortRangeMin-1),
    mLastAllocatedTcpPort(config.mAllocationPortRangeMin-1),
    mIOService(ioService),
-   mConfig(config)
+   mConfig(config),
+   mCongestionLogTimer(ioService)
 {
    // Initialize Allocation Ports
    for(unsigned short i = config.mAllocationPortRangeMin; i <= config.mAllocationPortRangeMax && i != 0; i++) // i != 0 catches case where we increment 65535 (as an unsigned short)
@@ -23,13 +35,41 @@ TurnManager::TurnManager(asio::io_service& ioService, const ReTurnConfig& config
       mUdpAllocationPorts[i] = PortStateUnallocated;
       mTcpAllocationPorts[i] = PortStateUnallocated;
    }
+
+   if(config.mRelayQueueMaxWaitTime > 0)
+   {
+      InfoLog(<< "Relay congestion management enabled, max expected wait time=" << config.mRelayQueueMaxWaitTime << "ms");
+      mCongestionManager.reset(new resip::GeneralCongestionManager(resip::GeneralCongestionManager::WAIT_TIME, config.mRelayQueueMaxWaitTime));
+      startCongestionLogTimer();
+   }
 }
 
 TurnManager::~TurnManager()
 {
+   mCongestionLogTimer.cancel();
    InfoLog(<< "Turn Manager destroyed.");
 }
 
+void
+TurnManager::startCongestionLogTimer()
+{
+   if(mConfig.mRelayQueueStatisticsLogInterval > 0)
+   {
+      mCongestionLogTimer.expires_from_now(seconds(mConfig.mRelayQueueStatisticsLogInterval));
+      mCongestionLogTimer.async_wait(boost::bind(&TurnManager::congestionLogTimerExpired, this, asio::placeholders::error));
+   }
+}
+
+void
+TurnManager::congestionLogTimerExpired(const asio::error_code& e)
+{
+   if(!e && mCongestionManager)
+   {
+      mCongestionManager->logCurrentState();
+      startCongestionLogTimer();
+   }
+}
+
 unsigned short 
 TurnManager::allocateAnyPort(StunTuple::TransportType transport)
 {
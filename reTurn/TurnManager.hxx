@@ -2,6 +2,7 @@
 #define TURNMANAGER_HXX
 
 #include <map>
+#include <memory>
 #include <asio.hpp>
 #ifdef USE_SSL
 #include <asio/ssl.hpp>
@@ -9,6 +10,11 @@
 #include "ReTurnConfig.hxx"
 #include "StunTuple.hxx"
 
+namespace resip
+{
+class CongestionManager;
+}
+
 namespace reTurn {
 
 class TurnManager
@@ -28,7 +34,13 @@ public:
 
    const ReTurnConfig& getConfig() { return mConfig; }
 
+   /// Returns the congestion manager monitoring relay send queues, or 0 if 
+   /// RelayQueueMaxWaitTime is not configured
+   resip::CongestionManager* getCongestionManager() { return mCongestionManager.get(); }
+
 private:
+   void startCongestionLogTimer();
+   void congestionLogTimerExpired(const asio::error_code& e);
 
    typedef enum
    {
@@ -46,6 +58,9 @@ private:
 
    asio::io_service& mIOService;
    const ReTurnConfig& mConfig;
+
+   std::unique_ptr<resip::CongestionManager> mCongestionManager;
+   asio::steady_timer mCongestionLogTimer;
 };
 
 } 
@@ -31,6 +31,7 @@ using namespace std;
 
 int Flow::maxReceiveFifoDuration = 10; // seconds
 int Flow::maxReceiveFifoSize = 100 * maxReceiveFifoDuration; // 1000 = 1 message every 10 ms for 10 seconds - appropriate for RTP
+resip::CongestionManager* Flow::congestionManager = 0;
 
 #define RESIPROCATE_SUBSYSTEM FlowManagerSubsystem::FLOWMANAGER
 
@@ -142,10 +143,20 @@ Flow::Flow(asio::io_service& ioService,
     mAllocationProps(StunMessage::PropsNone),
     mReservationToken(0),
     mFlowState(Unconnected),
-    mReceivedDataFifo(maxReceiveFifoDuration, maxReceiveFifoSize)
+    mReceivedDataFifo(maxReceiveFifoDuration, maxReceiveFifoSize),
+    mCongestionManager(congestionManager),
+    mCongestionBehavior(CongestionManager::NORMAL),
+    mReceivedPacketCount(0),
+    mCongestionDiscardCount(0)
 {
    InfoLog(<< "Flow: flow created for " << mLocalBinding << "  ComponentId=" << mComponentId);
 
+   mReceivedDataFifo.setDescription("Flow::mReceivedDataFifo");
+   if(mCongestionManager)
+   {
+      mCongestionManager->registerFifo(&mReceivedDataFifo);
+   }
+
    if(componentId != RTCP_COMPONENT_ID && mRtcpEventLoggingHandler.get())
    {
       ErrLog(<< "attempting to set an RTCPEventLoggingHandler for non-RTCP flow");
@@ -188,6 +199,14 @@ Flow::~Flow()
 {
    InfoLog(<< "Flow: flow destroyed for " << mLocalBinding << "  ComponentId=" << mComponentId);
 
+   if(mCongestionManager)
+   {
+      mCongestionManager->unregisterFifo(&mReceivedDataFifo);
+      if(mCongestionDiscardCount)
+      {
+         InfoLog(<< "Flow: " << mCongestionDiscardCount << " packets discarded due to congestion, componentId=" << mComponentId);
+      }
+   }
 
 #ifdef USE_SSL
    // Cleanup DtlsSockets
@@ -839,6 +858,21 @@ Flow::onReceiveSuccess(unsigned int socketDesc, const asio::ip::address& address
    }
 #endif 
 
+   // Early discard - once the expected wait time of the fifo is too high, queued media would
+   // only arrive late for playout, so drop it here instead of growing the fifo further
+   if(mCongestionManager && mReceivedPacketCount++ % CongestionCheckInterval == 0)
+   {
+      mCongestionBehavior = mCongestionManager->getRejectionBehavior(&mReceivedDataFifo);
+   }
+   if(mCongestionBehavior != CongestionManager::NORMAL)
+   {
+      if(mCongestionDiscardCount++ == 0)
+      {
+         WarningLog(<< "Flow::onReceiveSuccess: receive fifo congested - discarding data!  componentId=" << mComponentId);
+      }
+      return;
+   }
+
    if(!mReceivedDataFifo.add(new ReceivedData(address, port, data), ReceivedDataFifo::EnforceTimeDepth))
    {
       WarningLog(<< "Flow::onReceiveSuccess: TimeLimitFifo is full - discarding data!  componentId=" << mComponentId);
@@ -8,6 +8,7 @@
 #include <map>
 #include <rutil/TimeLimitFifo.hxx>
 #include <rutil/Mutex.hxx>
+#include <rutil/CongestionManager.hxx>
 
 #ifdef WIN32
 #include <srtp.h>
@@ -51,6 +52,11 @@ public:
 
    static int maxReceiveFifoDuration;
    static int maxReceiveFifoSize;
+   // If set, the receive fifo of each Flow created afterwards is registered with this 
+   // congestion manager (as "Flow::mReceivedDataFifo"), and received media is discarded
+   // early whenever the fifo is not in the NORMAL state.  Use the WAIT_TIME metric, so 
+   // that packets are dropped before the expected wait time makes them useless for playout.
+   static resip::CongestionManager* congestionManager;
 
    enum FlowState
    {
@@ -180,6 +186,13 @@ private:
    // FIFO for received data
    typedef resip::TimeLimitFifo<ReceivedData> ReceivedDataFifo;
    ReceivedDataFifo mReceivedDataFifo; 
+   resip::CongestionManager* mCongestionManager;
+   // The congestion manager takes a lock shared by all fifos, so its verdict
+   // is only refreshed every CongestionCheckInterval received packets
+   static const unsigned int CongestionCheckInterval = 16;
+   resip::CongestionManager::RejectionBehavior mCongestionBehavior;
+   unsigned int mReceivedPacketCount;
+   UInt64 mCongestionDiscardCount;
 
    // Helpers to perform SRTP protection/unprotection
    bool processSendData(char* buffer, unsigned int& size, const asio::ip::address& address, unsigned short port);
@@ -17,6 +17,7 @@
 #include "resip/stack/Helper.hxx"
 #include "resip/stack/SipMessage.hxx"
 #include "rutil/Logger.hxx"
+#include "rutil/Timer.hxx"
 
 #include "rutil/WinLeakCheck.hxx"
 
@@ -39,8 +40,16 @@ AccountingCollector::AccountingCollector(ProxyConfig& config) :
    mRegistrationAccountingAddRoutingHeaders(config.getConfigBool("RegistrationAccountingAddRoutingHeaders", false)),
    mRegistrationAccountingAddViaHeaders(config.getConfigBool("RegistrationAccountingAddViaHeaders", false)),
    mRegistrationAccountingLogRefreshes(config.getConfigBool("RegistrationAccountingLogRefreshes", false)),
-   mFifo(0, 0)  // not limited by time or size
+   mGroupCommitWindowMs(config.getConfigUnsignedLong("AccountingGroupCommitWindowMs", 0)),
+   mGroupCommitMaxEvents(config.getConfigUnsignedLong("AccountingGroupCommitMaxEvents", 256)),
+   mDroppedEvents(0),
+   mFifo(0, config.getConfigUnsignedLong("AccountingMaxQueuedEvents", 0))  // not limited by time, 0 for no size limit
 {
+   if(mGroupCommitMaxEvents == 0)
+   {
+      mGroupCommitMaxEvents = 1;
+   }
+
    if(config.getConfigBool("SessionAccountingEnabled", false))
    {
       if(!initializeEventQueue(SessionEventType))
@@ -646,63 +655,106 @@ AccountingCollector::pushEventObjectToQueue(Object& eventObject, AccountingColle
 
    // Note:  BerkeleyDb calls can block (ie. deaklock after consumer crash), so we use a 
    //        Fifo and thread to ensure we don't block the core proxy processing
-   mFifo.add(eventData, TimeLimitFifo<FifoEvent>::InternalElement);
+   if(!mFifo.add(eventData, TimeLimitFifo<FifoEvent>::InternalElement))
+   {
+      // Fifo is full - the accounting thread has fallen too far behind (or is blocked)
+      delete eventData;
+      UInt64 dropped = ++mDroppedEvents;
+      if(dropped == 1 || dropped % 1000 == 0)
+      {
+         WarningLog(<< "AccountingCollector: event fifo is full - dropping event, " << dropped << " event(s) dropped so far");
+      }
+   }
 }
 
 void 
-AccountingCollector::internalProcess(std::unique_ptr<FifoEvent> eventData)
+AccountingCollector::pushEventsToQueue(FifoEventType type, std::vector<Data>& events)
 {
-   InfoLog(<< "AccountingCollector::internalProcess: JSON=" << endl << eventData->mData);
+   if(events.empty())
+   {
+      return;
+   }
 
-   PersistentMessageEnqueue* queue = initializeEventQueue(eventData->mType);
+   PersistentMessageEnqueue* queue = initializeEventQueue(type);
 
    if(!queue)
    {
-      ErrLog(<< "AccountingCollector: cannot initialize PersistentMessageQueue - dropping event!");
+      ErrLog(<< "AccountingCollector: cannot initialize PersistentMessageQueue - dropping " << events.size() << " event(s)!");
+      events.clear();
       return;
    }
 
-   if(!queue->push(eventData->mData))
+   // All of the events are pushed in one transaction - if it fails then none of them were queued
+   if(!queue->push(events))
    {
       // Error pushing - see if db recovery is needed
       if(queue->isRecoveryNeeded())
       {
-         if((queue = initializeEventQueue(eventData->mType, true /* destoryFirst */)) == 0)
+         if((queue = initializeEventQueue(type, true /* destoryFirst */)) == 0)
          {
-            ErrLog(<< "AccountingCollector: cannot initialize PersistentMessageQueue - dropping event!");
-            return;
+            ErrLog(<< "AccountingCollector: cannot initialize PersistentMessageQueue - dropping " << events.size() << " event(s)!");
          }
          else
          {
-            if(!queue->push(eventData->mData))
+            if(!queue->push(events))
             {
-               ErrLog(<< "AccountingCollector: error pushing event to queue - dropping event!");
+               ErrLog(<< "AccountingCollector: error pushing events to queue - dropping " << events.size() << " event(s)!");
             }
          }
       }
       else
       {
-         ErrLog(<< "AccountingCollector: error pushing event to queue - dropping event!");
+         ErrLog(<< "AccountingCollector: error pushing events to queue - dropping " << events.size() << " event(s)!");
       }
    }
+   events.clear();
 }
 
 void 
 AccountingCollector::thread()
 {
+   std::vector<Data> sessionEvents;
+   std::vector<Data> registrationEvents;
    while (!isShutdown() || !mFifo.empty())  // Ensure we drain the queue before shutting down
    {
       try
       {
          std::unique_ptr<FifoEvent> eventData(mFifo.getNext(1000));  // Only need to wake up to see if we are shutdown
-         if (eventData)
+         if (!eventData)
          {
-            internalProcess(std::move(eventData));
+            continue;
          }
+
+         // Group commit: gather up whatever else is already waiting in the fifo, and whatever 
+         // arrives within the commit window, up to the max batch size - then push each type of
+         // event to its queue in a single transaction (one log write/fsync per batch, instead
+         // of one per event)
+         const UInt64 windowEnd = Timer::getTimeMs() + mGroupCommitWindowMs;
+         unsigned int numEvents = 0;
+         while (eventData)
+         {
+            InfoLog(<< "AccountingCollector::thread: JSON=" << endl << eventData->mData);
+            std::vector<Data>& events = eventData->mType == SessionEventType ? sessionEvents : registrationEvents;
+            events.push_back(Data::Empty);
+            events.back().takeBuf(eventData->mData);
+
+            if(++numEvents >= mGroupCommitMaxEvents)
+            {
+               break;
+            }
+            const UInt64 now = Timer::getTimeMs();
+            // a negative timeout only takes what is already waiting
+            eventData.reset(mFifo.getNext(now < windowEnd ? (int)(windowEnd - now) : -1));
+         }
+
+         pushEventsToQueue(SessionEventType, sessionEvents);
+         pushEventsToQueue(RegistrationEventType, registrationEvents);
       }
       catch (BaseException& e)
       {
          WarningLog (<< "Unhandled exception: " << e);
+         sessionEvents.clear();
+         registrationEvents.clear();
       }
    }
 }
@@ -1,7 +1,9 @@
 #if !defined(RESIP_ACCOUNTINGCOLLECTOR_HXX)
 #define RESIP_ACCOUNTINGCOLLECTOR_HXX 
 
+#include <atomic>
 #include <memory>
+#include <vector>
 #include "rutil/ThreadIf.hxx"
 #include "rutil/TimeLimitFifo.hxx"
 #include "resip/stack/SipMessage.hxx"
@@ -45,6 +47,9 @@ public:
    virtual void doSessionAccounting(const resip::SipMessage& sip, bool received, RequestContext& context);
    virtual void doRegistrationAccounting(RegistrationEvent regevent, const resip::SipMessage& sip);
 
+   // Number of events discarded because the collector fifo was full
+   UInt64 getDroppedEventCount() const { return mDroppedEvents; }
+
 private:
    resip::Data mDbBaseDir;
    PersistentMessageEnqueue* mSessionEventQueue;
@@ -54,6 +59,9 @@ private:
    bool mRegistrationAccountingAddRoutingHeaders;
    bool mRegistrationAccountingAddViaHeaders;
    bool mRegistrationAccountingLogRefreshes;
+   unsigned int mGroupCommitWindowMs;
+   unsigned int mGroupCommitMaxEvents;
+   std::atomic<UInt64> mDroppedEvents;
 
    virtual void thread();
 
@@ -71,7 +79,7 @@ private:
    resip::TimeLimitFifo<FifoEvent> mFifo;
    PersistentMessageEnqueue* initializeEventQueue(FifoEventType type, bool destroyFirst=false);
    void pushEventObjectToQueue(json::Object& object, FifoEventType type);
-   void internalProcess(std::unique_ptr<FifoEvent> eventData);
+   void pushEventsToQueue(FifoEventType type, std::vector<resip::Data>& events);
 };
 
 }
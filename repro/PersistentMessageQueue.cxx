@@ -231,6 +231,22 @@ PersistentMessageQueue::isRecoveryNeeded()
 
 bool 
 PersistentMessageEnqueue::push(const resip::Data& data)
+{
+   return push(&data, 1);
+}
+
+bool 
+PersistentMessageEnqueue::push(const std::vector<resip::Data>& records)
+{
+   if(records.empty())
+   {
+      return true;
+   }
+   return push(&records[0], records.size());
+}
+
+bool 
+PersistentMessageEnqueue::push(const resip::Data* records, size_t numRecords)
 {
 #ifndef DISABLE_BERKELEYDB_USE
    int res;
@@ -240,25 +256,26 @@ PersistentMessageEnqueue::push(const resip::Data& data)
       Transaction transaction;
       transaction.init(this);
 
-      db_recno_t recno; 
-      recno = 0;
-      Dbt val((void*)data.c_str(), data.size());
-      Dbt key((void*)&recno, sizeof(recno));
+      for(size_t i = 0; i < numRecords; i++)
+      {
+         db_recno_t recno; 
+         recno = 0;
+         Dbt val((void*)records[i].data(), records[i].size());
+         Dbt key((void*)&recno, sizeof(recno));
 
-      key.set_ulen(sizeof(recno));
-      key.set_flags(DB_DBT_USERMEM);
+         key.set_ulen(sizeof(recno));
+         key.set_flags(DB_DBT_USERMEM);
 
-      res = mDb->put(transaction.mDbTxn, &key, &val, DB_APPEND);
-      if(res == 0)
-      {
-         transaction.commit();
-         return true;
-      } 
-      else
-      {
-         WarningLog( << "PersistentMessageEnqueue::push - put failed: " << db_strerror(res));
-         return false;
+         res = mDb->put(transaction.mDbTxn, &key, &val, DB_APPEND);
+         if(res != 0)
+         {
+            // transaction is aborted by its destructor, so none of the records are queued
+            WarningLog( << "PersistentMessageEnqueue::push - put failed: " << db_strerror(res));
+            return false;
+         }
       }
+      transaction.commit();
+      return true;
    } 
    catch(DbException& e)
    {
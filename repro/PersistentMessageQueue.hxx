@@ -151,6 +151,14 @@ public:
    // Note:  this has a potential to block if the a consumer crashes and leaves a lock open on the database (deadlock)
    // typically restarting the consumer will "recover" the "dead" lock and allow this call to unblock
    bool push(const resip::Data& data);
+
+   // Group commit - pushes all of the records within a single transaction, so they share one 
+   // log write (and one fsync if the queue was initialized with sync=true).  Either all of the 
+   // records are queued or, on failure, none of them are.
+   bool push(const std::vector<resip::Data>& records);
+
+private:
+   bool push(const resip::Data* records, size_t numRecords);
 };  
 
 class PersistentMessageDequeue : public PersistentMessageQueue 
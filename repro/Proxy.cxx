@@ -10,6 +10,7 @@
 
 #include "resip/stack/TransactionTerminated.hxx"
 #include "resip/stack/ApplicationMessage.hxx"
+#include "resip/stack/ExtensionParameter.hxx"
 #include "resip/stack/SipStack.hxx"
 #include "resip/stack/Helper.hxx"
 #include "resip/stack/InteropHelper.hxx"
@@ -19,6 +20,7 @@
 #include "rutil/Inserter.hxx"
 #include "rutil/WinLeakCheck.hxx"
 
+#include <string.h>
 #include <utility>
 
 #define RESIPROCATE_SUBSYSTEM resip::Subsystem::REPRO
@@ -74,6 +76,25 @@ RequestContextFactory::createRequestContext(Proxy& proxy,
    return new RequestContext(proxy, requestP, responseP, targetP); 
 }
 
+// Record-Routes are copied into forwarded requests.  Build copies of the 
+// configured Record-Route with the ;lr that Helper::massageRoute() would 
+// otherwise add to every copy, and with ;drr as well, and freeze both so that 
+// unmodified copies are not re-encoded.  The configured one is left as is.
+static void
+prepareRecordRoute(const NameAddr& recordRoute, NameAddr& lrRecordRoute, NameAddr& drrRecordRoute)
+{
+   static ExtensionParameter p_drr("drr");
+   lrRecordRoute = recordRoute;
+   if(!recordRoute.uri().host().empty())
+   {
+      lrRecordRoute.uri().param(p_lr);
+   }
+   drrRecordRoute = lrRecordRoute;
+   drrRecordRoute.uri().param(p_drr);
+   lrRecordRoute.freeze();
+   drrRecordRoute.freeze();
+}
+
 Proxy::Proxy(SipStack& stack, 
              ProxyConfig& config,
              ProcessorChain& requestP, 
@@ -105,8 +126,12 @@ Proxy::Proxy(SipStack& stack,
 {
    FlowTokenSalt = Random::getCryptoRandom(20);   // 20-octet Crypto Random Key for Salting Flow Token HMACs
 
+   memset(mArenaUsage, 0, sizeof(mArenaUsage));
+
    mFifo.setDescription("Proxy::mFifo");
 
+   prepareRecordRoute(mRecordRoute, mLrRecordRoute, mDrrRecordRoute);
+
    if(InteropHelper::getOutboundSupported())
    {
       addSupportedOption("outbound");
@@ -537,6 +562,48 @@ Proxy::processUnknownMessage(Message* msg)
    resip_assert(false);
 }
 
+void
+Proxy::recordArenaUsage(MethodTypes method, const ArenaPool& arena)
+{
+   if(arena.getHeapBytes() > 0)
+   {
+      InfoLog(<< "RequestContext arena for " << getMethodName(method) << " filled up, "
+              << arena.getHeapBytes() << " bytes were allocated on the heap");
+   }
+
+   Lock lock(mArenaUsageMutex);
+   ArenaUsage& usage = mArenaUsage[method];
+   ++usage.contexts;
+   usage.totalBytes += arena.getHighWaterBytes();
+   if(arena.getHighWaterBytes() > usage.highWaterBytes)
+   {
+      usage.highWaterBytes = arena.getHighWaterBytes();
+   }
+   if(arena.getHeapBytes() > 0)
+   {
+      ++usage.overflows;
+   }
+}
+
+EncodeStream&
+Proxy::encodeArenaUsage(EncodeStream& strm) const
+{
+   Lock lock(mArenaUsageMutex);
+   for(int m = 0; m < MAX_METHODS; ++m)
+   {
+      const ArenaUsage& usage = mArenaUsage[m];
+      if(usage.contexts)
+      {
+         strm << getMethodName(MethodTypes(m)) << ": requests=" << usage.contexts
+              << " meanBytes=" << usage.totalBytes / usage.contexts
+              << " highWaterBytes=" << usage.highWaterBytes
+              << " overflows=" << usage.overflows << std::endl;
+      }
+   }
+   strm.flush();
+   return strm;
+}
+
 void
 Proxy::send(const SipMessage& msg) 
 {
@@ -612,12 +679,17 @@ Proxy::addTransportRecordRoute(unsigned int transportKey, const resip::NameAddr&
 {
    Lock lock(mTransportRecordRouteMutex);
    mTransportRecordRoutes[transportKey] = recordRoute;
+   prepareRecordRoute(recordRoute,
+                      mTransportLrRecordRoutes[transportKey],
+                      mTransportDrrRecordRoutes[transportKey]);
 }
 
 void Proxy::removeTransportRecordRoute(unsigned int transportKey)
 {
    Lock lock(mTransportRecordRouteMutex);
    mTransportRecordRoutes.erase(transportKey);
+   mTransportLrRecordRoutes.erase(transportKey);
+   mTransportDrrRecordRoutes.erase(transportKey);
 }
 
 const resip::NameAddr& 
@@ -641,6 +713,30 @@ Proxy::getRecordRoute(unsigned int transportKey, bool* transportSpecific) const
    return mRecordRoute;
 }
 
+const resip::NameAddr& 
+Proxy::getLrRecordRoute(unsigned int transportKey) const
+{
+   Lock lock(mTransportRecordRouteMutex);
+   TransportRecordRouteMap::const_iterator it = mTransportLrRecordRoutes.find(transportKey);
+   if(it != mTransportLrRecordRoutes.end())
+   {
+      return it->second;
+   }
+   return mLrRecordRoute;
+}
+
+const resip::NameAddr& 
+Proxy::getDrrRecordRoute(unsigned int transportKey) const
+{
+   Lock lock(mTransportRecordRouteMutex);
+   TransportRecordRouteMap::const_iterator it = mTransportDrrRecordRoutes.find(transportKey);
+   if(it != mTransportDrrRecordRoutes.end())
+   {
+      return it->second;
+   }
+   return mDrrRecordRoute;
+}
+
 bool 
 Proxy::compressionEnabled() const
 {
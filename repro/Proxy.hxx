@@ -77,6 +77,12 @@ class Proxy : public resip::TransactionUser, public resip::ThreadIf
       void addTransportRecordRoute(unsigned int transportKey, const resip::NameAddr& recordRoute);
       void removeTransportRecordRoute(unsigned int transportKey);
       const resip::NameAddr& getRecordRoute(unsigned int transportKey, bool* transportSpecific = 0) const;
+      // As getRecordRoute(), with the ;lr parameter already in place; 
+      // encoded once, for copying into forwarded requests
+      const resip::NameAddr& getLrRecordRoute(unsigned int transportKey) const;
+      // As getLrRecordRoute(), with the ;drr parameter used when double 
+      // record-routing also in place
+      const resip::NameAddr& getDrrRecordRoute(unsigned int transportKey) const;
       bool getRecordRouteForced() const { return mRecordRouteForced; }
       void setRecordRouteForced(bool forced) { mRecordRouteForced = forced; }
 
@@ -106,17 +112,28 @@ class Proxy : public resip::TransactionUser, public resip::ThreadIf
 
       void doSessionAccounting(const resip::SipMessage& sip, bool received, RequestContext& context);
       void doRegistrationAccounting(repro::AccountingCollector::RegistrationEvent regEvent, const resip::SipMessage& sip);
+      // 0 unless session or registration accounting is enabled
+      const AccountingCollector* getAccountingCollector() const { return mAccountingCollector; }
 
       virtual void processUnknownMessage(resip::Message* msg);
 
+      /// Called by each RequestContext as it goes away, to keep track of how
+      /// much of its arena the requests of each method use.
+      void recordArenaUsage(resip::MethodTypes method, const resip::ArenaPool& arena);
+      EncodeStream& encodeArenaUsage(EncodeStream& strm) const;
+
    protected:
       virtual const resip::Data& name() const;
 
       resip::SipStack& mStack;
       ProxyConfig& mConfig;
       resip::NameAddr mRecordRoute;
+      resip::NameAddr mLrRecordRoute;
+      resip::NameAddr mDrrRecordRoute;
       typedef std::map<unsigned int, resip::NameAddr> TransportRecordRouteMap;
       TransportRecordRouteMap mTransportRecordRoutes;
+      TransportRecordRouteMap mTransportLrRecordRoutes;
+      TransportRecordRouteMap mTransportDrrRecordRoutes;
       mutable resip::Mutex mTransportRecordRouteMutex;
 
       bool mRecordRouteForced;
@@ -149,6 +166,16 @@ class Proxy : public resip::TransactionUser, public resip::ThreadIf
       bool mRegistrationAccountingEnabled;
       AccountingCollector* mAccountingCollector;
 
+      struct ArenaUsage
+      {
+         UInt64 contexts;
+         UInt64 totalBytes;
+         size_t highWaterBytes;
+         UInt64 overflows; // contexts that used the heap once the arena was full
+      };
+      ArenaUsage mArenaUsage[resip::MAX_METHODS];
+      mutable resip::Mutex mArenaUsageMutex;
+
       // disabled
       Proxy();
 };
@@ -94,9 +94,10 @@ RRDecorator::decorateMessage(resip::SipMessage& request,
       routes=&(request.header(resip::h_RecordRoutes));
    }
 
+   const resip::NameAddrs& constRoutes = *routes;
    if(routes->size() > 1 && 
       mAddedRecordRoute && 
-      routes->front().uri().exists(p_drr))
+      constRoutes.front().uri().exists(p_drr))
    {
       // .bwc. It is possible that we have duplicate Record-Routes at this 
       // point, if we have done a transport switch but both transports use the 
@@ -118,11 +119,31 @@ RRDecorator::singleRecordRoute(resip::SipMessage& request,
                                const resip::Tuple &destination,
                                const resip::Data& sigcompId)
 {
-   resip::NameAddr rt;
+   static ExtensionParameter p_drr("drr");
+   resip::NameAddrs* routes=0;
+   if(mDoPath)
+   {
+      routes=&(request.header(resip::h_Paths));
+   }
+   else
+   {
+      routes=&(request.header(resip::h_RecordRoutes));
+   }
+
+   resip_assert(routes->size() > 0);
+   // Only touch the existing route through non-const accessors if it does not 
+   // already carry ;drr, so that a frozen one stays frozen.
+   const NameAddr& previous = routes->front();
+   if(!previous.uri().exists(p_drr))
+   {
+      routes->front().uri().param(p_drr);
+   }
+
    // .bwc. outboundFlowTokenNeeded means that we are assuming that whoever is
    // just downstream will remain in the call-path throughout the dialog.
    if(outboundFlowTokenNeeded(request, source, destination, sigcompId))
    {
+      resip::NameAddr rt;
       if(isSecure(destination.getType()))
       {
          rt = mProxy.getRecordRoute(destination.mTransportKey);
@@ -149,39 +170,34 @@ RRDecorator::singleRecordRoute(resip::SipMessage& request,
       resip::Tuple::writeBinaryToken(destination, binaryFlowToken, Proxy::FlowTokenSalt);
       
       rt.uri().user()=binaryFlowToken.base64encode();
+      rt.uri().param(p_drr);
+      routes->push_front(rt);
    }
    else
    {
-      // No need for a flow-token; just use an ordinary record-route.
-      rt = mProxy.getRecordRoute(destination.mTransportKey);
-      resip::Helper::massageRoute(request,rt);
+      // No need for a flow-token; just use an ordinary record-route. The 
+      // proxy keeps one with ;drr already added, so unless massageRoute() has
+      // to change it this goes out with the encoding cached in the proxy.
+      routes->push_front(mProxy.getDrrRecordRoute(destination.mTransportKey));
+      resip::Helper::massageRoute(request,routes->front());
    }
 
 #ifdef USE_SIGCOMP
    if(mProxy.compressionEnabled() && !sigcompId.empty())
    {
-      rt.uri().param(p_comp)="sigcomp";
+      routes->front().uri().param(p_comp)="sigcomp";
    }
 #endif
 
-   static ExtensionParameter p_drr("drr");
-   rt.uri().param(p_drr);
-
-   resip::NameAddrs* routes=0;
+   const NameAddr& added = routes->front();
    if(mDoPath)
    {
-      routes=&(request.header(resip::h_Paths));
-      InfoLog(<< "Adding outbound Path: " << rt);
+      InfoLog(<< "Adding outbound Path: " << added);
    }
    else
    {
-      routes=&(request.header(resip::h_RecordRoutes));
-      InfoLog(<< "Adding outbound Record-Route: " << rt);
+      InfoLog(<< "Adding outbound Record-Route: " << added);
    }
-
-   resip_assert(routes->size() > 0);
-   routes->front().uri().param(p_drr);
-   routes->push_front(rt);
    ++mAddedRecordRoute;
 }
 
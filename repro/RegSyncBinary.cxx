@@ -0,0 +1,310 @@
+#if defined(HAVE_CONFIG_H)
+#include "config.h"
+#endif
+
+#include <resip/stack/Tuple.hxx>
+#include <rutil/Data.hxx>
+#include <rutil/ParseException.hxx>
+#include <rutil/ResipAssert.h>
+
+#include "repro/RegSyncBinary.hxx"
+
+using namespace repro;
+using namespace resip;
+using namespace std;
+
+namespace
+{
+
+void
+writeUInt32(Data& frame, UInt32 value)
+{
+   char buf[4];
+   buf[0] = (char)(value >> 24);
+   buf[1] = (char)(value >> 16);
+   buf[2] = (char)(value >> 8);
+   buf[3] = (char)value;
+   frame.append(buf, 4);
+}
+
+void
+writeUInt64(Data& frame, UInt64 value)
+{
+   writeUInt32(frame, (UInt32)(value >> 32));
+   writeUInt32(frame, (UInt32)value);
+}
+
+void
+writeString(Data& frame, const Data& value)
+{
+   writeUInt32(frame, (UInt32)value.size());
+   frame.append(value.data(), value.size());
+}
+
+void
+startFrame(Data& frame, RegSyncBinary::FrameType type)
+{
+   frame.clear();
+   frame += RegSyncBinary::FrameMarker;
+   frame += (char)type;
+   writeUInt32(frame, 0);  // payload length, filled in by endFrame
+}
+
+void
+endFrame(Data& frame)
+{
+   UInt32 length = (UInt32)(frame.size() - RegSyncBinary::HeaderSize);
+   frame[2] = (char)(length >> 24);
+   frame[3] = (char)(length >> 16);
+   frame[4] = (char)(length >> 8);
+   frame[5] = (char)length;
+}
+
+UInt32
+peekUInt32(const char* pos)
+{
+   const unsigned char* p = (const unsigned char*)pos;
+   return ((UInt32)p[0] << 24) | ((UInt32)p[1] << 16) | ((UInt32)p[2] << 8) | (UInt32)p[3];
+}
+
+// Bounds checked cursor over the payload of a complete frame
+class FrameReader
+{
+public:
+   FrameReader(const char* frame, unsigned int size) :
+      mPos(frame + RegSyncBinary::HeaderSize),
+      mEnd(frame + size) {}
+
+   UInt32 readUInt32()
+   {
+      need(4);
+      UInt32 value = peekUInt32(mPos);
+      mPos += 4;
+      return value;
+   }
+   UInt64 readUInt64()
+   {
+      UInt64 high = readUInt32();
+      return (high << 32) | readUInt32();
+   }
+   unsigned char readUInt8()
+   {
+      need(1);
+      return (unsigned char)*mPos++;
+   }
+   Data readString()
+   {
+      UInt32 length = readUInt32();
+      need(length);
+      Data value(mPos, length);
+      mPos += length;
+      return value;
+   }
+
+private:
+   void need(UInt32 bytes)
+   {
+      if ((UInt32)(mEnd - mPos) < bytes)
+      {
+         throw ParseException("Truncated RegSync binary frame", "RegSyncBinary", __FILE__, __LINE__);
+      }
+   }
+
+   const char* mPos;
+   const char* mEnd;
+};
+
+}
+
+unsigned int
+RegSyncBinary::encodeAorUpdate(Data& frame, const Uri& aor, const ContactList& contacts, UInt64 now)
+{
+   unsigned int count = 0;
+   Data contactData;
+   for (ContactList::const_iterator it = contacts.begin(); it != contacts.end(); it++)
+   {
+      const ContactInstanceRecord& rec = *it;
+      if (rec.mReceivedFrom.onlyUseExistingConnection ||
+          rec.mRegExpires == NeverExpire)  // Don't sync over static registrations
+      {
+         continue;
+      }
+
+      writeString(contactData, Data::from(rec.mContact));
+      // If contact is expired or removed, then pass expires time as 0, otherwise send number of seconds until expiry
+      writeUInt64(contactData, ((rec.mRegExpires == 0) || (rec.mRegExpires <= now)) ? 0 : (rec.mRegExpires - now));
+      // mLastUpdated can be ahead of now after a clock step, or when it came from a peer
+      writeUInt64(contactData, rec.mLastUpdated < now ? now - rec.mLastUpdated : 0);
+      Data binaryFlowToken;
+      if (rec.mReceivedFrom.getPort() != 0)
+      {
+         Tuple::writeBinaryToken(rec.mReceivedFrom, binaryFlowToken);
+      }
+      writeString(contactData, binaryFlowToken);
+      binaryFlowToken.clear();
+      if (rec.mPublicAddress.getType() != UNKNOWN_TRANSPORT)
+      {
+         Tuple::writeBinaryToken(rec.mPublicAddress, binaryFlowToken);
+      }
+      writeString(contactData, binaryFlowToken);
+      writeUInt32(contactData, (UInt32)rec.mSipPath.size());
+      for (NameAddrs::const_iterator naIt = rec.mSipPath.begin(); naIt != rec.mSipPath.end(); naIt++)
+      {
+         writeString(contactData, Data::from(naIt->uri()));
+      }
+      writeString(contactData, rec.mInstance);
+      writeUInt32(contactData, rec.mRegId);
+      writeString(contactData, rec.mUserAgent);
+      count++;
+   }
+
+   if (count > 0)
+   {
+      Data aorData(Data::from(aor));
+      frame.reserve(HeaderSize + 8 + 4 + aorData.size() + 4 + contactData.size());
+      startFrame(frame, AorUpdate);
+      writeUInt64(frame, 0);  // sequence, set with setSequence
+      writeString(frame, aorData);
+      writeUInt32(frame, count);
+      frame += contactData;
+      endFrame(frame);
+   }
+   return count;
+}
+
+void
+RegSyncBinary::setSequence(Data& frame, UInt64 seq)
+{
+   resip_assert(frame.size() >= HeaderSize + 8);
+   for (int i = 7; i >= 0; i--)
+   {
+      frame[HeaderSize + i] = (char)seq;
+      seq >>= 8;
+   }
+}
+
+void
+RegSyncBinary::encodeSyncMarker(Data& frame, FrameType type, UInt64 epoch, UInt64 seq, bool resumed)
+{
+   startFrame(frame, type);
+   writeUInt64(frame, epoch);
+   writeUInt64(frame, seq);
+   frame += (char)(resumed ? 1 : 0);
+   endFrame(frame);
+}
+
+unsigned int
+RegSyncBinary::frameSize(const char* buffer, unsigned int size)
+{
+   if (size < HeaderSize)
+   {
+      return 0;
+   }
+   if (buffer[0] != FrameMarker)
+   {
+      throw ParseException("Missing RegSync binary frame marker", "RegSyncBinary", __FILE__, __LINE__);
+   }
+   UInt32 length = peekUInt32(buffer + 2);
+   if (length > MaxPayloadSize)
+   {
+      throw ParseException("RegSync binary frame too large", "RegSyncBinary", __FILE__, __LINE__);
+   }
+   return size - HeaderSize >= length ? HeaderSize + length : 0;
+}
+
+void
+RegSyncBinary::decodeAorUpdate(const char* frame, unsigned int size, UInt64 now, UInt64& seq, Uri& aor, ContactList& contacts)
+{
+   FrameReader reader(frame, size);
+   seq = reader.readUInt64();
+   aor = Uri(reader.readString());
+   UInt32 count = reader.readUInt32();
+   for (UInt32 i = 0; i < count; i++)
+   {
+      ContactInstanceRecord rec;
+      rec.mContact = NameAddr(reader.readString());
+      UInt64 expires = reader.readUInt64();
+      rec.mRegExpires = (expires == 0 ? 0 : now + expires);
+      UInt64 age = reader.readUInt64();
+      rec.mLastUpdated = age < now ? now - age : 0;
+      Data binaryFlowToken = reader.readString();
+      if (!binaryFlowToken.empty())
+      {
+         rec.mReceivedFrom = Tuple::makeTupleFromBinaryToken(binaryFlowToken);
+      }
+      binaryFlowToken = reader.readString();
+      if (!binaryFlowToken.empty())
+      {
+         rec.mPublicAddress = Tuple::makeTupleFromBinaryToken(binaryFlowToken);
+      }
+      UInt32 pathCount = reader.readUInt32();
+      for (UInt32 p = 0; p < pathCount; p++)
+      {
+         rec.mSipPath.push_back(NameAddr(reader.readString()));
+      }
+      rec.mInstance = reader.readString();
+      rec.mRegId = reader.readUInt32();
+      rec.mUserAgent = reader.readString();
+      rec.mSyncContact = true;  // This ContactInstanceRecord came from registration sync process
+      contacts.push_back(rec);
+   }
+}
+
+void
+RegSyncBinary::decodeSyncMarker(const char* frame, unsigned int size, UInt64& epoch, UInt64& seq, bool& resumed)
+{
+   FrameReader reader(frame, size);
+   epoch = reader.readUInt64();
+   seq = reader.readUInt64();
+   resumed = reader.readUInt8() != 0;
+}
+
+/* ====================================================================
+ * The Vovida Software License, Version 1.0 
+ * 
+ * Copyright (c) 2000 Vovida Networks, Inc.  All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 
+ * 3. The names "VOCAL", "Vovida Open Communication Application Library",
+ *    and "Vovida Open Communication Application Library (VOCAL)" must
+ *    not be used to endorse or promote products derived from this
+ *    software without prior written permission. For written
+ *    permission, please contact vocal@vovida.org.
+ *
+ * 4. Products derived from this software may not be called "VOCAL", nor
+ *    may "VOCAL" appear in their name, without prior written
+ *    permission of Vovida Networks, Inc.
+ * 
+ * THIS SOFTWARE IS PROVIDED "AS IS" AND ANY EXPRESSED OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, TITLE AND
+ * NON-INFRINGEMENT ARE DISCLAIMED.  IN NO EVENT SHALL VOVIDA
+ * NETWORKS, INC. OR ITS CONTRIBUTORS BE LIABLE FOR ANY DIRECT DAMAGES
+ * IN EXCESS OF $1,000, NOR FOR ANY INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+ * USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+ * DAMAGE.
+ * 
+ * ====================================================================
+ * 
+ * This software consists of voluntary contributions made by Vovida
+ * Networks, Inc. and many individuals on behalf of Vovida Networks,
+ * Inc.  For more information on Vovida Networks, Inc., please see
+ * <http://www.vovida.org/>.
+ *
+ */
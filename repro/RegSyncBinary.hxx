@@ -0,0 +1,140 @@
+#if !defined(RegSyncBinary_hxx)
+#define RegSyncBinary_hxx
+
+#include <rutil/Data.hxx>
+#include <rutil/compat.hxx>
+#include <resip/stack/Uri.hxx>
+#include <resip/dum/ContactInstanceRecord.hxx>
+
+namespace repro
+{
+
+/**
+  Encoding and decoding of the binary RegSync replication format.
+
+  A RegSyncClient can ask for this format by adding <Format>binary</Format>
+  to its InitialSync request.  Servers that do not know the element ignore it
+  and keep sending XML, so XML remains the fallback.  Requests and responses
+  stay XML in both directions; only the server to client event stream changes.
+
+  Each binary frame is a FrameMarker byte (which can never start an XML
+  document), a frame type byte, a 4 byte payload length and the payload.
+  All integers are big endian and strings are a 4 byte length followed by
+  the bytes.
+
+  AorUpdate frames carry a sequence number, the AOR and only the contacts
+  that changed.  Every frame a server sends is numbered from the same
+  sequence, so a client that keeps the epoch and the last sequence it saw
+  can resume from the server's replay log after reconnecting instead of
+  asking for a full snapshot.  SyncBegin and SyncEnd bracket the snapshot or
+  replayed frames sent in reply to an InitialSync request.
+*/
+class RegSyncBinary
+{
+public:
+   static const char FrameMarker = '\0';
+   static const unsigned int HeaderSize = 6;  // marker, type, length
+   static const unsigned int MaxPayloadSize = 16*1024*1024;
+
+   typedef enum
+   {
+      AorUpdate = 1,
+      SyncBegin = 2,
+      SyncEnd = 3
+   } FrameType;
+
+   // Encodes the syncable contacts in contacts (static registrations are skipped)
+   // into frame with the sequence number left as 0.  Returns the number of
+   // contacts encoded.  Expiry and last update times are sent relative to now.
+   static unsigned int encodeAorUpdate(resip::Data& frame,
+                                       const resip::Uri& aor,
+                                       const resip::ContactList& contacts,
+                                       UInt64 now);
+   // Stores seq into a frame produced by encodeAorUpdate
+   static void setSequence(resip::Data& frame, UInt64 seq);
+
+   // SyncBegin - resumed is true if the frames that follow come from the replay
+   // log and not from a snapshot; seq is the position the snapshot was taken at
+   // or the last sequence the client reported.
+   // SyncEnd - seq is the last sequence covered by the sync.
+   static void encodeSyncMarker(resip::Data& frame,
+                                FrameType type,
+                                UInt64 epoch,
+                                UInt64 seq,
+                                bool resumed);
+
+   // Returns the size of the complete frame at the start of buffer, or 0 if
+   // more data is needed.  Throws ParseException if the header is invalid.
+   static unsigned int frameSize(const char* buffer, unsigned int size);
+
+   static FrameType frameType(const char* frame) { return (FrameType)(unsigned char)frame[1]; }
+
+   // Decoders take a complete frame as returned by frameSize and throw
+   // ParseException if it is malformed.  Times are converted back to
+   // absolute values using now.
+   static void decodeAorUpdate(const char* frame,
+                               unsigned int size,
+                               UInt64 now,
+                               UInt64& seq,
+                               resip::Uri& aor,
+                               resip::ContactList& contacts);
+   static void decodeSyncMarker(const char* frame,
+                                unsigned int size,
+                                UInt64& epoch,
+                                UInt64& seq,
+                                bool& resumed);
+};
+
+}
+
+#endif
+
+/* ====================================================================
+ * The Vovida Software License, Version 1.0 
+ * 
+ * Copyright (c) 2000 Vovida Networks, Inc.  All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 
+ * 3. The names "VOCAL", "Vovida Open Communication Application Library",
+ *    and "Vovida Open Communication Application Library (VOCAL)" must
+ *    not be used to endorse or promote products derived from this
+ *    software without prior written permission. For written
+ *    permission, please contact vocal@vovida.org.
+ *
+ * 4. Products derived from this software may not be called "VOCAL", nor
+ *    may "VOCAL" appear in their name, without prior written
+ *    permission of Vovida Networks, Inc.
+ * 
+ * THIS SOFTWARE IS PROVIDED "AS IS" AND ANY EXPRESSED OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, TITLE AND
+ * NON-INFRINGEMENT ARE DISCLAIMED.  IN NO EVENT SHALL VOVIDA
+ * NETWORKS, INC. OR ITS CONTRIBUTORS BE LIABLE FOR ANY DIRECT DAMAGES
+ * IN EXCESS OF $1,000, NOR FOR ANY INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+ * USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+ * DAMAGE.
+ * 
+ * ====================================================================
+ * 
+ * This software consists of voluntary contributions made by Vovida
+ * Networks, Inc. and many individuals on behalf of Vovida Networks,
+ * Inc.  For more information on Vovida Networks, Inc., please see
+ * <http://www.vovida.org/>.
+ *
+ */
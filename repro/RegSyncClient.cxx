@@ -12,6 +12,7 @@
 #include <rutil/TransportType.hxx>
 #include <rutil/Timer.hxx>
 
+#include "repro/RegSyncBinary.hxx"
 #include "repro/RegSyncClient.hxx"
 #include "repro/RegSyncServer.hxx"
 
@@ -24,11 +25,16 @@ using namespace std;
 RegSyncClient::RegSyncClient(InMemorySyncRegDb* regDb,
                              Data address,
                              unsigned short port,
-                             InMemorySyncPubDb* pubDb) :
+                             InMemorySyncPubDb* pubDb,
+                             bool binaryFormat) :
    mRegDb(regDb),
    mPubDb(pubDb),
    mAddress(address),
    mPort(port),
+   mBinaryFormat(binaryFormat),
+   mEpoch(0),
+   mLastSeq(0),
+   mResumable(false),
    mSocketDesc(0)
 {
     resip_assert(mRegDb);
@@ -124,9 +130,21 @@ RegSyncClient::thread()
       Data request(
          "<InitialSync>\r\n"
          "  <Request>\r\n"
-         "     <Version>" + Data(REGSYNC_VERSION) + "</Version>\r\n"   // For use in detecting if client/server are a compatible version
+         "     <Version>" + Data(REGSYNC_VERSION) + "</Version>\r\n");   // For use in detecting if client/server are a compatible version
+      if(mBinaryFormat)
+      {
+         // Servers that don't know these elements ignore them and reply in XML
+         request += "     <Format>binary</Format>\r\n";
+         if(mResumable)
+         {
+            request += "     <ResumeEpoch>" + Data(mEpoch) + "</ResumeEpoch>\r\n";
+            request += "     <ResumeSeq>" + Data(mLastSeq) + "</ResumeSeq>\r\n";
+         }
+      }
+      request += 
          "  </Request>\r\n"
-         "</InitialSync>\r\n");   
+         "</InitialSync>\r\n";
+      mRxDataBuffer.clear();
       rc = ::send(mSocketDesc, request.c_str(), (int)request.size(), 0);
       if(rc < 0) 
       {
@@ -177,7 +195,7 @@ RegSyncClient::thread()
          }
          else if(rc == 0) // timeout - send keepalive
          {
-            rc = ::send(mSocketDesc, Symbols::CRLFCRLF, (int)request.size(), 0);
+            rc = ::send(mSocketDesc, Symbols::CRLFCRLF, (int)strlen(Symbols::CRLFCRLF), 0);
             if(rc < 0) 
             {
                int e = getErrno();
@@ -204,6 +222,12 @@ RegSyncClient::thread()
              break;
          }
       }
+      if(mSocketDesc)
+      {
+         // Connection closed by peer
+         closeSocket(mSocketDesc);
+         mSocketDesc = 0;
+      }
    } // end while
 
    if(mSocketDesc) closeSocket(mSocketDesc);
@@ -212,6 +236,22 @@ RegSyncClient::thread()
 bool 
 RegSyncClient::tryParse()
 {
+   // Binary frames and XML documents can be interleaved - XML is still used for responses and publications
+   const char* pos = mRxDataBuffer.data();
+   const char* end = pos + mRxDataBuffer.size();
+   while(pos < end && isspace((unsigned char)*pos))
+   {
+      pos++;
+   }
+   if(pos < end && *pos == RegSyncBinary::FrameMarker)
+   {
+      if(pos != mRxDataBuffer.data())
+      {
+         mRxDataBuffer = Data(pos, (Data::size_type)(end - pos));
+      }
+      return tryParseBinary();
+   }
+
    ParseBuffer pb(mRxDataBuffer);
    Data initialTag;
    const char* start = pb.position();
@@ -251,6 +291,113 @@ RegSyncClient::tryParse()
    return false;
 }
 
+bool
+RegSyncClient::tryParseBinary()
+{
+   const char* buffer = mRxDataBuffer.data();
+   unsigned int size = (unsigned int)mRxDataBuffer.size();
+   unsigned int offset = 0;
+   try
+   {
+      while(offset < size && buffer[offset] == RegSyncBinary::FrameMarker)
+      {
+         unsigned int frameSize = RegSyncBinary::frameSize(buffer + offset, size - offset);
+         if(frameSize == 0)
+         {
+            break;  // wait for the rest of the frame
+         }
+         handleBinaryFrame(buffer + offset, frameSize);
+         offset += frameSize;
+      }
+   }
+   catch(BaseException& e)
+   {
+      // Framing is lost - drop the connection and start again with a full snapshot
+      ErrLog(<< "RegSyncClient::tryParseBinary: invalid frame, reconnecting: " << e);
+      mRxDataBuffer.clear();
+      mResumable = false;
+      if(mSocketDesc)
+      {
+#ifdef WIN32
+         ::shutdown(mSocketDesc, SD_BOTH);
+#else
+         ::shutdown(mSocketDesc, SHUT_RDWR);
+#endif
+      }
+      return false;
+   }
+
+   // Remove processed frames from RxBuffer
+   if(offset == size)
+   {
+      mRxDataBuffer.clear();
+      return false;
+   }
+   if(offset > 0)
+   {
+      mRxDataBuffer = Data(buffer + offset, size - offset);
+   }
+   // More to do if an XML document follows
+   return offset > 0 && mRxDataBuffer[0] != RegSyncBinary::FrameMarker;
+}
+
+void
+RegSyncClient::handleBinaryFrame(const char* frame, unsigned int size)
+{
+   UInt64 epoch;
+   UInt64 seq;
+   bool resumed;
+   try
+   {
+      switch(RegSyncBinary::frameType(frame))
+      {
+      case RegSyncBinary::AorUpdate:
+         {
+            Uri aor;
+            ContactList contacts;
+            RegSyncBinary::decodeAorUpdate(frame, size, Timer::getTimeSecs(), seq, aor, contacts);
+            if(mRegDb)
+            {
+               processModify(aor, contacts);
+            }
+            // Snapshot records have sequence 0.  Replayed and live updates can overlap and arrive
+            // out of order, which processModify tolerates - resume after the highest one seen.
+            if(seq > mLastSeq)
+            {
+               mLastSeq = seq;
+            }
+         }
+         break;
+      case RegSyncBinary::SyncBegin:
+         RegSyncBinary::decodeSyncMarker(frame, size, epoch, seq, resumed);
+         InfoLog(<< "RegSyncClient::handleBinaryFrame: " << (resumed ? "resuming" : "snapshot") << " sync from seq=" << seq << ", epoch=" << epoch);
+         mEpoch = epoch;
+         mLastSeq = seq;
+         mResumable = false;  // until SyncEnd
+         break;
+      case RegSyncBinary::SyncEnd:
+         RegSyncBinary::decodeSyncMarker(frame, size, epoch, seq, resumed);
+         if(seq > mLastSeq)
+         {
+            mLastSeq = seq;
+         }
+         mResumable = (epoch == mEpoch);
+         InfoLog(<< "RegSyncClient::handleBinaryFrame: InitialSync complete at seq=" << mLastSeq);
+         break;
+      default:
+         WarningLog(<< "RegSyncClient::handleBinaryFrame: Ignoring frame with unknown type: " << (int)RegSyncBinary::frameType(frame));
+         break;
+      }
+   }
+   catch(BaseException& e)
+   {
+      // An update was lost - don't resume past it
+      ErrLog(<< "RegSyncClient::handleBinaryFrame: exception: " << e);
+      mResumable = false;
+      mEpoch = 0;  // so that a SyncEnd still to come doesn't make us resumable
+   }
+}
+
 void 
 RegSyncClient::handleXml(const Data& xmlData)
 {
@@ -16,7 +16,8 @@ public:
    RegSyncClient(resip::InMemorySyncRegDb* regDb,
                  resip::Data address,
                  unsigned short port,
-                 resip::InMemorySyncPubDb* pubDb = 0);
+                 resip::InMemorySyncPubDb* pubDb = 0,
+                 bool binaryFormat = true);
 
    virtual void thread();
    virtual void shutdown();
@@ -24,7 +25,9 @@ public:
 private: 
    void delaySeconds(unsigned int seconds);
    bool tryParse();  // returns true if we processed something and there is more data in the buffer
+   bool tryParseBinary();
    void handleXml(const resip::Data& xmlData);
+   void handleBinaryFrame(const char* frame, unsigned int size);
    void handleRegInfoEvent(resip::XMLCursor& xml);
    void handlePubInfoEvent(resip::XMLCursor& xml);
    void processModify(const resip::Uri& aor, resip::ContactList& syncContacts);
@@ -33,6 +36,11 @@ private:
    resip::InMemorySyncPubDb* mPubDb;
    resip::Data mAddress;
    unsigned short mPort;
+   bool mBinaryFormat;  // ask the server for the binary format - it falls back to XML if it doesn't support it
+   // Position in the server's binary update stream, used to resume after a reconnect
+   UInt64 mEpoch;
+   UInt64 mLastSeq;
+   bool mResumable;  // true once a binary sync has completed on the current or last connection
    char mRxBuffer[8000];
    resip::Data mRxDataBuffer;
    int mSocketDesc;
@@ -13,10 +13,12 @@
 #include <rutil/ParseBuffer.hxx>
 #include <rutil/Socket.hxx>
 #include <rutil/TransportType.hxx>
+#include <rutil/Random.hxx>
 #include <rutil/Timer.hxx>
 
 #include "repro/XmlRpcServerBase.hxx"
 #include "repro/XmlRpcConnection.hxx"
+#include "repro/RegSyncBinary.hxx"
 #include "repro/RegSyncServer.hxx"
 
 using namespace repro;
@@ -25,6 +27,15 @@ using namespace std;
 
 #define RESIPROCATE_SUBSYSTEM Subsystem::REPRO
 
+// Snapshot and replayed binary frames are queued to the connection in chunks of about this size
+static const Data::size_type InitialSyncChunkSize = 64*1024;
+
+// Wall clock start time plus random bits - never 0, and unlikely to repeat across restarts
+static UInt64
+makeEpoch()
+{
+   return ((UInt64)time(0) << 32) | (UInt32)Random::getRandom();
+}
 
 RegSyncServer::RegSyncServer(resip::InMemorySyncRegDb* regDb,
                              int port, 
@@ -32,7 +43,14 @@ RegSyncServer::RegSyncServer(resip::InMemorySyncRegDb* regDb,
                              resip::InMemorySyncPubDb* pubDb) :
    XmlRpcServerBase(port, version),
    mRegDb(regDb),
-   mPubDb(pubDb)
+   mPubDb(pubDb),
+   mBinaryAllowed(true),
+   mEpoch(makeEpoch()),
+   mLastSeq(0),
+   mReplayLogSize(100000),
+   mXmlConnections(0),
+   mInitialSyncConnectionId(0),
+   mInitialSyncBinary(false)
 {
    if (mRegDb)
    {
@@ -49,7 +67,14 @@ RegSyncServer::RegSyncServer(resip::InMemorySyncRegDb* regDb,
                              resip::InMemorySyncPubDb* pubDb) :
    XmlRpcServerBase(brokerQueue),
    mRegDb(regDb),
-   mPubDb(pubDb)
+   mPubDb(pubDb),
+   mBinaryAllowed(false),
+   mEpoch(makeEpoch()),
+   mLastSeq(0),
+   mReplayLogSize(0),
+   mXmlConnections(0),
+   mInitialSyncConnectionId(0),
+   mInitialSyncBinary(false)
 {
    if (mRegDb)
    {
@@ -73,6 +98,17 @@ RegSyncServer::~RegSyncServer()
    }
 }
 
+void
+RegSyncServer::setReplayLogSize(unsigned int size)
+{
+   Lock lock(mReplayLogMutex);
+   mReplayLogSize = size;
+   while(mReplayLog.size() > mReplayLogSize)
+   {
+      mReplayLog.pop_front();
+   }
+}
+
 void 
 RegSyncServer::sendResponse(unsigned int connectionId, 
                            unsigned int requestId, 
@@ -118,8 +154,37 @@ RegSyncServer::sendRegistrationModifiedEvent(unsigned int connectionId, const re
 
    if(infoFound)
    {
-      sendEvent(connectionId, ss.str().c_str());
+      // Events for all connections only go to connections that asked for XML
+      sendEvent(connectionId, ss.str().c_str(), XmlEvents);
+   }
+}
+
+void
+RegSyncServer::sendBinaryAorUpdate(const resip::Uri& aor, const ContactList& contacts)
+{
+   if(!mBinaryAllowed)
+   {
+      return;
+   }
+
+   Data frame;
+   if(RegSyncBinary::encodeAorUpdate(frame, aor, contacts, Timer::getTimeSecs()) == 0)
+   {
+      return;
    }
+
+   // Sequence numbers must reach the event fifo in order
+   Lock lock(mReplayLogMutex);
+   RegSyncBinary::setSequence(frame, ++mLastSeq);
+   if(mReplayLogSize > 0)
+   {
+      mReplayLog.push_back(frame);
+      if(mReplayLog.size() > mReplayLogSize)
+      {
+         mReplayLog.pop_front();
+      }
+   }
+   sendEvent(0, frame, BinaryEvents);
 }
 
 void 
@@ -251,22 +316,52 @@ RegSyncServer::handleInitialSyncRequest(unsigned int connectionId, unsigned int
 {
    InfoLog(<< "RegSyncServer::handleInitialSyncRequest");
 
-   // Check for correct Version
+   // Check for correct Version, and for binary format and resume position from newer clients
    unsigned int version = 0;
+   bool binary = false;
+   UInt64 resumeEpoch = 0;
+   UInt64 resumeSeq = 0;
    if(xml.firstChild())
    {
       if(isEqualNoCase(xml.getTag(), "request"))
       {
          if(xml.firstChild())
          {
-            if(isEqualNoCase(xml.getTag(), "version"))
+            do
             {
-               if(xml.firstChild())
+               if(isEqualNoCase(xml.getTag(), "version"))
                {
-                  version = xml.getValue().convertUnsignedLong();
-                  xml.parent();
+                  if(xml.firstChild())
+                  {
+                     version = xml.getValue().convertUnsignedLong();
+                     xml.parent();
+                  }
                }
-            }
+               else if(isEqualNoCase(xml.getTag(), "format"))
+               {
+                  if(xml.firstChild())
+                  {
+                     binary = isEqualNoCase(xml.getValue(), "binary");
+                     xml.parent();
+                  }
+               }
+               else if(isEqualNoCase(xml.getTag(), "resumeepoch"))
+               {
+                  if(xml.firstChild())
+                  {
+                     resumeEpoch = xml.getValue().convertUInt64();
+                     xml.parent();
+                  }
+               }
+               else if(isEqualNoCase(xml.getTag(), "resumeseq"))
+               {
+                  if(xml.firstChild())
+                  {
+                     resumeSeq = xml.getValue().convertUInt64();
+                     xml.parent();
+                  }
+               }
+            } while(xml.nextSibling());
             xml.parent();
          }
       }
@@ -275,15 +370,55 @@ RegSyncServer::handleInitialSyncRequest(unsigned int connectionId, unsigned int
 
    if(version == REGSYNC_VERSION)
    {
-      if (mRegDb)
+      binary = binary && mBinaryAllowed;
+
+      std::map<unsigned int, bool>::iterator it = mSyncConnections.find(connectionId);
+      if(it != mSyncConnections.end() && !it->second)
+      {
+         mXmlConnections--;
+      }
+      mSyncConnections[connectionId] = binary;
+      if(!binary)
       {
+         mXmlConnections++;
+      }
+      // Must be set before the snapshot is taken, so that no update after it is missed
+      setConnectionEventClass(connectionId, binary ? BinaryEvents : XmlEvents);
+
+      bool resumed = false;
+      if(binary && resumeEpoch != 0)
+      {
+         resumed = resumeFromReplayLog(connectionId, resumeEpoch, resumeSeq);
+      }
+
+      if (mRegDb && !resumed)
+      {
+         Data frame;
+         if(binary)
+         {
+            Lock lock(mReplayLogMutex);
+            RegSyncBinary::encodeSyncMarker(frame, RegSyncBinary::SyncBegin, mEpoch, mLastSeq, false /* resumed */);
+            sendEvent(connectionId, frame);
+         }
+
+         mInitialSyncConnectionId = connectionId;
+         mInitialSyncBinary = binary;
          mRegDb->initialSync(connectionId);
+         flushInitialSyncBuffer();
+         mInitialSyncConnectionId = 0;
+
+         if(binary)
+         {
+            Lock lock(mReplayLogMutex);
+            RegSyncBinary::encodeSyncMarker(frame, RegSyncBinary::SyncEnd, mEpoch, mLastSeq, false /* resumed */);
+            sendEvent(connectionId, frame);
+         }
       }
       if (mPubDb)
       {
          mPubDb->initialSync(connectionId);
       }
-      sendResponse(connectionId, requestId, Data::Empty, 200, "Initial Sync Completed.");
+      sendResponse(connectionId, requestId, Data::Empty, 200, resumed ? "Initial Sync Resumed." : "Initial Sync Completed.");
    }
    else
    {
@@ -291,6 +426,48 @@ RegSyncServer::handleInitialSyncRequest(unsigned int connectionId, unsigned int
    }
 }
 
+bool
+RegSyncServer::resumeFromReplayLog(unsigned int connectionId, UInt64 epoch, UInt64 seq)
+{
+   Lock lock(mReplayLogMutex);
+   UInt64 firstSeq = mLastSeq - mReplayLog.size() + 1;
+   if(epoch != mEpoch || seq > mLastSeq || seq + 1 < firstSeq)
+   {
+      InfoLog(<< "RegSyncServer::resumeFromReplayLog: cannot resume from seq=" << seq << " (log holds " << firstSeq << " to " << mLastSeq
+              << (epoch != mEpoch ? ", epoch changed" : "") << ") - sending snapshot");
+      return false;
+   }
+
+   InfoLog(<< "RegSyncServer::resumeFromReplayLog: replaying " << mLastSeq - seq << " updates after seq=" << seq);
+   Data frame;
+   RegSyncBinary::encodeSyncMarker(frame, RegSyncBinary::SyncBegin, mEpoch, seq, true /* resumed */);
+   mInitialSyncBuffer = frame;
+   for(std::deque<Data>::const_iterator it = mReplayLog.begin() + (size_t)(seq + 1 - firstSeq); it != mReplayLog.end(); it++)
+   {
+      mInitialSyncBuffer += *it;
+      if(mInitialSyncBuffer.size() >= InitialSyncChunkSize)
+      {
+         sendEvent(connectionId, mInitialSyncBuffer);
+         mInitialSyncBuffer.clear();
+      }
+   }
+   RegSyncBinary::encodeSyncMarker(frame, RegSyncBinary::SyncEnd, mEpoch, mLastSeq, true /* resumed */);
+   mInitialSyncBuffer += frame;
+   sendEvent(connectionId, mInitialSyncBuffer);
+   mInitialSyncBuffer.clear();
+   return true;
+}
+
+void
+RegSyncServer::flushInitialSyncBuffer()
+{
+   if(!mInitialSyncBuffer.empty())
+   {
+      sendEvent(mInitialSyncConnectionId, mInitialSyncBuffer);
+      mInitialSyncBuffer.clear();
+   }
+}
+
 void 
 RegSyncServer::streamContactInstanceRecord(std::stringstream& ss, const ContactInstanceRecord& rec)
 {
@@ -333,16 +510,68 @@ RegSyncServer::streamContactInstanceRecord(std::stringstream& ss, const ContactI
     ss << "   </contactinfo>" << Symbols::CRLF;
 }
 
+void
+RegSyncServer::onConnectionClosed(unsigned int connectionId)
+{
+   std::map<unsigned int, bool>::iterator it = mSyncConnections.find(connectionId);
+   if(it != mSyncConnections.end())
+   {
+      if(!it->second)
+      {
+         mXmlConnections--;
+      }
+      mSyncConnections.erase(it);
+   }
+}
+
 void 
 RegSyncServer::onAorModified(const resip::Uri& aor, const ContactList& contacts)
 {
-   sendRegistrationModifiedEvent(0, aor, contacts);
+   if(xmlEventsRequired())
+   {
+      sendRegistrationModifiedEvent(0, aor, contacts);
+   }
+   sendBinaryAorUpdate(aor, contacts);
+}
+
+void 
+RegSyncServer::onContactModified(const resip::Uri& aor, const ContactList& contacts, const ContactInstanceRecord& rec)
+{
+   // XML peers always get the whole contact list, binary peers only the contact that changed
+   if(xmlEventsRequired())
+   {
+      sendRegistrationModifiedEvent(0, aor, contacts);
+   }
+   ContactList changed;
+   changed.push_back(rec);
+   sendBinaryAorUpdate(aor, changed);
 }
 
 void 
 RegSyncServer::onInitialSyncAor(unsigned int connectionId, const resip::Uri& aor, const ContactList& contacts)
 {
-   sendRegistrationModifiedEvent(connectionId, aor, contacts);
+   // Every RegSyncServer sharing the database is called - ignore syncs for other servers' connections
+   if(connectionId != mInitialSyncConnectionId)
+   {
+      return;
+   }
+   if(mInitialSyncBinary)
+   {
+      Data frame;
+      if(RegSyncBinary::encodeAorUpdate(frame, aor, contacts, Timer::getTimeSecs()) > 0)
+      {
+         // Snapshot records carry sequence 0
+         mInitialSyncBuffer += frame;
+         if(mInitialSyncBuffer.size() >= InitialSyncChunkSize)
+         {
+            flushInitialSyncBuffer();
+         }
+      }
+   }
+   else
+   {
+      sendRegistrationModifiedEvent(connectionId, aor, contacts);
+   }
 }
 
 void 
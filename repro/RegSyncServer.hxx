@@ -1,7 +1,11 @@
 #if !defined(RegSyncServer_hxx)
 #define RegSyncServer_hxx 
 
+#include <atomic>
+#include <deque>
+#include <map>
 #include <rutil/Data.hxx>
+#include <rutil/Mutex.hxx>
 #include <rutil/TransportType.hxx>
 #include <rutil/XMLCursor.hxx>
 #include <resip/dum/InMemorySyncRegDb.hxx>
@@ -28,6 +32,11 @@ public:
                  resip::InMemorySyncPubDb* pubDb = 0);
    virtual ~RegSyncServer();
 
+   // Number of binary AOR updates kept so that a reconnecting binary client can
+   // resume from its last sequence number instead of requesting a full snapshot.
+   // 0 disables resumption.
+   void setReplayLogSize(unsigned int size);
+
    // thread safe
    virtual void sendResponse(unsigned int connectionId, 
                              unsigned int requestId, 
@@ -44,8 +53,11 @@ public:
 protected:
    virtual void handleRequest(unsigned int connectionId, unsigned int requestId, const resip::Data& request); 
 
+   virtual void onConnectionClosed(unsigned int connectionId);
+
    // InMemorySyncRegDbHandler methods
    virtual void onAorModified(const resip::Uri& aor, const resip::ContactList& contacts);
+   virtual void onContactModified(const resip::Uri& aor, const resip::ContactList& contacts, const resip::ContactInstanceRecord& rec);
    virtual void onInitialSyncAor(unsigned int connectionId, const resip::Uri& aor, const resip::ContactList& contacts);
 
    // InMemorySyncPubDbHandler methods
@@ -54,11 +66,37 @@ protected:
    virtual void onInitialSyncDocument(unsigned int connectionId, const resip::Data& eventType, const resip::Data& documentKey, const resip::Data& eTag, UInt64 expirationTime, UInt64 lastUpdated, const resip::Contents* contents, const resip::SecurityAttributes* securityAttributes);
 
 private: 
+   static const unsigned int XmlEvents = XmlRpcServerBase::DefaultEventClass;
+   static const unsigned int BinaryEvents = 0x2;
+
    void handleInitialSyncRequest(unsigned int connectionId, unsigned int requestId, resip::XMLCursor& xml);
+   bool resumeFromReplayLog(unsigned int connectionId, UInt64 epoch, UInt64 seq);
    void streamContactInstanceRecord(std::stringstream& ss, const resip::ContactInstanceRecord& rec);
+   bool xmlEventsRequired() const { return !mBinaryAllowed || mXmlConnections > 0; }
+   void sendBinaryAorUpdate(const resip::Uri& aor, const resip::ContactList& contacts);
+   void flushInitialSyncBuffer();
 
    resip::InMemorySyncRegDb* mRegDb;
    resip::InMemorySyncPubDb* mPubDb;
+
+   // Binary format is only offered on TCP connections, not when publishing to an AMQP broker
+   bool mBinaryAllowed;
+   // Identifies this server's sequence numbers, so clients do not resume against a restarted peer
+   const UInt64 mEpoch;
+
+   resip::Mutex mReplayLogMutex;  // also orders binary updates in the event fifo
+   UInt64 mLastSeq;
+   std::deque<resip::Data> mReplayLog;  // holds sequence numbers mLastSeq - size() + 1 to mLastSeq
+   unsigned int mReplayLogSize;
+
+   // connectionId -> true if binary, for connections that have sent InitialSync (server thread only)
+   std::map<unsigned int, bool> mSyncConnections;
+   std::atomic<unsigned int> mXmlConnections;
+
+   // Set for the duration of an initialSync call on the server thread
+   unsigned int mInitialSyncConnectionId;
+   bool mInitialSyncBinary;
+   resip::Data mInitialSyncBuffer;
 };
 
 }
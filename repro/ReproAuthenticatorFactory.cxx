@@ -185,6 +185,10 @@ ReproAuthenticatorFactory::getServerAuthManager()
                                   mDigestChallengeThirdParties,
                                   mStaticRealm));
       }
+      if(mServerAuthManager.get())
+      {
+         mServerAuthManager->setMaxOutstandingCredentialLookups(mProxyConfig.getConfigUnsignedLong("MaxOutstandingCredentialLookups", 1000));
+      }
    }
    return mServerAuthManager;
 }
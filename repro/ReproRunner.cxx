@@ -702,6 +702,13 @@ ReproRunner::createSipStack()
       ConnectionBase::setMessageSizeMax(messageSizeLimit);
    }
 
+   unsigned long queuedBytesLimit = mProxyConfig->getConfigUnsignedLong("StreamQueuedBytesLimit", 0);
+   if(queuedBytesLimit > 0)
+   {
+      DebugLog(<< "Using maximum of "<< queuedBytesLimit << " bytes queued for sending on each stream-based connection");
+      ConnectionBase::setQueuedBytesMax(queuedBytesLimit);
+   }
+
    // Create Security (TLS / Certificates) and Compression (SigComp) objects if
    // pre-precessor defines are enabled
    Security* security = 0;
@@ -819,7 +826,8 @@ ReproRunner::createSipStack()
    {
       int capturePort = mProxyConfig->getConfigInt("CapturePort", 9060);
       int captureAgentID = mProxyConfig->getConfigInt("CaptureAgentID", 2001);
-      auto agent = std::make_shared<HepAgent>(captureHost, capturePort, captureAgentID);
+      unsigned int captureQueueSize = mProxyConfig->getConfigUnsignedLong("CaptureQueueSize", HepAgent::DefaultQueueSize);
+      auto agent = std::make_shared<HepAgent>(captureHost, capturePort, captureAgentID, captureQueueSize);
       mSipStack->setTransportSipMessageLoggingHandler(std::make_shared<HEPSipMessageLoggingHandler>(agent));
    }
    else if(mProxyConfig->getConfigBool("EnableSipMessageLogging", false))
@@ -827,6 +835,35 @@ ReproRunner::createSipStack()
        mSipStack->setTransportSipMessageLoggingHandler(std::make_shared<ReproSipMessageLoggingHandler>());
    }
 
+   // Set up per-source rate limiting, if enabled - must be done before transports are added
+   if(mProxyConfig->getConfigBool("SourceRateLimiting", false))
+   {
+      auto limiter = std::make_shared<SourceRateLimiter>(
+                        mProxyConfig->getConfigUnsignedLong("SourceRateLimitRequestsPerSecond", 50),
+                        mProxyConfig->getConfigUnsignedLong("SourceRateLimitBurst", 100),
+                        mProxyConfig->getConfigUnsignedLong("SourceRateLimitMaxSources", 16384));
+      std::vector<Data> methodRates;
+      mProxyConfig->getConfigValue("SourceRateLimitMethods", methodRates);
+      for(std::vector<Data>::iterator it = methodRates.begin(); it != methodRates.end(); it++)
+      {
+         // METHOD:rate:burst
+         Data::size_type first = it->find(":");
+         Data::size_type second = first == Data::npos ? Data::npos : it->find(":", first + 1);
+         MethodTypes method = first == Data::npos ? UNKNOWN : getMethodType(it->substr(0, first));
+         if(second == Data::npos || method == UNKNOWN || method == RESPONSE)
+         {
+            WarningLog( << "SourceRateLimitMethods entry (" << *it << ") is not of the form METHOD:rate:burst, ignoring.");
+            continue;
+         }
+         limiter->setMethodRate(method,
+                                (UInt32)it->substr(first + 1, second - first - 1).convertUnsignedLong(),
+                                (UInt32)it->substr(second + 1).convertUnsignedLong());
+      }
+      limiter->setBan(mProxyConfig->getConfigUnsignedLong("SourceRateLimitBanThreshold", 200),
+                      mProxyConfig->getConfigUnsignedLong("SourceRateLimitBanSeconds", 60) * 1000);
+      mSipStack->setTransportSourceRateLimiter(limiter);
+   }
+
    // Add stack transports
    bool allTransportsSpecifyRecordRoute=false;
    if(!addTransports(allTransportsSpecifyRecordRoute))
@@ -1144,7 +1181,9 @@ ReproRunner::createDialogUsageManager()
       // Configure DUM to handle SUBSCRIBE and PUBLISH requests for presence
       mPresenceServer = new PresenceServer(*mDum, mAuthFactory->getDispatcher(), 
                                            mProxyConfig->getConfigBool("PresenceUsesRegistrationState", true),
-                                           mProxyConfig->getConfigBool("PresenceNotifyClosedStateForNonPublishedUsers", true));
+                                           mProxyConfig->getConfigBool("PresenceNotifyClosedStateForNonPublishedUsers", true),
+                                           mProxyConfig->getConfigUnsignedLong("PresenceNotifyBatchSize", 50),
+                                           mProxyConfig->getConfigUnsignedLong("PresenceNotifyMinInterval", 1000));
 
       // Install rules so that the cert server receives SUBSCRIBEs and PUBLISHs
       MessageFilterRule::MethodList methodList;
@@ -1445,6 +1484,11 @@ ReproRunner::createRegSync()
       }
       if(!regSyncServerList.empty())
       {
+         unsigned int replayLogSize = mProxyConfig->getConfigUnsignedLong("RegSyncReplayLogSize", 100000);
+         for(std::list<RegSyncServer*>::iterator it = regSyncServerList.begin(); it != regSyncServerList.end(); it++)
+         {
+            (*it)->setReplayLogSize(replayLogSize);
+         }
          mRegSyncServerThread = new RegSyncServerThread(regSyncServerList);
       }
       Data regSyncPeerAddress(mProxyConfig->getConfigData("RegSyncPeer", ""));
@@ -1455,9 +1499,11 @@ ReproRunner::createRegSync()
          {
             remoteRegSyncPort = mRegSyncPort;
          }
+         Data regSyncFormat = mProxyConfig->getConfigData("RegSyncFormat", "binary");
          mRegSyncClient = new RegSyncClient(dynamic_cast<InMemorySyncRegDb*>(mRegistrationPersistenceManager),
                                             regSyncPeerAddress, remoteRegSyncPort,
-                                            enablePublicationReplication ? dynamic_cast<InMemorySyncPubDb*>(mPublicationPersistenceManager) : 0);
+                                            enablePublicationReplication ? dynamic_cast<InMemorySyncPubDb*>(mPublicationPersistenceManager) : 0,
+                                            !isEqualNoCase(regSyncFormat, "xml"));
       }
    }
    Data regSyncBrokerTopic = mProxyConfig->getConfigData("RegSyncBrokerTopic", Data::Empty);
@@ -28,6 +28,8 @@ ReproServerAuthManager::ReproServerAuthManager(DialogUsageManager& dum,
    mUseAuthInt(useAuthInt),
    mRejectBadNonces(rejectBadNonces)
 {
+   // the A1 returned by UserAuthGrabber only depends on the user and realm
+   setCredentialLookupSharing(true);
 }
 
 ReproServerAuthManager::~ReproServerAuthManager()
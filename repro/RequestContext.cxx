@@ -58,6 +58,10 @@ RequestContext::RequestContext(Proxy& proxy,
 RequestContext::~RequestContext()
 {
    DebugLog (<< "RequestContext::~RequestContext() " << this);
+   if (mOriginalRequest)
+   {
+      mProxy.recordArenaUsage(mOriginalRequest->method(), mArena);
+   }
    if (mOriginalRequest != mCurrentEvent)
    {
       delete mOriginalRequest;
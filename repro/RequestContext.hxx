@@ -11,6 +11,7 @@
 #include "repro/ResponseContext.hxx"
 #include "repro/TimerCMessage.hxx"
 #include "rutil/resipfaststreams.hxx"
+#include "rutil/ArenaPool.hxx"
 #include "rutil/KeyValueStore.hxx"
 
 namespace resip
@@ -78,9 +79,15 @@ class RequestContext
 
       // Accessor for per-requset extensible state storage for monkeys
       resip::KeyValueStore& getKeyValueStore() { return mKeyValueStore; }
+
+      /** Memory that lasts as long as this RequestContext, and is freed with
+          it all at once. Targets for this request can be placed here. */
+      resip::ArenaPool& getArena() { return mArena; }
       
       bool mHaveSentFinalResponse;
    protected:
+      // first, so that it outlives everything kept in it
+      resip::ArenaPool mArena;
       resip::SipMessage*  mOriginalRequest;
       resip::Message*  mCurrentEvent;
       resip::SipMessage* mAck200ToRetransmit;
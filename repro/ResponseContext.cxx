@@ -3,6 +3,7 @@
 #endif
 
 #include <iostream>
+#include <tuple>
 #include <utility>
 
 #include "resip/stack/ExtensionParameter.hxx"
@@ -29,6 +30,10 @@ using namespace std;
 
 ResponseContext::ResponseContext(RequestContext& context) : 
    mRequestContext(context),
+   mCandidateTransactionMap(std::less<Data>(), TransactionMap::allocator_type(&context.mArena)),
+   mActiveTransactionMap(std::less<Data>(), TransactionMap::allocator_type(&context.mArena)),
+   mTerminatedTransactionMap(std::less<Data>(), TransactionMap::allocator_type(&context.mArena)),
+   mTargetList(TargetList::allocator_type(&context.mArena)),
    mBestPriority(50),
    mSecure(false), //context.getOriginalRequest().header(h_RequestLine).uri().scheme() == Symbols::Sips)
    mIsClientBehindNAT(false)
@@ -63,7 +68,7 @@ resip::Data
 ResponseContext::addTarget(const NameAddr& addr, bool beginImmediately)
 {
    InfoLog (<< "Adding candidate " << addr);
-   std::unique_ptr<Target> target(new Target(addr));
+   std::unique_ptr<Target> target(new (&mRequestContext.mArena) Target(addr));
    Data tid=target->tid();
    addTarget(std::move(target), beginImmediately);
    return tid;
@@ -101,7 +106,7 @@ ResponseContext::addTarget(std::unique_ptr<repro::Target> target, bool beginImme
       beginClientTransaction(target.get());
       target->status()=Target::Started;
       Target* toAdd=target.release();
-      mActiveTransactionMap[toAdd->tid()]=toAdd;
+      mapTarget(mActiveTransactionMap, toAdd);
    }
    else
    {
@@ -113,7 +118,7 @@ ResponseContext::addTarget(std::unique_ptr<repro::Target> target, bool beginImme
       }
 
       Target* toAdd=target.release();
-      mCandidateTransactionMap[toAdd->tid()]=toAdd;
+      mapTarget(mCandidateTransactionMap, toAdd);
    }
    
    return true;
@@ -150,7 +155,7 @@ ResponseContext::addTargetBatch(TargetPtrList& targets,
             queue.push_back(target->tid());
          }
          DebugLog(<<"Adding Target to Candidates: " << target->uri() << " tid=" << target->tid());
-         mCandidateTransactionMap[target->tid()]=target;
+         mapTarget(mCandidateTransactionMap, target);
       }
       else
       {
@@ -193,13 +198,13 @@ ResponseContext::beginClientTransactions()
          // see rfc 3261 section 16.6
          //This code moves the Target from mCandidateTransactionMap to mActiveTransactionMap,
          //and begins the transaction.
-         mActiveTransactionMap[i->second->tid()] = i->second;
+         mapTarget(mActiveTransactionMap, i->second);
          InfoLog (<< "Creating new client transaction " << i->second->tid() << " -> " << i->second->uri());
       }
       else
       {
          i->second->status() = Target::Terminated;
-         mTerminatedTransactionMap[i->second->tid()] = i->second;
+         mapTarget(mTerminatedTransactionMap, i->second);
          DebugLog(<<"Found a repeated target.");
       }
       
@@ -223,7 +228,7 @@ ResponseContext::beginClientTransaction(const resip::Data& tid)
    if(isDuplicate(i->second) || mRequestContext.mHaveSentFinalResponse)
    {
       i->second->status() = Target::Terminated;
-      mTerminatedTransactionMap[i->second->tid()] = i->second;
+      mapTarget(mTerminatedTransactionMap, i->second);
       mCandidateTransactionMap.erase(i);
       return false;
    }
@@ -231,7 +236,7 @@ ResponseContext::beginClientTransaction(const resip::Data& tid)
    mTargetList.push_back(i->second->rec()); // Add to Target list for future duplicate detection
 
    beginClientTransaction(i->second);
-   mActiveTransactionMap[i->second->tid()] = i->second;
+   mapTarget(mActiveTransactionMap, i->second);
    InfoLog(<< "Creating new client transaction " << i->second->tid() << " -> " << i->second->uri());
    mCandidateTransactionMap.erase(i);
    
@@ -302,7 +307,7 @@ ResponseContext::clearCandidateTransactions(const resip::Tokens* reasons)
    {
       result=true;
       cancelClientTransaction(j->second, reasons);
-      mTerminatedTransactionMap[j->second->tid()] = j->second;
+      mapTarget(mTerminatedTransactionMap, j->second);
       TransactionMap::iterator temp = j;
       j++;
       mCandidateTransactionMap.erase(temp);
@@ -329,7 +334,7 @@ ResponseContext::cancelClientTransaction(const resip::Data& tid, const resip::To
    if(j != mCandidateTransactionMap.end())
    {
       cancelClientTransaction(j->second, reasons);
-      mTerminatedTransactionMap[tid] = j->second;
+      mapTarget(mTerminatedTransactionMap, j->second);
       mCandidateTransactionMap.erase(j);
       return true;
    }
@@ -462,10 +467,25 @@ ResponseContext::removeClientTransaction(const resip::Data& transactionId)
          
 }
 
+void
+ResponseContext::mapTarget(TransactionMap& map, Target* target)
+{
+   TransactionMap::iterator i = map.find(target->tid());
+   if(i != map.end())
+   {
+      i->second = target;
+      return;
+   }
+   // the key shares a copy of the tid in the arena, instead of owning one
+   map.emplace(std::piecewise_construct,
+               std::forward_as_tuple(Data::Share, mRequestContext.mArena.copy(target->tid())),
+               std::forward_as_tuple(target));
+}
+
 bool
 ResponseContext::isDuplicate(const repro::Target* target) const
 {
-   resip::ContactList::const_iterator i;
+   TargetList::const_iterator i;
    // make sure each target is only inserted once
 
    // !bwc! We can not optimize this by using stl, because operator
@@ -616,7 +636,9 @@ ResponseContext::insertRecordRoute(SipMessage& outgoing,
       resip::NameAddr rt;
       if(inboundFlowToken.empty())
       {
-         rt = receivedTransportRecordRoute;
+         // The proxy's copy already carries ;lr and its encoding, so unless 
+         // massageRoute() has to change it this goes out without re-encoding.
+         rt = mRequestContext.mProxy.getLrRecordRoute(mRequestContext.getOriginalRequest().getSource().mTransportKey);
       }
       else
       {
@@ -1302,7 +1324,7 @@ ResponseContext::terminateClientTransaction(const resip::Data& tid)
    {
       InfoLog (<< "client transactions: " << InserterP(mActiveTransactionMap));
       i->second->status() = Target::Terminated;
-      mTerminatedTransactionMap[tid] = i->second;
+      mapTarget(mTerminatedTransactionMap, i->second);
       mActiveTransactionMap.erase(i);
       return;
    }
@@ -1312,7 +1334,7 @@ ResponseContext::terminateClientTransaction(const resip::Data& tid)
    {
       InfoLog (<< "client transactions: " << InserterP(mCandidateTransactionMap));
       j->second->status() = Target::Terminated;
-      mTerminatedTransactionMap[tid] = j->second;
+      mapTarget(mTerminatedTransactionMap, j->second);
       mCandidateTransactionMap.erase(j);
       return;   
    }
@@ -6,6 +6,7 @@
 #include <list>
 
 #include "rutil/HashMap.hxx"
+#include "rutil/StlPoolAllocator.hxx"
 #include "resip/stack/NameAddr.hxx"
 #include "resip/stack/SipMessage.hxx"
 #include "resip/stack/Via.hxx"
@@ -164,8 +165,10 @@ class ResponseContext
       */
       Target* getTarget(const resip::Data& serial) const;
 
-      //Keyed by transaction id
-      typedef std::map<resip::Data,repro::Target*> TransactionMap;
+      //Keyed by transaction id; kept in the RequestContext's arena
+      typedef std::map<resip::Data, repro::Target*, std::less<resip::Data>,
+                       resip::StlPoolAllocator<std::pair<const resip::Data, repro::Target*>,
+                                               resip::PoolBase> > TransactionMap;
 
       /**
          Self-explanatory.
@@ -248,6 +251,9 @@ class ResponseContext
 
       void terminateClientTransaction(const resip::Data& tid);
       void removeClientTransaction(const resip::Data& transactionId); 
+
+      // puts target in map under its tid, with the key in the arena
+      void mapTarget(TransactionMap& map, Target* target);
       
       //There is no terminateClientTransaction(Target target) since terminating
       //a branch is very simple. The guts can be found in the API functions.
@@ -271,7 +277,9 @@ class ResponseContext
 
       //Maybe someday canonicalized Uris will go here, and checking for duplicates
       //will be much faster
-      resip::ContactList mTargetList;
+      typedef std::list<resip::ContactInstanceRecord,
+                        resip::StlPoolAllocator<resip::ContactInstanceRecord, resip::PoolBase> > TargetList;
+      TargetList mTargetList;
       
       bool isDuplicate(const repro::Target* target) const;
       
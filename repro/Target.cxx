@@ -1,3 +1,5 @@
+#include <cstddef>
+
 #include "repro/Target.hxx"
 
 #include "resip/stack/Uri.hxx"
@@ -47,6 +49,49 @@ Target::~Target()
 {
 }
 
+// Room for the PoolBase* ahead of each Target, keeping the Target aligned.
+static const size_t PoolHeaderSize = alignof(std::max_align_t);
+
+void*
+Target::operator new(size_t size)
+{
+   return operator new(size, (resip::PoolBase*)0);
+}
+
+void*
+Target::operator new(size_t size, resip::PoolBase* pool)
+{
+   char* mem = static_cast<char*>(pool ? pool->allocate(PoolHeaderSize + size) :
+                                         ::operator new(PoolHeaderSize + size));
+   *reinterpret_cast<resip::PoolBase**>(mem) = pool;
+   return mem + PoolHeaderSize;
+}
+
+void
+Target::operator delete(void* ptr)
+{
+   if(!ptr)
+   {
+      return;
+   }
+   char* mem = static_cast<char*>(ptr) - PoolHeaderSize;
+   resip::PoolBase* pool = *reinterpret_cast<resip::PoolBase**>(mem);
+   if(pool)
+   {
+      pool->deallocate(mem);
+   }
+   else
+   {
+      ::operator delete(mem);
+   }
+}
+
+void
+Target::operator delete(void* ptr, resip::PoolBase*)
+{
+   operator delete(ptr);
+}
+
 const resip::Data&
 Target::tid() const
 {
@@ -10,6 +10,7 @@
 #include "resip/stack/Via.hxx"
 #include "resip/dum/ContactInstanceRecord.hxx"
 #include "rutil/KeyValueStore.hxx"
+#include "rutil/PoolBase.hxx"
 
 namespace repro
 {
@@ -33,6 +34,16 @@ class Target
       Target(const resip::ContactInstanceRecord& record);
 
       virtual ~Target();
+
+      /**
+         A Target can be placed in the arena of the RequestContext it is
+         for, with new (&context.getArena()) Target(...). Each Target
+         remembers where it came from, so delete works the same either way.
+      */
+      static void* operator new(size_t size);
+      static void* operator new(size_t size, resip::PoolBase* pool);
+      static void operator delete(void* ptr);
+      static void operator delete(void* ptr, resip::PoolBase* pool);
       
       virtual const resip::Data& tid() const;
            
@@ -2021,6 +2021,32 @@ WebAdmin::buildSettingsSubPage(DataStream& s)
         << endl;
    }
 
+   {
+      Data buffer;
+      DataStream strm(buffer);
+      mProxy.encodeArenaUsage(strm);
+      s << "<br>Request Arena Usage<br>"
+        << "<pre>" <<  buffer << "</pre>"
+        << endl;
+   }
+
+   if(mProxy.getAccountingCollector())
+   {
+      s << "<br>Accounting events dropped because the accounting queue was full: "
+        << mProxy.getAccountingCollector()->getDroppedEventCount() << "<br>"
+        << endl;
+   }
+
+   if(mProxy.getStack().getTransportSourceRateLimiter())
+   {
+      Data buffer;
+      DataStream strm(buffer);
+      mProxy.getStack().getTransportSourceRateLimiter()->encodeCurrentState(strm);
+      s << "<br>Source Rate Limiter Statistics<br>"
+        << "<pre>" <<  buffer << "</pre>"
+        << endl;
+   }
+
    s << "<form id=\"logLevel\" method=\"get\" action=\"logLevel.html\" name=\"logLevel\">" << endl
        << "  <br>Change log level to: <select name=\"level\">" << endl
        << "        <option value=\"NONE\"" << (Log::level() == Log::None ? " selected" : "") << ">NONE" << (Log::level() == Log::None ? " *" : "") << "</option>" << endl
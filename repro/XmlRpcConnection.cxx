@@ -24,6 +24,7 @@ unsigned int XmlRpcConnection::NextConnectionId = 1;
 XmlRpcConnection::XmlRpcConnection(XmlRpcServerBase& server, resip::Socket sock):
    mXmlRcpServer(server),
    mConnectionId(NextConnectionId++),
+   mEventClass(XmlRpcServerBase::DefaultEventClass),
    mNextRequestId(1),
    mSock(sock)
 {
@@ -36,6 +36,7 @@ private:
    const unsigned int mConnectionId;
    static unsigned int NextConnectionId;
 
+   unsigned int mEventClass;
    unsigned int mNextRequestId;
    typedef std::map<unsigned int, resip::Data> RequestMap;
    RequestMap mRequests;
@@ -195,7 +195,10 @@ XmlRpcServerBase::process(FdSet& fdset)
             ConnectionMap::iterator it = mConnections.begin();
             for(; it != mConnections.end(); it++)
             {
-               it->second->sendEvent(responseInfo->getResponseData());
+               if(it->second->mEventClass & responseInfo->getEventClasses())
+               {
+                  it->second->sendEvent(responseInfo->getResponseData());
+               }
             }
          }
          else
@@ -263,6 +266,7 @@ XmlRpcServerBase::process(FdSet& fdset)
       bool ok = it->second->process(fdset);
       if (!ok)
       {
+         onConnectionClosed(it->first);
          delete it->second;
          mConnections.erase(it++);
       }
@@ -293,7 +297,8 @@ XmlRpcServerBase::sendResponse(unsigned int connectionId,
 
 void 
 XmlRpcServerBase::sendEvent(unsigned int connectionId,
-                            const Data& eventData)
+                            const Data& eventData,
+                            unsigned int eventClasses)
 {
 #ifdef BUILD_QPID_PROTON
    if(mQpidProtonThread.get())
@@ -302,10 +307,20 @@ XmlRpcServerBase::sendEvent(unsigned int connectionId,
       return;
    }
 #endif
-   mResponseFifo.add(new ResponseInfo(connectionId, 0 /* requestId */, eventData, true /* isFinal */));
+   mResponseFifo.add(new ResponseInfo(connectionId, 0 /* requestId */, eventData, true /* isFinal */, eventClasses));
    mSelectInterruptor.interrupt();
 }
 
+void
+XmlRpcServerBase::setConnectionEventClass(unsigned int connectionId, unsigned int eventClass)
+{
+   ConnectionMap::iterator it = mConnections.find(connectionId);
+   if(it != mConnections.end())
+   {
+      it->second->mEventClass = eventClass;
+   }
+}
+
 std::shared_ptr<ThreadIf>
 XmlRpcServerBase::getThread()
 {
@@ -333,6 +348,7 @@ XmlRpcServerBase::closeOldestConnection()
          lowestConnectionIdIt = it;
       }
    }
+   onConnectionClosed(lowestConnectionIdIt->first);
    delete lowestConnectionIdIt->second;
    mConnections.erase(lowestConnectionIdIt);
 }
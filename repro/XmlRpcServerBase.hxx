@@ -30,22 +30,26 @@ public:
    ResponseInfo(unsigned int connectionId,
                 unsigned int requestId,
                 const resip::Data& responseData,
-                bool isFinal) :
+                bool isFinal,
+                unsigned int eventClasses = 0xFFFFFFFF) :
       mConnectionId(connectionId),
       mRequestId(requestId),
       mResponseData(responseData),
-      mIsFinal(isFinal) {}
+      mIsFinal(isFinal),
+      mEventClasses(eventClasses) {}
 
    unsigned int getConnectionId() const noexcept { return mConnectionId; }
    unsigned int getRequestId() const noexcept { return mRequestId; }
    const resip::Data& getResponseData() const noexcept { return mResponseData; }
    bool getIsFinal() const noexcept { return mIsFinal; }
+   unsigned int getEventClasses() const noexcept { return mEventClasses; }
 
 private:
    unsigned int mConnectionId;
    unsigned int mRequestId;
    resip::Data mResponseData;
    bool mIsFinal;
+   unsigned int mEventClasses;
 };
 
 class XmlRpcServerBase
@@ -69,9 +73,15 @@ public:
                      const resip::Data& responseData,
                      bool isFinal=true);
 
+   // Every connection starts in DefaultEventClass.  An event sent to all connections
+   // is only delivered to those whose event class is in eventClasses.
+   static const unsigned int DefaultEventClass = 0x1;
+   static const unsigned int AllEventClasses = 0xFFFFFFFF;
+
    // thread safe - uses fifo (use connectionId == 0 to send to all connections)
    void sendEvent(unsigned int connectionId,
-                  const resip::Data& eventData);
+                  const resip::Data& eventData,
+                  unsigned int eventClasses = AllEventClasses);
 
    std::shared_ptr<resip::ThreadIf> getThread();
 
@@ -79,6 +89,11 @@ protected:
    virtual void handleRequest(unsigned int connectionId, 
                               unsigned int requestId, 
                               const resip::Data& request) = 0; 
+
+   // Only call from handleRequest - changes which events sent to all connections this connection receives
+   void setConnectionEventClass(unsigned int connectionId, unsigned int eventClass);
+   // Called from the server thread when a connection is closed
+   virtual void onConnectionClosed(unsigned int connectionId) {}
       
 private:
    static const unsigned int MaxConnections = 60;   // Note:  use caution if making this any bigger, default fd_set size in windows is 64
@@ -46,7 +46,7 @@ AmIResponsible::process(RequestContext& context)
    // Topmost route had a flow-token; this is our problem
    if(context.isTopRouteFlowTupleSet())
    {
-      std::unique_ptr<Target> target(new Target(request.header(h_RequestLine).uri()));
+      std::unique_ptr<Target> target(new (&context.getArena()) Target(request.header(h_RequestLine).uri()));
       target->rec().mReceivedFrom = context.getTopRouteFlowTuple();
       target->rec().mUseFlowRouting = true;
       context.getResponseContext().addTarget(std::move(target));
@@ -134,7 +134,7 @@ AmIResponsible::process(RequestContext& context)
             }
          }
          
-         std::unique_ptr<Target> target(new Target(uri));
+         std::unique_ptr<Target> target(new (&context.getArena()) Target(uri));
          context.getResponseContext().addTarget(std::move(target));
 
          InfoLog (<< "Sending to requri: " << uri);
@@ -74,7 +74,7 @@ LocationServer::process(RequestContext& context)
                   " with tuple " << contact.mReceivedFrom);
             if(contact.mInstance.empty() || contact.mRegId==0)
             {
-               QValueTarget* target = new QValueTarget(contact);
+               QValueTarget* target = new (&context.getArena()) QValueTarget(contact);
                batch.push_back(target);
             }
             else
@@ -96,7 +96,7 @@ LocationServer::process(RequestContext& context)
       for(o=outboundBatch.begin(); o!=outboundBatch.end(); ++o)
       {
          o->second.sort(OutboundTarget::instanceCompare);  // Orders records by lastUpdate time
-         OutboundTarget* ot = new OutboundTarget(inputUri.toString(), o->second);
+         OutboundTarget* ot = new (&context.getArena()) OutboundTarget(inputUri.toString(), o->second);
          batch.push_back(ot);
       }
       
@@ -43,7 +43,7 @@ RecursiveRedirect::process(RequestContext& context)
       {
          if(i->isWellFormed() && !i->isAllContacts())
          {
-            QValueTarget* target = new QValueTarget(*i);
+            QValueTarget* target = new (&context.getArena()) QValueTarget(*i);
             batch.push_back(target);
          }
       }
@@ -101,7 +101,7 @@ StaticRoute::process(RequestContext& context)
 
          if(mParallelForkStaticRoutes)
          {
-            Target* target = new Target(*i);
+            Target* target = new (&context.getArena()) Target(*i);
             parallelBatch.push_back(target);
          }
          else
@@ -56,7 +56,7 @@ StrictRouteFixup::process(RequestContext& context)
       // Will cancel any active transactions (ideally there should be none)
       // and terminate any pending transactions.
       context.getResponseContext().cancelAllClientTransactions();
-      std::unique_ptr<Target> target(new Target(request.header(h_RequestLine).uri()));
+      std::unique_ptr<Target> target(new (&context.getArena()) Target(request.header(h_RequestLine).uri()));
       if (context.isTopRouteFlowTupleSet())
       {
          target->rec().mReceivedFrom = context.getTopRouteFlowTuple();
@@ -11,9 +11,10 @@ using namespace repro;
 #define RESIPROCATE_SUBSYSTEM resip::Subsystem::REPRO
 
 PresenceServer::PresenceServer(DialogUsageManager& dum, resip::Dispatcher* userDispatcher, bool presenceUsesRegistrationState, 
-                               bool PresenceNotifyClosedStateForNonPublishedUsers) :
+                               bool PresenceNotifyClosedStateForNonPublishedUsers, unsigned int notifyBatchSize, unsigned int notifyMinIntervalMs) :
    mDum(dum), 
-   mPresenceSubscriptionHandler(dum, userDispatcher, presenceUsesRegistrationState, PresenceNotifyClosedStateForNonPublishedUsers),
+   mPresenceSubscriptionHandler(dum, userDispatcher, presenceUsesRegistrationState, PresenceNotifyClosedStateForNonPublishedUsers,
+                                notifyBatchSize, notifyMinIntervalMs),
    mPresencePublicationHandler(dum)
 {         
     MasterProfile& profile = *mDum.getMasterProfile();
@@ -18,7 +18,8 @@ namespace repro
 class PresenceServer
 {
    public:
-      PresenceServer(resip::DialogUsageManager& dum, resip::Dispatcher* userDispatcher, bool presenceUsesRegistrationState, bool presenceNotifyClosedStateForNonPublishedUsers);
+      PresenceServer(resip::DialogUsageManager& dum, resip::Dispatcher* userDispatcher, bool presenceUsesRegistrationState, bool presenceNotifyClosedStateForNonPublishedUsers,
+                     unsigned int notifyBatchSize = 50, unsigned int notifyMinIntervalMs = 1000);
       ~PresenceServer();
 
    private:
@@ -19,7 +19,9 @@ using namespace resip;
 PresenceSubscriptionHandler::PresenceSubscriptionHandler(resip::DialogUsageManager& dum,
                                                          resip::Dispatcher* userDispatcher,
                                                          bool presenceUsesRegistrationState,
-                                                         bool presenceNotifyClosedStateForNonPublishedUsers)
+                                                         bool presenceNotifyClosedStateForNonPublishedUsers,
+                                                         unsigned int notifyBatchSize,
+                                                         unsigned int notifyMinIntervalMs)
   : InMemorySyncRegDbHandler(InMemorySyncRegDbHandler::AllChanges),
     InMemorySyncPubDbHandler(InMemorySyncPubDbHandler::AllChanges),
     mDum(dum), 
@@ -27,7 +29,10 @@ PresenceSubscriptionHandler::PresenceSubscriptionHandler(resip::DialogUsageManag
     mRegistrationDb(dynamic_cast<InMemorySyncRegDb*>(dum.getRegistrationPersistenceManager())),
     mPresenceUsesRegistrationState(presenceUsesRegistrationState),
     mPresenceNotifyClosedStateForNonPublishedUsers(presenceNotifyClosedStateForNonPublishedUsers),
-    mUserDispatcher(userDispatcher)
+    mUserDispatcher(userDispatcher),
+    mNotifyBatchSize(resipMax(notifyBatchSize, 1U)),
+    mNotifyMinIntervalMs(notifyMinIntervalMs),
+    mNotifyBatchPosted(false)
 {
    resip_assert(mPublicationDb);
    resip_assert(mRegistrationDb);
@@ -65,7 +70,12 @@ void PresenceSubscriptionHandler::onRefresh(ServerSubscriptionHandle h, const Si
       UInt64 maxExpires = 0;
       bool isRegistered = mRegistrationDb->aorIsRegistered(aor, &maxExpires);
       InfoLog(<< "PresenceSubscriptionHandler::onRefresh: aor=" << aor << ", registered=" << isRegistered << ", maxRegExpires=" << maxExpires);
-      if (!checkRegistrationStateChanged(aor, isRegistered, maxExpires))
+      if (checkRegistrationStateChanged(aor, isRegistered, maxExpires))
+      {
+         // The other subscriptions are notified by a pass that may not run straight away - this one gets its NOTIFY now
+         notifyPresence(h, false /* sendAcceptReject? */);
+      }
+      else
       {
          auto notify = h->neutralNotify();
          if (maxExpires && isRegistered)
@@ -298,8 +308,7 @@ PresenceSubscriptionHandler::fabricateSimplePresence(ServerSubscriptionHandle h,
 
    // Fabricate a simple presence update based on registration state
    GenericPidfContents pidf;
-   pidf.setEntity(aor);
-   pidf.setSimplePresenceTupleNode(h->getDocumentKey(), online, GenericPidfContents::generateNowTimestampData());
+   buildSimplePresence(pidf, h->getDocumentKey(), aor, online);
    if (sendAcceptReject)
    {
       h->setSubscriptionState(Active);
@@ -313,6 +322,13 @@ PresenceSubscriptionHandler::fabricateSimplePresence(ServerSubscriptionHandle h,
    h->send(std::move(notify));
 }
 
+void
+PresenceSubscriptionHandler::buildSimplePresence(GenericPidfContents& pidf, const Data& documentKey, const Uri& aor, bool online)
+{
+   pidf.setEntity(aor);
+   pidf.setSimplePresenceTupleNode(documentKey, online, GenericPidfContents::generateNowTimestampData());
+}
+
 bool 
 PresenceSubscriptionHandler::mergeETag(Contents* eTagDest, Contents* eTagSrc, bool isFirst)
 {
@@ -357,36 +373,6 @@ private:
    UInt64 mRegMaxExpires;
 };
 
-// Used to fabricate a presence update to all applicable subscriptions
-class repro::PresenceServerSubscriptionRegFunctor
-{
-public:
-   PresenceServerSubscriptionRegFunctor(PresenceSubscriptionHandler& handler, const resip::Uri& aor, bool online, UInt64 regMaxExpires) :
-      mHandler(handler), mAor(aor), mOnline(online), mRegMaxExpires(regMaxExpires) {}
-   virtual ~PresenceServerSubscriptionRegFunctor() { }
-
-   virtual void operator()(ServerSubscriptionHandle h)
-   {
-      if (mOnline)
-      {
-         if (!mHandler.sendPublishedPresence(h, false /* sendAcceptReject */))
-         {
-            // Fabricate a simple presence update based on registration state
-            mHandler.fabricateSimplePresence(h, false /* sendAcceptReject */, mAor, true /* online? */, mRegMaxExpires);
-         }
-      }
-      else
-      {
-         mHandler.fabricateSimplePresence(h, false /* sendAcceptReject */, mAor, false /* online? */, mRegMaxExpires);
-      }
-   }
-private:
-   PresenceSubscriptionHandler& mHandler;
-   Uri mAor;
-   bool mOnline;
-   UInt64 mRegMaxExpires;
-};
-
 bool 
 PresenceSubscriptionHandler::checkRegistrationStateChanged(const resip::Uri& aor, bool registered, UInt64 regMaxExpires)
 {
@@ -410,9 +396,7 @@ PresenceSubscriptionHandler::checkRegistrationStateChanged(const resip::Uri& aor
    }
    if (stateChanged)
    {
-      PresenceServerSubscriptionRegFunctor functor(*this, aor, online, regMaxExpires);
-      Data aorData = aor.user() + "@" + aor.host();
-      mDum.applyToServerSubscriptions<PresenceServerSubscriptionRegFunctor>(aorData, Symbols::Presence, functor);
+      notifySubscriptions(aor.user() + "@" + aor.host());
    }
    else
    {
@@ -445,19 +429,18 @@ PresenceSubscriptionHandler::onAorModified(const resip::Uri& aor, const ContactL
    mDum.post(new PresenceServerRegStateChangeCommand(*this, aor, registered, maxExpirationTime));
 }
 
-// Used to notify presence update to all applicable subscriptions
-class repro::PresenceServerSubscriptionFunctor
+// Used to collect the subscriptions a notify pass sends to
+class repro::PresenceServerSubscriptionCollector
 {
 public:
-   PresenceServerSubscriptionFunctor(PresenceSubscriptionHandler& handler) : mHandler(handler) {}
-   virtual ~PresenceServerSubscriptionFunctor() { }
+   PresenceServerSubscriptionCollector(std::deque<ServerSubscriptionHandle>& handles) : mHandles(handles) {}
 
-   virtual void operator()(ServerSubscriptionHandle h)
+   void operator()(ServerSubscriptionHandle h)
    {
-      mHandler.notifyPresence(h, false /* sendAcceptReject? */);
+      mHandles.push_back(h);
    }
 private:
-   PresenceSubscriptionHandler& mHandler;
+   std::deque<ServerSubscriptionHandle>& mHandles;
 };
 
 // Used to send notifies in DumThread context
@@ -504,11 +487,215 @@ private:
    UInt64 mLastUpdated;
 };
 
+// Used to send the next batch of NOTIFYs in a later DumThread loop iteration
+class repro::PresenceServerNotifyBatchCommand : public DumCommandAdapter
+{
+public:
+   PresenceServerNotifyBatchCommand(PresenceSubscriptionHandler& handler) : mHandler(handler) {}
+
+   virtual void executeCommand()
+   {
+      mHandler.processNotifyBatch();
+   }
+
+   virtual EncodeStream& encodeBrief(EncodeStream& strm) const
+   {
+      return strm << "PresenceServerNotifyBatchCommand";
+   }
+private:
+   PresenceSubscriptionHandler& mHandler;
+};
+
+// Used to end the minimum interval between notify passes in DumThread context
+class repro::PresenceServerNotifyIntervalCommand : public DumCommandAdapter
+{
+public:
+   PresenceServerNotifyIntervalCommand(PresenceSubscriptionHandler& handler, const resip::Data& documentKey)
+      : mHandler(handler), mDocumentKey(documentKey) {}
+
+   virtual void executeCommand()
+   {
+      mHandler.onNotifyIntervalExpired(mDocumentKey);
+   }
+
+   virtual EncodeStream& encodeBrief(EncodeStream& strm) const
+   {
+      return strm << "PresenceServerNotifyIntervalCommand: aor=" << mDocumentKey;
+   }
+private:
+   PresenceSubscriptionHandler& mHandler;
+   resip::Data mDocumentKey;
+};
+
 void
 PresenceSubscriptionHandler::notifySubscriptions(const Data& documentKey)
 {
-   PresenceServerSubscriptionFunctor functor(*this);
-   mDum.applyToServerSubscriptions<PresenceServerSubscriptionFunctor>(documentKey, Symbols::Presence, functor);
+   NotifyPassMap::iterator it = mNotifyPasses.find(documentKey);
+   if (it != mNotifyPasses.end())
+   {
+      // A pass is running or finished too recently - one more pass will pick this change up
+      DebugLog(<< "PresenceSubscriptionHandler::notifySubscriptions: coalescing change for aor=" << documentKey);
+      it->second.mChangedSinceStart = true;
+      return;
+   }
+   startNotifyPass(documentKey, mNotifyPasses[documentKey]);
+}
+
+void
+PresenceSubscriptionHandler::startNotifyPass(const Data& documentKey, NotifyPass& pass)
+{
+   pass.mRunning = true;
+   pass.mChangedSinceStart = false;
+   pass.mRegMaxExpires = 0;
+   pass.mContents.reset();
+   pass.mPending.clear();
+   PresenceServerSubscriptionCollector collector(pass.mPending);
+   mDum.applyToServerSubscriptions<PresenceServerSubscriptionCollector>(documentKey, Symbols::Presence, collector);
+
+   if (!pass.mPending.empty())
+   {
+      // Build the document every subscription will get once.  If there is nothing to share
+      // (no publication and not using registration state) each subscription is handled by
+      // notifyPresence, which may need to check that the user exists.
+      try
+      {
+         Uri aor("sip:" + documentKey);
+         GenericPidfContents pidf;
+         bool haveDocument = false;
+         if (mPresenceUsesRegistrationState)
+         {
+            UInt64 maxExpires = 0;
+            if (mRegistrationDb->aorIsRegistered(aor, &maxExpires))
+            {
+               mOnlineAors.insert(aor);
+               if (!mPublicationDb->getMergedETags(Symbols::Presence, documentKey, *this, &pidf))
+               {
+                  // Fabricate a simple presence update based on registration state
+                  buildSimplePresence(pidf, documentKey, aor, true /* online? */);
+                  pass.mRegMaxExpires = maxExpires;
+               }
+            }
+            else
+            {
+               // Subscriptions only exist for users that exist, so there is no need to check
+               mOnlineAors.erase(aor);
+               buildSimplePresence(pidf, documentKey, aor, false /* online? */);
+            }
+            haveDocument = true;
+         }
+         else
+         {
+            haveDocument = mPublicationDb->getMergedETags(Symbols::Presence, documentKey, *this, &pidf);
+         }
+         if (haveDocument)
+         {
+            pass.mBody = pidf.getBodyData();
+            pass.mContents.reset(new GenericPidfContents(HeaderFieldValue(pass.mBody.data(), (unsigned int)pass.mBody.size()), 
+                                                         GenericPidfContents::getStaticType()));
+         }
+      }
+      catch (BaseException& ex)
+      {
+         ErrLog(<< "PresenceSubscriptionHandler::startNotifyPass: problem building presence document for aor=" << documentKey << ": " << ex);
+      }
+   }
+
+   DebugLog(<< "PresenceSubscriptionHandler::startNotifyPass: aor=" << documentKey << ", subscriptions=" << pass.mPending.size() 
+            << ", sharedDocument=" << (pass.mContents.get() != 0));
+   mRunningPasses.push_back(documentKey);
+   if (!mNotifyBatchPosted)
+   {
+      mNotifyBatchPosted = true;
+      mDum.post(new PresenceServerNotifyBatchCommand(*this));
+   }
+}
+
+void
+PresenceSubscriptionHandler::processNotifyBatch()
+{
+   mNotifyBatchPosted = false;
+   unsigned int remaining = mNotifyBatchSize;
+   while (remaining > 0 && !mRunningPasses.empty())
+   {
+      NotifyPassMap::iterator it = mNotifyPasses.find(mRunningPasses.front());
+      resip_assert(it != mNotifyPasses.end());
+      NotifyPass& pass = it->second;
+      while (remaining > 0 && !pass.mPending.empty())
+      {
+         ServerSubscriptionHandle h = pass.mPending.front();
+         pass.mPending.pop_front();
+         if (!h.isValid())
+         {
+            continue;  // terminated since the pass started
+         }
+         if (pass.mContents.get())
+         {
+            // Contents are cloned into the NOTIFY - as they are unparsed that is a copy of the encoded body
+            auto notify = h->update(pass.mContents.get());
+            if (pass.mRegMaxExpires)
+            {
+               adjustNotifyExpiresTime(*notify.get(), pass.mRegMaxExpires);
+            }
+            h->send(std::move(notify));
+         }
+         else
+         {
+            notifyPresence(h, false /* sendAcceptReject? */);
+         }
+         remaining--;
+      }
+      if (pass.mPending.empty())
+      {
+         mRunningPasses.pop_front();
+         finishNotifyPass(it);
+      }
+   }
+   if (!mRunningPasses.empty() && !mNotifyBatchPosted)
+   {
+      // Let other DUM work run before the next batch
+      mNotifyBatchPosted = true;
+      mDum.post(new PresenceServerNotifyBatchCommand(*this));
+   }
+}
+
+void
+PresenceSubscriptionHandler::finishNotifyPass(NotifyPassMap::iterator it)
+{
+   NotifyPass& pass = it->second;
+   pass.mRunning = false;
+   pass.mContents.reset();
+   pass.mBody.clear();
+   if (mNotifyMinIntervalMs > 0)
+   {
+      // Keep the entry so that changes during the interval are coalesced
+      mDum.getSipStack().postMS(std::unique_ptr<resip::ApplicationMessage>(new PresenceServerNotifyIntervalCommand(*this, it->first)), mNotifyMinIntervalMs, &mDum);
+   }
+   else if (pass.mChangedSinceStart)
+   {
+      startNotifyPass(it->first, pass);
+   }
+   else
+   {
+      mNotifyPasses.erase(it);
+   }
+}
+
+void
+PresenceSubscriptionHandler::onNotifyIntervalExpired(const Data& documentKey)
+{
+   NotifyPassMap::iterator it = mNotifyPasses.find(documentKey);
+   if (it == mNotifyPasses.end() || it->second.mRunning)
+   {
+      return;
+   }
+   if (it->second.mChangedSinceStart)
+   {
+      startNotifyPass(it->first, it->second);
+   }
+   else
+   {
+      mNotifyPasses.erase(it);
+   }
 }
 
 void PresenceSubscriptionHandler::checkExpired(const resip::Data& documentKey, const resip::Data& eTag, UInt64 lastUpdated)
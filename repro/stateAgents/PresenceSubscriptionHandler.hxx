@@ -1,6 +1,9 @@
 #if !defined(PresenceSubscriptionHandler_hxx)
 #define PresenceSubscriptionHandler_hxx
 
+#include <deque>
+#include <map>
+#include <memory>
 #include <set>
 #include "resip/dum/ServerSubscription.hxx"
 #include "resip/dum/DumCommand.hxx"
@@ -16,6 +19,7 @@ class SipMessage;
 class SecurityAttributes;
 class Data;
 class Contents;
+class GenericPidfContents;
 }
 
 namespace repro
@@ -55,11 +59,12 @@ private:
    resip::Uri mAor;
 };
 
-class PresenceServerSubscriptionRegFunctor;
-class PresenceServerSubscriptionFunctor;
+class PresenceServerSubscriptionCollector;
 class PresenceServerRegStateChangeCommand;
 class PresenceServerDocStateChangeCommand;
 class PresenceServerCheckDocExpiredCommand;
+class PresenceServerNotifyBatchCommand;
+class PresenceServerNotifyIntervalCommand;
 class PresenceSubscriptionHandler : public resip::ServerSubscriptionHandler, 
                                     public resip::PublicationPersistenceManager::ETagMerger,
                                     public resip::InMemorySyncRegDbHandler,
@@ -69,7 +74,9 @@ public:
     PresenceSubscriptionHandler(resip::DialogUsageManager& dum,
                                resip::Dispatcher* userDispatcher,
                                bool presenceUsesRegistrationState,
-                               bool PresenceNotifyClosedStateForNonPublishedUsers);
+                               bool PresenceNotifyClosedStateForNonPublishedUsers,
+                               unsigned int notifyBatchSize = 50,
+                               unsigned int notifyMinIntervalMs = 1000);
     virtual ~PresenceSubscriptionHandler();
 
     // ServerSubscriptionHandler interfaces
@@ -101,21 +108,52 @@ protected:
     bool sendPublishedPresence(resip::ServerSubscriptionHandle h, bool sendAcceptReject);
     void adjustNotifyExpiresTime(resip::SipMessage& notify, UInt64 regMaxExpires);
     void fabricateSimplePresence(resip::ServerSubscriptionHandle h, bool sendAcceptReject, const resip::Uri& aor, bool online, UInt64 regMaxExpires);
+    static void buildSimplePresence(resip::GenericPidfContents& pidf, const resip::Data& documentKey, const resip::Uri& aor, bool online);
     void continueNotifyPresenceAfterUserExistsCheck(resip::ServerSubscriptionHandle h, bool sendAcceptReject, const resip::Uri& aor, bool userExists);
     bool checkRegistrationStateChanged(const resip::Uri& aor, bool registered, UInt64 regMaxExpires);
     void notifySubscriptions(const resip::Data& documentKey);
     void checkExpired(const resip::Data& documentKey, const resip::Data& eTag, UInt64 lastUpdated);
-    friend class PresenceServerSubscriptionRegFunctor;
-    friend class PresenceServerSubscriptionFunctor;
+    friend class PresenceServerSubscriptionCollector;
     friend class PresenceServerRegStateChangeCommand;
     friend class PresenceServerDocStateChangeCommand;
     friend class PresenceServerCheckDocExpiredCommand;
+    friend class PresenceServerNotifyBatchCommand;
+    friend class PresenceServerNotifyIntervalCommand;
     friend class PresenceUserExists;
 
+    // A presence change for a presentity is sent to all of its subscriptions by a "pass":
+    // the document is built and encoded once, and the NOTIFYs are sent notifyBatchSize
+    // at a time from successive DUM loop iterations.  Changes that arrive while a pass is
+    // running, or within notifyMinIntervalMs of the last one finishing, are coalesced into
+    // a single further pass.
+    class NotifyPass
+    {
+    public:
+       NotifyPass() : mRunning(false), mChangedSinceStart(false), mRegMaxExpires(0) {}
+       bool mRunning;             // false while waiting out notifyMinIntervalMs after a pass
+       bool mChangedSinceStart;
+       std::deque<resip::ServerSubscriptionHandle> mPending;
+       resip::Data mBody;         // encoded document shared by all NOTIFYs of the pass
+       std::unique_ptr<resip::Contents> mContents;  // unparsed contents over mBody, or 0 to notify each subscription individually
+       UInt64 mRegMaxExpires;
+    };
+    typedef std::map<resip::Data, NotifyPass> NotifyPassMap;
+
+    void startNotifyPass(const resip::Data& documentKey, NotifyPass& pass);
+    void finishNotifyPass(NotifyPassMap::iterator it);
+    void processNotifyBatch();
+    void onNotifyIntervalExpired(const resip::Data& documentKey);
+
     bool mPresenceUsesRegistrationState;
     bool mPresenceNotifyClosedStateForNonPublishedUsers;
     resip::Dispatcher* mUserDispatcher;
     std::set<resip::Uri> mOnlineAors;
+
+    unsigned int mNotifyBatchSize;
+    unsigned int mNotifyMinIntervalMs;
+    NotifyPassMap mNotifyPasses;
+    std::deque<resip::Data> mRunningPasses;  // document keys with NOTIFYs still to send, in start order
+    bool mNotifyBatchPosted;
 };
  
 }
@@ -0,0 +1,250 @@
+#if defined(HAVE_CONFIG_H)
+#include "config.h"
+#endif
+
+#include <iostream>
+#include <stdlib.h>
+
+#include "repro/AbstractDb.hxx"
+#include "repro/ProcessorChain.hxx"
+#include "repro/Proxy.hxx"
+#include "repro/ProxyConfig.hxx"
+#include "repro/RRDecorator.hxx"
+#include "resip/stack/ExtensionParameter.hxx"
+#include "resip/stack/Helper.hxx"
+#include "resip/stack/SipMessage.hxx"
+#include "resip/stack/SipStack.hxx"
+#include "rutil/DataStream.hxx"
+#include "rutil/Log.hxx"
+#include "rutil/Timer.hxx"
+
+using namespace resip;
+using namespace repro;
+using namespace std;
+
+// Empty database; the Proxy only needs a Store to exist.
+class NullDb : public AbstractDb
+{
+   public:
+      virtual bool isSane() {return true;}
+      virtual bool dbWriteRecord(const Table table, const Data& key, const Data& data) {return true;}
+      virtual bool dbReadRecord(const Table table, const Data& key, Data& data) const {return false;}
+      virtual void dbEraseRecord(const Table table, const Data& key, bool isSecondaryKey=false) {}
+      virtual Data dbNextKey(const Table table, bool first=false) {return Data::Empty;}
+      virtual bool dbNextRecord(const Table table, const Data& key, Data& data, bool forUpdate, bool first=false) {return false;}
+      virtual bool dbBeginTransaction(const Table table) {return true;}
+      virtual bool dbCommitTransaction(const Table table) {return true;}
+      virtual bool dbRollbackTransaction(const Table table) {return true;}
+};
+
+static Tuple
+makeTuple(const char* address, int port, TransportType type, unsigned int transportKey)
+{
+   Tuple tuple(address, port, type);
+   tuple.mTransportKey = transportKey;
+   return tuple;
+}
+
+// repro's forwarding of a request that was record-routed on a UDP transport 
+// and leaves on a TCP one: ResponseContext adds the inbound Record-Route and 
+// the RRDecorator double record-routes through singleRecordRoute() when the 
+// request goes out.
+static UInt64
+forward(const Proxy& proxy, const SipMessage& orig, int runs, Data& last)
+{
+   const Tuple received(makeTuple("192.0.2.1", 5060, UDP, 1));
+   const Tuple sending(makeTuple("198.51.100.1", 5060, TCP, 2));
+   const Tuple destination(makeTuple("198.51.100.2", 5060, TCP, 2));
+
+   UInt64 startTime = Timer::getTimeMs();
+   for (int i = 0; i < runs; ++i)
+   {
+      SipMessage request(orig);
+      NameAddr rt(proxy.getLrRecordRoute(received.mTransportKey));
+      Helper::massageRoute(request, rt);
+      request.header(h_RecordRoutes).push_front(rt);
+
+      RRDecorator decorator(proxy, received, proxy.getRecordRoute(received.mTransportKey),
+                            true /* alreadySingleRecordRouted */, false, false);
+      decorator.decorateMessage(request, sending, destination, Data::Empty);
+
+      const SipMessage& constRequest = request;
+      if (!constRequest.header(h_RecordRoutes).front().isFrozen())
+      {
+         cerr << "Outbound Record-Route was re-encoded" << endl;
+         return 0;
+      }
+
+      last.clear();
+      DataStream str(last);
+      request.encode(str);
+   }
+   return Timer::getTimeMs() - startTime;
+}
+
+// The same forward, with the outbound Record-Route built the way 
+// singleRecordRoute() used to: copied from an unfrozen NameAddr and given 
+// ;drr after the copy.
+static UInt64
+forwardUnfrozen(const SipMessage& orig, const NameAddr& inbound, const NameAddr& outbound, int runs, Data& last)
+{
+   static ExtensionParameter p_drr("drr");
+   UInt64 startTime = Timer::getTimeMs();
+   for (int i = 0; i < runs; ++i)
+   {
+      SipMessage request(orig);
+      NameAddr rt(inbound);
+      Helper::massageRoute(request, rt);
+      request.header(h_RecordRoutes).push_front(rt);
+
+      NameAddr outRt(outbound);
+      Helper::massageRoute(request, outRt);
+      outRt.uri().param(p_drr);
+      request.header(h_RecordRoutes).front().uri().param(p_drr);
+      request.header(h_RecordRoutes).push_front(outRt);
+
+      last.clear();
+      DataStream str(last);
+      request.encode(str);
+   }
+   return Timer::getTimeMs() - startTime;
+}
+
+int
+main(int argc, char* argv[])
+{
+   int runs = 100000;
+   if (argc > 1)
+   {
+      runs = atoi(argv[1]);
+   }
+   Log::initialize(Log::Cout, Log::Warning, argv[0]);
+
+   Data txt("INVITE sip:bob@biloxi.example.com SIP/2.0\r\n"
+            "Via: SIP/2.0/UDP 192.0.2.4:5060;branch=z9hG4bK-524287-1---776asdhds;rport\r\n"
+            "Max-Forwards: 70\r\n"
+            "To: Bob <sip:bob@biloxi.example.com>\r\n"
+            "From: Alice <sip:alice@atlanta.example.com>;tag=1928301774\r\n"
+            "Call-ID: a84b4c76e66710@pc33.atlanta.example.com\r\n"
+            "CSeq: 314159 INVITE\r\n"
+            "Contact: <sip:alice@192.0.2.4;transport=udp>\r\n"
+            "Record-Route: <sip:edge.atlanta.example.com;lr>\r\n"
+            "Content-Length: 0\r\n"
+            "\r\n");
+
+   SipMessage* msg = SipMessage::make(txt);
+   if (msg == 0)
+   {
+      cerr << "Unable to build test message" << endl;
+      return -1;
+   }
+   // touch the headers repro touches, so that every copy is parsed alike
+   msg->header(h_Vias).front().param(p_branch);
+   msg->header(h_RecordRoutes).front().uri();
+
+   NullDb db;
+   ProxyConfig config;
+   config.insertConfigValue("RecordRouteUri", "sip:proxy.biloxi.example.com");
+   config.createDataStore(&db);
+
+   SipStack stack;
+   ProcessorChain requestProcessors(Processor::REQUEST_CHAIN);
+   ProcessorChain responseProcessors(Processor::RESPONSE_CHAIN);
+   ProcessorChain targetProcessors(Processor::TARGET_CHAIN);
+   Proxy proxy(stack, config, requestProcessors, responseProcessors, targetProcessors);
+   proxy.addTransportRecordRoute(2, NameAddr(Uri("sip:proxy.biloxi.example.com;transport=tcp")));
+
+   // the configured Record-Routes are left as they were given
+   if (Data::from(proxy.getRecordRoute(1)) != "<sip:proxy.biloxi.example.com>" ||
+       Data::from(proxy.getRecordRoute(2)) != "<sip:proxy.biloxi.example.com;transport=tcp>" ||
+       !proxy.getLrRecordRoute(2).isFrozen())
+   {
+      cerr << "Unexpected Record-Routes in the proxy" << endl;
+      return -1;
+   }
+
+   Data frozenEncoded;
+   UInt64 frozen = forward(proxy, *msg, runs, frozenEncoded);
+   if (frozenEncoded.empty())
+   {
+      delete msg;
+      return -1;
+   }
+
+   Data plainEncoded;
+   UInt64 plain = forwardUnfrozen(*msg,
+                                  NameAddr(Uri("sip:proxy.biloxi.example.com")),
+                                  NameAddr(Uri("sip:proxy.biloxi.example.com;transport=tcp")),
+                                  runs, plainEncoded);
+   if (plainEncoded != frozenEncoded)
+   {
+      cerr << "Encoded requests differ:" << endl
+           << plainEncoded << endl << frozenEncoded << endl;
+      delete msg;
+      return -1;
+   }
+   if (frozenEncoded.find("Record-Route: <sip:proxy.biloxi.example.com;transport=tcp;lr;drr>\r\n"
+                          "Record-Route: <sip:proxy.biloxi.example.com;lr;drr>\r\n"
+                          "Record-Route: <sip:edge.atlanta.example.com;lr>\r\n") == Data::npos)
+   {
+      cerr << "Unexpected Record-Routes:" << endl << frozenEncoded << endl;
+      delete msg;
+      return -1;
+   }
+
+   cout << "Double record-routed " << runs << " forwarded requests; Record-Routes built per request: "
+        << plain << " ms, frozen in the proxy: " << frozen << " ms" << endl;
+
+   delete msg;
+   return 0;
+}
+
+/* ====================================================================
+ * The Vovida Software License, Version 1.0
+ *
+ * Copyright (c) 2000 Vovida Networks, Inc.  All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * 3. The names "VOCAL", "Vovida Open Communication Application Library",
+ *    and "Vovida Open Communication Application Library (VOCAL)" must
+ *    not be used to endorse or promote products derived from this
+ *    software without prior written permission. For written
+ *    permission, please contact vocal@vovida.org.
+ *
+ * 4. Products derived from this software may not be called "VOCAL", nor
+ *    may "VOCAL" appear in their name, without prior written
+ *    permission of Vovida Networks, Inc.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS" AND ANY EXPRESSED OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, TITLE AND
+ * NON-INFRINGEMENT ARE DISCLAIMED.  IN NO EVENT SHALL VOVIDA
+ * NETWORKS, INC. OR ITS CONTRIBUTORS BE LIABLE FOR ANY DIRECT DAMAGES
+ * IN EXCESS OF $1,000, NOR FOR ANY INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+ * USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+ * DAMAGE.
+ *
+ * ====================================================================
+ *
+ * This software consists of voluntary contributions made by Vovida
+ * Networks, Inc. and many individuals on behalf of Vovida Networks,
+ * Inc.  For more information on Vovida Networks, Inc., please see
+ * <http://www.vovida.org/>.
+ *
+ */
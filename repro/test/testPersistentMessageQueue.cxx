@@ -0,0 +1,190 @@
+/**
+    Durability / throughput benchmark for PersistentMessageEnqueue group commit.
+
+    For each batch size, pushes the given number of accounting-sized records
+    to a fresh queue (one transaction per batch), closes it, then reopens the
+    queue with a PersistentMessageDequeue and checks that every record is
+    there, in order.  With sync=1 (the default, and what AccountingCollector
+    uses) every transaction commit is written and flushed to disk, so the
+    throughput shows what group commit saves.
+
+    Usage: testPersistentMessageQueue [baseDir] [numRecords] [sync]
+
+    Queues are created under baseDir (default ./) as pmqbatch<N>, and are
+    left empty afterwards.
+**/
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#include "rutil/Data.hxx"
+#include "rutil/Log.hxx"
+#include "rutil/Timer.hxx"
+#include "repro/PersistentMessageQueue.hxx"
+
+using namespace resip;
+using namespace repro;
+using namespace std;
+
+static Data
+makeRecord(unsigned int i)
+{
+   // roughly the size of a Registration Added event
+   Data record("{\"EventId\":1,\"EventName\":\"Registration Added\",\"Datetime\":\"Mon, 19 Oct 2026 01:00:00 GMT\","
+               "\"CallId\":\"");
+   record += Data(i);
+   record += "\",\"User\":{\"Aor\":\"sip:user";
+   record += Data(i);
+   record += "@example.com\"},\"Contacts\":[\"<sip:user@192.0.2.1:5060;transport=udp>;expires=3600\"],"
+             "\"Expires\":3600,\"ClientPublicAddress\":{\"Transport\":\"UDP\",\"IP\":\"192.0.2.1\",\"Port\":5060},"
+             "\"UserAgent\":\"testPersistentMessageQueue\"}";
+   return record;
+}
+
+static bool
+runBatchSize(const Data& baseDir, unsigned int numRecords, bool sync, unsigned int batchSize)
+{
+   const Data queueName("pmqbatch" + Data(batchSize));
+
+   UInt64 elapsedMs = 0;
+   {
+      PersistentMessageEnqueue queue(baseDir);
+      if(!queue.init(sync, queueName))
+      {
+         cerr << "cannot initialize queue " << queueName << endl;
+         return false;
+      }
+
+      vector<Data> batch;
+      batch.reserve(batchSize);
+      const UInt64 start = Timer::getTimeMs();
+      for(unsigned int i = 0; i < numRecords; i++)
+      {
+         batch.push_back(makeRecord(i));
+         if(batch.size() == batchSize || i == numRecords - 1)
+         {
+            if(!queue.push(batch))
+            {
+               cerr << "push failed at record " << i << endl;
+               return false;
+            }
+            batch.clear();
+         }
+      }
+      elapsedMs = Timer::getTimeMs() - start;
+   }
+
+   // reopen and read everything back
+   unsigned int numRead = 0;
+   {
+      PersistentMessageDequeue queue(baseDir);
+      if(!queue.init(sync, queueName))
+      {
+         cerr << "cannot reopen queue " << queueName << endl;
+         return false;
+      }
+      vector<Data> records;
+      for(;;)
+      {
+         if(!queue.pop(1000, records, true /* autoCommit */))
+         {
+            cerr << "pop failed after " << numRead << " records" << endl;
+            return false;
+         }
+         if(records.empty())
+         {
+            break;
+         }
+         for(size_t i = 0; i < records.size(); i++, numRead++)
+         {
+            if(records[i] != makeRecord(numRead))
+            {
+               cerr << "record " << numRead << " is missing or out of order" << endl;
+               return false;
+            }
+         }
+      }
+   }
+
+   if(numRead != numRecords)
+   {
+      cerr << "pushed " << numRecords << " records, read back " << numRead << endl;
+      return false;
+   }
+
+   cout << "batch " << batchSize << ": " << numRecords << " records in " << elapsedMs << " ms, "
+        << (elapsedMs ? (UInt64)numRecords * 1000 / elapsedMs : (UInt64)numRecords * 1000) << " records/s; "
+        << numRead << " read back" << endl;
+   return true;
+}
+
+int
+main(int argc, char* argv[])
+{
+   Log::initialize(Log::Cout, Log::Warning, argv[0]);
+
+   Data baseDir(argc > 1 ? argv[1] : "./");
+   unsigned int numRecords = argc > 2 ? atoi(argv[2]) : 2000;
+   bool sync = argc > 3 ? atoi(argv[3]) != 0 : true;
+
+   cout << "sync=" << sync << endl;
+   const unsigned int batchSizes[] = { 1, 16, 64, 256 };
+   for(size_t i = 0; i < sizeof(batchSizes) / sizeof(batchSizes[0]); i++)
+   {
+      if(!runBatchSize(baseDir, numRecords, sync, batchSizes[i]))
+      {
+         return 1;
+      }
+   }
+   return 0;
+}
+
+/* ====================================================================
+ * The Vovida Software License, Version 1.0
+ *
+ * Copyright (c) 2000 Vovida Networks, Inc.  All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * 3. The names "VOCAL", "Vovida Open Communication Application Library",
+ *    and "Vovida Open Communication Application Library (VOCAL)" must
+ *    not be used to endorse or promote products derived from this
+ *    software without prior written permission. For written
+ *    permission, please contact vocal@vovida.org.
+ *
+ * 4. Products derived from this software may not be called "VOCAL", nor
+ *    may "VOCAL" appear in their name, without prior written
+ *    permission of Vovida Networks, Inc.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS" AND ANY EXPRESSED OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, TITLE AND
+ * NON-INFRINGEMENT ARE DISCLAIMED.  IN NO EVENT SHALL VOVIDA
+ * NETWORKS, INC. OR ITS CONTRIBUTORS BE LIABLE FOR ANY DIRECT DAMAGES
+ * IN EXCESS OF $1,000, NOR FOR ANY INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+ * USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+ * DAMAGE.
+ *
+ * ====================================================================
+ *
+ * This software consists of voluntary contributions made by Vovida
+ * Networks, Inc. and many individuals on behalf of Vovida Networks,
+ * Inc.  For more information on Vovida Networks, Inc., please see
+ * <http://www.vovida.org/>.
+ *
+ */
@@ -0,0 +1,253 @@
+#if defined(HAVE_CONFIG_H)
+#include "config.h"
+#endif
+
+#include <iostream>
+
+#include "repro/RegSyncBinary.hxx"
+#include "resip/stack/Tuple.hxx"
+#include "rutil/Log.hxx"
+#include "rutil/ParseException.hxx"
+#include "rutil/ResipAssert.h"
+
+using namespace resip;
+using namespace repro;
+using namespace std;
+
+static bool
+throwsParseException(const Data& frame)
+{
+   try
+   {
+      unsigned int size = RegSyncBinary::frameSize(frame.data(), (unsigned int)frame.size());
+      if (size == 0)
+      {
+         return false;
+      }
+      UInt64 seq;
+      Uri aor;
+      ContactList contacts;
+      RegSyncBinary::decodeAorUpdate(frame.data(), size, 1000, seq, aor, contacts);
+   }
+   catch (ParseException&)
+   {
+      return true;
+   }
+   return false;
+}
+
+int
+main(int argc, char* argv[])
+{
+   Log::initialize(Log::Cout, Log::Warning, argv[0]);
+
+   const UInt64 now = 1000;
+   Uri aor("sip:alice@example.com");
+
+   ContactList contacts;
+   {
+      ContactInstanceRecord rec;
+      rec.mContact = NameAddr(Uri("sip:alice@192.0.2.4:5060;transport=tcp"));
+      rec.mRegExpires = now + 3600;
+      rec.mLastUpdated = now - 10;
+      rec.mReceivedFrom = Tuple("192.0.2.4", 5060, TCP);
+      rec.mSipPath.push_back(NameAddr(Uri("sip:edge.example.com;lr")));
+      rec.mInstance = "<urn:uuid:00000000-0000-1000-8000-000a95a0e128>";
+      rec.mRegId = 1;
+      rec.mUserAgent = "testRegSyncBinary";
+      contacts.push_back(rec);
+
+      // Updated after now, eg. a clock step; the age must not wrap
+      ContactInstanceRecord ahead;
+      ahead.mContact = NameAddr(Uri("sip:alice@192.0.2.5"));
+      ahead.mRegExpires = 0;
+      ahead.mLastUpdated = now + 50;
+      contacts.push_back(ahead);
+
+      // Static registrations are not synced
+      ContactInstanceRecord fixed;
+      fixed.mContact = NameAddr(Uri("sip:alice@192.0.2.6"));
+      fixed.mRegExpires = NeverExpire;
+      contacts.push_back(fixed);
+   }
+
+   {
+      Data frame;
+      resip_assert(RegSyncBinary::encodeAorUpdate(frame, aor, contacts, now) == 2);
+      RegSyncBinary::setSequence(frame, 0x0102030405060708ULL);
+      resip_assert(RegSyncBinary::frameSize(frame.data(), (unsigned int)frame.size()) == frame.size());
+      resip_assert(RegSyncBinary::frameSize(frame.data(), (unsigned int)frame.size() - 1) == 0);
+      resip_assert(RegSyncBinary::frameType(frame.data()) == RegSyncBinary::AorUpdate);
+
+      // Decoded on a peer whose clock is 100s behind
+      UInt64 seq = 0;
+      Uri decodedAor;
+      ContactList decoded;
+      RegSyncBinary::decodeAorUpdate(frame.data(), (unsigned int)frame.size(), now - 100, seq, decodedAor, decoded);
+      resip_assert(seq == 0x0102030405060708ULL);
+      resip_assert(decodedAor == aor);
+      resip_assert(decoded.size() == 2);
+
+      const ContactInstanceRecord& rec = decoded.front();
+      resip_assert(rec.mContact.uri() == contacts.front().mContact.uri());
+      resip_assert(rec.mRegExpires == now - 100 + 3600);
+      resip_assert(rec.mLastUpdated == now - 100 - 10);
+      resip_assert(rec.mReceivedFrom == contacts.front().mReceivedFrom);
+      resip_assert(rec.mReceivedFrom.getType() == TCP);
+      resip_assert(rec.mPublicAddress.getType() == UNKNOWN_TRANSPORT);
+      resip_assert(rec.mSipPath.size() == 1);
+      resip_assert(rec.mSipPath.front().uri() == Uri("sip:edge.example.com;lr"));
+      resip_assert(rec.mInstance == contacts.front().mInstance);
+      resip_assert(rec.mRegId == 1);
+      resip_assert(rec.mUserAgent == "testRegSyncBinary");
+      resip_assert(rec.mSyncContact);
+
+      const ContactInstanceRecord& ahead = decoded.back();
+      resip_assert(ahead.mRegExpires == 0);
+      resip_assert(ahead.mLastUpdated == now - 100);
+
+      // Every truncation of a valid frame either needs more data or throws
+      for (unsigned int len = RegSyncBinary::HeaderSize; len < frame.size(); len++)
+      {
+         Data truncated(frame.data(), len);
+         resip_assert(RegSyncBinary::frameSize(truncated.data(), len) == 0);
+         // Claim the shorter length so the payload itself is cut short
+         UInt32 length = len - RegSyncBinary::HeaderSize;
+         truncated[2] = (char)(length >> 24);
+         truncated[3] = (char)(length >> 16);
+         truncated[4] = (char)(length >> 8);
+         truncated[5] = (char)length;
+         resip_assert(throwsParseException(truncated));
+      }
+   }
+
+   {
+      // An age larger than the decoder's clock must not wrap mLastUpdated
+      Data frame;
+      ContactList one;
+      ContactInstanceRecord rec;
+      rec.mContact = NameAddr(Uri("sip:alice@192.0.2.7"));
+      rec.mRegExpires = 0;
+      rec.mLastUpdated = 0;
+      one.push_back(rec);
+      resip_assert(RegSyncBinary::encodeAorUpdate(frame, aor, one, now) == 1);
+
+      UInt64 seq;
+      Uri decodedAor;
+      ContactList decoded;
+      RegSyncBinary::decodeAorUpdate(frame.data(), (unsigned int)frame.size(), 10, seq, decodedAor, decoded);
+      resip_assert(decoded.size() == 1);
+      resip_assert(decoded.front().mLastUpdated == 0);
+   }
+
+   {
+      Data frame;
+      RegSyncBinary::encodeSyncMarker(frame, RegSyncBinary::SyncBegin, 42, 7, true);
+      resip_assert(RegSyncBinary::frameSize(frame.data(), (unsigned int)frame.size()) == frame.size());
+      resip_assert(RegSyncBinary::frameType(frame.data()) == RegSyncBinary::SyncBegin);
+      UInt64 epoch = 0;
+      UInt64 seq = 0;
+      bool resumed = false;
+      RegSyncBinary::decodeSyncMarker(frame.data(), (unsigned int)frame.size(), epoch, seq, resumed);
+      resip_assert(epoch == 42);
+      resip_assert(seq == 7);
+      resip_assert(resumed);
+
+      RegSyncBinary::encodeSyncMarker(frame, RegSyncBinary::SyncEnd, 42, 9, false);
+      resip_assert(RegSyncBinary::frameType(frame.data()) == RegSyncBinary::SyncEnd);
+      RegSyncBinary::decodeSyncMarker(frame.data(), (unsigned int)frame.size(), epoch, seq, resumed);
+      resip_assert(seq == 9);
+      resip_assert(!resumed);
+
+      // Marker without its resumed flag
+      Data truncated(frame.data(), frame.size() - 1);
+      truncated[5] = (char)(frame.size() - 1 - RegSyncBinary::HeaderSize);
+      bool threw = false;
+      try
+      {
+         RegSyncBinary::decodeSyncMarker(truncated.data(), (unsigned int)truncated.size(), epoch, seq, resumed);
+      }
+      catch (ParseException&)
+      {
+         threw = true;
+      }
+      resip_assert(threw);
+   }
+
+   {
+      // XML where a binary frame was expected
+      Data xml("<reginfo></reginfo>");
+      resip_assert(throwsParseException(xml));
+
+      // Payload length over MaxPayloadSize
+      Data header;
+      header += RegSyncBinary::FrameMarker;
+      header += (char)RegSyncBinary::AorUpdate;
+      header += (char)0x01;
+      header += (char)0x00;
+      header += (char)0x00;
+      header += (char)0x01;
+      resip_assert(throwsParseException(header));
+
+      // A string length pointing past the end of the frame
+      Data frame;
+      ContactList one;
+      one.push_back(contacts.front());
+      resip_assert(RegSyncBinary::encodeAorUpdate(frame, aor, one, now) == 1);
+      frame[RegSyncBinary::HeaderSize + 8] = (char)0x7f;
+      resip_assert(throwsParseException(frame));
+   }
+
+   cerr << "All OK" << endl;
+   return 0;
+}
+
+/* ====================================================================
+ * The Vovida Software License, Version 1.0
+ *
+ * Copyright (c) 2000 Vovida Networks, Inc.  All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * 3. The names "VOCAL", "Vovida Open Communication Application Library",
+ *    and "Vovida Open Communication Application Library (VOCAL)" must
+ *    not be used to endorse or promote products derived from this
+ *    software without prior written permission. For written
+ *    permission, please contact vocal@vovida.org.
+ *
+ * 4. Products derived from this software may not be called "VOCAL", nor
+ *    may "VOCAL" appear in their name, without prior written
+ *    permission of Vovida Networks, Inc.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS" AND ANY EXPRESSED OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, TITLE AND
+ * NON-INFRINGEMENT ARE DISCLAIMED.  IN NO EVENT SHALL VOVIDA
+ * NETWORKS, INC. OR ITS CONTRIBUTORS BE LIABLE FOR ANY DIRECT DAMAGES
+ * IN EXCESS OF $1,000, NOR FOR ANY INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+ * USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+ * DAMAGE.
+ *
+ * ====================================================================
+ *
+ * This software consists of voluntary contributions made by Vovida
+ * Networks, Inc. and many individuals on behalf of Vovida Networks,
+ * Inc.  For more information on Vovida Networks, Inc., please see
+ * <http://www.vovida.org/>.
+ *
+ */
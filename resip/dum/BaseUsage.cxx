@@ -43,6 +43,12 @@ void BaseUsage::postDum(Message* messageForDum)
    mDum.post(messageForDum);
 }
 
+unsigned int
+BaseUsage::getShardId() const
+{
+   return mDum.getShardId();
+}
+
 #if 0
 EncodeStream& 
 BaseUsage::dump(EncodeStream& strm) const
@@ -30,6 +30,10 @@ class BaseUsage : public Handled
 
       virtual void end()=0;
       virtual EncodeStream& dump(EncodeStream& strm) const=0;
+
+      /// @brief the shard of the DUM this usage belongs to, 0 unless the
+      /// DUM is sharded (see DialogUsageManager::setShard)
+      unsigned int getShardId() const;
       
    protected:
       BaseUsage(DialogUsageManager& dum);      
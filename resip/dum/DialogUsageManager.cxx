@@ -117,7 +117,9 @@ DialogUsageManager::DialogUsageManager(SipStack& stack, bool createDefaultFeatur
    mDumShutdownHandler(0),
    mShutdownState(Running),
    mThreadDebugKey(0),
-   mHiddenThreadDebugKey(0)
+   mHiddenThreadDebugKey(0),
+   mShardId(0),
+   mShardCount(1)
 {
    //TODO -- create default features
    mStack.registerTransactionUser(*this);
@@ -207,6 +209,52 @@ DialogUsageManager::name() const
    return n;
 }
 
+bool
+DialogUsageManager::isForMe(const SipMessage& msg) const
+{
+   if(mShardCount > 1)
+   {
+      // A malformed Call-ID goes to shard 0, which rejects the request
+      const CallId& callId = msg.header(h_CallId);
+      const unsigned int shard = callId.isWellFormed() ? shardForCallId(callId.value(), mShardCount) : 0;
+      if(shard != mShardId)
+      {
+         return false;
+      }
+   }
+   return TransactionUser::isForMe(msg);
+}
+
+void
+DialogUsageManager::setShard(unsigned int shardId, unsigned int shardCount)
+{
+   if(shardCount == 0 || shardId >= shardCount)
+   {
+      throw Exception("Shard id must be less than the shard count", __FILE__, __LINE__);
+   }
+   InfoLog(<< "DialogUsageManager is shard " << shardId << " of " << shardCount);
+   mShardId = shardId;
+   mShardCount = shardCount;
+}
+
+unsigned int
+DialogUsageManager::shardForCallId(const Data& callId, unsigned int shardCount)
+{
+   return shardCount > 1 ? (unsigned int)(callId.hash() % shardCount) : 0;
+}
+
+Data
+DialogUsageManager::makeCallId() const
+{
+   // Call-IDs are random, so on average this takes mShardCount attempts
+   Data callId = Helper::computeCallId();
+   while(shardForCallId(callId, mShardCount) != mShardId)
+   {
+      callId = Helper::computeCallId();
+   }
+   return callId;
+}
+
 void
 DialogUsageManager::addTransport( TransportType protocol,
                                   int port,
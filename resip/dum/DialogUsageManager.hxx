@@ -129,6 +129,26 @@ class DialogUsageManager : public HandleManager, public TransactionUser
       SipStack& getSipStack();
       const SipStack& getSipStack() const;
       Security* getSecurity();
+
+      // Several DialogUsageManagers, each driven by its own DumThread, can
+      // share one SipStack as shards.  A shard only accepts requests whose
+      // Call-ID hashes to its shard id (see shardForCallId) and every Call-ID
+      // it creates hashes to its own id, so a dialog set and all messages in
+      // it stay with one shard and nothing is shared between their threads.
+      // Responses and timers already return to the DUM that sent the request.
+      //
+      // Call setShard before the stack starts delivering messages.  Handlers,
+      // profiles and domains are set up on each shard; anything the shards
+      // share (e.g. a RegistrationPersistenceManager) must be thread safe.
+      // Requests that refer to another Call-ID (Replaces, Join, Target-Dialog)
+      // only find dialogs in their own shard.
+      void setShard(unsigned int shardId, unsigned int shardCount);
+      unsigned int getShardId() const { return mShardId; }
+      unsigned int getShardCount() const { return mShardCount; }
+      static unsigned int shardForCallId(const Data& callId, unsigned int shardCount);
+
+      // Returns a new Call-ID that belongs to this shard
+      Data makeCallId() const;
       
       Data getHostAddress();
 
@@ -368,6 +388,7 @@ class DialogUsageManager : public HandleManager, public TransactionUser
       virtual void onAllHandlesDestroyed();      
       //TransactionUser virtuals
       virtual const Data& name() const;
+      bool isForMe(const SipMessage& msg) const override;
       friend class DumThread;
 
       DumFeatureChain::FeatureList mIncomingFeatureList;
@@ -566,6 +587,9 @@ class DialogUsageManager : public HandleManager, public TransactionUser
       ThreadIf::TlsKey mThreadDebugKey;
       ThreadIf::TlsKey mHiddenThreadDebugKey;
 
+      unsigned int mShardId;
+      unsigned int mShardCount;
+
       EventDispatcher<ConnectionTerminated> mConnectionTerminatedEventDispatcher;
 };
 
@@ -104,6 +104,19 @@ InMemorySyncRegDb::invokeOnAorModified(bool sync, const resip::Uri& aor, const C
    }
 }
 
+void 
+InMemorySyncRegDb::invokeOnContactModified(bool sync, const resip::Uri& aor, const ContactList& contacts, const ContactInstanceRecord& rec)
+{
+   Lock lock(mHandlerMutex);
+   for(HandlerList::iterator it = mHandlers.begin(); it != mHandlers.end(); it++)
+   {
+      if (sync || (*it)->getMode() == InMemorySyncRegDbHandler::AllChanges)
+      {
+         (*it)->onContactModified(aor, contacts, rec);
+      }
+   }
+}
+
 void
 InMemorySyncRegDb::invokeOnInitialSyncAor(unsigned int connectionId, const resip::Uri& aor, const ContactList& contacts)
 {
@@ -338,7 +351,7 @@ InMemorySyncRegDb::updateContact(const resip::Uri& aor,
          }
          *j=rec;
          // Only pass sync as true if this update didn't just come from an inbound sync operation
-         invokeOnAorModified(!rec.mSyncContact /* sync? */, aor, *contactList);
+         invokeOnContactModified(!rec.mSyncContact /* sync? */, aor, *contactList, rec);
          return status;
       }
    }
@@ -346,7 +359,7 @@ InMemorySyncRegDb::updateContact(const resip::Uri& aor,
    // This is a new contact, so we add it to the list.
    contactList->push_back(rec);
    // Only pass sync as true if this update didn't just come from an inbound sync operation
-   invokeOnAorModified(!rec.mSyncContact /* sync? */, aor, *contactList);
+   invokeOnContactModified(!rec.mSyncContact /* sync? */, aor, *contactList, rec);
    return CONTACT_CREATED;
 }
 
@@ -380,10 +393,13 @@ InMemorySyncRegDb::removeContact(const Uri& aor,
             j->mRegExpires = 0;
             j->mLastUpdated = Timer::getTimeSecs();
             // Only pass sync as true if this update didn't just come from an inbound sync operation
-            invokeOnAorModified(!rec.mSyncContact /* sync? */, aor, *contactList);
+            invokeOnContactModified(!rec.mSyncContact /* sync? */, aor, *contactList, *j);
          }
          else
          {
+            ContactInstanceRecord removed(*j);
+            removed.mRegExpires = 0;
+            removed.mLastUpdated = Timer::getTimeSecs();
             contactList->erase(j);
             if (contactList->empty())
             {
@@ -392,7 +408,7 @@ InMemorySyncRegDb::removeContact(const Uri& aor,
             else
             {
                // Only pass sync as true if this update didn't just come from an inbound sync operation
-               invokeOnAorModified(!rec.mSyncContact /* sync? */, aor, *contactList);
+               invokeOnContactModified(!rec.mSyncContact /* sync? */, aor, *contactList, removed);
             }
          }
          return;
@@ -25,6 +25,10 @@ public:
    virtual ~InMemorySyncRegDbHandler(){}
    HandlerMode getMode() { return mMode; }
    virtual void onAorModified(const resip::Uri& aor, const ContactList& contacts) = 0;
+   // Called instead of onAorModified when a single contact was added, updated or removed.
+   // rec is the changed contact (with mRegExpires of 0 if it was removed), contacts is the
+   // resulting list.  Handlers that only replicate changes can send rec on its own.
+   virtual void onContactModified(const resip::Uri& aor, const ContactList& contacts, const ContactInstanceRecord& rec) { onAorModified(aor, contacts); }
    virtual void onInitialSyncAor(unsigned int connectionId, const resip::Uri& aor, const ContactList& contacts) {}
 protected:
    HandlerMode mMode;
@@ -90,6 +94,7 @@ class InMemorySyncRegDb : public RegistrationPersistenceManager
       Condition mRecordUnlocked;
 
       void invokeOnAorModified(bool sync, const resip::Uri& aor, const ContactList& contacts);
+      void invokeOnContactModified(bool sync, const resip::Uri& aor, const ContactList& contacts, const ContactInstanceRecord& rec);
       void invokeOnInitialSyncAor(unsigned int connectionId, const resip::Uri& aor, const ContactList& contacts);
       unsigned int mRemoveLingerSecs;
       typedef std::list<InMemorySyncRegDbHandler*> HandlerList;
@@ -5,6 +5,7 @@
 #include "resip/dum/DialogUsageManager.hxx"
 #include "resip/stack/Helper.hxx"
 #include "rutil/Logger.hxx"
+#include "rutil/Timer.hxx"
 #include "rutil/TransportType.hxx"
 #include "resip/stack/SipStack.hxx"
 
@@ -14,6 +15,18 @@ using namespace resip;
 using namespace std;
 
 int KeepAliveManager::mKeepAlivePongTimeoutMs = 10000;  // Defaults to 10000ms (10s) as specified in RFC5626 section 4.4.1
+int KeepAliveManager::mKeepAliveTickMs = 1000;
+
+KeepAliveManager::KeepAliveManager() :
+   mDum(0),
+   mCurrentId(0),
+   mWheel(WheelSize),
+   mWheelStartMs(0),
+   mCurrentTick(0),
+   mTicking(false),
+   mTickSeq(0)
+{
+}
 
 void 
 KeepAliveManager::add(const Tuple& target, int keepAliveInterval, bool targetSupportsOutbound)
@@ -32,17 +45,8 @@ KeepAliveManager::add(const Tuple& target, int keepAliveInterval, bool targetSup
       info.supportsOutbound = targetSupportsOutbound;
       info.pongReceivedForLastPing = false;
       mNetworkAssociations.insert(NetworkAssociationMap::value_type(target, info));
-      KeepAliveTimeout t(target, mCurrentId);
-      SipStack &stack = mDum->getSipStack();
-      if(targetSupportsOutbound)
-      {
-         // Used randomized timeout between 80% and 100% of keepalivetime
-         stack.post(t, Helper::jitterValue(keepAliveInterval, 80, 100), mDum);
-      }
-      else
-      {
-         stack.post(t, keepAliveInterval, mDum);
-      }
+      startTicking();
+      scheduleKeepAlive(target, info);
       ++mCurrentId;
    }
    else
@@ -70,6 +74,7 @@ KeepAliveManager::add(const Tuple& target, int keepAliveInterval, bool targetSup
 void 
 KeepAliveManager::remove(const Tuple& target)
 {
+   // Anything still on the wheel for the association is dropped when it falls due
    NetworkAssociationMap::iterator it = mNetworkAssociations.find(target);
    if (it != mNetworkAssociations.end())
    {
@@ -89,11 +94,75 @@ void
 KeepAliveManager::process(KeepAliveTimeout& timeout)
 {
    resip_assert(mDum);
-   static KeepAliveMessage msg;
-   NetworkAssociationMap::iterator it = mNetworkAssociations.find(timeout.target());
-   if (it != mNetworkAssociations.end() && timeout.id() == it->second.id)
+   if (!mTicking || timeout.id() != mTickSeq)
    {
-      SipStack &stack = mDum->getSipStack();
+      // tick timer of a wheel that has since been stopped
+      return;
+   }
+
+   const UInt64 nowTick = (Timer::getTimeMs() - mWheelStartMs) / mKeepAliveTickMs;
+   if (nowTick > mCurrentTick + WheelSize)
+   {
+      // The timer ran very late, one turn of the wheel still visits every slot
+      mCurrentTick = nowTick - WheelSize;
+   }
+
+   std::vector<Tuple> keepAlives;
+   while (mCurrentTick < nowTick)
+   {
+      ++mCurrentTick;
+      processTick(keepAlives);
+   }
+
+   if (!keepAlives.empty())
+   {
+      static KeepAliveMessage msg;
+      DebugLog(<< "Sending " << keepAlives.size() << " keepalive(s)");
+      mDum->getSipStack().sendTo(msg, keepAlives, mDum);
+   }
+
+   if (mNetworkAssociations.empty())
+   {
+      DebugLog(<< "No network associations left, stopping keepalive timer");
+      mTicking = false;
+      return;
+   }
+   postTick();
+}
+
+void
+KeepAliveManager::processTick(std::vector<Tuple>& keepAlives)
+{
+   WheelSlot& slot = mWheel[mCurrentTick % WheelSize];
+   WheelSlot entries;
+   entries.swap(slot);
+
+   for (WheelSlot::const_iterator e = entries.begin(); e != entries.end(); ++e)
+   {
+      if (e->dueTick > mCurrentTick)
+      {
+         // due on a later turn of the wheel
+         slot.push_back(*e);
+         continue;
+      }
+
+      NetworkAssociationMap::iterator it = mNetworkAssociations.find(e->target);
+      if (it == mNetworkAssociations.end() || it->second.id != e->id)
+      {
+         continue;
+      }
+
+      if (e->pongTimeout)
+      {
+         if(!it->second.pongReceivedForLastPing)
+         {
+            // Timeout expecting pong response
+            InfoLog(<< "Timed out expecting pong response for keep alive id=" << it->second.id << ": " << it->first);
+            mDum->getSipStack().terminateFlow(it->first);
+         }
+         continue;
+      }
+
       DebugLog(<< "Refreshing keepalive for id=" << it->second.id << ": " << it->first
                << ", interval=" << it->second.keepAliveInterval << "s, supportsOutbound=" 
                << (it->second.supportsOutbound ? "true" : "false") 
@@ -109,24 +178,83 @@ KeepAliveManager::process(KeepAliveTimeout& timeout)
          if(isReliable(it->first.getType()))
          {
             DebugLog( << "Starting pong timeout for keepalive id " << it->second.id);
-            KeepAlivePongTimeout t(it->first, it->second.id);
-            stack.postMS(t, mKeepAlivePongTimeoutMs, mDum);
+            schedule(it->first, it->second.id, mKeepAlivePongTimeoutMs, true);
          }
       }
       it->second.pongReceivedForLastPing = false;  // reset flag
 
-      stack.sendTo(msg, timeout.target(), mDum);
-      KeepAliveTimeout t(it->first, it->second.id);
-      if(it->second.supportsOutbound)
-      {
-         // Used randomized timeout between 80% and 100% of keepalivetime
-         stack.post(t, Helper::jitterValue(it->second.keepAliveInterval, 80, 100), mDum);
-      }
-      else
-      {
-         stack.post(t, it->second.keepAliveInterval, mDum);
-      }
+      keepAlives.push_back(it->first);
+      scheduleKeepAlive(it->first, it->second);
+   }
+
+   if (slot.empty())
+   {
+      // keep the slot's capacity for the next turn
+      entries.clear();
+      slot.swap(entries);
+   }
+}
+
+void
+KeepAliveManager::scheduleKeepAlive(const Tuple& target, const NetworkAssociationInfo& info)
+{
+   if(info.supportsOutbound)
+   {
+      // Used randomized timeout between 80% and 100% of keepalivetime
+      schedule(target, info.id, Helper::jitterValue(info.keepAliveInterval * 1000, 80, 100), false);
+   }
+   else
+   {
+      schedule(target, info.id, info.keepAliveInterval * 1000ULL, false);
+   }
+}
+
+void
+KeepAliveManager::schedule(const Tuple& target, int id, UInt64 delayMs, bool pongTimeout)
+{
+   UInt64 ticks = (delayMs + mKeepAliveTickMs - 1) / mKeepAliveTickMs;
+   if (ticks == 0)
+   {
+      ticks = 1;
+   }
+   WheelEntry entry;
+   entry.target = target;
+   entry.id = id;
+   entry.dueTick = mCurrentTick + ticks;
+   entry.pongTimeout = pongTimeout;
+   mWheel[entry.dueTick % WheelSize].push_back(entry);
+}
+
+void
+KeepAliveManager::startTicking()
+{
+   if (mTicking)
+   {
+      return;
    }
+   const UInt64 now = Timer::getTimeMs();
+   if (mWheelStartMs == 0)
+   {
+      mWheelStartMs = now;
+   }
+   mCurrentTick = (now - mWheelStartMs) / mKeepAliveTickMs;
+   // Only entries of removed associations can be left from before
+   for (std::vector<WheelSlot>::iterator it = mWheel.begin(); it != mWheel.end(); ++it)
+   {
+      it->clear();
+   }
+   mTicking = true;
+   ++mTickSeq;
+   postTick();
+}
+
+void
+KeepAliveManager::postTick()
+{
+   const UInt64 now = Timer::getTimeMs();
+   const UInt64 next = mWheelStartMs + (mCurrentTick + 1) * mKeepAliveTickMs;
+   KeepAliveTimeout t(Tuple(), mTickSeq);
+   mDum->getSipStack().postMS(t, next > now ? (unsigned int)(next - now) : 1, mDum);
 }
 
 void 
@@ -1,7 +1,9 @@
 #ifndef RESIP_KEEPALIVE_MANAGER_HXX
 #define RESIP_KEEPALIVE_MANAGER_HXX
 
-#include <map>
+#include <unordered_map>
+#include <vector>
+#include "rutil/compat.hxx"
 #include "resip/stack/Tuple.hxx"
 
 namespace resip 
@@ -17,6 +19,12 @@ class KeepAliveManager
       // Defaults to 10000ms (10s) as specified in RFC5626 section 4.4.1 
       static int mKeepAlivePongTimeoutMs;  // ?slg? move to Profile setting?
 
+      // Keepalives and pong timeouts are scheduled on a timer wheel with this
+      // resolution.  Everything that falls due in the same tick is handled by
+      // a single DUM timer, and the keepalives are sent as one batch.
+      // Defaults to 1000ms.
+      static int mKeepAliveTickMs;
+
       struct NetworkAssociationInfo
       {
             int refCount;
@@ -33,21 +41,56 @@ class KeepAliveManager
       //        For UDP, this is not currently the case, when the transport is bound to any interface
       //        (ie. 0.0.0.0), as the flow key will be same regardless of the source interface used to
       //        send the UDP message - fixing this for UDP remains an outstanding item.
-      typedef std::map<Tuple, NetworkAssociationInfo, Tuple::FlowKeyCompare> NetworkAssociationMap;
+      // Hash and equality match Tuple::FlowKeyCompare.
+      class FlowKeyHash
+      {
+         public:
+            size_t operator()(const Tuple& t) const { return t.hash() ^ (size_t)t.getFlowKey(); }
+      };
+      class FlowKeyEqual
+      {
+         public:
+            bool operator()(const Tuple& x, const Tuple& y) const { return x == y && x.getFlowKey() == y.getFlowKey(); }
+      };
+      typedef std::unordered_map<Tuple, NetworkAssociationInfo, FlowKeyHash, FlowKeyEqual> NetworkAssociationMap;
 
-      KeepAliveManager() : mCurrentId(0) {}
+      KeepAliveManager();
       virtual ~KeepAliveManager() {}
       void setDialogUsageManager(DialogUsageManager* dum) { mDum = dum; }
       virtual void add(const Tuple& target, int keepAliveInterval, bool targetSupportsOutbound);
       virtual void remove(const Tuple& target);
+      // Called for the wheel's tick timer
       virtual void process(KeepAliveTimeout& timeout);
+      // No longer posted by KeepAliveManager, pong timeouts are on the wheel
       virtual void process(KeepAlivePongTimeout& timeout);
       virtual void receivedPong(const Tuple& flow);
 
    protected:
+      struct WheelEntry
+      {
+         Tuple target;
+         int id;
+         UInt64 dueTick;
+         bool pongTimeout;   // otherwise a keepalive is due
+      };
+      typedef std::vector<WheelEntry> WheelSlot;
+      static const unsigned int WheelSize = 512;
+
+      void scheduleKeepAlive(const Tuple& target, const NetworkAssociationInfo& info);
+      void schedule(const Tuple& target, int id, UInt64 delayMs, bool pongTimeout);
+      void startTicking();
+      void postTick();
+      void processTick(std::vector<Tuple>& keepAlives);
+
       DialogUsageManager* mDum;
       NetworkAssociationMap mNetworkAssociations;
       unsigned int mCurrentId;
+
+      std::vector<WheelSlot> mWheel;
+      UInt64 mWheelStartMs;
+      UInt64 mCurrentTick;    // last tick processed
+      bool mTicking;
+      int mTickSeq;           // identifies the live tick timer
 };
 
 }
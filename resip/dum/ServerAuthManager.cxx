@@ -1,6 +1,7 @@
 #include "rutil/ResipAssert.h"
 
 #include "resip/dum/ChallengeInfo.hxx"
+#include "resip/dum/DumCommand.hxx"
 #include "resip/dum/DumFeature.hxx"
 #include "resip/dum/DumFeatureChain.hxx"
 #include "resip/dum/ServerAuthManager.hxx"
@@ -9,6 +10,7 @@
 #include "rutil/Logger.hxx"
 #include "resip/dum/UserAuthInfo.hxx"
 #include "resip/stack/Helper.hxx"
+#include "rutil/Random.hxx"
 #include "rutil/WinLeakCheck.hxx"
 
 #include <utility>
@@ -18,17 +20,41 @@
 using namespace resip;
 using namespace std;
 
+class ServerAuthManager::FlushLookupsCommand : public DumCommandAdapter
+{
+   public:
+      FlushLookupsCommand(ServerAuthManager& manager) : mManager(manager) {}
+
+      void executeCommand() override
+      {
+         mManager.flushLookups();
+      }
+
+      EncodeStream& encodeBrief(EncodeStream& strm) const override
+      {
+         return strm << "ServerAuthManager::FlushLookupsCommand";
+      }
+
+   private:
+      ServerAuthManager& mManager;
+};
+
 ServerAuthManager::ServerAuthManager(DialogUsageManager& dum, TargetCommand::Target& target, bool challengeThirdParties, const Data& staticRealm) :
    DumFeature(dum, target),
    mChallengeThirdParties(challengeThirdParties),
-   mStaticRealm(staticRealm)
+   mStaticRealm(staticRealm),
+   mFlushPosted(false),
+   mShareLookups(false),
+   mBatchSize(1),
+   mMaxOutstandingLookups(0)
 {
 }
 
 
 ServerAuthManager::~ServerAuthManager()
 {
-   InfoLog(<< "~ServerAuthManager:  " << mMessages.size() << " messages in memory when destroying.");
+   InfoLog(<< "~ServerAuthManager:  " << mMessages.size() << " messages in memory when destroying, "
+           << mLookups.size() << " credential lookups outstanding.");
 }
 
 // !bwc! We absolutely, positively, MUST NOT throw here. This is because in
@@ -100,20 +126,22 @@ ServerAuthManager::process(Message* msg)
    if (userAuth)
    {
       //InfoLog(<< "Got UserAuthInfo");
-      UserAuthInfo* userAuth = dynamic_cast<UserAuthInfo*>(msg);
-      if (userAuth)
+      completeLookup(*userAuth);
+      if (mMessages.find(userAuth->getTransactionId()) == mMessages.end())
       {
-         Message* result = handleUserAuthInfo(userAuth);
-         if (result)
-         {
-            postCommand(unique_ptr<Message>(result));
-            return FeatureDoneAndEventDone;
-         }
-         else
-         {
-            InfoLog(<< "ServerAuth rejected request " << *userAuth);
-            return ChainDoneAndEventDone;            
-         }
+         InfoLog(<< "ServerAuth no request waiting for " << *userAuth);
+         return ChainDoneAndEventDone;
+      }
+      Message* result = handleUserAuthInfo(userAuth);
+      if (result)
+      {
+         postCommand(unique_ptr<Message>(result));
+         return FeatureDoneAndEventDone;
+      }
+      else
+      {
+         InfoLog(<< "ServerAuth rejected request " << *userAuth);
+         return ChainDoneAndEventDone;            
       }
    }
    return FeatureDone;   
@@ -364,6 +392,7 @@ ServerAuthManager::handle(SipMessage* sipMsg)
             {
                std::unique_ptr<SipMessage> inviteMsg(it->second);
                mMessages.erase(it);  // Remove the INVITE from the message map and respond to it
+               abandonLookup(sipMsg->getTransactionId());
 
                InfoLog (<< "Received a CANCEL for an INVITE request that we are still waiting on auth "
                         << "info for, responding appropriately, tid=" 
@@ -385,14 +414,12 @@ ServerAuthManager::handle(SipMessage* sipMsg)
       }
       else if(sipMsg->method() != ACK)  // Do not challenge ACKs or CANCELs (picked off above)
       {
-         ParserContainer<Auth>* auths;
          if (proxyAuthenticationMode())
          {
             if(!sipMsg->exists(h_ProxyAuthorizations))
             {
                return issueChallengeIfRequired(sipMsg);
             }
-            auths = &sipMsg->header(h_ProxyAuthorizations);
          }
          else
          {
@@ -400,26 +427,14 @@ ServerAuthManager::handle(SipMessage* sipMsg)
             {
                return issueChallengeIfRequired(sipMsg);
             }
-            auths = &sipMsg->header(h_Authorizations);
          }
  
          try
          {
-            for(Auths::iterator it = auths->begin(); it != auths->end(); it++)
+            const Auth* auth = findMyAuth(*sipMsg);
+            if (auth)
             {
-               if (isMyRealm(it->param(p_realm)))
-               {
-                  InfoLog (<< "Requesting credential for " 
-                           << it->param(p_username) << " @ " << it->param(p_realm));
-               
-                  requestCredential(it->param(p_username),
-                                    it->param(p_realm), 
-                                    *sipMsg,
-                                     *it,
-                                    sipMsg->getTransactionId());
-                  mMessages[sipMsg->getTransactionId()] = sipMsg;
-                  return RequestedCredentials;
-               }
+               return startLookup(sipMsg, auth->param(p_username), auth->param(p_realm));
             }
 
             InfoLog (<< "Didn't find matching realm ");
@@ -472,6 +487,218 @@ ServerAuthManager::issueChallenge(SipMessage *sipMsg)
   mDum.send(std::move(challenge));
 }
 
+const Auth*
+ServerAuthManager::findMyAuth(const SipMessage& msg)
+{
+   const Auths& auths = proxyAuthenticationMode() ? msg.const_header(h_ProxyAuthorizations)
+                                                  : msg.const_header(h_Authorizations);
+   for(Auths::const_iterator it = auths.begin(); it != auths.end(); it++)
+   {
+      if (isMyRealm(it->param(p_realm)))
+      {
+         return &(*it);
+      }
+   }
+   return 0;
+}
+
+ServerAuthManager::Result
+ServerAuthManager::startLookup(SipMessage* sipMsg, const Data& user, const Data& realm)
+{
+   const Data& tid = sipMsg->getTransactionId();
+   LookupKey key = mShareLookups ? LookupKey(user, realm) : LookupKey(tid, Data::Empty);
+
+   LookupMap::iterator it = mLookups.find(key);
+   if (it != mLookups.end())
+   {
+      InfoLog (<< "Waiting for outstanding credential lookup for " << user << " @ " << realm);
+      it->second.mWaiting.push_back(tid);
+      mMessages[tid] = sipMsg;
+      return RequestedCredentials;
+   }
+
+   if (mMaxOutstandingLookups && mLookups.size() >= mMaxOutstandingLookups)
+   {
+      WarningLog (<< "Too many credential lookups outstanding (" << mLookups.size()
+                  << "), rejecting request from " << user << " @ " << realm);
+      auto response = std::make_shared<SipMessage>();
+      Helper::makeResponse(*response, *sipMsg, 503);
+      // spread the retries out rather than have every client come back at once
+      response->header(h_RetryAfter).value() = 1 + Random::getRandom() % 5;
+      mDum.send(std::move(response));
+      onAuthFailure(Error, *sipMsg);
+      return Rejected;
+   }
+
+   InfoLog (<< "Requesting credential for " << user << " @ " << realm);
+   mLookups[key].mWaiting.push_back(tid);
+   mLookupTokens[tid] = key;
+   mMessages[tid] = sipMsg;
+   queueLookup(key);
+   return RequestedCredentials;
+}
+
+void
+ServerAuthManager::queueLookup(const LookupKey& key)
+{
+   mQueuedLookups.push_back(key);
+   if (mQueuedLookups.size() >= mBatchSize)
+   {
+      flushLookups();
+   }
+   else if (!mFlushPosted)
+   {
+      // runs after the messages already queued to DUM, so a burst ends up in one batch
+      mFlushPosted = true;
+      mDum.post(new FlushLookupsCommand(*this));
+   }
+}
+
+void
+ServerAuthManager::flushLookups()
+{
+   mFlushPosted = false;
+   if (mQueuedLookups.empty())
+   {
+      return;
+   }
+
+   std::vector<LookupKey> queued;
+   queued.swap(mQueuedLookups);
+
+   std::vector<CredentialRequest> requests;
+   requests.reserve(queued.size());
+   for(std::vector<LookupKey>::const_iterator k = queued.begin(); k != queued.end(); ++k)
+   {
+      LookupMap::iterator it = mLookups.find(*k);
+      if (it == mLookups.end() || it->second.mRequested)
+      {
+         continue;
+      }
+      resip_assert(!it->second.mWaiting.empty());
+      const Data& tid = it->second.mWaiting.front();
+      MessageMap::const_iterator m = mMessages.find(tid);
+      resip_assert(m != mMessages.end());
+      const Auth* auth = findMyAuth(*m->second);
+      resip_assert(auth);
+
+      CredentialRequest request;
+      request.user = auth->param(p_username);
+      request.realm = auth->param(p_realm);
+      request.msg = m->second;
+      request.auth = auth;
+      request.transactionToken = tid;
+      requests.push_back(request);
+      it->second.mRequested = true;
+   }
+
+   if (!requests.empty())
+   {
+      DebugLog (<< "Requesting " << requests.size() << " credentials");
+      requestCredentials(requests);
+   }
+}
+
+void
+ServerAuthManager::requestCredentials(const std::vector<CredentialRequest>& requests)
+{
+   for(std::vector<CredentialRequest>::const_iterator it = requests.begin(); it != requests.end(); ++it)
+   {
+      requestCredential(it->user, it->realm, *it->msg, *it->auth, it->transactionToken);
+   }
+}
+
+void
+ServerAuthManager::completeLookup(const UserAuthInfo& userAuth)
+{
+   std::map<Data, LookupKey>::iterator token = mLookupTokens.find(userAuth.getTransactionId());
+   if (token == mLookupTokens.end())
+   {
+      return;
+   }
+   LookupMap::iterator it = mLookups.find(token->second);
+   mLookupTokens.erase(token);
+   resip_assert(it != mLookups.end());
+
+   std::list<Data> waiting;
+   waiting.swap(it->second.mWaiting);
+   mLookups.erase(it);
+
+   const bool shared = userAuth.getMode() == UserAuthInfo::UserUnknown ||
+                       userAuth.getMode() == UserAuthInfo::RetrievedA1 ||
+                       userAuth.getMode() == UserAuthInfo::Error;
+   for(std::list<Data>::const_iterator tid = waiting.begin(); tid != waiting.end(); ++tid)
+   {
+      if (*tid == userAuth.getTransactionId())
+      {
+         continue;
+      }
+      MessageMap::iterator m = mMessages.find(*tid);
+      if (m == mMessages.end())
+      {
+         continue;
+      }
+      if (shared)
+      {
+         // goes through the feature chain of the waiting request
+         if (userAuth.getMode() == UserAuthInfo::RetrievedA1)
+         {
+            postCommand(unique_ptr<Message>(new UserAuthInfo(userAuth.getUser(), userAuth.getRealm(),
+                                                             userAuth.getA1(), *tid)));
+         }
+         else
+         {
+            postCommand(unique_ptr<Message>(new UserAuthInfo(userAuth.getUser(), userAuth.getRealm(),
+                                                             userAuth.getMode(), *tid)));
+         }
+      }
+      else
+      {
+         // the result only speaks for the digest in one request, look the
+         // others up on their own
+         LookupKey key(*tid, Data::Empty);
+         mLookups[key].mWaiting.push_back(*tid);
+         mLookupTokens[*tid] = key;
+         queueLookup(key);
+      }
+   }
+}
+
+void
+ServerAuthManager::abandonLookup(const Data& tid)
+{
+   std::map<Data, LookupKey>::iterator token = mLookupTokens.find(tid);
+   if (token == mLookupTokens.end())
+   {
+      return;
+   }
+   LookupKey key = token->second;
+   mLookupTokens.erase(token);
+   LookupMap::iterator it = mLookups.find(key);
+   resip_assert(it != mLookups.end());
+
+   Lookup& lookup = it->second;
+   lookup.mWaiting.pop_front();
+   while (!lookup.mWaiting.empty() && mMessages.find(lookup.mWaiting.front()) == mMessages.end())
+   {
+      lookup.mWaiting.pop_front();
+   }
+   if (lookup.mWaiting.empty())
+   {
+      mLookups.erase(it);
+      return;
+   }
+
+   // the result for tid will be dropped with its feature chain, so ask again
+   // on behalf of the next request in line
+   mLookupTokens[lookup.mWaiting.front()] = key;
+   if (lookup.mRequested)
+   {
+      lookup.mRequested = false;
+      queueLookup(key);
+   }
+}
+
 void 
 ServerAuthManager::onAuthSuccess(const SipMessage& msg) 
 {
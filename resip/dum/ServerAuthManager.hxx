@@ -1,7 +1,9 @@
 #if !defined(RESIP_SERVERAUTHMANAGER_HXX)
 #define RESIP_SERVERAUTHMANAGER_HXX
 
+#include <list>
 #include <map>
+#include <vector>
 
 #include "rutil/AsyncBool.hxx"
 #include "resip/stack/Auth.hxx"
@@ -41,7 +43,28 @@ class ServerAuthManager : public DumFeature
 
       // can return Challenged, RequestedCredentials, Rejected, Skipped
       virtual Result handle(SipMessage* sipMsg);
-      
+
+      // When enabled, requests that arrive while a credential lookup for the
+      // same user and realm is outstanding wait for that lookup instead of
+      // starting their own (eg. the REGISTER, SUBSCRIBE and PUBLISH a phone
+      // sends at boot).  Only UserUnknown, RetrievedA1 and Error results are
+      // shared; the others are verdicts on one request's digest, so waiters
+      // are looked up again on their own.  Disabled by default, since the
+      // credential may depend on more than the user and realm.
+      void setCredentialLookupSharing(bool enable) { mShareLookups = enable; }
+
+      // Up to size lookups are collected and passed to requestCredentials()
+      // together.  A partial batch is flushed once DUM has processed the
+      // messages already queued to it.  The default of 1 requests each
+      // lookup immediately.
+      void setCredentialBatchSize(unsigned int size) { mBatchSize = size; }
+
+      // Requests that would start a lookup while max lookups are outstanding
+      // are rejected with a 503 and a short Retry-After.  Requests joining an
+      // outstanding lookup are not counted.  0 (the default) is unlimited.
+      void setMaxOutstandingCredentialLookups(unsigned int max) { mMaxOutstandingLookups = max; }
+      size_t getOutstandingCredentialLookups() const { return mLookups.size(); }
+
    protected:
 
       enum AuthFailureReason
@@ -58,6 +81,20 @@ class ServerAuthManager : public DumFeature
                                      const SipMessage& msg,
                                      const Auth& auth, // the auth line we have chosen to authenticate against
                                      const Data& transactionToken ) = 0;
+
+      struct CredentialRequest
+      {
+         Data user;
+         Data realm;
+         const SipMessage* msg;  // only valid during requestCredentials()
+         const Auth* auth;       // points into msg
+         Data transactionToken;
+      };
+
+      // batched variant of requestCredential(), should async cause a post of
+      // one UserAuthInfo per request - the default calls requestCredential()
+      // for each of them
+      virtual void requestCredentials(const std::vector<CredentialRequest>& requests);
       
       virtual bool useAuthInt() const;
       virtual bool proxyAuthenticationMode() const;
@@ -96,6 +133,36 @@ class ServerAuthManager : public DumFeature
 
       bool mChallengeThirdParties;
       resip::Data mStaticRealm;
+
+   private:
+      class FlushLookupsCommand;
+
+      // (user, realm), or (transaction id, empty) when lookups are not shared
+      typedef std::pair<Data, Data> LookupKey;
+      struct Lookup
+      {
+         Lookup() : mRequested(false) {}
+         std::list<Data> mWaiting;  // transaction ids, the front one is in the request
+         bool mRequested;
+      };
+      typedef std::map<LookupKey, Lookup> LookupMap;
+
+      Result startLookup(SipMessage* sipMsg, const Data& user, const Data& realm);
+      void queueLookup(const LookupKey& key);
+      void flushLookups();
+      // fans a result out to the other requests waiting on the same lookup
+      void completeLookup(const UserAuthInfo& userAuth);
+      // called when the request a lookup was requested for goes away
+      void abandonLookup(const Data& tid);
+      const Auth* findMyAuth(const SipMessage& msg);
+
+      LookupMap mLookups;
+      std::map<Data, LookupKey> mLookupTokens;  // front transaction id -> lookup
+      std::vector<LookupKey> mQueuedLookups;
+      bool mFlushPosted;
+      bool mShareLookups;
+      unsigned int mBatchSize;
+      unsigned int mMaxOutstandingLookups;
 };
 
  
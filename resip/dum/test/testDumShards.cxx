@@ -0,0 +1,83 @@
+#include <cassert>
+#include <iostream>
+#include <memory>
+
+#include "resip/dum/DialogUsageManager.hxx"
+#include "resip/dum/MasterProfile.hxx"
+#include "resip/stack/Helper.hxx"
+#include "resip/stack/SipMessage.hxx"
+#include "resip/stack/SipStack.hxx"
+#include "rutil/Log.hxx"
+
+using namespace resip;
+using namespace std;
+
+// exposes the TuSelector's view of which shard takes a message
+class ShardedDum : public DialogUsageManager
+{
+   public:
+      ShardedDum(SipStack& stack) : DialogUsageManager(stack) {}
+      using DialogUsageManager::isForMe;
+};
+
+static const unsigned int ShardCount = 4;
+
+int main(int argc, const char* argv[])
+{
+   Log::initialize(Log::Cout, Log::Warning, argv[0]);
+
+   SipStack stack;
+   std::unique_ptr<ShardedDum> shards[ShardCount];
+   for(unsigned int i = 0; i < ShardCount; i++)
+   {
+      shards[i].reset(new ShardedDum(stack));
+      assert(shards[i]->getShardId() == 0);
+      assert(shards[i]->getShardCount() == 1);
+      shards[i]->setShard(i, ShardCount);
+      shards[i]->setMasterProfile(std::make_shared<MasterProfile>());
+      shards[i]->getMasterProfile()->setDefaultFrom(NameAddr("sip:alice@example.com"));
+   }
+
+   bool thrown = false;
+   try
+   {
+      shards[0]->setShard(ShardCount, ShardCount);
+   }
+   catch(DialogUsageManager::Exception&)
+   {
+      thrown = true;
+   }
+   assert(thrown);
+   assert(shards[0]->getShardId() == 0);
+
+   assert(DialogUsageManager::shardForCallId("anything", 1) == 0);
+
+   // Every shard takes exactly the requests whose Call-ID hashes to it
+   for(int n = 0; n < 1000; n++)
+   {
+      std::unique_ptr<SipMessage> request(Helper::makeRequest(NameAddr("sip:bob@example.com"),
+                                                              NameAddr("sip:alice@example.com"),
+                                                              OPTIONS));
+      const Data& callId = request->header(h_CallId).value();
+      const unsigned int owner = DialogUsageManager::shardForCallId(callId, ShardCount);
+      for(unsigned int i = 0; i < ShardCount; i++)
+      {
+         assert(shards[i]->isForMe(*request) == (i == owner));
+      }
+   }
+
+   // Requests a shard creates come back to the same shard
+   for(unsigned int i = 0; i < ShardCount; i++)
+   {
+      for(int n = 0; n < 100; n++)
+      {
+         assert(DialogUsageManager::shardForCallId(shards[i]->makeCallId(), ShardCount) == i);
+         std::shared_ptr<SipMessage> request = shards[i]->makeOutOfDialogRequest(NameAddr("sip:bob@example.com"), OPTIONS);
+         assert(DialogUsageManager::shardForCallId(request->header(h_CallId).value(), ShardCount) == i);
+         assert(shards[i]->isForMe(*request));
+      }
+   }
+
+   cout << "testDumShards succeeded" << endl;
+   return 0;
+}
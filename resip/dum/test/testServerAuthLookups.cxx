@@ -0,0 +1,150 @@
+#include <cassert>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+#include "resip/dum/DialogUsageManager.hxx"
+#include "resip/dum/MasterProfile.hxx"
+#include "resip/dum/ServerAuthManager.hxx"
+#include "resip/dum/UserAuthInfo.hxx"
+#include "resip/stack/Helper.hxx"
+#include "resip/stack/SipMessage.hxx"
+#include "resip/stack/SipStack.hxx"
+#include "rutil/Log.hxx"
+
+using namespace resip;
+using namespace std;
+
+// records the lookups instead of answering them
+class TestAuthManager : public ServerAuthManager
+{
+   public:
+      TestAuthManager(DialogUsageManager& dum) :
+         ServerAuthManager(dum, dum.dumIncomingTarget()),
+         mBatches(0)
+      {
+      }
+
+      void requestCredential(const Data& user,
+                             const Data& realm,
+                             const SipMessage& msg,
+                             const Auth& auth,
+                             const Data& transactionToken) override
+      {
+         mTokens.push_back(transactionToken);
+      }
+
+      void requestCredentials(const std::vector<CredentialRequest>& requests) override
+      {
+         mBatches++;
+         ServerAuthManager::requestCredentials(requests);
+      }
+
+      std::vector<Data> mTokens;
+      int mBatches;
+};
+
+static SipMessage*
+makeRequest(DialogUsageManager& dum, MethodTypes method, const Data& user)
+{
+   SipMessage* request = Helper::makeRequest(NameAddr("sip:registrar@example.com"),
+                                             NameAddr("sip:" + user + "@example.com"),
+                                             method);
+   Auth auth;
+   auth.scheme() = "Digest";
+   auth.param(p_username) = user;
+   auth.param(p_realm) = "example.com";
+   auth.param(p_nonce) = "0";
+   auth.param(p_uri) = "sip:registrar@example.com";
+   auth.param(p_response) = "0";
+   request->header(h_ProxyAuthorizations).push_back(auth);
+   return request;
+}
+
+// processes msg the way a DumFeatureChain would
+static DumFeature::ProcessingResult
+process(ServerAuthManager& manager, Message* msg)
+{
+   DumFeature::ProcessingResult result = manager.process(msg);
+   if (result & DumFeature::EventDoneBit)
+   {
+      delete msg;
+   }
+   return result;
+}
+
+int main(int argc, const char* argv[])
+{
+   Log::initialize(Log::Cout, Log::Warning, argv[0]);
+
+   SipStack stack;
+   DialogUsageManager dum(stack);
+   dum.setMasterProfile(std::make_shared<MasterProfile>());
+   dum.addDomain("example.com");
+
+   {
+      // without sharing every request has its own lookup
+      TestAuthManager manager(dum);
+      for(int n = 0; n < 3; n++)
+      {
+         assert(process(manager, makeRequest(dum, REGISTER, "alice")) == DumFeature::EventTaken);
+      }
+      assert(manager.mTokens.size() == 3);
+      assert(manager.getOutstandingCredentialLookups() == 3);
+   }
+
+   {
+      TestAuthManager manager(dum);
+      manager.setCredentialLookupSharing(true);
+      manager.setMaxOutstandingCredentialLookups(2);
+
+      // a boot burst from one user needs one lookup
+      SipMessage* reg = makeRequest(dum, REGISTER, "alice");
+      Data regTid = reg->getTransactionId();
+      assert(process(manager, reg) == DumFeature::EventTaken);
+      assert(process(manager, makeRequest(dum, SUBSCRIBE, "alice")) == DumFeature::EventTaken);
+      assert(process(manager, makeRequest(dum, PUBLISH, "alice")) == DumFeature::EventTaken);
+      assert(manager.mTokens.size() == 1);
+      assert(manager.mTokens[0] == regTid);
+      assert(manager.getOutstandingCredentialLookups() == 1);
+
+      assert(process(manager, makeRequest(dum, REGISTER, "bob")) == DumFeature::EventTaken);
+      assert(manager.mTokens.size() == 2);
+
+      // over the limit, rejected without a lookup
+      assert(process(manager, makeRequest(dum, REGISTER, "carol")) == DumFeature::ChainDoneAndEventDone);
+      assert(manager.mTokens.size() == 2);
+      // joining an outstanding lookup is still allowed
+      assert(process(manager, makeRequest(dum, REGISTER, "bob")) == DumFeature::EventTaken);
+      assert(manager.getOutstandingCredentialLookups() == 2);
+
+      // the result completes the lookup for every waiting request
+      assert(process(manager, new UserAuthInfo("alice", "example.com", UserAuthInfo::UserUnknown, regTid))
+             == DumFeature::ChainDoneAndEventDone);
+      assert(manager.getOutstandingCredentialLookups() == 1);
+      assert(process(manager, makeRequest(dum, REGISTER, "carol")) == DumFeature::EventTaken);
+      assert(manager.mTokens.size() == 3);
+
+      // a result for a single digest sends the other waiters to the store again
+      Data bobTid = manager.mTokens[1];
+      assert(process(manager, new UserAuthInfo("bob", "example.com", UserAuthInfo::DigestNotAccepted, bobTid))
+             == DumFeature::ChainDoneAndEventDone);
+      assert(manager.mTokens.size() == 4);
+      assert(manager.mTokens[3] != bobTid);
+   }
+
+   {
+      // lookups are batched until DUM gets to the posted flush
+      TestAuthManager manager(dum);
+      manager.setCredentialBatchSize(3);
+      assert(process(manager, makeRequest(dum, REGISTER, "alice")) == DumFeature::EventTaken);
+      assert(process(manager, makeRequest(dum, REGISTER, "bob")) == DumFeature::EventTaken);
+      assert(manager.mTokens.empty());
+      assert(process(manager, makeRequest(dum, REGISTER, "carol")) == DumFeature::EventTaken);
+      assert(manager.mBatches == 1);
+      assert(manager.mTokens.size() == 3);
+   }
+
+   cout << "testServerAuthLookups succeeded" << endl;
+   return 0;
+}
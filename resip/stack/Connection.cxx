@@ -69,6 +69,15 @@ Connection::~Connection()
 void
 Connection::requestWrite(SendData* sendData)
 {
+   if (queuedBytesMax && mQueuedBytes > queuedBytesMax &&
+       sendData->command == SendData::NoCommand)
+   {
+      WarningLog(<< "Dropping send on " << *this << ", " << mQueuedBytes << " bytes already queued");
+      mTransport->fail(sendData->transactionId, TransportFailure::Failure);
+      delete sendData;
+      return;
+   }
+   mQueuedBytes += sendData->data.size();
    mOutstandingSends.push_back(sendData);
    if (isWritable())
    {
@@ -79,6 +88,7 @@ Connection::requestWrite(SendData* sendData)
 void 
 Connection::removeFrontOutstandingSend()
 {
+   mQueuedBytes -= resipMin(mQueuedBytes, (size_t)mOutstandingSends.front()->data.size());
    delete mOutstandingSends.front();
    mOutstandingSends.pop_front();
 
@@ -211,6 +221,7 @@ Connection::performWrite()
       }
 
       memcpy(uBuffer, dataRaw.data(), dataRaw.size());
+      mQueuedBytes += dataWs->data.size() - dataRaw.size();
       mOutstandingSends.front() = dataWs;
       dataWs = 0;
       delete oldSd;
@@ -237,6 +248,8 @@ Connection::performWrite()
                                      oldSd->transactionId,
                                      oldSd->sigcompId,
                                      true);
+      mQueuedBytes -= resipMin(mQueuedBytes, (size_t)uncompressed.size());
+      mQueuedBytes += newSd->data.size();
       mOutstandingSends.front() = newSd;
       delete oldSd;
       delete sm;
@@ -249,7 +262,7 @@ Connection::performWrite()
       mFirstWriteAfterConnectedPending = false;  // reset
 
       // Notify all outstanding sends that we are now connected - stops the TCP Connection timer for all transactions
-      for (std::list<SendData*>::iterator it = mOutstandingSends.begin(); it != mOutstandingSends.end(); it++)
+      for (std::deque<SendData*>::iterator it = mOutstandingSends.begin(); it != mOutstandingSends.end(); it++)
       {
          mTransport->setTcpConnectState((*it)->transactionId, TcpConnectState::Connected);
       }
@@ -259,6 +272,16 @@ Connection::performWrite()
       }
    }
 
+   if (mSendingTransmissionFormat == Uncompressed)
+   {
+      int nBytes = writeQueued();
+      if (nBytes < 0)
+      {
+         InfoLog(<< "Write failed on socket: " << this->getSocket() << ", closing connection");
+      }
+      return nBytes;
+   }
+
    const Data& data = mOutstandingSends.front()->data;
    int nBytes = write(data.data() + mSendPos,int(data.size() - mSendPos));
 
@@ -291,6 +314,78 @@ Connection::performWrite()
 }
 
 
+int
+Connection::writeQueued()
+{
+   // plain SIP needs no per message framing, so everything queued up to the
+   // next command can go out in one write
+   WriteBuffer buffers[MaxWriteBatchBuffers];
+   int count = 0;
+   size_t total = 0;
+   for (std::deque<SendData*>::const_iterator it = mOutstandingSends.begin();
+        it != mOutstandingSends.end() && count < MaxWriteBatchBuffers; ++it)
+   {
+      if ((*it)->command != SendData::NoCommand)
+      {
+         break;
+      }
+      const Data& data = (*it)->data;
+      const Data::size_type offset = count ? 0 : mSendPos;
+      const size_t size = data.size() - offset;
+      if (count && total + size > MaxWriteBatchBytes)
+      {
+         break;
+      }
+      buffers[count].data = data.data() + offset;
+      buffers[count].size = int(size);
+      total += size;
+      count++;
+   }
+   resip_assert(count > 0);
+
+   int nBytes = writeBuffers(buffers, count);
+   if (nBytes <= 0)
+   {
+      return nBytes;
+   }
+
+   size_t written = nBytes;
+   while (written > 0)
+   {
+      const size_t remaining = mOutstandingSends.front()->data.size() - mSendPos;
+      if (written < remaining)
+      {
+         mSendPos += written;
+         break;
+      }
+      written -= remaining;
+      mSendPos = 0;
+      removeFrontOutstandingSend();
+   }
+   return nBytes;
+}
+
+int
+Connection::writeBuffers(const WriteBuffer* buffers, int count)
+{
+   int total = 0;
+   for (int i = 0; i < count; i++)
+   {
+      int nBytes = write(buffers[i].data, buffers[i].size);
+      if (nBytes < 0)
+      {
+         // report what did go out, the error will come back on the next write
+         return total ? total : nBytes;
+      }
+      total += nBytes;
+      if (nBytes < buffers[i].size)
+      {
+         break;
+      }
+   }
+   return total;
+}
+
 bool 
 Connection::performWrites(unsigned int max)
 {
@@ -346,6 +441,8 @@ Connection::read()
    int bytesRead = read(writePair.first, (int)bytesToRead);
    if (bytesRead <= 0)
    {
+      // eg. TLS handshake or a partial record, nothing to keep a buffer for
+      releaseIdleBuffer();
       return bytesRead;
    }  
    // mBuffer might have been reallocated inside read()
@@ -414,9 +511,22 @@ Connection::read()
          }
       }
    }
+   releaseIdleBuffer();
    return bytesRead;
 }
 
+char*
+Connection::allocateReadBuffer()
+{
+   return getConnectionManager().borrowReadBuffer();
+}
+
+void
+Connection::freeReadBuffer(char* buffer, size_t size)
+{
+   getConnectionManager().returnReadBuffer(buffer, size);
+}
+
 bool 
 Connection::performReads(unsigned int max)
 {
@@ -66,9 +66,13 @@ class Connection : public ConnectionBase,
       /// queue data to write and add this to writable list
       void requestWrite(SendData* sendData);
 
-      /// send some or all of a queued data; remove from writable if completely written
+      /** send some or all of the queued data; remove from writable if
+          completely written.  Queued messages are written together, up to
+          MaxWriteBatchBytes and MaxWriteBatchBuffers at a time */
       int performWrite();
 
+      enum { MaxWriteBatchBytes = 65536, MaxWriteBatchBuffers = 64 };
+
       /** Call performWrite() repeatedly, until either the send queue is 
             exhausted, the write() call fails (probably because the fd is no 
             longer ready to write), or a set number of writes has been 
@@ -109,8 +113,20 @@ class Connection : public ConnectionBase,
       virtual int read(char* /* buffer */, const int /* count */) { return 0; }
       /// pure virtual, but need concrete Connection for book-ends of lists
       virtual int write(const char* /* buffer */, const int /* count */) { return 0; }
+
+      struct WriteBuffer
+      {
+         const char* data;
+         int size;
+      };
+      /// writes count (at most MaxWriteBatchBuffers) buffers in order, returns
+      /// the bytes written like write(); the default writes one at a time.
+      /// Every batch goes through here, including one of a single buffer.
+      virtual int writeBuffers(const WriteBuffer* buffers, int count);
       virtual void onDoubleCRLF();
       virtual void onSingleCRLF();
+      virtual char* allocateReadBuffer();
+      virtual void freeReadBuffer(char* buffer, size_t size);
 
       /* callback method of FdPollItemIf */
       virtual void processPollEvent(FdPollEventMask mask);
@@ -120,6 +136,7 @@ class Connection : public ConnectionBase,
    private:
       ConnectionManager& getConnectionManager() const;
       void removeFrontOutstandingSend();
+      int writeQueued();
       bool mInWritable;
       bool mFlowTimerEnabled;
       FdPollItemHandle mPollItemHandle;
@@ -46,8 +46,12 @@ ConnectionBase::connectionStates[ConnectionBase::MAX][32] = { "NewMessage", "Rea
 size_t
 ConnectionBase::messageSizeMax = RESIP_SIP_MSG_MAX_BYTES;
 
+size_t
+ConnectionBase::queuedBytesMax = 0;
+
 ConnectionBase::ConnectionBase(Transport* transport, const Tuple& who, Compression &compression)
    : mSendPos(0),
+     mQueuedBytes(0),
      mTransport(transport),
      mWho(who),
      mFailureReason(TransportFailure::None),
@@ -65,7 +69,9 @@ ConnectionBase::ConnectionBase(Transport* transport, const Tuple& who, Compressi
      mBufferSize(0),
      mWsFrameExtractor(messageSizeMax),
      mLastUsed(Timer::getTimeMs()),
-     mConnState(NewMessage)
+     mConnState(NewMessage),
+     mSourceCounted(false),
+     mDropWhenComplete(false)
 {
    DebugLog (<< "ConnectionBase::ConnectionBase, who: " << mWho << " " << this);
 #ifdef USE_SIGCOMP
@@ -153,7 +159,7 @@ ConnectionBase::preparseNewBytes(int bytesRead)
             }
             else
             {
-               delete [] mBuffer;
+               freeReadBuffer(mBuffer, mBufferSize);
                mBuffer = 0;
                return true;
             }
@@ -170,13 +176,36 @@ ConnectionBase::preparseNewBytes(int bytesRead)
             }
             else
             {
-               delete [] mBuffer;
+               freeReadBuffer(mBuffer, mBufferSize);
                mBuffer = 0;
                return true;
             }
          }
 
          resip_assert(mTransport);
+
+         size_t shed = bytesRead;
+         mSourceCounted = false;
+         mDropWhenComplete = false;
+         if (mTransport->shedIncoming(mBuffer + mBufferPos, shed, mWho, true,
+                                      getRejectionBehaviorForIncoming(),
+                                      &mSourceCounted))
+         {
+            bytesRead -= (int)shed;
+            if (bytesRead)
+            {
+               memmove(mBuffer, mBuffer + mBufferPos + shed, bytesRead);
+               mBufferPos = 0;
+               goto start;
+            }
+            else
+            {
+               freeReadBuffer(mBuffer, mBufferSize);
+               mBuffer = 0;
+               return true;
+            }
+         }
+
          mMessage = new SipMessage(&mTransport->getTuple());
          
          DebugLog(<< "ConnectionBase::process setting source " << mWho);
@@ -355,6 +384,15 @@ ConnectionBase::preparseNewBytes(int bytesRead)
                return false;
             }
 
+            if (!mSourceCounted)
+            {
+               // it did not fit in the first read; count it now that its
+               // start line has been scanned
+               mSourceCounted = true;
+               mDropWhenComplete = mTransport->limitIncoming(mWho, mMessage->isRequest() ?
+                                                             mMessage->method() : RESPONSE);
+            }
+
             if (numUnprocessedChars < contentLength)
             {
                // The message body is incomplete.
@@ -403,8 +441,13 @@ ConnectionBase::preparseNewBytes(int bytesRead)
 
                // The message body is complete.
                mMessage->setBody(unprocessedCharPtr, (UInt32)contentLength);
-               CongestionManager::RejectionBehavior b=mTransport->getRejectionBehaviorForIncoming();
-               if (b==CongestionManager::REJECTING_NON_ESSENTIAL
+               CongestionManager::RejectionBehavior b=getRejectionBehaviorForIncoming();
+               if (mDropWhenComplete)
+               {
+                  delete mMessage; // over its source's rate
+                  mMessage = 0;
+               }
+               else if (b==CongestionManager::REJECTING_NON_ESSENTIAL
                      || (b==CongestionManager::REJECTING_NEW_WORK
                         && mMessage->isRequest()))
                {
@@ -502,8 +545,13 @@ ConnectionBase::preparseNewBytes(int bytesRead)
 
             // .bwc. basicCheck takes up substantial CPU. Don't bother doing it
             // if we're overloaded.
-            CongestionManager::RejectionBehavior b=mTransport->getRejectionBehaviorForIncoming();
-            if (b==CongestionManager::REJECTING_NON_ESSENTIAL
+            CongestionManager::RejectionBehavior b=getRejectionBehaviorForIncoming();
+            if (mDropWhenComplete)
+            {
+               delete mMessage; // over its source's rate
+               mMessage = 0;
+            }
+            else if (b==CongestionManager::REJECTING_NON_ESSENTIAL
                   || (b==CongestionManager::REJECTING_NEW_WORK
                      && mMessage->isRequest()))
             {
@@ -704,6 +752,7 @@ ConnectionBase::wsProcessHandshake(int bytesRead, bool &dropConnection)
                   Data::Empty,
                   Data::Empty,
                   true));
+         mQueuedBytes += wsResponsePtr->size();
       }
       else
       {
@@ -805,20 +854,23 @@ bool
 ConnectionBase::wsProcessData(int bytesRead)
 {
    bool dropConnection = false;
-   // Always consumes the whole buffer:
-   std::unique_ptr<Data> msg = mWsFrameExtractor.processBytes((UInt8*)mBuffer, bytesRead, dropConnection);
+   Data::size_type msg_len = 0;
+   // Consumes the whole buffer, one message at a time; mBuffer must not be
+   // touched until processBytes() returns 0
+   char *sipBuffer = mWsFrameExtractor.processBytes((UInt8*)mBuffer, bytesRead, msg_len, dropConnection);
 
-   while(msg.get())
+   while(sipBuffer)
    {
-      // mWsBuffer should now contain a discrete SIP message, let the
+      // sipBuffer should now contain a discrete SIP message, let the
       // stack go to work on it
 
-      if(msg->size() == 4 && memcmp(msg->data(), "\r\n\r\n", 4) == 0)
+      if(msg_len == 4 && memcmp(sipBuffer, "\r\n\r\n", 4) == 0)
       {
          // sending a keep alive reply now
          StackLog(<<"got a SIP ping embedded in WebSocket frame, replying");
          onDoubleCRLF();
-         msg = mWsFrameExtractor.processBytes(0, 0, dropConnection);
+         delete [] sipBuffer;
+         sipBuffer = mWsFrameExtractor.processBytes(0, 0, msg_len, dropConnection);
          continue;
       }
 
@@ -846,9 +898,8 @@ ConnectionBase::wsProcessData(int bytesRead)
          mMessage->setWsCookieContext(wsConnectionBase->getWsCookieContext());
       }
 
-      Data::size_type msg_len = msg->size();
-      // cast permitted, as it is borrowed:
-      char *sipBuffer = (char *)msg->data();
+      // the buffer was allocated by MsgHeaderScanner::allocateBuffer, and
+      // now belongs to the SipMessage
       mMessage->addBuffer(sipBuffer);
       mMsgHeaderScanner.prepareForMessage(mMessage);
       char *unprocessedCharPtr;
@@ -887,7 +938,7 @@ ConnectionBase::wsProcessData(int bytesRead)
          // Something wrong...
          ErrLog(<< "We don't have a valid SIP message, maybe drop the connection?");
       }
-      msg = mWsFrameExtractor.processBytes(0, 0, dropConnection);
+      sipBuffer = mWsFrameExtractor.processBytes(0, 0, msg_len, dropConnection);
    }
 
    if(dropConnection)
@@ -1027,6 +1078,7 @@ ConnectionBase::decompressNewBytes(int bytesRead)
                    Data::Empty,
                    Data::Empty,
                    true));
+      mQueuedBytes += nack->getStreamLength();
     }
     else
     {
@@ -1041,18 +1093,61 @@ ConnectionBase::getWriteBuffer()
 {
    if (mConnState == NewMessage)
    {
-      if (!mBuffer)
-      {
-         DebugLog (<< "Creating buffer for " << *this);
-
-         mBuffer = MsgHeaderScanner::allocateBuffer(ConnectionBase::ChunkSize);
-         mBufferSize = ConnectionBase::ChunkSize;
-      }
       mBufferPos = 0;
    }
+   if (!mBuffer)
+   {
+      // only released when nothing was buffered, see releaseIdleBuffer()
+      resip_assert(mBufferPos == 0);
+      DebugLog (<< "Creating buffer for " << *this);
+
+      mBuffer = allocateReadBuffer();
+      mBufferSize = ConnectionBase::ChunkSize;
+   }
    return getCurrentWriteBuffer();
 }
 
+CongestionManager::RejectionBehavior
+ConnectionBase::getRejectionBehaviorForIncoming() const
+{
+   CongestionManager::RejectionBehavior b = mTransport->getRejectionBehaviorForIncoming();
+   if (b == CongestionManager::NORMAL && queuedBytesMax && mQueuedBytes > queuedBytesMax)
+   {
+      // the peer is not reading what we send it, so nothing we could answer
+      // new requests with would get through
+      return CongestionManager::REJECTING_NEW_WORK;
+   }
+   return b;
+}
+
+void
+ConnectionBase::releaseIdleBuffer()
+{
+   // In NewMessage everything read has been handed to a SipMessage or
+   // dropped.  WebSocket frames are copied out by mWsFrameExtractor, so once
+   // the handshake is done the buffer never holds anything between reads.
+   if (mBuffer && mBufferPos == 0 &&
+       (mConnState == NewMessage ||
+        (mConnState == WebSocket && mReceivingTransmissionFormat == WebSocketData)))
+   {
+      freeReadBuffer(mBuffer, mBufferSize);
+      mBuffer = 0;
+      mBufferSize = 0;
+   }
+}
+
+char*
+ConnectionBase::allocateReadBuffer()
+{
+   return MsgHeaderScanner::allocateBuffer(ConnectionBase::ChunkSize);
+}
+
+void
+ConnectionBase::freeReadBuffer(char* buffer, size_t size)
+{
+   delete [] buffer;
+}
+
 std::pair<char*, size_t> 
 ConnectionBase::getCurrentWriteBuffer()
 {
@@ -55,6 +55,9 @@ class ConnectionBase
          //      also good for the larger SDP coming in with ICE attributes,
          //      multiple media streams, etc
 
+      /// bytes held for reading, 0 unless part of a message is buffered
+      size_t getReadBufferSize() const { return mBuffer ? mBufferSize : 0; }
+
    protected:
       enum ConnState
       {
@@ -88,8 +91,19 @@ class ConnectionBase
       // for avoiding copies in external transports--not used in core resip
       void setBuffer(char* bytes, int count);
 
+      /// gives the read buffer back if it holds nothing of a message, so
+      /// idle connections do not keep one; call after the bytes read have
+      /// been processed
+      void releaseIdleBuffer();
+      /// read buffers are ChunkSize bytes, allocated with
+      /// MsgHeaderScanner::allocateBuffer(); size is the buffer's current
+      /// size, which may have grown since it was allocated
+      virtual char* allocateReadBuffer();
+      virtual void freeReadBuffer(char* buffer, size_t size);
+
       Data::size_type mSendPos;
-      std::list<SendData*> mOutstandingSends; // !jacob! intrusive queue?
+      std::deque<SendData*> mOutstandingSends;
+      size_t mQueuedBytes;  // size of the data in mOutstandingSends
 
       void setFailureReason(TransportFailure::FailureReason failReason, int subCode);
 
@@ -103,6 +117,7 @@ class ConnectionBase
       std::unique_ptr<Data> makeWsHandshakeResponse();
       bool isUsingSecWebSocketKey();
       bool isUsingDeprecatedSecWebSocketKeys();
+      CongestionManager::RejectionBehavior getRejectionBehaviorForIncoming() const;
    protected:
       virtual void onDoubleCRLF(){}
       virtual void onSingleCRLF(){}
@@ -127,12 +142,24 @@ class ConnectionBase
       UInt64 mLastUsed;
       ConnState mConnState;
       MsgHeaderScanner mMsgHeaderScanner;
+      // whether the SourceRateLimiter has seen the message being read, and
+      // whether it refused it (it is read through, then dropped)
+      bool mSourceCounted;
+      bool mDropWhenComplete;
 
       static size_t messageSizeMax;
 
+   protected:
+      static size_t queuedBytesMax;
+
    public:
       static void setMessageSizeMax(size_t max)
          { messageSizeMax = max; };
+      /// Once a connection has more than max bytes waiting to be written,
+      /// further sends on it fail and requests read from it are rejected
+      /// as if the stack were congested.  0 (the default) is unlimited.
+      static void setQueuedBytesMax(size_t max)
+         { queuedBytesMax = max; };
 };
 
 EncodeStream& 
@@ -41,6 +41,35 @@ ConnectionManager::~ConnectionManager()
    resip_assert(mWriteHead->empty());
    resip_assert(mLRUHead->empty());
    resip_assert(mFlowTimerLRUHead->empty());
+   for (std::vector<char*>::iterator it = mReadBuffers.begin(); it != mReadBuffers.end(); ++it)
+   {
+      delete [] *it;
+   }
+}
+
+char*
+ConnectionManager::borrowReadBuffer()
+{
+   if (mReadBuffers.empty())
+   {
+      return MsgHeaderScanner::allocateBuffer(Connection::ChunkSize);
+   }
+   char* buffer = mReadBuffers.back();
+   mReadBuffers.pop_back();
+   return buffer;
+}
+
+void
+ConnectionManager::returnReadBuffer(char* buffer, size_t size)
+{
+   if (size == Connection::ChunkSize && mReadBuffers.size() < MaxPooledReadBuffers)
+   {
+      mReadBuffers.push_back(buffer);
+   }
+   else
+   {
+      delete [] buffer;
+   }
 }
 
 void 
@@ -2,6 +2,7 @@
 #define RESIP_ConnectionMgr_hxx 
 
 #include <map>
+#include <vector>
 #include "rutil/HashMap.hxx"
 #include "resip/stack/Connection.hxx"
 
@@ -68,6 +69,11 @@ class ConnectionManager
       /// move to youngest 
       void touch(Connection* connection);
       void moveToFlowTimerLru(Connection *connection);
+
+      /// read buffers are lent to connections only while they are reading;
+      /// a buffer handed on to a SipMessage is not returned
+      char* borrowReadBuffer();
+      void returnReadBuffer(char* buffer, size_t size);
       
       AddrMap mAddrMap;
       IdMap mIdMap;
@@ -86,6 +92,10 @@ class ConnectionManager
 
       /// collection for epoll
       FdPollGrp* mPollGrp;
+
+      /// ChunkSize buffers ready to lend, at most MaxPooledReadBuffers
+      std::vector<char*> mReadBuffers;
+      static const size_t MaxPooledReadBuffers = 64;
       //<<---------------------------------
 
       friend class TcpBaseTransport;
@@ -40,10 +40,18 @@ DnsInterface::DnsInterface(DnsStub& dnsStub, bool useDnsVip) :
    {
       mDnsStub.setResultTransform(&mVip);
    }
+   mDnsStub.addTimerHandler(this);
 }
 
 DnsInterface::~DnsInterface()
 {
+   mDnsStub.removeTimerHandler(this);
+}
+
+void
+DnsInterface::onDnsTimer(UInt64 now)
+{
+   mMarkManager.expire(now);
 }
 
 void 
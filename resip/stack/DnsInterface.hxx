@@ -21,7 +21,7 @@ class Uri;
 class Via;
 class DnsRawSink;
 
-class DnsInterface
+class DnsInterface : public DnsStub::TimerHandler
 {
    public:
       class Exception final : public BaseException
@@ -74,6 +74,9 @@ class DnsInterface
 
       TupleMarkManager& getMarkManager(){return mMarkManager;}
 
+      // sweeps expired marks out of the TupleMarkManager
+      virtual void onDnsTimer(UInt64 now);
+
       bool setUdpOnlyOnNumeric(bool value)
       {
          mUdpOnlyOnNumeric = value;
@@ -14,7 +14,8 @@
 using namespace resip;
 
 ExtensionHeader::ExtensionHeader(const char* name)
-   : mName(name)
+   : mName(name),
+     mHash(Data::rawCaseInsensitiveTokenHash((const unsigned char*)mName.data(), mName.size()))
 {
    resip_assert(name);
    if (mName.empty())
@@ -28,7 +29,8 @@ ExtensionHeader::ExtensionHeader(const char* name)
 }
 
 ExtensionHeader::ExtensionHeader(const Data& name)
-   : mName(name)
+   : mName(name),
+     mHash(Data::rawCaseInsensitiveTokenHash((const unsigned char*)mName.data(), mName.size()))
 {
    if (mName.empty())
    {
@@ -13,6 +13,9 @@ class ExtensionHeader
       explicit ExtensionHeader(const Data& unknownHeaderName);
 
       const Data& getName() const;
+      // case insensitive hash of the name, used to find the header in a
+      // SipMessage with many unknown headers
+      size_t getHash() const { return mHash; }
 
       class Exception final : public BaseException
       {
@@ -23,6 +26,7 @@ class ExtensionHeader
 
    private:
       const Data mName;
+      const size_t mHash;
 };
 
 }
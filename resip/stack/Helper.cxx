@@ -485,6 +485,18 @@ Helper::makeResponse(const SipMessage& request,
    return response.release();
 }
 
+// Headers copied from the request into a raw response, in order.
+static const Headers::Type RawResponseHeaders[] =
+{
+   Headers::Via,
+   Headers::To,
+   Headers::From,
+   Headers::CallID,
+   Headers::CSeq
+};
+
+static const size_t NumRawResponseHeaders = sizeof(RawResponseHeaders)/sizeof(RawResponseHeaders[0]);
+
 void
 Helper::makeRawResponse(Data& raw,
                         const SipMessage& msg, 
@@ -492,21 +504,72 @@ Helper::makeRawResponse(Data& raw,
                         const Data& additionalHeaders,
                         const Data& body)
 {
-   raw.reserve(256);
+   Data reason;
+   getResponseCodeReason(responseCode, reason);
+
+   // Size the buffer up front; unparsed values are copied as they are, and
+   // 128 bytes covers a parsed one (usually the top Via, which has been
+   // stamped with received= and rport).
+   size_t size = 48 + reason.size() + additionalHeaders.size() + body.size();
+   bool parsed = false;
+   for (size_t i = 0; i < NumRawResponseHeaders; ++i)
    {
+      const HeaderFieldValueList* hfvs = msg.getRawHeader(RawResponseHeaders[i]);
+      if (hfvs)
+      {
+         const size_t nameSize = Headers::getHeaderName(RawResponseHeaders[i]).size() + 4;
+         for (HeaderFieldValueList::const_iterator j = hfvs->begin(); j != hfvs->end(); ++j)
+         {
+            size += nameSize + (hfvs->getParserContainer() ? 128 : j->getLength());
+         }
+         parsed = parsed || hfvs->getParserContainer();
+      }
+   }
+   raw.reserve(raw.size() + size);
+
+   raw += "SIP/2.0 ";
+   raw += Data(responseCode);
+   raw += Symbols::SPACE;
+   raw += reason;
+   raw += Symbols::CRLF;
+
+   if (parsed)
+   {
+      // Parsed headers may have been modified since they were received, so
+      // they have to be encoded. Setting up the stream is what costs, so
+      // it is done once for all of them.
       DataStream encodeStream(raw);
-      encodeStream << "SIP/2.0 " << responseCode << " ";
-      Data reason;
-      getResponseCodeReason(responseCode, reason);
-      encodeStream << reason;
-      msg.encodeSingleHeader(Headers::Via,encodeStream);
-      msg.encodeSingleHeader(Headers::To,encodeStream);
-      msg.encodeSingleHeader(Headers::From,encodeStream);
-      msg.encodeSingleHeader(Headers::CallID,encodeStream);
-      msg.encodeSingleHeader(Headers::CSeq,encodeStream);
-      encodeStream << additionalHeaders;
-      encodeStream << "Content-Length: " << body.size() << "\r\n\r\n";
+      for (size_t i = 0; i < NumRawResponseHeaders; ++i)
+      {
+         msg.encodeSingleHeader(RawResponseHeaders[i], encodeStream);
+      }
    }
+   else
+   {
+      // still the bytes from the receive buffer
+      for (size_t i = 0; i < NumRawResponseHeaders; ++i)
+      {
+         const HeaderFieldValueList* hfvs = msg.getRawHeader(RawResponseHeaders[i]);
+         if (hfvs)
+         {
+            const Data& name = Headers::getHeaderName(RawResponseHeaders[i]);
+            for (HeaderFieldValueList::const_iterator j = hfvs->begin(); j != hfvs->end(); ++j)
+            {
+               raw += name;
+               raw += Symbols::COLON;
+               raw += Symbols::SPACE;
+               raw.append(j->getBuffer(), j->getLength());
+               raw += Symbols::CRLF;
+            }
+         }
+      }
+   }
+
+   raw += additionalHeaders;
+   raw += "Content-Length: ";
+   raw += Data((UInt64)body.size());
+   raw += Symbols::CRLFCRLF;
+   raw += body;
 }
 
 void   
@@ -1665,6 +1728,10 @@ void
 Helper::massageRoute(const SipMessage& request, NameAddr& rt)
 {
    resip_assert(request.isRequest());
+   // Only touch rt through non-const accessors when something actually 
+   // changes, so that a frozen (pre-encoded) route stays frozen.
+   const NameAddr& constRt = rt;
+   const Data* scheme = 0;
    // .bwc. Let's not record-route with a tel uri or something, shall we?
    // If the topmost route header is malformed, we can get along without.
    if (!request.empty(h_Routes) && 
@@ -1672,15 +1739,23 @@ Helper::massageRoute(const SipMessage& request, NameAddr& rt)
        (request.header(h_Routes).front().uri().scheme() == "sip" ||
         request.header(h_Routes).front().uri().scheme() == "sips" ))
    {
-      rt.uri().scheme() = request.header(h_Routes).front().uri().scheme();
+      scheme = &request.header(h_Routes).front().uri().scheme();
    }
    else if(request.header(h_RequestLine).uri().scheme() == "sip" ||
            request.header(h_RequestLine).uri().scheme() == "sips")
    {
-      rt.uri().scheme() = request.header(h_RequestLine).uri().scheme();
+      scheme = &request.header(h_RequestLine).uri().scheme();
+   }
+
+   if (scheme && constRt.uri().scheme() != *scheme)
+   {
+      rt.uri().scheme() = *scheme;
    }
    
-   rt.uri().param(p_lr);
+   if (!constRt.uri().exists(p_lr))
+   {
+      rt.uri().param(p_lr);
+   }
 }
 
 int
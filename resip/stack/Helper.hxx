@@ -243,6 +243,24 @@ class Helper
                                       const Data& hostname = Data::Empty,
                                       const Data& warning=Data::Empty);
 
+      /**
+          Encodes a response to a provided request straight into rawBuffer,
+          without building a SipMessage. The Via, To, From, Call-ID and CSeq
+          header values that have not been parsed are copied byte-for-byte
+          from the request's receive buffer; parsed ones are re-encoded. No
+          To tag is added, so this is meant for responses the stack sends on
+          its own (100 Trying, 503 when congested).
+
+          @param rawBuffer  Buffer the response is appended to.
+
+          @param request  SipMessage request from which to generate the response
+
+          @param responseCode Response code to use on status line.
+
+          @param additionalHeaders Optional header lines, each ending in CRLF.
+
+          @param body     Optional body.
+      */
       static void makeRawResponse(Data& rawBuffer,
                                     const SipMessage& request, 
                                     int responseCode,
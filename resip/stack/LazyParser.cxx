@@ -9,41 +9,48 @@
 #include "resip/stack/HeaderFieldValue.hxx"
 #include "resip/stack/LazyParser.hxx"
 #include "rutil/ParseBuffer.hxx"
+#include "rutil/DataStream.hxx"
 #include "rutil/WinLeakCheck.hxx"
 
 using namespace resip;
 
 LazyParser::LazyParser(const HeaderFieldValue& headerFieldValue)
    : mHeaderField(headerFieldValue, HeaderFieldValue::NoOwnership),
-      mState(mHeaderField.getBuffer() == 0 ? DIRTY : NOT_PARSED)
+      mState(mHeaderField.getBuffer() == 0 ? DIRTY : NOT_PARSED),
+      mFrozen(false)
 {
 }
 
 LazyParser::LazyParser(const HeaderFieldValue& headerFieldValue,
                         HeaderFieldValue::CopyPaddingEnum e)
    : mHeaderField(headerFieldValue, e), // Causes ownership to be taken. Oh well
-      mState(mHeaderField.getBuffer() == 0 ? DIRTY : NOT_PARSED)
+      mState(mHeaderField.getBuffer() == 0 ? DIRTY : NOT_PARSED),
+      mFrozen(false)
 {}
 
 LazyParser::LazyParser(const char* buf, int length) :
    mHeaderField(buf, length),
-   mState(buf == 0 ? DIRTY : NOT_PARSED)
+   mState(buf == 0 ? DIRTY : NOT_PARSED),
+   mFrozen(false)
 {}
 
 LazyParser::LazyParser()
    : mHeaderField(),
-      mState(DIRTY)
+      mState(DIRTY),
+      mFrozen(false)
 {
 }
 
 LazyParser::LazyParser(const LazyParser& rhs)
    : mHeaderField((rhs.mState==DIRTY ? HeaderFieldValue::Empty : rhs.mHeaderField)), // Pretty cheap when rhs is DIRTY
-      mState(rhs.mState)
+      mState(rhs.mState),
+      mFrozen(rhs.mFrozen)
 {}
 
 LazyParser::LazyParser(const LazyParser& rhs,HeaderFieldValue::CopyPaddingEnum e)
    :  mHeaderField((rhs.mState==DIRTY ? HeaderFieldValue::Empty : rhs.mHeaderField), e), // Pretty cheap when rhs is DIRTY
-      mState(rhs.mState)
+      mState(rhs.mState),
+      mFrozen(rhs.mFrozen)
 {}
 
 
@@ -61,6 +68,7 @@ LazyParser::operator=(const LazyParser& rhs)
    {
       clear();
       mState = rhs.mState;
+      mFrozen = rhs.mFrozen;
       if (rhs.mState!=DIRTY)
       {
          mHeaderField=rhs.mHeaderField;
@@ -101,6 +109,30 @@ LazyParser::clear()
    mHeaderField.clear();
 }
 
+void
+LazyParser::freeze()
+{
+   if (mState == DIRTY)
+   {
+      Data encoded;
+      {
+         DataStream str(encoded);
+         encodeParsed(str);
+      }
+
+      if (!encoded.empty())
+      {
+         char* buffer = new char[encoded.size()];
+         memcpy(buffer, encoded.data(), encoded.size());
+         mHeaderField.init(buffer, encoded.size(), true);
+         // The parsed representation and the buffer now agree, which is 
+         // the same situation as a well-formed element fresh off the wire.
+         mState = WELL_FORMED;
+         mFrozen = true;
+      }
+   }
+}
+
 EncodeStream&
 LazyParser::encode(EncodeStream& str) const
 {
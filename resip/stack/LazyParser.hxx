@@ -111,9 +111,32 @@ class LazyParser
          const LazyParser* constThis = const_cast<const LazyParser*>(this);
          constThis->checkParsed();
          mState=DIRTY;
+         mFrozen=false;
       }
       void doParse() const;
-      inline void markDirty() const {mState=DIRTY;}
+      inline void markDirty() const {mState=DIRTY; mFrozen=false;}
+
+      /**
+         @brief Caches the encoded form of a parsed, modified element so that 
+            subsequent encodes (and copies) write the cached bytes instead of 
+            re-encoding the parsed representation.
+
+         This is intended for long-lived elements that are copied into many 
+         outgoing messages (eg; the Record-Route held by the proxy). The cache 
+         is dropped by the first non-const access, exactly as if the element 
+         had been parsed from the wire. References to sub-elements obtained 
+         before the freeze (eg; NameAddr::uri()) must not be used to modify 
+         the element afterward.
+      */
+      void freeze();
+
+      /**
+         @brief Returns true iff freeze() cached the encoded form and no 
+            non-const access has dropped it since.
+         @note An element parsed from the wire and never modified also encodes 
+            its original bytes, but is not considered frozen.
+      */
+      bool isFrozen() const {return mFrozen;}
       
       /**
          @brief Returns true iff this element was parsed successfully, according
@@ -149,6 +172,7 @@ class LazyParser
          DIRTY // Well-formed, and underlying buffer is invalid
       } ParseState;
       mutable ParseState mState;
+      mutable bool mFrozen;
 };
 
 #ifndef  RESIP_USE_STL_STREAMS
@@ -0,0 +1,531 @@
+#if defined(HAVE_CONFIG_H)
+#include "config.h"
+#endif
+
+#include <string.h>
+
+#include "resip/stack/LoadShedder.hxx"
+#include "rutil/compat.hxx"
+#include "rutil/Logger.hxx"
+#include "rutil/Timer.hxx"
+
+#define RESIPROCATE_SUBSYSTEM Subsystem::TRANSPORT
+
+using namespace resip;
+
+UInt64 LoadShedder::RememberRejectedMs = 32000;
+
+namespace
+{
+
+const size_t RecentlyRejectedSize = 1024;
+const int MaxViaLines = 32;
+
+// A header line, without its line ending.
+struct Line
+{
+   Line() : start(0), end(0) {}
+   const char* start;
+   const char* end;
+};
+
+// What LoadShedder needs from the front of a message.
+struct Peek
+{
+   Peek() : request(false), method(UNKNOWN), vias(0), contentLength(-1), headerLength(0) {}
+
+   bool request;
+   MethodTypes method;
+   Line via[MaxViaLines];
+   int vias;
+   Line to;
+   Line from;
+   Line callId;
+   Line cseq;
+   long contentLength;
+   size_t headerLength;
+};
+
+inline bool
+isWhitespace(char c)
+{
+   return c == ' ' || c == '\t';
+}
+
+inline bool
+nameIs(const char* name, size_t len, const char* full, char compact)
+{
+   if (len == 1)
+   {
+      return (name[0] | 0x20) == compact;
+   }
+   return len == strlen(full) && strncasecmp(name, full, len) == 0;
+}
+
+// Finds the end of the line starting at p; sets next to the start of the
+// following line. Returns 0 if there is no line ending before end.
+const char*
+lineEnd(const char* p, const char* end, const char*& next)
+{
+   const char* lf = static_cast<const char*>(memchr(p, '\n', end - p));
+   if (!lf)
+   {
+      return 0;
+   }
+   next = lf + 1;
+   return (lf > p && lf[-1] == '\r') ? lf - 1 : lf;
+}
+
+const char*
+headerValue(const Line& line)
+{
+   const char* p = static_cast<const char*>(memchr(line.start, ':', line.end - line.start));
+   if (!p)
+   {
+      return line.end;
+   }
+   for (++p; p < line.end && isWhitespace(*p); ++p)
+   {}
+   return p;
+}
+
+// Reads the start line at the front of buffer; sets next to the start of
+// the first header line.
+bool
+peekStartLine(const char* buffer, size_t length, Peek& peek, const char*& next)
+{
+   const char* p = buffer;
+   const char* const end = buffer + length;
+
+   // leading blank lines are allowed, and ignored
+   while (p < end && (*p == '\r' || *p == '\n'))
+   {
+      ++p;
+   }
+
+   const char* eol = lineEnd(p, end, next);
+   if (!eol)
+   {
+      return false;
+   }
+
+   static const char sipVersion[] = "SIP/2.0";
+   const size_t versionLen = sizeof(sipVersion) - 1;
+   if (size_t(eol - p) > versionLen && strncasecmp(p, sipVersion, versionLen) == 0 &&
+       p[versionLen] == ' ')
+   {
+      peek.request = false;
+      peek.method = RESPONSE;
+   }
+   else
+   {
+      const char* sp = static_cast<const char*>(memchr(p, ' ', eol - p));
+      if (!sp || sp == p || size_t(eol - p) < versionLen ||
+          strncasecmp(eol - versionLen, sipVersion, versionLen) != 0)
+      {
+         return false;
+      }
+      peek.request = true;
+      peek.method = getMethodType(p, int(sp - p));
+   }
+   return true;
+}
+
+bool
+peekMessage(const char* buffer, size_t length, Peek& peek)
+{
+   const char* const end = buffer + length;
+   const char* next = 0;
+   if (!peekStartLine(buffer, length, peek, next))
+   {
+      return false;
+   }
+
+   const char* p;
+   const char* eol;
+   Line* last = 0;
+   for (p = next; ; p = next)
+   {
+      eol = lineEnd(p, end, next);
+      if (!eol)
+      {
+         return false;
+      }
+      if (eol == p)
+      {
+         peek.headerLength = next - buffer;
+         return true;
+      }
+
+      if (isWhitespace(*p))
+      {
+         // folded onto the previous header line
+         if (last)
+         {
+            last->end = eol;
+         }
+         continue;
+      }
+
+      last = 0;
+      const char* colon = static_cast<const char*>(memchr(p, ':', eol - p));
+      if (!colon)
+      {
+         return false;
+      }
+      const char* nameEnd = colon;
+      while (nameEnd > p && isWhitespace(nameEnd[-1]))
+      {
+         --nameEnd;
+      }
+      const size_t nameLen = nameEnd - p;
+
+      if (nameIs(p, nameLen, "Via", 'v'))
+      {
+         if (peek.vias == MaxViaLines)
+         {
+            return false;
+         }
+         last = &peek.via[peek.vias++];
+      }
+      else if (nameIs(p, nameLen, "To", 't'))
+      {
+         last = &peek.to;
+      }
+      else if (nameIs(p, nameLen, "From", 'f'))
+      {
+         last = &peek.from;
+      }
+      else if (nameIs(p, nameLen, "Call-ID", 'i'))
+      {
+         last = &peek.callId;
+      }
+      else if (nameLen == 4 && strncasecmp(p, "CSeq", 4) == 0)
+      {
+         last = &peek.cseq;
+      }
+      else if (nameIs(p, nameLen, "Content-Length", 'l'))
+      {
+         const char* v = colon + 1;
+         while (v < eol && isWhitespace(*v))
+         {
+            ++v;
+         }
+         long value = 0;
+         const char* digits = v;
+         for (; v < eol && *v >= '0' && *v <= '9' && v - digits < 9; ++v)
+         {
+            value = value*10 + (*v - '0');
+         }
+         while (v < eol && isWhitespace(*v))
+         {
+            ++v;
+         }
+         if (v == digits || v != eol)
+         {
+            return false;
+         }
+         peek.contentLength = value;
+      }
+
+      if (last)
+      {
+         last->start = p;
+         last->end = eol;
+      }
+   }
+}
+
+// The branch parameter of the first value in a Via line, or an empty range.
+void
+topBranch(const Line& via, const char*& start, const char*& end)
+{
+   start = end = 0;
+   const char* p = headerValue(via);
+   const char* valueEnd = static_cast<const char*>(memchr(p, ',', via.end - p));
+   if (!valueEnd)
+   {
+      valueEnd = via.end;
+   }
+
+   static const char branch[] = "branch";
+   const size_t branchLen = sizeof(branch) - 1;
+   while ((p = static_cast<const char*>(memchr(p, ';', valueEnd - p))) != 0)
+   {
+      for (++p; p < valueEnd && isWhitespace(*p); ++p)
+      {}
+      if (size_t(valueEnd - p) > branchLen && strncasecmp(p, branch, branchLen) == 0)
+      {
+         const char* v = p + branchLen;
+         while (v < valueEnd && isWhitespace(*v))
+         {
+            ++v;
+         }
+         if (v < valueEnd && *v == '=')
+         {
+            for (++v; v < valueEnd && isWhitespace(*v); ++v)
+            {}
+            start = v;
+            while (v < valueEnd && *v != ';' && !isWhitespace(*v))
+            {
+               ++v;
+            }
+            end = v;
+            return;
+         }
+      }
+   }
+}
+
+inline void
+appendLine(Data& data, const Line& line)
+{
+   data.append(line.start, line.end - line.start);
+   data += "\r\n";
+}
+
+}
+
+LoadShedder::Stats::Stats()
+{
+   memset(admitted, 0, sizeof(admitted));
+   memset(rejected, 0, sizeof(rejected));
+   memset(dropped, 0, sizeof(dropped));
+}
+
+LoadShedder::LoadShedder()
+{
+   for (int m = 0; m < MAX_METHODS; ++m)
+   {
+      mAdmitted[m].store(0, std::memory_order_relaxed);
+      mRejected[m].store(0, std::memory_order_relaxed);
+      mDropped[m].store(0, std::memory_order_relaxed);
+   }
+}
+
+void
+LoadShedder::addStats(Stats& stats) const
+{
+   for (int m = 0; m < MAX_METHODS; ++m)
+   {
+      stats.admitted[m] += getAdmitted(MethodTypes(m));
+      stats.rejected[m] += getRejected(MethodTypes(m));
+      stats.dropped[m] += getDropped(MethodTypes(m));
+   }
+}
+
+bool
+LoadShedder::peekFrame(const char* buffer,
+                       size_t length,
+                       bool stream,
+                       MethodTypes& method,
+                       size_t& messageLength)
+{
+   Peek peek;
+   if (!stream)
+   {
+      const char* next = 0;
+      method = peekStartLine(buffer, length, peek, next) ? peek.method : UNKNOWN;
+      messageLength = length;
+      return true;
+   }
+
+   if (!peekMessage(buffer, length, peek) || peek.contentLength < 0 ||
+       peek.headerLength + size_t(peek.contentLength) > length)
+   {
+      return false;
+   }
+   method = peek.method;
+   messageLength = peek.headerLength + peek.contentLength;
+   return true;
+}
+
+LoadShedder::Verdict
+LoadShedder::classify(const char* buffer,
+                      size_t length,
+                      bool stream,
+                      CongestionManager::RejectionBehavior behavior,
+                      UInt32 retryAfter,
+                      Data& response,
+                      size_t& messageLength)
+{
+   if (behavior == CongestionManager::NORMAL)
+   {
+      return Admit;
+   }
+
+   Peek peek;
+   if (!peekMessage(buffer, length, peek))
+   {
+      count(mAdmitted, peek.method);
+      return Admit;
+   }
+
+   if (stream)
+   {
+      // without a Content-Length (or all of the body) we can not tell where
+      // the next message starts
+      if (peek.contentLength < 0 ||
+          peek.headerLength + size_t(peek.contentLength) > length)
+      {
+         count(mAdmitted, peek.method);
+         return Admit;
+      }
+      messageLength = peek.headerLength + peek.contentLength;
+   }
+   else
+   {
+      messageLength = length;
+   }
+
+   if (!peek.request)
+   {
+      // When REJECTING_NEW_WORK, responses still get through; they
+      // finish work that is already under way.
+      if (behavior == CongestionManager::REJECTING_NON_ESSENTIAL)
+      {
+         count(mDropped, RESPONSE);
+         return Drop;
+      }
+      count(mAdmitted, RESPONSE);
+      return Admit;
+   }
+
+   if (peek.method == ACK)
+   {
+      // nothing to respond with
+      count(mDropped, ACK);
+      return Drop;
+   }
+
+   if (peek.vias == 0 || !peek.to.start || !peek.from.start ||
+       !peek.callId.start || !peek.cseq.start)
+   {
+      // basicCheck() will have something to say about this one
+      count(mAdmitted, peek.method);
+      return Admit;
+   }
+
+   // The transaction is identified by the top branch (or, for RFC 2543
+   // requests, by Call-ID) and the CSeq, which tells a CANCEL from the
+   // INVITE it shares a branch with.
+   const char* keyStart = 0;
+   const char* keyEnd = 0;
+   topBranch(peek.via[0], keyStart, keyEnd);
+   if (keyStart == keyEnd)
+   {
+      keyStart = headerValue(peek.callId);
+      keyEnd = peek.callId.end;
+   }
+   const char* cseq = headerValue(peek.cseq);
+   const size_t key = Data::rawHash(reinterpret_cast<const unsigned char*>(keyStart), keyEnd - keyStart) * 31 +
+                      Data::rawHash(reinterpret_cast<const unsigned char*>(cseq), peek.cseq.end - cseq);
+
+   const UInt64 now = Timer::getTimeMs();
+   if (wasRejected(key, now))
+   {
+      StackLog(<< "Dropping retransmission of a request already rejected for congestion");
+      count(mDropped, peek.method);
+      return Drop;
+   }
+   rememberRejected(key, now);
+
+   size_t size = 96;
+   for (int i = 0; i < peek.vias; ++i)
+   {
+      size += peek.via[i].end - peek.via[i].start + 2;
+   }
+   size += peek.to.end - peek.to.start + peek.from.end - peek.from.start +
+           peek.callId.end - peek.callId.start + peek.cseq.end - peek.cseq.start + 8;
+   response.reserve(response.size() + size);
+
+   response += "SIP/2.0 503 Service Unavailable\r\n";
+   for (int i = 0; i < peek.vias; ++i)
+   {
+      appendLine(response, peek.via[i]);
+   }
+   appendLine(response, peek.to);
+   appendLine(response, peek.from);
+   appendLine(response, peek.callId);
+   appendLine(response, peek.cseq);
+   response += "Retry-After: ";
+   response += Data(retryAfter);
+   response += "\r\nContent-Length: 0\r\n\r\n";
+
+   count(mRejected, peek.method);
+   return Reject;
+}
+
+bool
+LoadShedder::wasRejected(size_t key, UInt64 now)
+{
+   if (mRecentlyRejected.empty())
+   {
+      return false;
+   }
+   const Rejected& entry = mRecentlyRejected[key % RecentlyRejectedSize];
+   return entry.key == key && entry.expiry > now;
+}
+
+void
+LoadShedder::rememberRejected(size_t key, UInt64 now)
+{
+   if (mRecentlyRejected.empty())
+   {
+      Rejected none = {0, 0};
+      mRecentlyRejected.resize(RecentlyRejectedSize, none);
+   }
+   Rejected& entry = mRecentlyRejected[key % RecentlyRejectedSize];
+   entry.key = key;
+   entry.expiry = now + RememberRejectedMs;
+}
+
+/* ====================================================================
+ * The Vovida Software License, Version 1.0
+ *
+ * Copyright (c) 2000 Vovida Networks, Inc.  All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * 3. The names "VOCAL", "Vovida Open Communication Application Library",
+ *    and "Vovida Open Communication Application Library (VOCAL)" must
+ *    not be used to endorse or promote products derived from this
+ *    software without prior written permission. For written
+ *    permission, please contact vocal@vovida.org.
+ *
+ * 4. Products derived from this software may not be called "VOCAL", nor
+ *    may "VOCAL" appear in their name, without prior written
+ *    permission of Vovida Networks, Inc.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS" AND ANY EXPRESSED OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, TITLE AND
+ * NON-INFRINGEMENT ARE DISCLAIMED.  IN NO EVENT SHALL VOVIDA
+ * NETWORKS, INC. OR ITS CONTRIBUTORS BE LIABLE FOR ANY DIRECT DAMAGES
+ * IN EXCESS OF $1,000, NOR FOR ANY INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+ * USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+ * DAMAGE.
+ *
+ * ====================================================================
+ *
+ * This software consists of voluntary contributions made by Vovida
+ * Networks, Inc. and many individuals on behalf of Vovida Networks,
+ * Inc.  For more information on Vovida Networks, Inc., please see
+ * <http://www.vovida.org/>.
+ *
+ */
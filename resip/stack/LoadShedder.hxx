@@ -0,0 +1,175 @@
+#if !defined(RESIP_LOADSHEDDER_HXX)
+#define RESIP_LOADSHEDDER_HXX
+
+#include <atomic>
+#include <vector>
+
+#include "resip/stack/MethodTypes.hxx"
+#include "rutil/CongestionManager.hxx"
+#include "rutil/Data.hxx"
+
+namespace resip
+{
+
+/**
+   @internal
+
+   Sheds incoming traffic while a Transport is congested, working on the raw
+   bytes of a message before MsgHeaderScanner or SipMessage ever see them.
+   Only the start line and the Via, To, From, Call-ID, CSeq and
+   Content-Length header lines are looked at. Requests are answered with a
+   503 built by copying those lines, and retransmissions of a request that
+   has already been turned away are dropped silently. Anything that can not
+   be classified from the raw bytes is admitted, so the regular congestion
+   handling after the parse still applies to it.
+
+   Not thread safe; each Transport owns one and uses it from its own thread.
+   The counts may be read from any thread.
+*/
+class LoadShedder
+{
+   public:
+      typedef enum
+      {
+         Admit, // parse it as usual
+         Reject, // answered with the 503 in response
+         Drop // nothing to send
+      } Verdict;
+
+      LoadShedder();
+
+      /**
+         Decides what to do with the message at the front of buffer.
+
+         @param stream true if buffer came off a stream, in which case a
+                Content-Length is required and more than one message may be
+                in the buffer. For a datagram the body is the rest of it.
+
+         @param behavior The rejection behavior of the Transport's fifo.
+                Nothing is shed when it is NORMAL.
+
+         @param retryAfter Seconds to put in the 503's Retry-After.
+
+         @param response On Reject, the 503 is appended here.
+
+         @param messageLength On Reject and Drop, set to the number of bytes
+                the message (headers and body) took up in buffer.
+      */
+      Verdict classify(const char* buffer,
+                       size_t length,
+                       bool stream,
+                       CongestionManager::RejectionBehavior behavior,
+                       UInt32 retryAfter,
+                       Data& response,
+                       size_t& messageLength);
+
+      /**
+         Finds the method (RESPONSE for a response) and the length of the
+         message at the front of buffer, from the start line and, on a
+         stream, the Content-Length.
+
+         @return false if the end of the message can not be told yet, which
+                 only happens on a stream. A datagram that does not start
+                 with a SIP start line is taken whole, as UNKNOWN.
+      */
+      static bool peekFrame(const char* buffer,
+                            size_t length,
+                            bool stream,
+                            MethodTypes& method,
+                            size_t& messageLength);
+
+      /// Counts of what classify() did with each method, while congested.
+      /// Responses are counted under RESPONSE, and what could not be told
+      /// from its start line under UNKNOWN.
+      UInt64 getAdmitted(MethodTypes method) const { return mAdmitted[method].load(std::memory_order_relaxed); }
+      UInt64 getRejected(MethodTypes method) const { return mRejected[method].load(std::memory_order_relaxed); }
+      UInt64 getDropped(MethodTypes method) const { return mDropped[method].load(std::memory_order_relaxed); }
+
+      struct Stats
+      {
+         Stats();
+         UInt64 admitted[MAX_METHODS];
+         UInt64 rejected[MAX_METHODS];
+         UInt64 dropped[MAX_METHODS];
+      };
+      /// Adds the counts to those already in stats.
+      void addStats(Stats& stats) const;
+
+      /// How long a rejected request is remembered; covers Timer B and F.
+      static UInt64 RememberRejectedMs;
+
+   private:
+      bool wasRejected(size_t key, UInt64 now);
+      void rememberRejected(size_t key, UInt64 now);
+
+      struct Rejected
+      {
+         size_t key;
+         UInt64 expiry;
+      };
+      // direct mapped; a collision just forgets the older request
+      std::vector<Rejected> mRecentlyRejected;
+
+      static void count(std::atomic<UInt64>* counts, MethodTypes method)
+      {
+         counts[method].fetch_add(1, std::memory_order_relaxed);
+      }
+
+      std::atomic<UInt64> mAdmitted[MAX_METHODS];
+      std::atomic<UInt64> mRejected[MAX_METHODS];
+      std::atomic<UInt64> mDropped[MAX_METHODS];
+};
+
+}
+
+#endif
+
+/* ====================================================================
+ * The Vovida Software License, Version 1.0
+ *
+ * Copyright (c) 2000 Vovida Networks, Inc.  All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * 3. The names "VOCAL", "Vovida Open Communication Application Library",
+ *    and "Vovida Open Communication Application Library (VOCAL)" must
+ *    not be used to endorse or promote products derived from this
+ *    software without prior written permission. For written
+ *    permission, please contact vocal@vovida.org.
+ *
+ * 4. Products derived from this software may not be called "VOCAL", nor
+ *    may "VOCAL" appear in their name, without prior written
+ *    permission of Vovida Networks, Inc.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS" AND ANY EXPRESSED OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, TITLE AND
+ * NON-INFRINGEMENT ARE DISCLAIMED.  IN NO EVENT SHALL VOVIDA
+ * NETWORKS, INC. OR ITS CONTRIBUTORS BE LIABLE FOR ANY DIRECT DAMAGES
+ * IN EXCESS OF $1,000, NOR FOR ANY INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+ * USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+ * DAMAGE.
+ *
+ * ====================================================================
+ *
+ * This software consists of voluntary contributions made by Vovida
+ * Networks, Inc. and many individuals on behalf of Vovida Networks,
+ * Inc.  For more information on Vovida Networks, Inc., please see
+ * <http://www.vovida.org/>.
+ *
+ */
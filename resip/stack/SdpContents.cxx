@@ -29,6 +29,7 @@ const char* NetworkType[] = {"???", "IP4", "IP6"};
 
 static const Data rtpmap("rtpmap");
 static const Data fmtp("fmtp");
+static const Data mediumContext("SdpContents::Session::Medium");
 
 // RFC2327 6. page 9
 // "parsers should be tolerant and accept records terminated with a single
@@ -210,6 +211,25 @@ SdpContents::encodeParsed(EncodeStream& s) const
    return s;
 }
 
+bool
+SdpContents::isWellFormed() const
+{
+   if (!LazyParser::isWellFormed())
+   {
+      return false;
+   }
+
+   for (Session::MediumContainer::const_iterator i = mSession.media().begin();
+        i != mSession.media().end(); ++i)
+   {
+      if (!i->isWellFormed())
+      {
+         return false;
+      }
+   }
+   return true;
+}
+
 const Mime&
 SdpContents::getStaticType()
 {
@@ -1217,6 +1237,13 @@ SdpContents::Session::Medium::Medium(const Data& name,
                                      unsigned long multicast,
                                      const Data& protocol)
    : mSession(0),
+     mBodyOffset(0),
+     mBodyParsed(true),
+     mBodyValid(true),
+     mLineExposed(false),
+     mExposedPort(0),
+     mExposedMulticast(1),
+     mBodyExposed(false),
      mName(name),
      mPort(port),
      mMulticast(multicast),
@@ -1226,6 +1253,13 @@ SdpContents::Session::Medium::Medium(const Data& name,
 
 SdpContents::Session::Medium::Medium()
    : mSession(0),
+     mBodyOffset(0),
+     mBodyParsed(true),
+     mBodyValid(true),
+     mLineExposed(false),
+     mExposedPort(0),
+     mExposedMulticast(1),
+     mBodyExposed(false),
      mPort(0),
      mMulticast(1),
      mRtpMapDone(false)
@@ -1233,6 +1267,17 @@ SdpContents::Session::Medium::Medium()
 
 SdpContents::Session::Medium::Medium(const Medium& rhs)
    : mSession(0),
+     mRawSection(rhs.mRawSection),
+     mBodyOffset(rhs.mBodyOffset),
+     mBodyParsed(rhs.mBodyParsed),
+     mBodyValid(rhs.mBodyValid),
+     mLineExposed(rhs.mLineExposed),
+     mExposedName(rhs.mExposedName),
+     mExposedPort(rhs.mExposedPort),
+     mExposedMulticast(rhs.mExposedMulticast),
+     mExposedProtocol(rhs.mExposedProtocol),
+     mBodyExposed(rhs.mBodyExposed),
+     mExposedEncoding(rhs.mExposedEncoding),
      mName(rhs.mName),
      mPort(rhs.mPort),
      mMulticast(rhs.mMulticast),
@@ -1257,6 +1302,17 @@ SdpContents::Session::Medium::operator=(const Medium& rhs)
    if (this != &rhs)
    {
       mSession = 0;
+      mRawSection = rhs.mRawSection;
+      mBodyOffset = rhs.mBodyOffset;
+      mBodyParsed = rhs.mBodyParsed;
+      mBodyValid = rhs.mBodyValid;
+      mLineExposed = rhs.mLineExposed;
+      mExposedName = rhs.mExposedName;
+      mExposedPort = rhs.mExposedPort;
+      mExposedMulticast = rhs.mExposedMulticast;
+      mExposedProtocol = rhs.mExposedProtocol;
+      mBodyExposed = rhs.mBodyExposed;
+      mExposedEncoding = rhs.mExposedEncoding;
       mName = rhs.mName;
       mPort = rhs.mPort;
       mMulticast = rhs.mMulticast;
@@ -1278,6 +1334,7 @@ SdpContents::Session::Medium::operator=(const Medium& rhs)
 void
 SdpContents::Session::Medium::setPort(int port)
 {
+   onModified();
    mPort = port;
 }
 
@@ -1290,6 +1347,7 @@ SdpContents::Session::Medium::setSession(Session* session)
 void
 SdpContents::Session::Medium::parse(ParseBuffer& pb)
 {
+   const char* sectionStart = pb.position();
    pb.skipChar('m');
    const char* anchor = pb.skipChar(Symbols::EQUALS[0]);
 
@@ -1318,12 +1376,137 @@ SdpContents::Session::Medium::parse(ParseBuffer& pb)
      {
       Data format;
       pb.data(format, anchor);
-      addFormat(format);
+      mFormats.push_back(format);
      }
    }
 
    skipEol(pb);
 
+   // Index the rest of the section (up to the next m= line) without parsing 
+   // it; most users only look at the m= and c= lines of a few media, or pass 
+   // the body through untouched.
+   const char* bodyStart = pb.position();
+   while (!pb.eof() && *pb.position() != 'm')
+   {
+      pb.skipToOneOf(Symbols::CRLF);
+      while (!pb.eof() && (*pb.position() == Symbols::CR[0] ||
+                           *pb.position() == Symbols::LF[0]))
+      {
+         pb.skipChar();
+      }
+   }
+
+   pb.data(mRawSection, sectionStart);
+   mBodyOffset = (Data::size_type)(bodyStart - sectionStart);
+   mBodyParsed = (bodyStart == pb.position());
+   if (mRawSection[mRawSection.size() - 1] != Symbols::LF[0])
+   {
+      mRawSection += Symbols::CRLF;
+   }
+}
+
+void
+SdpContents::Session::Medium::checkBodyParsed() const
+{
+   if (!mBodyParsed)
+   {
+      Medium* ncThis = const_cast<Medium*>(this);
+      ncThis->mBodyParsed = true;
+      ParseBuffer pb(mRawSection.data() + mBodyOffset, 
+                     mRawSection.size() - mBodyOffset,
+                     mediumContext);
+      try
+      {
+         ncThis->parseBody(pb);
+      }
+      catch (ParseException& e)
+      {
+         // Callers of the const accessors do not expect a parse failure, so
+         // drop what was parsed and present the section as having no
+         // attributes; the original bytes are still encoded unchanged.
+         WarningLog(<< "Malformed media section for " << mName << " " << mPort << ": " << e);
+         ncThis->mBodyValid = false;
+         ncThis->mInformation.clear();
+         ncThis->mConnections.clear();
+         ncThis->mBandwidths.clear();
+         ncThis->mEncryption = Encryption();
+         ncThis->mAttributeHelper = AttributeHelper();
+      }
+   }
+}
+
+void
+SdpContents::Session::Medium::onModified()
+{
+   checkBodyParsed();
+   mRawSection.clear();
+   mBodyOffset = 0;
+   mLineExposed = false;
+   mExposedName.clear();
+   mExposedProtocol.clear();
+   mBodyExposed = false;
+   mExposedEncoding.clear();
+}
+
+void
+SdpContents::Session::Medium::exposeLine()
+{
+   // the m= line is always parsed, so remembering its fields is enough and 
+   // does not force a parse of the rest of the section
+   if (!mRawSection.empty() && !mLineExposed)
+   {
+      mLineExposed = true;
+      mExposedName = mName;
+      mExposedPort = mPort;
+      mExposedMulticast = mMulticast;
+      mExposedProtocol = mProtocol;
+   }
+}
+
+void
+SdpContents::Session::Medium::exposeBody()
+{
+   checkBodyParsed();
+   if (!mRawSection.empty() && !mBodyExposed)
+   {
+      // convert to codecs first so that a later codecs() call does not make 
+      // the parsed form differ from the snapshot
+      buildCodecs();
+      mBodyExposed = true;
+      DataStream ds(mExposedEncoding);
+      encodeParsed(ds);
+   }
+}
+
+bool
+SdpContents::Session::Medium::isChanged() const
+{
+   if (mLineExposed &&
+       (mName != mExposedName ||
+        mPort != mExposedPort ||
+        mMulticast != mExposedMulticast ||
+        mProtocol != mExposedProtocol))
+   {
+      return true;
+   }
+
+   if (mBodyExposed)
+   {
+      Data encoding;
+      {
+         DataStream ds(encoding);
+         encodeParsed(ds);
+      }
+      return encoding != mExposedEncoding;
+   }
+
+   return false;
+}
+
+void
+SdpContents::Session::Medium::parseBody(ParseBuffer& pb)
+{
+   const char* anchor;
    if (!pb.eof() && *pb.position() == 'i')
    {
       pb.skipChar('i');
@@ -1336,7 +1519,7 @@ SdpContents::Session::Medium::parse(ParseBuffer& pb)
 
    while (!pb.eof() && *pb.position() == 'c')
    {
-      addConnection(Connection());
+      mConnections.push_back(Connection());
       mConnections.back().parse(pb);
       if (!pb.eof() && *pb.position() == Symbols::SLASH[0])
       {
@@ -1373,7 +1556,7 @@ SdpContents::Session::Medium::parse(ParseBuffer& pb)
 
             for (int i = 1; i < num; i++)
             {
-               addConnection(con);
+               mConnections.push_back(con);
                mConnections.back().mAddress = before + Data(after+i);
             }
          }
@@ -1385,7 +1568,7 @@ SdpContents::Session::Medium::parse(ParseBuffer& pb)
 
             for (int i = 1; i < num; i++)
             {
-               addConnection(con);
+               mConnections.push_back(con);
                memset(hexstring, 0, sizeof(hexstring));
                Helper::integer2hex(hexstring, after+i, false /* supress leading zeros */);
                mConnections.back().mAddress = before + Data(hexstring);
@@ -1398,7 +1581,7 @@ SdpContents::Session::Medium::parse(ParseBuffer& pb)
 
    while (!pb.eof() && *pb.position() == 'b')
    {
-      addBandwidth(Bandwidth());
+      mBandwidths.push_back(Bandwidth());
       mBandwidths.back().parse(pb);
    }
 
@@ -1412,6 +1595,18 @@ SdpContents::Session::Medium::parse(ParseBuffer& pb)
 
 EncodeStream&
 SdpContents::Session::Medium::encode(EncodeStream& s) const
+{
+   if (!mRawSection.empty() && !isChanged())
+   {
+      s << mRawSection;
+      return s;
+   }
+
+   return encodeParsed(s);
+}
+
+EncodeStream&
+SdpContents::Session::Medium::encodeParsed(EncodeStream& s) const
 {
    s << "m="
      << mName << Symbols::SPACE[0]
@@ -1496,12 +1691,14 @@ SdpContents::Session::Medium::encode(EncodeStream& s) const
 void
 SdpContents::Session::Medium::addFormat(const Data& format)
 {
+   onModified();
    mFormats.push_back(format);
 }
 
 void
 SdpContents::Session::Medium::setConnection(const Connection& connection)
 {
+   onModified();
    mConnections.clear();
    addConnection(connection);
 }
@@ -1509,12 +1706,14 @@ SdpContents::Session::Medium::setConnection(const Connection& connection)
 void
 SdpContents::Session::Medium::addConnection(const Connection& connection)
 {
+   onModified();
    mConnections.push_back(connection);
 }
 
 void
 SdpContents::Session::Medium::setBandwidth(const Bandwidth& bandwidth)
 {
+   onModified();
    mBandwidths.clear();
    addBandwidth(bandwidth);
 }
@@ -1522,12 +1721,14 @@ SdpContents::Session::Medium::setBandwidth(const Bandwidth& bandwidth)
 void
 SdpContents::Session::Medium::addBandwidth(const Bandwidth& bandwidth)
 {
+   onModified();
    mBandwidths.push_back(bandwidth);
 }
 
 void
 SdpContents::Session::Medium::addAttribute(const Data& key, const Data& value)
 {
+   onModified();
    mAttributeHelper.addAttribute(key, value);
    if (key == rtpmap)
    {
@@ -1538,7 +1739,7 @@ SdpContents::Session::Medium::addAttribute(const Data& key, const Data& value)
 const list<SdpContents::Session::Connection>
 SdpContents::Session::Medium::getConnections() const
 {
-   list<Connection> connections = const_cast<Medium*>(this)->getMediumConnections();
+   list<Connection> connections = getMediumConnections();
    // If there are connections specified at the medium level, then check if a session level
    // connection is present - if so then return it
    if (connections.empty() && mSession && !mSession->connection().getAddress().empty())
@@ -1552,6 +1753,7 @@ SdpContents::Session::Medium::getConnections() const
 bool
 SdpContents::Session::Medium::exists(const Data& key) const
 {
+   checkBodyParsed();
    if (mAttributeHelper.exists(key))
    {
       return true;
@@ -1562,6 +1764,7 @@ SdpContents::Session::Medium::exists(const Data& key) const
 const list<Data>&
 SdpContents::Session::Medium::getValues(const Data& key) const
 {
+   checkBodyParsed();
    if (mAttributeHelper.exists(key))
    {
       return mAttributeHelper.getValues(key);
@@ -1578,6 +1781,7 @@ SdpContents::Session::Medium::getValues(const Data& key) const
 void
 SdpContents::Session::Medium::clearAttribute(const Data& key)
 {
+   onModified();
    mAttributeHelper.clearAttribute(key);
    if (key == rtpmap)
    {
@@ -1588,6 +1792,7 @@ SdpContents::Session::Medium::clearAttribute(const Data& key)
 void
 SdpContents::Session::Medium::clearCodecs()
 {
+   onModified();
    mFormats.clear();
    clearAttribute(rtpmap);
    clearAttribute(fmtp);
@@ -1597,7 +1802,8 @@ SdpContents::Session::Medium::clearCodecs()
 void
 SdpContents::Session::Medium::addCodec(const Codec& codec)
 {
-   codecs();
+   onModified();
+   buildCodecs();
    mCodecs.push_back(codec);
 }
 
@@ -1605,11 +1811,21 @@ SdpContents::Session::Medium::addCodec(const Codec& codec)
 const SdpContents::Session::Medium::CodecContainer&
 SdpContents::Session::Medium::codecs() const
 {
-   return const_cast<Medium*>(this)->codecs();
+   // Converting formats and rtpmap attributes to Codecs does not change what 
+   // is encoded, so this does not count as a modification
+   checkBodyParsed();
+   return const_cast<Medium*>(this)->buildCodecs();
 }
 
 SdpContents::Session::Medium::CodecContainer&
 SdpContents::Session::Medium::codecs()
+{
+   exposeBody();
+   return buildCodecs();
+}
+
+SdpContents::Session::Medium::CodecContainer&
+SdpContents::Session::Medium::buildCodecs()
 {
 #if defined(WIN32) && defined(_MSC_VER) && (_MSC_VER < 1310)  // CJ TODO fix 
    resip_assert(0);
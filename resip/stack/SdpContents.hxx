@@ -575,6 +575,17 @@ class SdpContents : public Contents
 
             /** @brief  process m= (media announcement) blocks
               * 
+              *   Only the m= line is parsed up front; the remainder of the 
+              *   section (i=, c=, b=, k= and a= lines) is kept as raw bytes 
+              *   and parsed on first access.  A section that has not been 
+              *   modified is encoded byte-for-byte from the original buffer; 
+              *   reading through a non-const accessor only falls back to the 
+              *   parsed form if the returned value was actually changed.
+              *
+              *   A malformed section does not make the SDP fail to parse: its 
+              *   accessors report no i=, c=, b=, k= or a= lines, isWellFormed() 
+              *   returns false, and SdpContents::isWellFormed() returns false 
+              *   for the enclosing SDP.
               **/
             class Medium
             {
@@ -637,7 +648,7 @@ class SdpContents : public Contents
                     * 
                     * @return media type  
                     **/                  
-                  Data& name() {return mName;}
+                  Data& name() {exposeLine(); return mName;}
                   /** @brief return the base port
                     * 
                     * @return base port  
@@ -647,7 +658,7 @@ class SdpContents : public Contents
                     * 
                     * @return base port  
                     **/
-                  unsigned long& port() {return mPort;}
+                  unsigned long& port() {exposeLine(); return mPort;}
                   /** @brief change the base port
                     * 
                     * @param port new base port
@@ -663,7 +674,7 @@ class SdpContents : public Contents
                     * 
                     * @return number of transport port pairs  
                     **/
-                  unsigned long& multicast() {return mMulticast;}
+                  unsigned long& multicast() {exposeLine(); return mMulticast;}
                   /** @brief return the transport protocol
                     * 
                     * @return transport protocol name  
@@ -673,7 +684,7 @@ class SdpContents : public Contents
                     * 
                     * @return transport protocol name  
                     **/
-                  Data& protocol() {return mProtocol;}
+                  Data& protocol() {exposeLine(); return mProtocol;}
 
                   // preferred codec/format interface
                   typedef std::list<Codec> CodecContainer;
@@ -709,18 +720,18 @@ class SdpContents : public Contents
                     * 
                     * @return contents  
                     **/
-                  const Data& information() const {return mInformation;}
+                  const Data& information() const {checkBodyParsed(); return mInformation;}
                   /** @brief get optional i= (information) line contents
                     * 
                     * @return contents  
                     **/
-                  Data& information() {return mInformation;}
+                  Data& information() {exposeBody(); return mInformation;}
                   /** @brief get a list of bandwidth lines
                     * 
                     * @return list of Bandwidth objects  
                     **/
-                  const std::list<Bandwidth>& bandwidths() const {return mBandwidths;}
-                  std::list<Bandwidth>& bandwidths() {return mBandwidths;}
+                  const std::list<Bandwidth>& bandwidths() const {checkBodyParsed(); return mBandwidths;}
+                  std::list<Bandwidth>& bandwidths() {exposeBody(); return mBandwidths;}
 
                   /** @brief get a list of Connection objects, including the Session's c= line.
                     * 
@@ -733,11 +744,11 @@ class SdpContents : public Contents
                     * 
                     * @return list of connections  
                     **/
-                  const std::list<Connection>& getMediumConnections() const {return mConnections;}
-                  std::list<Connection>& getMediumConnections() {return mConnections;}
-                  const Encryption& getEncryption() const {return mEncryption;}
-                  const Encryption& encryption() const {return mEncryption;}
-                  Encryption& encryption() {return mEncryption;}
+                  const std::list<Connection>& getMediumConnections() const {checkBodyParsed(); return mConnections;}
+                  std::list<Connection>& getMediumConnections() {exposeBody(); return mConnections;}
+                  const Encryption& getEncryption() const {checkBodyParsed(); return mEncryption;}
+                  const Encryption& encryption() const {checkBodyParsed(); return mEncryption;}
+                  Encryption& encryption() {exposeBody(); return mEncryption;}
                   /** @brief tests if an a= key is present in the media section
                     * 
                     * @param key key to check
@@ -780,10 +791,47 @@ class SdpContents : public Contents
                     **/
                   int findTelephoneEventPayloadType() const;
 
+                  /** @brief true if the section will be encoded from the 
+                    *   original bytes it was parsed from
+                    **/
+                  bool isUnmodified() const {return !mRawSection.empty() && !isChanged();}
+
+                  /** @brief false if the lines following the m= line could 
+                    *   not be parsed; such a section reports no i=, c=, b=, 
+                    *   k= or a= lines
+                    **/
+                  bool isWellFormed() const {checkBodyParsed(); return mBodyValid;}
+
                private:
                   void setSession(Session* session);
+                  void parseBody(ParseBuffer& pb);
+                  void checkBodyParsed() const;
+                  void onModified();
+                  void exposeLine();
+                  void exposeBody();
+                  bool isChanged() const;
+                  EncodeStream& encodeParsed(EncodeStream& s) const;
+                  CodecContainer& buildCodecs();
                   Session* mSession;
 
+                  // original m= section, and the offset of the lines following 
+                  // the m= line; cleared once the section is modified
+                  Data mRawSection;
+                  Data::size_type mBodyOffset;
+                  bool mBodyParsed;
+                  bool mBodyValid;
+
+                  // values handed out through the non-const accessors while 
+                  // mRawSection is still in use; compared on encode to tell 
+                  // whether the caller changed them
+                  bool mLineExposed;
+                  Data mExposedName;
+                  unsigned long mExposedPort;
+                  unsigned long mExposedMulticast;
+                  Data mExposedProtocol;
+                  bool mBodyExposed;
+                  Data mExposedEncoding;
+
                   Data mName;
                   unsigned long mPort;
                   unsigned long mMulticast;
@@ -1039,6 +1087,11 @@ class SdpContents : public Contents
       Session& session() {checkParsed(); return mSession;}
       const Session& session() const {checkParsed(); return mSession;}
 
+      /** @brief false if the SDP failed to parse, or if any of its media 
+        *   sections is malformed (see Session::Medium::isWellFormed())
+        **/
+      bool isWellFormed() const;
+
       virtual EncodeStream& encodeParsed(EncodeStream& str) const;
       virtual void parse(ParseBuffer& pb);
       static const Mime& getStaticType() ;
@@ -63,6 +63,25 @@ class SendData
          return data.empty();
       }
 
+      // clear() keeps the buffers for reuse; release() gives them back
+      void release()
+      {
+         Data none;
+         data.takeBuf(none);
+         Data noTid;
+         transactionId.takeBuf(noTid);
+         Data noSigcompId;
+         sigcompId.takeBuf(noSigcompId);
+      }
+
+      // Reallocates data to its size, dropping the headroom reserved while
+      // encoding.  Used for data that is kept around for retransmission.
+      void compact()
+      {
+         Data exact(data);
+         data.takeBuf(exact);
+      }
+
       Tuple destination;
       Data data;
       Data transactionId;
@@ -38,6 +38,7 @@ SipMessage::SipMessage(const Tuple *receivedTransportTuple)
 #else
      mUnknownHeaders(),
 #endif
+     mUnknownHeaderIndex(StlPoolAllocator<UnknownHeaderSlot, PoolBase >(&mPool)),
      mRequest(false),
      mResponse(false),
      mInvalid(false),
@@ -60,6 +61,7 @@ SipMessage::SipMessage(const SipMessage& from)
 #else
      mUnknownHeaders(),
 #endif
+     mUnknownHeaderIndex(StlPoolAllocator<UnknownHeaderSlot, PoolBase >(&mPool)),
      mCreatedTime(Timer::getTimeMicroSec())
 {
    init(from);
@@ -114,6 +116,7 @@ SipMessage::clear(bool leaveResponseStuff)
    }
 
    mUnknownHeaders.clear();
+   mUnknownHeaderIndex.clear();
 
    mStartLine = 0;
    mContents = 0;
@@ -165,6 +168,10 @@ SipMessage::init(const SipMessage& rhs)
                                    i->first,
                                    getCopyHfvl(*i->second)));
    }
+   if (mUnknownHeaders.size() >= UnknownHeaderIndexMin)
+   {
+      rebuildUnknownHeaderIndex();
+   }
    if (rhs.mStartLine != 0)
    {
       mStartLine = rhs.mStartLine->clone(mStartLineMem);
@@ -1124,19 +1131,18 @@ SipMessage::releaseContents()
 const StringCategories& 
 SipMessage::header(const ExtensionHeader& headerName) const
 {
-   for (UnknownHeaders::const_iterator i = mUnknownHeaders.begin();
-        i != mUnknownHeaders.end(); i++)
-   {      
-      if (isEqualNoCase(i->first, headerName.getName()))
+   UnknownHeaders::const_iterator i = findUnknownHeader(headerName.getName().data(),
+                                                        headerName.getName().size(),
+                                                        headerName.getHash());
+   if (i != mUnknownHeaders.end())
+   {
+      HeaderFieldValueList* hfvs = i->second;
+      if (hfvs->getParserContainer() == 0)
       {
-         HeaderFieldValueList* hfvs = i->second;
-         if (hfvs->getParserContainer() == 0)
-         {
-            SipMessage* nc_this(const_cast<SipMessage*>(this));
-            hfvs->setParserContainer(nc_this->makeParserContainer<StringCategory>(hfvs, Headers::RESIP_DO_NOT_USE));
-         }
-         return *dynamic_cast<ParserContainer<StringCategory>*>(hfvs->getParserContainer());
+         SipMessage* nc_this(const_cast<SipMessage*>(this));
+         hfvs->setParserContainer(nc_this->makeParserContainer<StringCategory>(hfvs, Headers::RESIP_DO_NOT_USE));
       }
+      return *dynamic_cast<ParserContainer<StringCategory>*>(hfvs->getParserContainer());
    }
    // missing extension header
    resip_assert(false);
@@ -1147,56 +1153,148 @@ SipMessage::header(const ExtensionHeader& headerName) const
 StringCategories& 
 SipMessage::header(const ExtensionHeader& headerName)
 {
-   for (UnknownHeaders::iterator i = mUnknownHeaders.begin();
-        i != mUnknownHeaders.end(); i++)
+   UnknownHeaders::const_iterator i = findUnknownHeader(headerName.getName().data(),
+                                                        headerName.getName().size(),
+                                                        headerName.getHash());
+   if (i != mUnknownHeaders.end())
    {
-      if (isEqualNoCase(i->first, headerName.getName()))
+      HeaderFieldValueList* hfvs = i->second;
+      if (hfvs->getParserContainer() == 0)
       {
-         HeaderFieldValueList* hfvs = i->second;
-         if (hfvs->getParserContainer() == 0)
-         {
-            hfvs->setParserContainer(makeParserContainer<StringCategory>(hfvs, Headers::RESIP_DO_NOT_USE));
-         }
-         return *dynamic_cast<ParserContainer<StringCategory>*>(hfvs->getParserContainer());
+         hfvs->setParserContainer(makeParserContainer<StringCategory>(hfvs, Headers::RESIP_DO_NOT_USE));
       }
+      return *dynamic_cast<ParserContainer<StringCategory>*>(hfvs->getParserContainer());
    }
 
    // create the list empty
    HeaderFieldValueList* hfvs = getEmptyHfvl();
    hfvs->setParserContainer(makeParserContainer<StringCategory>(hfvs, Headers::RESIP_DO_NOT_USE));
    mUnknownHeaders.push_back(make_pair(headerName.getName(), hfvs));
+   indexUnknownHeader(--mUnknownHeaders.end(), headerName.getHash());
    return *dynamic_cast<ParserContainer<StringCategory>*>(hfvs->getParserContainer());
 }
 
 bool
 SipMessage::exists(const ExtensionHeader& symbol) const
 {
-   for (UnknownHeaders::const_iterator i = mUnknownHeaders.begin();
-        i != mUnknownHeaders.end(); i++)
+   return findUnknownHeader(symbol.getName().data(),
+                            symbol.getName().size(),
+                            symbol.getHash()) != mUnknownHeaders.end();
+}
+
+void
+SipMessage::remove(const ExtensionHeader& headerName)
+{
+   UnknownHeaders::const_iterator i = findUnknownHeader(headerName.getName().data(),
+                                                        headerName.getName().size(),
+                                                        headerName.getHash());
+   if (i != mUnknownHeaders.end())
    {
-      if (isEqualNoCase(i->first, symbol.getName()))
+      freeHfvl(i->second);
+      mUnknownHeaders.erase(i);
+      if (mUnknownHeaders.size() < UnknownHeaderIndexMin)
+      {
+         mUnknownHeaderIndex.clear();
+      }
+      else
       {
-         return true;
+         rebuildUnknownHeaderIndex();
       }
    }
-   return false;
+}
+
+SipMessage::UnknownHeaders::const_iterator
+SipMessage::findUnknownHeader(const char* name, size_t len, size_t hash) const
+{
+   if (mUnknownHeaderIndex.empty())
+   {
+      for (UnknownHeaders::const_iterator i = mUnknownHeaders.begin();
+           i != mUnknownHeaders.end(); i++)
+      {
+         if (i->first.size() == len &&
+             strncasecmp(i->first.data(), name, (int)len) == 0)
+         {
+            return i;
+         }
+      }
+      return mUnknownHeaders.end();
+   }
+
+   const size_t mask = mUnknownHeaderIndex.size() - 1;
+   for (size_t s = hash & mask; mUnknownHeaderIndex[s].used; s = (s + 1) & mask)
+   {
+      const UnknownHeaderSlot& slot = mUnknownHeaderIndex[s];
+      if (slot.hash == hash &&
+          slot.header->first.size() == len &&
+          strncasecmp(slot.header->first.data(), name, (int)len) == 0)
+      {
+         return slot.header;
+      }
+   }
+   return mUnknownHeaders.end();
 }
 
 void
-SipMessage::remove(const ExtensionHeader& headerName)
+SipMessage::indexUnknownHeader(UnknownHeaders::iterator header, size_t hash)
+{
+   if (mUnknownHeaders.size() < UnknownHeaderIndexMin)
+   {
+      return;
+   }
+   if (mUnknownHeaders.size() * 2 > mUnknownHeaderIndex.size())
+   {
+      rebuildUnknownHeaderIndex();
+      return;
+   }
+   const size_t mask = mUnknownHeaderIndex.size() - 1;
+   size_t s = hash & mask;
+   while (mUnknownHeaderIndex[s].used)
+   {
+      s = (s + 1) & mask;
+   }
+   mUnknownHeaderIndex[s].used = true;
+   mUnknownHeaderIndex[s].hash = hash;
+   mUnknownHeaderIndex[s].header = header;
+}
+
+void
+SipMessage::rebuildUnknownHeaderIndex()
 {
+   // at most half full
+   size_t size = 2 * UnknownHeaderIndexMin;
+   while (size < mUnknownHeaders.size() * 2)
+   {
+      size *= 2;
+   }
+   mUnknownHeaderIndex.assign(size, UnknownHeaderSlot());
+   const size_t mask = size - 1;
    for (UnknownHeaders::iterator i = mUnknownHeaders.begin();
         i != mUnknownHeaders.end(); i++)
    {
-      if (isEqualNoCase(i->first, headerName.getName()))
+      const size_t hash = Data::rawCaseInsensitiveTokenHash((const unsigned char*)i->first.data(),
+                                                            i->first.size());
+      size_t s = hash & mask;
+      while (mUnknownHeaderIndex[s].used)
       {
-         freeHfvl(i->second);
-         mUnknownHeaders.erase(i);
-         return;
+         s = (s + 1) & mask;
       }
+      mUnknownHeaderIndex[s].used = true;
+      mUnknownHeaderIndex[s].hash = hash;
+      mUnknownHeaderIndex[s].header = i;
    }
 }
 
+size_t
+SipMessage::unknownHeaderHash(const char* name, size_t len) const
+{
+   // without an index the hash is not looked at
+   if (mUnknownHeaders.size() < UnknownHeaderIndexMin)
+   {
+      return 0;
+   }
+   return Data::rawCaseInsensitiveTokenHash((const unsigned char*)name, len);
+}
+
 void
 SipMessage::addHeader(Headers::Type header, const char* headerName, int headerLen, 
                       const char* start, int len)
@@ -1255,19 +1353,16 @@ SipMessage::addHeader(Headers::Type header, const char* headerName, int headerLe
    else
    {
       resip_assert(headerLen >= 0);
-      for (UnknownHeaders::iterator i = mUnknownHeaders.begin();
-           i != mUnknownHeaders.end(); i++)
+      const size_t hash = unknownHeaderHash(headerName, headerLen);
+      UnknownHeaders::const_iterator i = findUnknownHeader(headerName, headerLen, hash);
+      if (i != mUnknownHeaders.end())
       {
-         if (i->first.size() == (unsigned int)headerLen &&
-             strncasecmp(i->first.data(), headerName, headerLen) == 0)
+         // add to end of list
+         if (len)
          {
-            // add to end of list
-            if (len)
-            {
-               i->second->push_back(start, len, false);
-            }
-            return;
+            i->second->push_back(start, len, false);
          }
+         return;
       }
 
       // didn't find it, add an entry
@@ -1278,6 +1373,7 @@ SipMessage::addHeader(Headers::Type header, const char* headerName, int headerLe
       }
       mUnknownHeaders.push_back(pair<Data, HeaderFieldValueList*>(Data(headerName, headerLen),
                                                                   hfvs));
+      indexUnknownHeader(--mUnknownHeaders.end(), hash);
    }
 }
 
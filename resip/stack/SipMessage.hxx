@@ -680,6 +680,30 @@ class SipMessage : public TransactionMessage
       // raw text corresponding to each unknown header
       UnknownHeaders mUnknownHeaders;
 
+      // Open addressed index over mUnknownHeaders by case insensitive name
+      // hash. It exists exactly while a message carries at least
+      // UnknownHeaderIndexMin unknown headers (an SBC can add dozens of X-
+      // headers); with fewer, scanning the list is cheaper. Only the
+      // non-const paths that add or remove unknown headers (parse, copy,
+      // header(), remove()) maintain it, so const lookups never write.
+      struct UnknownHeaderSlot
+      {
+         UnknownHeaderSlot() : used(false), hash(0) {}
+         bool used;
+         size_t hash;
+         UnknownHeaders::iterator header;
+      };
+      typedef std::vector<UnknownHeaderSlot,
+                          StlPoolAllocator<UnknownHeaderSlot, PoolBase > > UnknownHeaderIndex;
+      static const size_t UnknownHeaderIndexMin = 8;
+      UnknownHeaderIndex mUnknownHeaderIndex;
+
+      // hash is only used once there is an index; see unknownHeaderHash()
+      UnknownHeaders::const_iterator findUnknownHeader(const char* name, size_t len, size_t hash) const;
+      void indexUnknownHeader(UnknownHeaders::iterator header, size_t hash);
+      void rebuildUnknownHeaderIndex();
+      size_t unknownHeaderHash(const char* name, size_t len) const;
+
       // For messages received from the wire, this indicates information about 
       // the transport the message was received on
       Tuple mReceivedTransportTuple;
@@ -213,6 +213,7 @@ SipStack::init(const SipStackOptions& options)
    mProcessingHasStarted = false;
    mShuttingDown = false;
    mStatisticsManagerEnabled = true;
+   mStatsManager.measureWaitTime(mTUFifo);
    mSocketFunc = options.mSocketFunc;
 
    // .kw. note that stats manager has already called getTimeMs()
@@ -574,6 +575,12 @@ SipStack::addTransport(std::unique_ptr<Transport> transport)
        transport->setSipMessageLoggingHandler(mTransportSipMessageLoggingHandler);
    }
 
+   // Set Source Rate Limiter if one was provided
+   if (mTransportSourceRateLimiter)
+   {
+       transport->setSourceRateLimiter(mTransportSourceRateLimiter);
+   }
+
    if(mProcessingHasStarted)
    {
        // Stack is running.  Need to queue add request for TransactionController Thread
@@ -917,6 +924,24 @@ SipStack::sendTo(const SipMessage& msg, const Tuple& destination, TransactionUse
    mTransactionController->send(toSend);
 }
 
+void
+SipStack::sendTo(const SipMessage& msg, const std::vector<Tuple>& destinations, TransactionUser* tu)
+{
+   resip_assert(!mShuttingDown);
+
+   std::vector<SipMessage*> batch;
+   batch.reserve(destinations.size());
+   for(std::vector<Tuple>::const_iterator it = destinations.begin(); it != destinations.end(); ++it)
+   {
+      SipMessage* toSend = static_cast<SipMessage*>(msg.clone());
+      if (tu) toSend->setTransactionUser(tu);
+      toSend->setDestination(*it);
+      toSend->setFromTU();
+      batch.push_back(toSend);
+   }
+   mTransactionController->send(batch);
+}
+
 void
 SipStack::checkAsyncProcessHandler()
 {
@@ -1167,6 +1192,7 @@ void
 SipStack::registerTransactionUser(TransactionUser& tu, const bool front)
 {
    mTuSelector.registerTransactionUser(tu, front);
+   mStatsManager.measureWaitTime(tu);
 }
 
 void
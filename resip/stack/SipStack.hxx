@@ -6,6 +6,7 @@
 #endif
 
 #include <set>
+#include <vector>
 #include <iosfwd>
 
 #include "rutil/CongestionManager.hxx"
@@ -309,6 +310,18 @@ class SipStack : public FdSetIOObserver
       */
       void setTransportSipMessageLoggingHandler(std::shared_ptr<Transport::SipMessageLoggingHandler> handler) { mTransportSipMessageLoggingHandler = std::move(handler); }
 
+      /**
+         Used by the application to provide a SourceRateLimiter that transports added
+         after calling this will consult for every incoming message, before parsing it.
+         The same limiter is shared by all of them, so a source is limited across
+         transports.
+
+         @param limiter               std::shared_ptr to the limiter, or an empty one to
+                                      not limit transports added from now on.
+      */
+      void setTransportSourceRateLimiter(std::shared_ptr<SourceRateLimiter> limiter) { mTransportSourceRateLimiter = std::move(limiter); }
+      SourceRateLimiter* getTransportSourceRateLimiter() const { return mTransportSourceRateLimiter.get(); }
+
       /**
          Used by the application to add in a new built-in transport.  The transport is
          created and then added to the Transport Selector.
@@ -514,6 +527,22 @@ class SipStack : public FdSetIOObserver
       void sendTo(const SipMessage& msg, const Tuple& tuple,
                   TransactionUser* tu=0);
 
+      /**
+          @brief send a copy of a message to each of several destinations
+          @details Like sendTo(const SipMessage&, const Tuple&, TransactionUser*)
+          for every destination, but all copies are handed to the transaction
+          layer in one go.  Intended for messages such as keepalives that go to
+          many flows at the same time.
+
+          @param msg          SipMessage to send.
+
+          @param destinations Destinations to send to, specified as Tuples.
+
+          @param tu           TransactionUser to send from.
+      */
+      void sendTo(const SipMessage& msg, const std::vector<Tuple>& destinations,
+                  TransactionUser* tu=0);
+
       /**
           @brief force the a message out over an existing connection
 
@@ -1193,6 +1222,7 @@ class SipStack : public FdSetIOObserver
       unsigned int mNextTransportKey;
 
       std::shared_ptr<Transport::SipMessageLoggingHandler> mTransportSipMessageLoggingHandler;
+      std::shared_ptr<SourceRateLimiter> mTransportSourceRateLimiter;
 
       friend class Executive;
       friend class StatelessHandler;
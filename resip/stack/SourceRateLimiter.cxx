@@ -0,0 +1,464 @@
+#if defined(HAVE_CONFIG_H)
+#include "config.h"
+#endif
+
+#include <string.h>
+
+#include "resip/stack/SourceRateLimiter.hxx"
+#include "resip/stack/Tuple.hxx"
+#include "rutil/Data.hxx"
+#include "rutil/Lock.hxx"
+#include "rutil/Logger.hxx"
+#include "rutil/ResipAssert.h"
+#include "rutil/Timer.hxx"
+
+#define RESIPROCATE_SUBSYSTEM Subsystem::TRANSPORT
+
+using namespace resip;
+
+namespace
+{
+const UInt32 Nil = 0xFFFFFFFF;
+const UInt64 WindowMs = 1000;
+}
+
+SourceRateLimiter::Shard::Shard() :
+   lruHead(Nil),
+   lruTail(Nil),
+   refusedWhileBanned(0),
+   bans(0),
+   evictions(0)
+{
+   memset(admitted, 0, sizeof(admitted));
+   memset(limited, 0, sizeof(limited));
+}
+
+SourceRateLimiter::SourceRateLimiter(UInt32 requestsPerSecond, UInt32 burst, UInt32 maxSources) :
+   mMaxSources(maxSources ? maxSources : 1),
+   mNumShards(1),
+   mNumRates(1),
+   mBanAfter(0),
+   mBanMs(0)
+{
+   while (mNumShards < MaxShards && mNumShards * 2 * MinSourcesPerShard <= mMaxSources)
+   {
+      mNumShards *= 2;
+   }
+   mMaxSourcesPerShard = (mMaxSources + mNumShards - 1) / mNumShards;
+   mRates[0].perSecond = requestsPerSecond;
+   mRates[0].burst = burst;
+   memset(mBucketForMethod, 0, sizeof(mBucketForMethod));
+}
+
+void
+SourceRateLimiter::setMethodRate(MethodTypes method, UInt32 requestsPerSecond, UInt32 burst)
+{
+   resip_assert(method >= 0 && method < MAX_METHODS && method != RESPONSE);
+   lockShards();
+   int bucket = mBucketForMethod[method];
+   if (bucket == 0)
+   {
+      if (mNumRates > MaxMethodRates)
+      {
+         unlockShards();
+         ErrLog(<< "Too many methods with a rate of their own; "
+                << getMethodName(method) << " stays on the default rate");
+         return;
+      }
+      bucket = mNumRates++;
+      mBucketForMethod[method] = (UInt8)bucket;
+   }
+   mRates[bucket].perSecond = requestsPerSecond;
+   mRates[bucket].burst = burst;
+   // sources already known pick up the new bucket as a full one
+   for (UInt32 n = 0; n < mNumShards; ++n)
+   {
+      std::vector<Source>& sources = mShards[n].sources;
+      for (std::vector<Source>::iterator i = sources.begin(); i != sources.end(); ++i)
+      {
+         i->buckets[bucket].refilled = 0;
+         i->buckets[bucket].milliTokens = burst * 1000;
+      }
+   }
+   unlockShards();
+}
+
+void
+SourceRateLimiter::setBan(UInt32 limitedPerSecond, UInt32 banMs)
+{
+   lockShards();
+   mBanAfter = limitedPerSecond;
+   mBanMs = banMs;
+   unlockShards();
+}
+
+SourceRateLimiter::Verdict
+SourceRateLimiter::admit(const Tuple& source, MethodTypes method)
+{
+   return admit(source, method, Timer::getTimeMs());
+}
+
+SourceRateLimiter::Verdict
+SourceRateLimiter::admit(const Tuple& source, MethodTypes method, UInt64 now)
+{
+   unsigned char address[16];
+   UInt8 length;
+   const sockaddr& sa = source.getSockaddr();
+#ifdef USE_IPV6
+   if (sa.sa_family == AF_INET6)
+   {
+      const sockaddr_in6& in6 = reinterpret_cast<const sockaddr_in6&>(sa);
+      memcpy(address, &in6.sin6_addr, sizeof(in6.sin6_addr));
+      length = sizeof(in6.sin6_addr);
+   }
+   else
+#endif
+   {
+      const sockaddr_in& in4 = reinterpret_cast<const sockaddr_in&>(sa);
+      memcpy(address, &in4.sin_addr, sizeof(in4.sin_addr));
+      length = sizeof(in4.sin_addr);
+   }
+   const size_t hash = hashAddress(address, length);
+
+   Shard& shard = shardFor(hash);
+   Lock lock(shard.mutex);
+   UInt32 index = find(shard, address, length, hash);
+
+   if (method == RESPONSE)
+   {
+      // responses only finish work that we started; they do not get a
+      // source into the table
+      if (index != Nil && shard.sources[index].bannedUntil > now)
+      {
+         ++shard.refusedWhileBanned;
+         return Banned;
+      }
+      ++shard.admitted[RESPONSE];
+      return Admit;
+   }
+
+   if (index == Nil)
+   {
+      index = insert(shard, address, length, hash, now);
+   }
+   else
+   {
+      unlinkLru(shard, index);
+      pushFrontLru(shard, index);
+   }
+   Source& src = shard.sources[index];
+
+   if (src.bannedUntil > now)
+   {
+      ++shard.refusedWhileBanned;
+      return Banned;
+   }
+
+   const int b = mBucketForMethod[method];
+   const Rate& rate = mRates[b];
+   if (rate.perSecond == 0)
+   {
+      ++shard.admitted[method];
+      return Admit;
+   }
+
+   // a rate of r requests per second adds r thousandths of a token per ms
+   Bucket& bucket = src.buckets[b];
+   const UInt64 capacity = UInt64(rate.burst) * 1000;
+   if (now > bucket.refilled)
+   {
+      const UInt64 tokens = bucket.milliTokens + (now - bucket.refilled) * rate.perSecond;
+      bucket.milliTokens = UInt32(tokens < capacity ? tokens : capacity);
+      bucket.refilled = now;
+   }
+
+   if (bucket.milliTokens >= 1000)
+   {
+      bucket.milliTokens -= 1000;
+      ++shard.admitted[method];
+      return Admit;
+   }
+
+   ++shard.limited[method];
+   if (mBanAfter)
+   {
+      if (now - src.windowStart >= WindowMs)
+      {
+         src.windowStart = now;
+         src.limitedInWindow = 0;
+      }
+      if (++src.limitedInWindow >= mBanAfter)
+      {
+         src.bannedUntil = now + mBanMs;
+         src.limitedInWindow = 0;
+         ++shard.bans;
+         WarningLog(<< "Banning " << Tuple::inet_ntop(source) << " for " << mBanMs
+                    << "ms; it sent " << mBanAfter << " requests over its rate within a second");
+      }
+   }
+   return Limited;
+}
+
+void
+SourceRateLimiter::getStats(Stats& stats) const
+{
+   memset(stats.admitted, 0, sizeof(stats.admitted));
+   memset(stats.limited, 0, sizeof(stats.limited));
+   stats.refusedWhileBanned = 0;
+   stats.bans = 0;
+   stats.evictions = 0;
+   stats.sources = 0;
+   stats.bannedSources = 0;
+   const UInt64 now = Timer::getTimeMs();
+   for (UInt32 n = 0; n < mNumShards; ++n)
+   {
+      const Shard& shard = mShards[n];
+      Lock lock(shard.mutex);
+      for (int m = 0; m < MAX_METHODS; ++m)
+      {
+         stats.admitted[m] += shard.admitted[m];
+         stats.limited[m] += shard.limited[m];
+      }
+      stats.refusedWhileBanned += shard.refusedWhileBanned;
+      stats.bans += shard.bans;
+      stats.evictions += shard.evictions;
+      stats.sources += (UInt32)shard.sources.size();
+      for (std::vector<Source>::const_iterator i = shard.sources.begin(); i != shard.sources.end(); ++i)
+      {
+         if (i->bannedUntil > now)
+         {
+            ++stats.bannedSources;
+         }
+      }
+   }
+}
+
+void
+SourceRateLimiter::zeroOutStatistics()
+{
+   for (UInt32 n = 0; n < mNumShards; ++n)
+   {
+      Shard& shard = mShards[n];
+      Lock lock(shard.mutex);
+      memset(shard.admitted, 0, sizeof(shard.admitted));
+      memset(shard.limited, 0, sizeof(shard.limited));
+      shard.refusedWhileBanned = 0;
+      shard.bans = 0;
+      shard.evictions = 0;
+   }
+}
+
+EncodeStream&
+SourceRateLimiter::encodeCurrentState(EncodeStream& strm) const
+{
+   Stats stats;
+   getStats(stats);
+   strm << "Sources: " << stats.sources << "/" << mMaxSources
+        << " (" << stats.bannedSources << " banned)"
+        << " Bans: " << stats.bans
+        << " Refused while banned: " << stats.refusedWhileBanned
+        << " Evictions: " << stats.evictions << std::endl;
+   for (int m = 0; m < MAX_METHODS; ++m)
+   {
+      if (stats.admitted[m] || stats.limited[m])
+      {
+         strm << getMethodName(MethodTypes(m)) << ": admitted=" << stats.admitted[m]
+              << " limited=" << stats.limited[m] << std::endl;
+      }
+   }
+   strm.flush();
+   return strm;
+}
+
+void
+SourceRateLimiter::lockShards() const
+{
+   // always in the same order
+   for (UInt32 n = 0; n < mNumShards; ++n)
+   {
+      mShards[n].mutex.lock();
+   }
+}
+
+void
+SourceRateLimiter::unlockShards() const
+{
+   for (UInt32 n = mNumShards; n > 0; --n)
+   {
+      mShards[n - 1].mutex.unlock();
+   }
+}
+
+size_t
+SourceRateLimiter::hashAddress(const unsigned char* address, UInt8 length)
+{
+   return Data::rawHash(address, length);
+}
+
+UInt32
+SourceRateLimiter::find(const Shard& shard, const unsigned char* address, UInt8 length, size_t hash) const
+{
+   if (shard.hashHeads.empty())
+   {
+      return Nil;
+   }
+   for (UInt32 i = shard.hashHeads[hash & (shard.hashHeads.size() - 1)]; i != Nil; i = shard.sources[i].hashNext)
+   {
+      const Source& src = shard.sources[i];
+      if (src.addressLength == length && memcmp(src.address, address, length) == 0)
+      {
+         return i;
+      }
+   }
+   return Nil;
+}
+
+UInt32
+SourceRateLimiter::insert(Shard& shard, const unsigned char* address, UInt8 length, size_t hash, UInt64 now)
+{
+   if (shard.hashHeads.empty())
+   {
+      size_t heads = 1;
+      while (heads < mMaxSourcesPerShard)
+      {
+         heads <<= 1;
+      }
+      shard.hashHeads.assign(heads, Nil);
+      shard.sources.reserve(mMaxSourcesPerShard);
+   }
+
+   UInt32 index;
+   if (shard.sources.size() < mMaxSourcesPerShard)
+   {
+      index = (UInt32)shard.sources.size();
+      shard.sources.push_back(Source());
+   }
+   else
+   {
+      // forget whoever we heard from least recently
+      index = shard.lruTail;
+      const Source& old = shard.sources[index];
+      unlinkHash(shard, index, hashAddress(old.address, old.addressLength));
+      unlinkLru(shard, index);
+      ++shard.evictions;
+   }
+
+   Source& src = shard.sources[index];
+   memcpy(src.address, address, length);
+   src.addressLength = length;
+   src.bannedUntil = 0;
+   src.windowStart = now;
+   src.limitedInWindow = 0;
+   for (int b = 0; b < mNumRates; ++b)
+   {
+      src.buckets[b].refilled = now;
+      src.buckets[b].milliTokens = mRates[b].burst * 1000;
+   }
+
+   UInt32& head = shard.hashHeads[hash & (shard.hashHeads.size() - 1)];
+   src.hashNext = head;
+   head = index;
+   pushFrontLru(shard, index);
+   return index;
+}
+
+void
+SourceRateLimiter::unlinkHash(Shard& shard, UInt32 index, size_t hash)
+{
+   UInt32* link = &shard.hashHeads[hash & (shard.hashHeads.size() - 1)];
+   while (*link != index)
+   {
+      resip_assert(*link != Nil);
+      link = &shard.sources[*link].hashNext;
+   }
+   *link = shard.sources[index].hashNext;
+}
+
+void
+SourceRateLimiter::unlinkLru(Shard& shard, UInt32 index)
+{
+   Source& src = shard.sources[index];
+   if (src.lruPrev != Nil)
+   {
+      shard.sources[src.lruPrev].lruNext = src.lruNext;
+   }
+   else
+   {
+      shard.lruHead = src.lruNext;
+   }
+   if (src.lruNext != Nil)
+   {
+      shard.sources[src.lruNext].lruPrev = src.lruPrev;
+   }
+   else
+   {
+      shard.lruTail = src.lruPrev;
+   }
+}
+
+void
+SourceRateLimiter::pushFrontLru(Shard& shard, UInt32 index)
+{
+   Source& src = shard.sources[index];
+   src.lruPrev = Nil;
+   src.lruNext = shard.lruHead;
+   if (shard.lruHead != Nil)
+   {
+      shard.sources[shard.lruHead].lruPrev = index;
+   }
+   shard.lruHead = index;
+   if (shard.lruTail == Nil)
+   {
+      shard.lruTail = index;
+   }
+}
+
+/* ====================================================================
+ * The Vovida Software License, Version 1.0
+ *
+ * Copyright (c) 2000 Vovida Networks, Inc.  All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * 3. The names "VOCAL", "Vovida Open Communication Application Library",
+ *    and "Vovida Open Communication Application Library (VOCAL)" must
+ *    not be used to endorse or promote products derived from this
+ *    software without prior written permission. For written
+ *    permission, please contact vocal@vovida.org.
+ *
+ * 4. Products derived from this software may not be called "VOCAL", nor
+ *    may "VOCAL" appear in their name, without prior written
+ *    permission of Vovida Networks, Inc.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS" AND ANY EXPRESSED OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, TITLE AND
+ * NON-INFRINGEMENT ARE DISCLAIMED.  IN NO EVENT SHALL VOVIDA
+ * NETWORKS, INC. OR ITS CONTRIBUTORS BE LIABLE FOR ANY DIRECT DAMAGES
+ * IN EXCESS OF $1,000, NOR FOR ANY INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+ * USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+ * DAMAGE.
+ *
+ * ====================================================================
+ *
+ * This software consists of voluntary contributions made by Vovida
+ * Networks, Inc. and many individuals on behalf of Vovida Networks,
+ * Inc.  For more information on Vovida Networks, Inc., please see
+ * <http://www.vovida.org/>.
+ *
+ */
@@ -0,0 +1,219 @@
+#if !defined(RESIP_SOURCERATELIMITER_HXX)
+#define RESIP_SOURCERATELIMITER_HXX
+
+#include <vector>
+
+#include "resip/stack/MethodTypes.hxx"
+#include "rutil/Mutex.hxx"
+#include "rutil/resipfaststreams.hxx"
+
+namespace resip
+{
+
+class Tuple;
+
+/**
+   Per-source admission control for incoming requests. Each source address
+   (the port and transport are not looked at, so a flood can not get around
+   it by opening more connections) has a token bucket per configured method,
+   plus a default bucket that every other method shares. A request that
+   finds its bucket empty is refused; a source that has too many requests
+   refused within a second is banned for a while, and everything it sends,
+   responses included, is refused until the ban runs out.
+
+   Sources are kept in a fixed size hash table, split by address hash into
+   up to MaxShards shards of at least MinSourcesPerShard sources, each with
+   a lock of its own; Transports reading in their own threads only contend
+   when they hear from sources in the same shard. When a shard is full, the
+   source it heard from least recently is forgotten to make room.
+
+   Transports consult it before parsing (see
+   SipStack::setTransportSourceRateLimiter()); refused messages are dropped
+   without an answer, since answering a flood only feeds it. A message that
+   has not been read whole off a stream is counted once its headers are in,
+   and dropped when the rest of it arrives.
+
+   @code
+      std::shared_ptr<SourceRateLimiter> limiter = std::make_shared<SourceRateLimiter>(20, 40);
+      limiter->setMethodRate(INVITE, 5, 10);
+      limiter->setMethodRate(REGISTER, 2, 10);
+      limiter->setBan(100, 60000);
+      stack.setTransportSourceRateLimiter(limiter);
+   @endcode
+*/
+class SourceRateLimiter
+{
+   public:
+      typedef enum
+      {
+         Admit,
+         Limited, // over the rate for its method
+         Banned
+      } Verdict;
+
+      /**
+         @param requestsPerSecond The rate the default bucket fills at; 0
+                means requests that use it are never limited.
+
+         @param burst How many requests the default bucket holds.
+
+         @param maxSources How many sources are tracked at once.
+      */
+      SourceRateLimiter(UInt32 requestsPerSecond, UInt32 burst, UInt32 maxSources = 16384);
+
+      /// Gives method a bucket of its own. Up to MaxMethodRates methods can
+      /// have one; a rate of 0 means the method is never limited.
+      void setMethodRate(MethodTypes method, UInt32 requestsPerSecond, UInt32 burst);
+
+      /// Bans a source for banMs once limitedPerSecond of its requests have
+      /// been refused within a second. A limitedPerSecond of 0 turns bans off.
+      void setBan(UInt32 limitedPerSecond, UInt32 banMs);
+
+      /// method is RESPONSE for a response, which only a ban refuses.
+      Verdict admit(const Tuple& source, MethodTypes method);
+      Verdict admit(const Tuple& source, MethodTypes method, UInt64 now);
+
+      struct Stats
+      {
+         UInt64 admitted[MAX_METHODS];
+         UInt64 limited[MAX_METHODS];
+         UInt64 refusedWhileBanned;
+         UInt64 bans;
+         UInt64 evictions;
+         UInt32 sources;
+         UInt32 bannedSources;
+      };
+      void getStats(Stats& stats) const;
+      void zeroOutStatistics();
+      EncodeStream& encodeCurrentState(EncodeStream& strm) const;
+
+      static const int MaxMethodRates = 7;
+      static const UInt32 MaxShards = 16;
+      static const UInt32 MinSourcesPerShard = 1024;
+
+   private:
+      struct Bucket
+      {
+         UInt64 refilled; // ms
+         UInt32 milliTokens;
+      };
+
+      struct Source
+      {
+         unsigned char address[16];
+         UInt8 addressLength;
+         UInt32 hashNext;
+         UInt32 lruPrev;
+         UInt32 lruNext;
+         UInt64 bannedUntil;
+         UInt64 windowStart;
+         UInt32 limitedInWindow;
+         Bucket buckets[MaxMethodRates + 1];
+      };
+
+      struct Rate
+      {
+         UInt32 perSecond;
+         UInt32 burst;
+      };
+
+      struct Shard
+      {
+         Shard();
+
+         mutable Mutex mutex;
+
+         // the table is allocated on first use
+         std::vector<Source> sources;
+         std::vector<UInt32> hashHeads;
+         UInt32 lruHead; // most recently heard from
+         UInt32 lruTail;
+
+         UInt64 admitted[MAX_METHODS];
+         UInt64 limited[MAX_METHODS];
+         UInt64 refusedWhileBanned;
+         UInt64 bans;
+         UInt64 evictions;
+      };
+
+      Shard& shardFor(size_t hash) { return mShards[(hash >> 24) & (mNumShards - 1)]; }
+      UInt32 find(const Shard& shard, const unsigned char* address, UInt8 length, size_t hash) const;
+      UInt32 insert(Shard& shard, const unsigned char* address, UInt8 length, size_t hash, UInt64 now);
+      void unlinkHash(Shard& shard, UInt32 index, size_t hash);
+      void unlinkLru(Shard& shard, UInt32 index);
+      void pushFrontLru(Shard& shard, UInt32 index);
+      static size_t hashAddress(const unsigned char* address, UInt8 length);
+
+      // the settings are only changed with every shard locked
+      void lockShards() const;
+      void unlockShards() const;
+
+      const UInt32 mMaxSources;
+      UInt32 mNumShards; // a power of two
+      UInt32 mMaxSourcesPerShard;
+      Rate mRates[MaxMethodRates + 1]; // 0 is the default bucket
+      int mNumRates;
+      UInt8 mBucketForMethod[MAX_METHODS];
+      UInt32 mBanAfter;
+      UInt32 mBanMs;
+
+      Shard mShards[MaxShards];
+
+      // not implemented
+      SourceRateLimiter(const SourceRateLimiter&);
+      SourceRateLimiter& operator=(const SourceRateLimiter&);
+};
+
+}
+
+#endif
+
+/* ====================================================================
+ * The Vovida Software License, Version 1.0
+ *
+ * Copyright (c) 2000 Vovida Networks, Inc.  All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * 3. The names "VOCAL", "Vovida Open Communication Application Library",
+ *    and "Vovida Open Communication Application Library (VOCAL)" must
+ *    not be used to endorse or promote products derived from this
+ *    software without prior written permission. For written
+ *    permission, please contact vocal@vovida.org.
+ *
+ * 4. Products derived from this software may not be called "VOCAL", nor
+ *    may "VOCAL" appear in their name, without prior written
+ *    permission of Vovida Networks, Inc.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS" AND ANY EXPRESSED OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, TITLE AND
+ * NON-INFRINGEMENT ARE DISCLAIMED.  IN NO EVENT SHALL VOVIDA
+ * NETWORKS, INC. OR ITS CONTRIBUTORS BE LIABLE FOR ANY DIRECT DAMAGES
+ * IN EXCESS OF $1,000, NOR FOR ANY INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+ * USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+ * DAMAGE.
+ *
+ * ====================================================================
+ *
+ * This software consists of voluntary contributions made by Vovida
+ * Networks, Inc. and many individuals on behalf of Vovida Networks,
+ * Inc.  For more information on Vovida Networks, Inc., please see
+ * <http://www.vovida.org/>.
+ *
+ */
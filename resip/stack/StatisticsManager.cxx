@@ -2,11 +2,14 @@
 #include "config.h"
 #endif
 
+#include <string.h>
+
 #include "rutil/Logger.hxx"
 #include "resip/stack/StatisticsManager.hxx"
 #include "resip/stack/SipMessage.hxx"
 #include "resip/stack/TransactionController.hxx"
 #include "resip/stack/SipStack.hxx"
+#include "resip/stack/TransactionUser.hxx"
 
 using namespace resip;
 using std::vector;
@@ -19,7 +22,9 @@ StatisticsManager::StatisticsManager(SipStack& stack, unsigned long intervalSecs
      mInterval(intervalSecs*1000),
      mNextPoll(Timer::getTimeMs() + mInterval),
      mExternalHandler(NULL),
-     mPublicPayload(NULL)
+     mPublicPayload(NULL),
+     mLatencies(NumLatencies),
+     mCollectedLatencies(NumLatencies)
 {}
 
 StatisticsManager::~StatisticsManager()
@@ -45,6 +50,21 @@ StatisticsManager::poll()
    activeClientTransactions = mStack.mTransactionController->getNumClientTransactions();
    activeServerTransactions = mStack.mTransactionController->getNumServerTransactions();
 
+   mLatencies.collect(&mCollectedLatencies[0]);
+   for (int m = 0; m < MAX_METHODS; ++m)
+   {
+      serverTransactionLatencyByMethod[m] = LatencySummary(mCollectedLatencies[ServerTransactionLatency + m]);
+      clientTransactionLatencyByMethod[m] = LatencySummary(mCollectedLatencies[ClientTransactionLatency + m]);
+   }
+   transportToTuLatency = LatencySummary(mCollectedLatencies[TransportToTuLatency]);
+   tuFifoWaitLatency = LatencySummary(mCollectedLatencies[TuFifoWaitLatency]);
+
+   LoadShedder::Stats shed;
+   mStack.mTransactionController->sumLoadShedderStats(shed);
+   memcpy(shedAdmittedByMethod, shed.admitted, sizeof(shedAdmittedByMethod));
+   memcpy(shedRejectedByMethod, shed.rejected, sizeof(shedRejectedByMethod));
+   memcpy(shedDroppedByMethod, shed.dropped, sizeof(shedDroppedByMethod));
+
    // .kw. At last check payload was > 146kB, which seems too large
    // to alloc on stack. Also, the post'd message has reference
    // to the appStats, so not safe queue as ref to stack element.
@@ -80,6 +100,25 @@ StatisticsManager::poll()
    }
 }
 
+void
+StatisticsManager::zeroOut()
+{
+   StatisticsMessage::Payload::zeroOut();
+   mLatencies.reset();
+}
+
+void
+StatisticsManager::measureWaitTime(TimeLimitFifo<Message>& fifo)
+{
+   fifo.setWaitTimeRecorder(&mLatencies, TuFifoWaitLatency);
+}
+
+void
+StatisticsManager::measureWaitTime(TransactionUser& tu)
+{
+   measureWaitTime(tu.mFifo);
+}
+
 void 
 StatisticsManager::process()
 {
@@ -116,6 +155,28 @@ StatisticsManager::sent(SipMessage* msg)
    return false;
 }
 
+bool
+StatisticsManager::sent(MethodTypes met, bool request, unsigned int code)
+{
+   if (request)
+   {
+      ++requestsSent;
+      ++requestsSentByMethod[met];
+   }
+   else
+   {
+      if (code >= MaxCode)
+      {
+         code = 0;
+      }
+
+      ++responsesSent;
+      ++responsesSentByMethod[met];
+      ++responsesSentByMethodByCode[met][code];
+   }
+   return false;
+}
+
 bool 
 StatisticsManager::retransmitted(MethodTypes met, 
                                  bool request, 
@@ -160,6 +221,26 @@ StatisticsManager::received(SipMessage* msg)
    return false;
 }
 
+void
+StatisticsManager::completed(MethodTypes method, bool client, UInt64 startMicroSec)
+{
+   UInt64 now = Timer::getTimeMicroSec();
+   mLatencies.record((client ? ClientTransactionLatency : ServerTransactionLatency) + method,
+                     now > startMicroSec ? now - startMicroSec : 0);
+}
+
+void
+StatisticsManager::queuedForTu(const Message* msg)
+{
+   const SipMessage* sip = dynamic_cast<const SipMessage*>(msg);
+   if (sip && sip->isExternal())
+   {
+      UInt64 now = Timer::getTimeMicroSec();
+      UInt64 created = sip->getCreatedTimeMicroSec();
+      mLatencies.record(TransportToTuLatency, now > created ? now - created : 0);
+   }
+}
+
 /* ====================================================================
  * The Vovida Software License, Version 1.0 
  * 
@@ -3,6 +3,8 @@
 
 #include "rutil/Timer.hxx"
 #include "rutil/Data.hxx"
+#include "rutil/LatencyHistogram.hxx"
+#include "rutil/TimeLimitFifo.hxx"
 #include "resip/stack/StatisticsMessage.hxx"
 #include "resip/stack/StatisticsHandler.hxx"
 
@@ -10,12 +12,18 @@ namespace resip
 {
 class SipStack;
 class SipMessage;
+class Message;
 class TransactionController;
+class TransactionUser;
 
 /**
    @brief Keeps track of various statistics on the stack's operation, and 
       periodically issues a StatisticsMessage to the TransactionUser (or, if the
       ExternalStatsHandler is set, it will be sent there).
+
+   Latencies are recorded by whichever thread sees them (the transaction
+   thread, or a TU pulling messages off its fifo) into per-thread histograms,
+   and merged into the Payload when the statistics are published.
 */
 class StatisticsManager : public StatisticsMessage::Payload
 {
@@ -50,13 +58,26 @@ class StatisticsManager : public StatisticsMessage::Payload
          mExternalHandler = handler;
       }
 
+      /**
+         Records how long each message waits in fifo, as part of
+         tuFifoWaitLatency.
+      */
+      void measureWaitTime(TimeLimitFifo<Message>& fifo);
+      void measureWaitTime(TransactionUser& tu);
+
    private:
       friend class TransactionState;
       bool sent(SipMessage* msg);
+      // for messages that were encoded without a SipMessage
+      bool sent(MethodTypes type, bool request, unsigned int code);
       bool retransmitted(MethodTypes type, bool request, unsigned int code);
       bool received(SipMessage* msg);
+      // a transaction started at startMicroSec got its first final response
+      void completed(MethodTypes method, bool client, UInt64 startMicroSec);
+      void queuedForTu(const Message* msg);
 
       void poll(); // force an update
+      void zeroOut();
 
       SipStack& mStack;
       UInt64 mInterval;
@@ -69,6 +90,18 @@ class StatisticsManager : public StatisticsMessage::Payload
       // published thru both ExternalHandler and posted to stack as message.
       // This payload is mutex protected.
       StatisticsMessage::AtomicPayload *mPublicPayload;
+
+      // indexes into mLatencies
+      enum
+      {
+         ServerTransactionLatency = 0,
+         ClientTransactionLatency = ServerTransactionLatency + MAX_METHODS,
+         TransportToTuLatency = ClientTransactionLatency + MAX_METHODS,
+         TuFifoWaitLatency,
+         NumLatencies
+      };
+      ConcurrentLatencyHistograms mLatencies;
+      std::vector<LatencyHistogram> mCollectedLatencies;
 };
 
 }
@@ -137,6 +137,16 @@ StatisticsMessage::Payload::zeroOut()
    memset(responsesSentByMethodByCode, 0, sizeof(responsesSentByMethodByCode));
    memset(responsesRetransmittedByMethodByCode, 0, sizeof(responsesRetransmittedByMethodByCode));
    memset(responsesReceivedByMethodByCode, 0, sizeof(responsesReceivedByMethodByCode));
+   for (int m = 0; m < MAX_METHODS; ++m)
+   {
+      serverTransactionLatencyByMethod[m].zeroOut();
+      clientTransactionLatencyByMethod[m].zeroOut();
+   }
+   transportToTuLatency.zeroOut();
+   tuFifoWaitLatency.zeroOut();
+   memset(shedAdmittedByMethod, 0, sizeof(shedAdmittedByMethod));
+   memset(shedRejectedByMethod, 0, sizeof(shedRejectedByMethod));
+   memset(shedDroppedByMethod, 0, sizeof(shedDroppedByMethod));
 }
 
 StatisticsMessage::Payload&
@@ -171,6 +181,16 @@ StatisticsMessage::Payload::operator=(const StatisticsMessage::Payload& rhs)
       memcpy(responsesSentByMethodByCode, rhs.responsesSentByMethodByCode, sizeof(responsesSentByMethodByCode));
       memcpy(responsesRetransmittedByMethodByCode, rhs.responsesRetransmittedByMethodByCode, sizeof(responsesRetransmittedByMethodByCode));
       memcpy(responsesReceivedByMethodByCode, rhs.responsesReceivedByMethodByCode, sizeof(responsesReceivedByMethodByCode));
+      for (int m = 0; m < MAX_METHODS; ++m)
+      {
+         serverTransactionLatencyByMethod[m] = rhs.serverTransactionLatencyByMethod[m];
+         clientTransactionLatencyByMethod[m] = rhs.clientTransactionLatencyByMethod[m];
+      }
+      transportToTuLatency = rhs.transportToTuLatency;
+      tuFifoWaitLatency = rhs.tuFifoWaitLatency;
+      memcpy(shedAdmittedByMethod, rhs.shedAdmittedByMethod, sizeof(shedAdmittedByMethod));
+      memcpy(shedRejectedByMethod, rhs.shedRejectedByMethod, sizeof(shedRejectedByMethod));
+      memcpy(shedDroppedByMethod, rhs.shedDroppedByMethod, sizeof(shedDroppedByMethod));
    }
 
    return *this;
@@ -272,7 +292,40 @@ resip::operator<<(EncodeStream& strm, const StatisticsMessage::Payload& stats)
         << " INFx " << stats.requestsRetransmittedByMethod[INFO]
         << " PRAx " << stats.requestsRetransmittedByMethod[PRACK]
         << " SERx " << stats.requestsRetransmittedByMethod[SERVICE]
-        << " UPDx " << stats.requestsRetransmittedByMethod[UPDATE];
+        << " UPDx " << stats.requestsRetransmittedByMethod[UPDATE]
+        << std::endl
+        << "Latency (us): TRANSPORT->TU ";
+   stats.transportToTuLatency.encode(strm);
+   strm << " TUFIFO ";
+   stats.tuFifoWaitLatency.encode(strm);
+
+   // only the methods that saw any transactions
+   for (int m = 0; m < MAX_METHODS; ++m)
+   {
+      if (stats.serverTransactionLatencyByMethod[m].getCount())
+      {
+         strm << std::endl << "Server transaction latency (us): " << getMethodName((MethodTypes)m) << " ";
+         stats.serverTransactionLatencyByMethod[m].encode(strm);
+      }
+   }
+   for (int m = 0; m < MAX_METHODS; ++m)
+   {
+      if (stats.clientTransactionLatencyByMethod[m].getCount())
+      {
+         strm << std::endl << "Client transaction latency (us): " << getMethodName((MethodTypes)m) << " ";
+         stats.clientTransactionLatencyByMethod[m].encode(strm);
+      }
+   }
+   for (int m = 0; m < MAX_METHODS; ++m)
+   {
+      if (stats.shedAdmittedByMethod[m] || stats.shedRejectedByMethod[m] || stats.shedDroppedByMethod[m])
+      {
+         strm << std::endl << "Shed while congested: " << getMethodName((MethodTypes)m)
+              << " admitted " << stats.shedAdmittedByMethod[m]
+              << " rejected " << stats.shedRejectedByMethod[m]
+              << " dropped " << stats.shedDroppedByMethod[m];
+      }
+   }
    strm.flush();
    return strm;
 }
@@ -6,6 +6,7 @@
 #include "resip/stack/MethodTypes.hxx"
 #include "rutil/Mutex.hxx"
 #include "rutil/HeapInstanceCounter.hxx"
+#include "rutil/LatencyHistogram.hxx"
 
 namespace resip
 {
@@ -56,6 +57,25 @@ class StatisticsMessage : public ApplicationMessage
             unsigned int responsesRetransmittedByMethodByCode[MAX_METHODS][MaxCode];
             unsigned int responsesReceivedByMethodByCode[MAX_METHODS][MaxCode];
 
+            // Latencies, in microseconds.  A server transaction runs from the
+            // request coming off the wire to the first final response going
+            // out; a client transaction from the request being handed to the
+            // stack to the first final response (real or generated, eg. 408)
+            // being queued for the TU.
+            LatencySummary serverTransactionLatencyByMethod[MAX_METHODS];
+            LatencySummary clientTransactionLatencyByMethod[MAX_METHODS];
+            // from a message coming off the wire to it being queued for the TU
+            LatencySummary transportToTuLatency;
+            // time messages spend in TU fifos before the TU picks them up
+            LatencySummary tuFifoWaitLatency;
+
+            // What the transports shed from the raw bytes while congested,
+            // since they were added (see LoadShedder).  Responses are under
+            // RESPONSE.
+            UInt64 shedAdmittedByMethod[MAX_METHODS];
+            UInt64 shedRejectedByMethod[MAX_METHODS];
+            UInt64 shedDroppedByMethod[MAX_METHODS];
+
             unsigned int sum2xxIn(MethodTypes method) const;
             unsigned int sumErrIn(MethodTypes method) const;
             unsigned int sum2xxOut(MethodTypes method) const;
@@ -7,6 +7,10 @@
 #include "resip/stack/TcpConnection.hxx"
 #include "resip/stack/Tuple.hxx"
 
+#if !defined(WIN32)
+#include <sys/uio.h>
+#endif
+
 using namespace resip;
 
 #define RESIPROCATE_SUBSYSTEM Subsystem::TRANSPORT
@@ -108,6 +112,41 @@ TcpConnection::write( const char* buf, const int count )
    return bytesWritten;
 }
 
+int
+TcpConnection::writeBuffers( const WriteBuffer* buffers, int count )
+{
+#if defined(WIN32)
+   return Connection::writeBuffers(buffers, count);
+#else
+   resip_assert(count > 0 && count <= MaxWriteBatchBuffers);
+   if (count == 1)
+   {
+      return write(buffers[0].data, buffers[0].size);
+   }
+
+   struct iovec iov[MaxWriteBatchBuffers];
+   for (int i = 0; i < count; i++)
+   {
+      iov[i].iov_base = const_cast<char*>(buffers[i].data);
+      iov[i].iov_len = buffers[i].size;
+   }
+
+   int bytesWritten = (int)::writev(getSocket(), iov, count);
+   if (bytesWritten == INVALID_SOCKET)
+   {
+      int e = getErrno();
+      if (e == EAGAIN || e == EWOULDBLOCK)
+      {
+          return 0;
+      }
+      InfoLog (<< "Failed writev on " << getSocket() << " " << strerror(e));
+      Transport::error(e);
+      return -1;
+   }
+   return bytesWritten;
+#endif
+}
+
 bool 
 TcpConnection::hasDataToRead()
 {
@@ -175,6 +175,34 @@ TransactionController::getTimeTillNextProcessMS()
 
 void
 TransactionController::send(SipMessage* msg)
+{
+   if(rejectIfCongested(msg))
+   {
+      return;
+   }
+   mStateMacFifo.add(msg);
+}
+
+void
+TransactionController::send(std::vector<SipMessage*>& msgs)
+{
+   Fifo<TransactionMessage>::Messages batch;
+   for(std::vector<SipMessage*>::iterator it = msgs.begin(); it != msgs.end(); ++it)
+   {
+      if(!rejectIfCongested(*it))
+      {
+         batch.push_back(*it);
+      }
+   }
+   msgs.clear();
+   if(!batch.empty())
+   {
+      mStateMacFifo.addMultiple(batch);
+   }
+}
+
+bool
+TransactionController::rejectIfCongested(SipMessage* msg)
 {
    if(msg->isRequest() && 
       msg->method() != ACK && 
@@ -186,9 +214,9 @@ TransactionController::send(SipMessage* msg)
       resp->setTransactionUser(msg->getTransactionUser());
       mTuSelector.add(resp, TimeLimitFifo<Message>::InternalElement);
       delete msg;
-      return;
+      return true;
    }
-   mStateMacFifo.add(msg);
+   return false;
 }
 
 
@@ -204,6 +232,12 @@ TransactionController::sumTransportFifoSizes() const
    return mTransportSelector.sumTransportFifoSizes();
 }
 
+void
+TransactionController::sumLoadShedderStats(LoadShedder::Stats& stats) const
+{
+   mTransportSelector.sumLoadShedderStats(stats);
+}
+
 unsigned int 
 TransactionController::getTransactionFifoSize() const
 {
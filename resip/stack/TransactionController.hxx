@@ -9,6 +9,8 @@
 
 #include "rutil/ConsumerFifoBuffer.hxx"
 
+#include <vector>
+
 namespace resip
 {
 
@@ -42,9 +44,12 @@ class TransactionController
       bool isTUOverloaded() const;
       
       void send(SipMessage* msg);
+      // Queues all of msgs to the state machine fifo at once, takes ownership
+      void send(std::vector<SipMessage*>& msgs);
 
       unsigned int getTuFifoSize() const;
       unsigned int sumTransportFifoSizes() const;
+      void sumLoadShedderStats(LoadShedder::Stats& stats) const;
       unsigned int getTransactionFifoSize() const;
       unsigned int getNumClientTransactions() const;
       unsigned int getNumServerTransactions() const;
@@ -108,6 +113,8 @@ class TransactionController
    private:
       TransactionController(const TransactionController& rhs);
       TransactionController& operator=(const TransactionController& rhs);
+      // 503s msg back to its TU and deletes it if the stack is congested
+      bool rejectIfCongested(SipMessage* msg);
       SipStack& mStack;
       
       // If true, indicate to the Transaction to ignore responses for which
@@ -65,12 +65,14 @@ TransactionState::TransactionState(TransactionController& controller, Machine m,
    mMethodText(method==UNKNOWN ? new Data(methodText) : 0),
    mCurrentMethodType(UNKNOWN),
    mCurrentResponseCode(0),
+   mMsgToRetransmitUnsent(false),
    mAckIsValid(false),
    mPendingOperation(None),
    mTransactionUser(tu),
    mFailureReason(TransportFailure::None),
    mFailureSubCode(0),
-   mTcpConnectTimerStarted(false)
+   mTcpConnectTimerStarted(false),
+   mStartTimeMicroSec(Timer::getTimeMicroSec())
 {
    StackLog (<< "Creating new TransactionState: " << *this);
 }
@@ -228,10 +230,11 @@ TransactionState::processSipMessageAsNew(SipMessage* sip, TransactionController&
                                                             Data::Empty,
                                                             tu);
 
-            state->mNextTransmission = state->make100(sip);
+            state->mStartTimeMicroSec = sip->getCreatedTimeMicroSec();
             state->mResponseTarget = sip->getSource(); // UACs source address
             // since we don't want to reply to the source port if rport present 
             state->mResponseTarget.setPort(Helper::getPortForReply(*sip));
+            state->make100(*sip);
             state->mIsReliable = isReliable(state->mResponseTarget.getType());
             state->add(tid);
                
@@ -270,6 +273,7 @@ TransactionState::processSipMessageAsNew(SipMessage* sip, TransactionController&
             {
                resip_assert(matchingInvite);
                TransactionState* state = TransactionState::makeCancelTransaction(matchingInvite, ServerNonInvite, tid);
+               state->mStartTimeMicroSec = sip->getCreatedTimeMicroSec();
                state->startServerNonInviteTimerTrying(*sip,tid);
                state->sendToTU(sip);
                return true;
@@ -284,6 +288,7 @@ TransactionState::processSipMessageAsNew(SipMessage* sip, TransactionController&
                                                             method,
                                                             sip->methodStr(),
                                                             tu);
+            state->mStartTimeMicroSec = sip->getCreatedTimeMicroSec();
             state->mResponseTarget = sip->getSource();
             // since we don't want to reply to the source port if rport present 
             state->mResponseTarget.setPort(Helper::getPortForReply(*sip));
@@ -926,7 +931,7 @@ TransactionState::startServerNonInviteTimerTrying(SipMessage& sip, const Data& t
       duration = Timer::T1;
       while(duration*2<Timer::T2) duration = duration * 2;
    }
-   resetNextTransmission(make100(&sip));  // Store for use when timer expires
+   make100(sip);  // Store for use when timer expires
    mController.mTimers.add(Timer::TimerTrying, tid, duration );  // Start trying timer so that we can send 100 to NITs as recommened in RFC4320
 }
 
@@ -1019,6 +1024,35 @@ void TransactionState::restoreOriginalContactAndVia()
    }
 }
 
+void
+TransactionState::releaseCompletedState(bool keepRetransmission)
+{
+   if(mDnsResult)
+   {
+      mDnsResult->destroy();
+      mDnsResult=0;
+      mPendingOperation=None;
+   }
+   mOriginalContact.reset();
+   mOriginalVia.reset();
+   setPendingCancelReasons(0);
+
+   if(keepRetransmission)
+   {
+      // onSendSuccess() has already deleted the response (or ACK) once
+      // it was encoded; if the send failed we still need mNextTransmission.
+      if(!mMsgToRetransmit.empty())
+      {
+         mMsgToRetransmit.compact();
+      }
+   }
+   else
+   {
+      resetNextTransmission(0);
+      mMsgToRetransmit.release();
+   }
+}
+
 void
 TransactionState::processClientNonInvite(TransactionMessage* msg)
 { 
@@ -1086,13 +1120,7 @@ TransactionState::processClientNonInvite(TransactionMessage* msg)
             mController.mTimers.add(Timer::TimerK, mId, Timer::T4 );
             // !bwc! Got final response in NIT. We don't need to do anything
             // except quietly absorb retransmissions. Dump all state.
-            if(mDnsResult)
-            {
-               mDnsResult->destroy();
-               mDnsResult=0;
-               mPendingOperation=None;
-            }
-            resetNextTransmission(0);
+            releaseCompletedState(false);
          }
       }
       else
@@ -1311,13 +1339,7 @@ TransactionState::processClientInvite(TransactionMessage* msg)
                // !bwc! We have a final response. We don't need either of
                // mMsgToRetransmit or mNextTransmission. We ignore further
                // traffic.
-               resetNextTransmission(0);
-               if(mDnsResult)
-               {
-                  mDnsResult->destroy();
-                  mDnsResult=0;
-                  mPendingOperation=None;
-               }
+               releaseCompletedState(false);
                StackLog (<< "Received 2xx on client invite transaction");
                StackLog (<< *this);
                mController.mTimers.add(Timer::TimerStaleClient, mId, Timer::TS );
@@ -1364,12 +1386,9 @@ TransactionState::processClientInvite(TransactionMessage* msg)
                      resetNextTransmission(ack);
                      sendCurrentToWire();
                      sendToTU(sip); // don't delete msg
-                     if (mDnsResult)
-                     {
-                         mDnsResult->destroy();
-                         mDnsResult = 0;
-                         mPendingOperation = None;
-                     }
+                     // Only the encoded ACK is needed to answer retransmissions
+                     // of the response.
+                     releaseCompletedState(true);
                   }
                   else if (mState == Completed)
                   {
@@ -1576,7 +1595,7 @@ TransactionState::processServerNonInvite(TransactionMessage* msg)
             SipMessage* sip = dynamic_cast<SipMessage*>(msg);
             if (sip && mMsgToRetransmit.empty() && !mNextTransmission)
             {
-               resetNextTransmission(make100(sip));
+               make100(*sip);
             }
             sendCurrentToWire();
          }
@@ -1631,6 +1650,9 @@ TransactionState::processServerNonInvite(TransactionMessage* msg)
                mController.mTimers.add(Timer::TimerJ, mId, 64*Timer::T1 );
                resetNextTransmission(sip);
                sendCurrentToWire();
+               // Timer J is 32s on unreliable transports; keep only the encoded
+               // response for retransmissions of the request.
+               releaseCompletedState(true);
             }
             else if (mState == Completed)
             {
@@ -1776,7 +1798,7 @@ TransactionState::processServerInvite(TransactionMessage* msg)
                // !bwc! If we have nothing to respond with, make something.
                if (mMsgToRetransmit.empty() && !mNextTransmission)
                {
-                  resetNextTransmission(make100(sip));
+                  make100(*sip);
                }
                delete sip;
                sendCurrentToWire();
@@ -1810,7 +1832,7 @@ TransactionState::processServerInvite(TransactionMessage* msg)
                   mController.mTimers.add(Timer::TimerI, mId, Timer::T4 );
                   // !bwc! Got an ACK/failure; we can stop retransmitting
                   // our failure response now.
-                  resetNextTransmission(0);
+                  releaseCompletedState(false);
                   delete sip;
                }
             }
@@ -1882,6 +1904,8 @@ TransactionState::processServerInvite(TransactionMessage* msg)
                   // source Tuple that the request was received on. 
                   //terminateServerTransaction(mId);
                   mMachine = ServerStale;
+                  // The TU retransmits the 2xx, not us.
+                  releaseCompletedState(false);
                   mController.mTimers.add(Timer::TimerStaleServer, mId, Timer::TS );
                }
                else
@@ -1914,6 +1938,7 @@ TransactionState::processServerInvite(TransactionMessage* msg)
                      mController.mTimers.add(Timer::TimerG, mId, Timer::T1 );
                   }
                   sendCurrentToWire(); // don't delete msg
+                  releaseCompletedState(true);
                }
                else
                {
@@ -2006,6 +2031,7 @@ TransactionState::processServerInvite(TransactionMessage* msg)
       if((mState == Trying || mState == Proceeding) && !mIsAbandoned)
       {
          // We need to schedule teardown, and 500 the next retransmission.
+         bool converted = false;
          if(mNextTransmission)
          {
             mMsgToRetransmit.clear();
@@ -2014,6 +2040,27 @@ TransactionState::processServerInvite(TransactionMessage* msg)
             resip_assert(mNextTransmission->const_header(h_StatusLine).statusCode()/100==1);
             mNextTransmission->header(h_StatusLine).statusCode()=500;
             mNextTransmission->header(h_StatusLine).reason()="Server Error";
+            converted = true;
+         }
+         else if(mCurrentResponseCode == 100 && !mMsgToRetransmit.empty())
+         {
+            // Same thing for a 100 we only have encoded (see make100);
+            // swapping the status line is all it takes.
+            Data& raw = mMsgToRetransmit.data;
+            Data::size_type eol = raw.find(Symbols::CRLF);
+            if(eol != Data::npos)
+            {
+               Data failure("SIP/2.0 500 Server Error");
+               failure.append(raw.data() + eol, raw.size() - eol);
+               raw.takeBuf(failure);
+               mCurrentResponseCode = 500;
+               mMsgToRetransmitUnsent = true;
+               converted = true;
+            }
+         }
+
+         if(converted)
+         {
             sendCurrentToWire();
             mAckIsValid=true;
             StackLog (<< "Received failed response in Trying or Proceeding. Start Timer H, move to completed." << *this);
@@ -2026,7 +2073,7 @@ TransactionState::processServerInvite(TransactionMessage* msg)
          }
          else
          {
-            // !bwc! TODO try to convert mMsgToRetransmit if present.
+            // !bwc! TODO try to convert other 1xx in mMsgToRetransmit.
             if(mIsReliable)
             {
                // We will never see another retransmission of the INVITE. We
@@ -2590,10 +2637,25 @@ TransactionState::sendCurrentToWire()
    {
       if(mController.mStack.statisticsManagerEnabled())
       {
-         mController.mStatsManager.retransmitted(mCurrentMethodType, 
-                                                   isClient(), 
-                                                   mCurrentResponseCode);
+         if(mMsgToRetransmitUnsent)
+         {
+            mController.mStatsManager.sent(mCurrentMethodType, 
+                                           isClient(), 
+                                           mCurrentResponseCode);
+            if(mCurrentResponseCode >= 200 && mStartTimeMicroSec)
+            {
+               mController.mStatsManager.completed(mMethod, false, mStartTimeMicroSec);
+               mStartTimeMicroSec = 0;
+            }
+         }
+         else
+         {
+            mController.mStatsManager.retransmitted(mCurrentMethodType, 
+                                                      isClient(), 
+                                                      mCurrentResponseCode);
+         }
       }
+      mMsgToRetransmitUnsent = false;
 
       mController.mTransportSelector.retransmit(mMsgToRetransmit);
    }
@@ -2724,6 +2786,15 @@ TransactionState::onSendSuccess()
    if(sip->isResponse())
    {
       mCurrentResponseCode = sip->const_header(h_StatusLine).statusCode();
+      if(mCurrentResponseCode >= 200 && mStartTimeMicroSec &&
+         (mMachine == ServerInvite || mMachine == ServerNonInvite))
+      {
+         if(mController.mStack.statisticsManagerEnabled())
+         {
+            mController.mStatsManager.completed(mMethod, false, mStartTimeMicroSec);
+         }
+         mStartTimeMicroSec = 0;
+      }
    }
 
    // !bwc! If mNextTransmission is a non-ACK request, we need to save the
@@ -2776,6 +2847,17 @@ TransactionState::sendToTU(TransactionMessage* msg)
       }
    }
 
+   if (sipMsg && sipMsg->isResponse() && mStartTimeMicroSec &&
+       (mMachine == ClientInvite || mMachine == ClientNonInvite) &&
+       sipMsg->const_header(h_StatusLine).statusCode() >= 200)
+   {
+      if(mController.mStack.statisticsManagerEnabled())
+      {
+         mController.mStatsManager.completed(mMethod, true, mStartTimeMicroSec);
+      }
+      mStartTimeMicroSec = 0;
+   }
+
    CongestionManager::RejectionBehavior behavior=CongestionManager::NORMAL;
    behavior=mController.mTuSelector.getRejectionBehavior(mTransactionUser);
 
@@ -2846,13 +2928,28 @@ void
 TransactionState::sendToTU(TransactionUser* tu, TransactionController& controller, TransactionMessage* msg) 
 {   
    msg->setTransactionUser(tu);
+   if(controller.mStack.statisticsManagerEnabled())
+   {
+      controller.mStatsManager.queuedForTu(msg);
+   }
    controller.mTuSelector.add(msg, TimeLimitFifo<Message>::InternalElement);
 }
 
-SipMessage*
-TransactionState::make100(SipMessage* request) const
+void
+TransactionState::make100(SipMessage& request)
 {
-   return (Helper::makeResponse(*request, 100));
+   resetNextTransmission(0);
+   if(mController.mTransportSelector.make100(request, mResponseTarget, mMsgToRetransmit))
+   {
+      mCurrentMethodType = mMethod;
+      mCurrentResponseCode = 100;
+      mMsgToRetransmitUnsent = true;
+   }
+   else
+   {
+      // No transport to hand; transmit() will sort it out.
+      mNextTransmission = Helper::makeResponse(request, 100);
+   }
 }
 
 void
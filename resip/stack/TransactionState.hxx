@@ -115,7 +115,9 @@ class TransactionState : public DnsHandler
       static void sendToTU(TransactionUser* tu, TransactionController& controller, TransactionMessage* msg);
       void sendCurrentToWire();
       void onSendSuccess();
-      SipMessage* make100(SipMessage* request) const;
+      // Puts a 100 for request in mMsgToRetransmit, copied from the request's
+      // bytes rather than built as a SipMessage. mResponseTarget must be set.
+      void make100(SipMessage& request);
       void terminateClientTransaction(const Data& tid); 
       void terminateServerTransaction(const Data& tid); 
       const Data& tid(SipMessage* sip) const;
@@ -140,7 +142,12 @@ class TransactionState : public DnsHandler
          delete mNextTransmission;
          mNextTransmission=msg;
          mMsgToRetransmit.clear();
+         mMsgToRetransmitUnsent=false;
       }
+      // Called on entering a state that only absorbs retransmissions until a
+      // timer fires. Frees everything except the key and, if keepRetransmission
+      // is true, the encoded message in mMsgToRetransmit.
+      void releaseCompletedState(bool keepRetransmission);
 
       static bool processSipMessageAsNew(resip::SipMessage* sip, 
                                          resip::TransactionController& controller,
@@ -186,6 +193,8 @@ class TransactionState : public DnsHandler
       // These two apply to the message we're currently retransmitting.
       MethodTypes mCurrentMethodType;
       unsigned int mCurrentResponseCode;
+      // mMsgToRetransmit was encoded by make100() and is not on the wire yet
+      bool mMsgToRetransmitUnsent;
 
       bool mAckIsValid;
       PendingOperation mPendingOperation;
@@ -194,6 +203,10 @@ class TransactionState : public DnsHandler
       int mFailureSubCode;
       bool mTcpConnectTimerStarted;
 
+      // When the transaction started, for the latency statistics; 0 once
+      // the first final response has been recorded.
+      UInt64 mStartTimeMicroSec;
+
       static UInt32 StatelessIdCounter;
       
       friend EncodeStream& operator<<(EncodeStream& strm, const TransactionState& state);
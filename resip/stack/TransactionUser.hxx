@@ -265,6 +265,7 @@ class TransactionUser
       bool mRegisteredForConnectionTermination;
       bool mRegisteredForKeepAlivePongs;
       friend class TuSelector;      
+      friend class StatisticsManager;
 };
 
 EncodeStream& 
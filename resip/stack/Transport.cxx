@@ -275,6 +275,73 @@ Transport::makeFailedResponse(const SipMessage& msg,
   send(makeSendData(dest, encoded, Data::Empty, remoteSigcompId));
 }
 
+bool
+Transport::shedIncoming(const char* buffer,
+                        size_t& length,
+                        const Tuple& source,
+                        bool stream,
+                        CongestionManager::RejectionBehavior behavior,
+                        bool* counted)
+{
+   if (mSourceRateLimiter)
+   {
+      MethodTypes method = UNKNOWN;
+      size_t used = 0;
+      // On a stream we can only skip what we can frame; the rest is
+      // counted by the connection once its headers are in.
+      if (LoadShedder::peekFrame(buffer, length, stream, method, used))
+      {
+         if (counted)
+         {
+            *counted = true;
+         }
+         if (limitIncoming(source, method))
+         {
+            length = used;
+            return true;
+         }
+      }
+   }
+
+   if (behavior == CongestionManager::NORMAL || mCompression.isEnabled())
+   {
+      // With sigcomp, the compartment for the 503 comes out of the
+      // parsed Via; make503() takes care of that after the parse.
+      return false;
+   }
+
+   Data response;
+   size_t used = 0;
+   LoadShedder::Verdict verdict = mLoadShedder.classify(buffer, length, stream, behavior,
+                                                        getExpectedWaitForIncoming()/1000,
+                                                        response, used);
+   if (verdict == LoadShedder::Admit)
+   {
+      return false;
+   }
+
+   if (!response.empty())
+   {
+      std::unique_ptr<SendData> tryLater(makeSendData(source, Data::Empty, Data::Empty));
+      tryLater->data.takeBuf(response);
+      send(std::move(tryLater));
+   }
+   length = used;
+   return true;
+}
+
+bool
+Transport::limitIncoming(const Tuple& source, MethodTypes method)
+{
+   if (mSourceRateLimiter &&
+       mSourceRateLimiter->admit(source, method) != SourceRateLimiter::Admit)
+   {
+      StackLog(<< "Dropping " << getMethodName(method) << " from " << source << "; over its rate");
+      return true;
+   }
+   return false;
+}
+
 std::unique_ptr<SendData>
 Transport::make503(SipMessage& msg, UInt16 retryAfter)
 {
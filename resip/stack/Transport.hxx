@@ -10,6 +10,8 @@
 #include "resip/stack/Tuple.hxx"
 #include "resip/stack/NameAddr.hxx"
 #include "resip/stack/Compression.hxx"
+#include "resip/stack/LoadShedder.hxx"
+#include "resip/stack/SourceRateLimiter.hxx"
 #include "resip/stack/SendData.hxx"
 
 #include <memory>
@@ -378,11 +380,45 @@ class Transport : public FdSetIOObserver
           mStateMachineFifo.flush();
       }
 
+      // in milliseconds
       UInt32 getExpectedWaitForIncoming() const
       {
-         return (UInt32)mStateMachineFifo.getFifo().expectedWaitTimeMilliSec()/1000;
+         return (UInt32)mStateMachineFifo.getFifo().expectedWaitTimeMilliSec();
       }
 
+      /**
+         Called with the raw bytes of an incoming message, before they are
+         scanned. Drops what the SourceRateLimiter (if any) refuses and, while
+         congested, turns away what it can without building a SipMessage (see
+         LoadShedder); a 503 is sent from here if one is called for.
+
+         @param behavior The rejection behavior to shed with; a connection
+                passes its own, which also accounts for its send queue.
+
+         @param counted If given, set to true when the SourceRateLimiter has
+                counted the message. On a stream it can only do that once the
+                whole message has been read; otherwise the caller is expected
+                to call limitIncoming() when the headers are in.
+
+         @return true if the message was shed, in which case length is set
+                 to the number of bytes it took up.
+      */
+      bool shedIncoming(const char* buffer,
+                        size_t& length,
+                        const Tuple& source,
+                        bool stream,
+                        CongestionManager::RejectionBehavior behavior,
+                        bool* counted = 0);
+
+      /// Counts a message against the SourceRateLimiter, if there is one.
+      /// @return true if it is to be dropped.
+      bool limitIncoming(const Tuple& source, MethodTypes method);
+
+      const LoadShedder& getLoadShedder() const { return mLoadShedder; }
+
+      void setSourceRateLimiter(std::shared_ptr<SourceRateLimiter> limiter) { mSourceRateLimiter = std::move(limiter); }
+      SourceRateLimiter* getSourceRateLimiter() const { return mSourceRateLimiter.get(); }
+
       // called by Connection to deliver a received message
       virtual void pushRxMsgUp(SipMessage* msg);
 
@@ -408,6 +444,8 @@ class Transport : public FdSetIOObserver
 
       Data mTlsDomain;
       std::shared_ptr<SipMessageLoggingHandler> mSipMessageLoggingHandler;
+      LoadShedder mLoadShedder;
+      std::shared_ptr<SourceRateLimiter> mSourceRateLimiter;
 
    protected:
       AfterSocketCreationFuncPtr mSocketFunc;
@@ -1426,6 +1426,15 @@ TransportSelector::sumTransportFifoSizes() const
    return sum;
 }
 
+void
+TransportSelector::sumLoadShedderStats(LoadShedder::Stats& stats) const
+{
+   for(TransportKeyMap::const_iterator it = mTransports.begin(); it != mTransports.end(); it++)
+   {
+      it->second->getLoadShedder().addStats(stats);
+   }
+}
+
 void 
 TransportSelector::terminateFlow(const resip::Tuple& flow)
 {
@@ -1464,6 +1473,28 @@ TransportSelector::invokeAfterSocketCreationFunc(TransportType type)
     }
 }
 
+bool
+TransportSelector::make100(SipMessage& request, const Tuple& target, SendData& sendData)
+{
+   Transport* transport = target.mTransportKey ? findTransportByDest(target) : 0;
+   if(!transport)
+   {
+      return false;
+   }
+
+   std::unique_ptr<SendData> trying(transport->make100(request));
+   if(!trying.get())
+   {
+      return false;
+   }
+
+   sendData.destination = target;
+   sendData.transactionId = request.getTransactionId();
+   sendData.sigcompId = trying->sigcompId;
+   sendData.data.takeBuf(trying->data);
+   return true;
+}
+
 Transport*
 TransportSelector::findTransportByDest(const Tuple& target)
 {
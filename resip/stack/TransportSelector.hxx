@@ -119,9 +119,15 @@ class TransportSelector
       /// Resend to the same transport as last time
       void retransmit(const SendData& msg);
 
+      /// Encodes a 100 to request into sendData, straight from the request's
+      /// bytes, ready for retransmit() to target. Returns false if target has
+      /// no transport.
+      bool make100(SipMessage& request, const Tuple& target, SendData& sendData);
+
       void closeConnection(const Tuple& peer);
 
       unsigned int sumTransportFifoSizes() const;
+      void sumLoadShedderStats(LoadShedder::Stats& stats) const;
 
       unsigned int getTimeTillNextProcessMS();
       Fifo<TransactionMessage>& stateMacFifo() { return mStateMacFifo; }
@@ -26,6 +26,12 @@ TuSelector::TuSelector(TimeLimitFifo<Message>& fallBackFifo) :
 TuSelector::~TuSelector()
 {
    //assert(mTuList.empty());
+   // The StatisticsManager measuring their fifos goes away with the stack;
+   // the TUs might not.
+   for(TuList::iterator it = mTuList.begin(); it != mTuList.end(); it++)
+   {
+      it->tu->mFifo.setWaitTimeRecorder(0, 0);
+   }
 }
 
 
@@ -225,6 +231,7 @@ TuSelector::remove(TransactionUser* tu)
    {
       if (it->tu == tu)
       {
+         tu->mFifo.setWaitTimeRecorder(0, 0);
          TransactionUserMessage* done = new TransactionUserMessage(TransactionUserMessage::TransactionUserRemoved, tu);
          tu->post(done);
          mTuList.erase(it);
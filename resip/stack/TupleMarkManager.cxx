@@ -10,18 +10,18 @@ namespace resip
 TupleMarkManager::MarkType 
 TupleMarkManager::getMarkType(const Tuple& tuple)
 {
-   ListEntry entry(tuple,0);
-   TupleList::iterator i=mList.find(entry);
+   TupleList::iterator i=mList.find(tuple);
    
    if(i!=mList.end())
    {
       UInt64 now=Timer::getTimeMs();
-      if(i->first.mExpiry > now)
+      if(i->second.mExpiry > now)
       {
-         return i->second;
+         return i->second.mMark;
       }
       else
       {
+         // expired since the last sweep
          mList.erase(i);
          // ?bwc? Should we do this?
          UInt64 expiry = 0;
@@ -37,8 +37,30 @@ void TupleMarkManager::mark(const Tuple& tuple,UInt64 expiry,MarkType mark)
 {
    // .amr. Notify listeners first so they can change the entry if they want
    notifyListeners(tuple,expiry,mark);
-   ListEntry entry(tuple,expiry);
-   mList[entry]=mark;
+   Mark& m=mList[tuple];
+   m.mExpiry=expiry;
+   m.mMark=mark;
+   mExpiries.push(Expiry(expiry,tuple));
+}
+
+void 
+TupleMarkManager::expire(UInt64 now)
+{
+   while(!mExpiries.empty() && mExpiries.top().first <= now)
+   {
+      // listeners may mark again, so we are done with the queue before
+      // telling them
+      Tuple tuple(mExpiries.top().second);
+      mExpiries.pop();
+      TupleList::iterator i=mList.find(tuple);
+      if(i!=mList.end() && i->second.mExpiry <= now)
+      {
+         mList.erase(i);
+         UInt64 expiry = 0;
+         MarkType mark = OK;
+         notifyListeners(tuple,expiry,mark);
+      }
+   }
 }
 
 void TupleMarkManager::registerMarkListener(MarkListener* listener)
@@ -60,55 +82,6 @@ TupleMarkManager::notifyListeners(const resip::Tuple& tuple, UInt64& expiry, Mar
    }
 }
 
-TupleMarkManager::ListEntry::ListEntry(const Tuple& tuple, UInt64 expiry)
-   : mTuple(tuple),
-   mExpiry(expiry)
-{}
-
-TupleMarkManager::ListEntry::ListEntry(const TupleMarkManager::ListEntry& orig)
-   : mTuple(orig.mTuple),
-   mExpiry(orig.mExpiry)
-{}
-
-TupleMarkManager::ListEntry::~ListEntry()
-{}
-
-bool 
-TupleMarkManager::ListEntry::operator<(const TupleMarkManager::ListEntry& rhs) const
-{
-   if(mTuple < rhs.mTuple)
-   {
-      return true;
-   }
-   else if(rhs.mTuple < mTuple)
-   {
-      return false;
-   }
-   
-   return mTuple.getTargetDomain() < rhs.mTuple.getTargetDomain();
-}
-
-bool 
-TupleMarkManager::ListEntry::operator>(const TupleMarkManager::ListEntry& rhs) const
-{
-   if(rhs.mTuple < mTuple)
-   {
-      return true;
-   }
-   else if(mTuple < rhs.mTuple)
-   {
-      return false;
-   }
-   
-   return mTuple.getTargetDomain() > rhs.mTuple.getTargetDomain();
-}
-
-bool 
-TupleMarkManager::ListEntry::operator==(const TupleMarkManager::ListEntry& rhs) const
-{
-   return (mTuple==rhs.mTuple && mTuple.getTargetDomain()==rhs.mTuple.getTargetDomain());
-}
-
 
 }
 
@@ -2,15 +2,24 @@
 #define TUPLE_MARK_MANAGER
 
 #include "resip/stack/Tuple.hxx"
+#include "rutil/HashMap.hxx"
 #include "rutil/Mutex.hxx"
 #include <set>
-#include <map>
+#include <queue>
+#include <vector>
 
 namespace resip
 {
 
 class MarkListener;
 
+/**
+   Keeps the grey and black marks DnsResult puts on targets that failed.
+   Marks are held in a hash table, and are swept out as they expire by
+   expire(), which DnsInterface calls from the DNS thread about once a
+   second; listeners are told about those as if the target had been marked
+   OK. All access must be from the DNS thread.
+*/
 class TupleMarkManager
 {
    public:
@@ -31,26 +40,50 @@ class TupleMarkManager
       void registerMarkListener(MarkListener*);
       void unregisterMarkListener(MarkListener*);
 
+      /// Drops every mark that has expired by now.
+      void expire(UInt64 now);
+
+      size_t size() const { return mList.size(); }
+
    private:
       
-      class ListEntry
+      // a mark is on the Tuple and the target domain it was resolved from
+      class TupleHash
       {
          public:
-            ListEntry(const Tuple& tuple, UInt64 expiry);
-            ListEntry(const ListEntry& orig);
-            ~ListEntry();
-            bool operator<(const ListEntry& rhs) const;
-            bool operator>(const ListEntry& rhs) const;
-            bool operator==(const ListEntry& rhs) const;
-            
-            Tuple mTuple;
+            size_t operator()(const Tuple& tuple) const { return tuple.hash() ^ tuple.getTargetDomain().hash(); }
+      };
+
+      class TupleEqual
+      {
+         public:
+            bool operator()(const Tuple& lhs, const Tuple& rhs) const
+            {
+               return lhs==rhs && lhs.getTargetDomain()==rhs.getTargetDomain();
+            }
+      };
+
+      class Mark
+      {
+         public:
+            Mark() : mExpiry(0), mMark(OK) {}
             UInt64 mExpiry;
-         private:
-            ListEntry();
+            MarkType mMark;
       };
       
-      typedef std::map<ListEntry,MarkType> TupleList;
+      typedef HashMap<Tuple,Mark,TupleHash,TupleEqual> TupleList;
       TupleList mList;
+
+      // When each mark was due to expire, soonest first. A tuple that is
+      // marked again is left in here under its old expiry too; expire()
+      // skips those.
+      typedef std::pair<UInt64,Tuple> Expiry;
+      class ExpiryLater
+      {
+         public:
+            bool operator()(const Expiry& lhs, const Expiry& rhs) const { return lhs.first > rhs.first; }
+      };
+      std::priority_queue<Expiry,std::vector<Expiry>,ExpiryLater> mExpiries;
             
       typedef std::set<MarkListener*> Listeners;
       Listeners mListeners;
@@ -567,6 +567,14 @@ UdpTransport::processRxParse(char *buffer, int len, Tuple& sender)
 
    buffer[len]=0; // null terminate the buffer string just to make debug easier and reduce errors
 
+   // A shed datagram leaves the buffer free for reuse
+   size_t shed = len;
+   if (origBufferConsumed &&
+       shedIncoming(buffer, shed, sender, false, getRejectionBehaviorForIncoming()))
+   {
+      return false;
+   }
+
    //DebugLog ( << "UDP Rcv : " << len << " b" );
    //DebugLog ( << Data(buffer, len).escaped().c_str());
 
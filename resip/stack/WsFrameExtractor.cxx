@@ -1,6 +1,9 @@
+#include <string.h>
 
 #include "rutil/Logger.hxx"
+#include "rutil/ResipAssert.h"
 #include "resip/stack/WsFrameExtractor.hxx"
+#include "resip/stack/MsgHeaderScanner.hxx"
 #include "rutil/WinLeakCheck.hxx"
 
 using namespace resip;
@@ -12,9 +15,18 @@ const int WsFrameExtractor::mMaxHeaderLen = 14;
 
 WsFrameExtractor::WsFrameExtractor(Data::size_type maxMessage)
    : mMaxMessage(maxMessage),
+     mInput(0),
+     mInputLen(0),
+     mInputPos(0),
+     mMessage(0),
+     mMessageCapacity(0),
      mMessageSize(0),
      mHaveHeader(false),
-     mHeaderLen(0)
+     mHeaderLen(0),
+     mFinalFrame(false),
+     mMasked(false),
+     mPayloadLength(0),
+     mPayloadPos(0)
 {
    // we re-use this for multiple messages throughout
    // the lifetime of this parser object
@@ -23,120 +35,179 @@ WsFrameExtractor::WsFrameExtractor(Data::size_type maxMessage)
 
 WsFrameExtractor::~WsFrameExtractor()
 {
-   // FIXME - delete any objects left in the queues
    delete [] mWsHeader;
-
-   while(!mFrames.empty()) 
-   {
-      delete [] mFrames.front()->data();
-      delete mFrames.front();
-      mFrames.pop();
-   }
-      
-   while(!mMessages.empty())
-   {
-      delete [] mMessages.front()->data();
-      delete mMessages.front();
-      mMessages.pop();
-   }
-
+   delete [] mMessage;
 }
 
-std::unique_ptr<Data>
-WsFrameExtractor::processBytes(UInt8 *input, Data::size_type len, bool& dropConnection)
+char*
+WsFrameExtractor::processBytes(const UInt8 *input, Data::size_type len,
+                               Data::size_type& messageLength, bool& dropConnection)
 {
-   std::unique_ptr<Data> ret;
    dropConnection = false;
-   Data::size_type pos = 0;
-   while(input != 0 && pos < len)
+   messageLength = 0;
+   if(input != 0)
    {
-      while(!mHaveHeader && pos < len)
+      resip_assert(mInput == 0);
+      mInput = input;
+      mInputLen = len;
+      mInputPos = 0;
+   }
+
+   while(mInput != 0 && mInputPos < mInputLen)
+   {
+      while(!mHaveHeader)
       {
          StackLog(<<"Need a header, parsing bytes...");
          // Append bytes to the header buffer
          int needed = parseHeader();
-         if(mHeaderLen >= mMaxHeaderLen)
+         if(needed == 0)
+         {
+            break;
+         }
+         if(mHeaderLen + needed > mMaxHeaderLen)
          {
             WarningLog(<<"WS Frame header too long");
             dropConnection = true;
-            return ret;
+            mInput = 0;
+            return 0;
          }
-         for( ; needed > 0 && pos < len; needed-- )
+         if(mInputPos == mInputLen)
          {
-            mWsHeader[mHeaderLen++] = input[pos++];
+            StackLog(<<"Not enough bytes available to form a full header");
+            mInput = 0;
+            return 0;
          }
-         if(needed > 0)
+         for( ; needed > 0 && mInputPos < mInputLen; needed-- )
          {
-            StackLog(<<"Not enough bytes available to form a full header");
-            return ret;
+            mWsHeader[mHeaderLen++] = mInput[mInputPos++];
          }
       }
-      if(mHaveHeader)
+
+      if(mPayloadPos == 0)
       {
-         StackLog(<<"have header, parsing payload data...");
-         // Process input bytes to output buffer, unmasking if necessary
-         if(mMessageSize + mPayloadLength > mMaxMessage)
+         if(mPayloadLength > mMaxMessage - mMessageSize)
          {
             WarningLog(<<"WS frame header describes a payload size bigger than messageSizeMax, max = " << mMaxMessage 
                  << ", dropping connection");
             dropConnection = true;
-            return ret;
+            mInput = 0;
+            return 0;
          }
+         reserveMessage(mMessageSize + (Data::size_type)mPayloadLength);
+      }
 
-         if(mPayload == 0)
-         {
-            StackLog(<<"starting new frame buffer");
-            // Include an extra byte at the end for null terminator
-            mPayload = (UInt8*)new char[mPayloadLength + 1];
-            mPayloadPos = 0;
-         }
+      StackLog(<<"have header, parsing payload data...");
+      Data::size_type takeBytes = mInputLen - mInputPos;
+      if(takeBytes > mPayloadLength - mPayloadPos)
+      {
+         takeBytes = (Data::size_type)(mPayloadLength - mPayloadPos);
+      }
 
-         Data::size_type takeBytes = len - pos;
-         if(takeBytes > mPayloadLength - mPayloadPos)
-         {
-            takeBytes = mPayloadLength - mPayloadPos;
-         }
+      UInt8* dst = (UInt8*)mMessage + mMessageSize + mPayloadPos;
+      if(mMasked)
+      {
+         unmask(dst, &mInput[mInputPos], takeBytes, mWsMaskKey, mPayloadPos);
+      }
+      else
+      {
+         memcpy(dst, &mInput[mInputPos], takeBytes);
+      }
+      mInputPos += takeBytes;
+      mPayloadPos += takeBytes;
 
-         if(mMasked)
-         {
-            Data::size_type endOffset = mPayloadPos + takeBytes;
-            for( ; mPayloadPos < endOffset; mPayloadPos++)
-            {
-               mPayload[mPayloadPos] = (input[pos++] ^ mWsMaskKey[(mPayloadPos & 3)]);
-            }
-         }
-         else
+      if(mPayloadPos == mPayloadLength)
+      {
+         StackLog(<<"Got a whole frame");
+         mMessageSize += (Data::size_type)mPayloadLength;
+         mHaveHeader = false;
+         mHeaderLen = 0;
+         if(mFinalFrame)
          {
-            memmove(&mPayload[mPayloadPos], &input[pos], takeBytes);
-            pos += takeBytes;
-            mPayloadPos += takeBytes;
-         }
+            char* msg = mMessage;
+            messageLength = mMessageSize;
+            // MsgHeaderScanner expects space for an extra byte at the end:
+            msg[messageLength] = 0;
 
-         if(mPayloadPos == mPayloadLength)
-         {
-            StackLog(<<"Got a whole frame, queueing it");
-            mMessageSize += mPayloadLength;
-            Data *mFrame = new Data(Data::Borrow, (char *)mPayload, mPayloadLength, mPayloadLength + 1);
-            mFrames.push(mFrame);
-            mHaveHeader = false;
-            mHeaderLen = 0;
-            mPayload = 0;
-            if(mFinalFrame)
+            // Ready to start examining first frame of next message...
+            mMessage = 0;
+            mMessageCapacity = 0;
+            mMessageSize = 0;
+            if(mInputPos == mInputLen)
             {
-               joinFrames();
+               mInput = 0;
             }
+            StackLog(<<"returning a message, size = " << messageLength);
+            return msg;
          }
       }
    }
-   if(mMessages.empty())
+
+   StackLog(<<"no full messages available"); 
+   mInput = 0;
+   return 0;
+}
+
+void
+WsFrameExtractor::reserveMessage(Data::size_type size)
+{
+   if(mMessage != 0 && size <= mMessageCapacity)
+   {
+      return;
+   }
+
+   // A message that fits in one frame is sized exactly.  Once it is known 
+   // to be fragmented, grow geometrically (bounded by the message limit).
+   Data::size_type capacity = size;
+   if(!mFinalFrame || mMessage != 0)
+   {
+      Data::size_type grown = mMessage != 0 ? mMessageCapacity * 2 : 2048;
+      if(grown > mMaxMessage)
+      {
+         grown = mMaxMessage;
+      }
+      if(capacity < grown)
+      {
+         capacity = grown;
+      }
+   }
+   
+   // allocateBuffer() leaves room for the null terminator
+   char* buffer = MsgHeaderScanner::allocateBuffer((int)capacity);
+   if(mMessage != 0)
+   {
+      memcpy(buffer, mMessage, mMessageSize);
+      delete [] mMessage;
+   }
+   mMessage = buffer;
+   mMessageCapacity = capacity;
+}
+
+void
+WsFrameExtractor::unmask(UInt8* dst, const UInt8* src, Data::size_type len,
+                         const UInt8 key[4], UInt64 keyOffset)
+{
+   // The key repeats every 4 bytes, so 8 bytes of it lined up with src[0]
+   // can be applied a word at a time (and vectorized by the compiler).
+   UInt8 rotated[8];
+   for(int i = 0; i < 8; ++i)
+   {
+      rotated[i] = key[(keyOffset + i) & 3];
+   }
+   UInt64 key64;
+   memcpy(&key64, rotated, sizeof(key64));
+
+   Data::size_type i = 0;
+   for( ; i + sizeof(key64) <= len; i += sizeof(key64))
+   {
+      UInt64 word;
+      memcpy(&word, src + i, sizeof(word));
+      word ^= key64;
+      memcpy(dst + i, &word, sizeof(word));
+   }
+   for( ; i < len; ++i)
    {
-      StackLog(<<"no full messages available in queue"); 
-      return ret;
+      dst[i] = src[i] ^ rotated[i & 7];
    }
-   ret = std::unique_ptr<Data>(mMessages.front());
-   mMessages.pop();
-   StackLog(<<"returning a message, size = " << ret->size());
-   return ret;
 }
 
 int
@@ -172,12 +243,12 @@ WsFrameExtractor::parseHeader()
    }
    else if(mPayloadLength == 127)
    {
-      if(mHeaderLen < 8)
+      if(mHeaderLen < 10)
       {
          StackLog(<< "Too short to contain ws data [2]");
-         return (8 - mHeaderLen) + (mMasked ? 4 : 0);
+         return (10 - mHeaderLen) + (mMasked ? 4 : 0);
       }
-      mPayloadLength = (((UInt64)mWsHeader[hdrPos]) << 56 | ((UInt64)mWsHeader[hdrPos + 1]) << 48 | ((UInt64)mWsHeader[hdrPos + 2]) << 40 | ((UInt64)mWsHeader[hdrPos + 3]) << 32 | ((UInt64)mWsHeader[hdrPos + 4]) << 24 | ((UInt64)mWsHeader[hdrPos + 5]) << 16 | ((UInt64)mWsHeader[hdrPos + 6]) << 8 || ((UInt64)mWsHeader[hdrPos + 7]));
+      mPayloadLength = (((UInt64)mWsHeader[hdrPos]) << 56 | ((UInt64)mWsHeader[hdrPos + 1]) << 48 | ((UInt64)mWsHeader[hdrPos + 2]) << 40 | ((UInt64)mWsHeader[hdrPos + 3]) << 32 | ((UInt64)mWsHeader[hdrPos + 4]) << 24 | ((UInt64)mWsHeader[hdrPos + 5]) << 16 | ((UInt64)mWsHeader[hdrPos + 6]) << 8 | ((UInt64)mWsHeader[hdrPos + 7]));
       hdrPos += 8;
    }
 
@@ -199,57 +270,10 @@ WsFrameExtractor::parseHeader()
             << ", masked = "<< mMasked << ", final frame = "<< mFinalFrame);
 
    mHaveHeader = true;
-   mPayload = 0;
+   mPayloadPos = 0;
    return 0;
 }
 
-void
-WsFrameExtractor::joinFrames()
-{
-   StackLog(<<"trying to join frames");
-   if(mFrames.empty())
-   {
-      ErrLog(<<"No frames to join!");
-      return;
-   }
-
-   Data *msg = mFrames.front();
-   mFrames.pop();
-   if(!mFrames.empty())
-   {
-      // must expand buffer because there are multiple frames
-      // can't use Data::reserve() to increase the buffer, because the
-      // ShareEnum will change to Take when expanded
-      char *_msg = (char *)msg->data();
-      Data::size_type frameSize = msg->size();
-      delete msg;
-
-      // allow extra byte for null terminator
-      char *newBuf = new char [mMessageSize + 1]; 
-      memcpy(newBuf, _msg, frameSize);
-
-      msg = new Data(Data::Borrow, newBuf, frameSize, mMessageSize + 1);
-   }
-   while(!mFrames.empty())
-   {
-      Data *mFrame = mFrames.front();
-      mFrames.pop();
-      msg->append(mFrame->data(), mFrame->size());
-      delete [] mFrame->data();
-      delete mFrame;
-   }
-
-   // It is safe to cast because we used Borrow:
-   char *_msg = (char *)msg->data();
-   // MsgHeaderScanner expects space for an extra byte at the end:
-   _msg[mMessageSize] = 0;
-
-   mMessages.push(msg);
-
-   // Ready to start examinging first frame of next message...
-   mMessageSize = 0;
-}
-
 /* ====================================================================
  *
  * Copyright 2013 Daniel Pocock.  All rights reserved.
@@ -1,22 +1,50 @@
 #ifndef RESIP_WsFrameExtractor_hxx
 #define RESIP_WsFrameExtractor_hxx
 
-#include <memory>
-#include <queue>
-
 #include "rutil/compat.hxx"
 #include "rutil/Data.hxx"
 
 namespace resip
 {
 
+/**
+   Extracts SIP messages from a stream of WebSocket frames.
+
+   Payload bytes are unmasked straight from the connection's read buffer into
+   a message buffer allocated with MsgHeaderScanner::allocateBuffer, so a
+   message (including one fragmented over several frames) is assembled in
+   the buffer that is later handed to SipMessage::addBuffer.  No per-frame
+   buffers are allocated and no fragments are copied a second time.
+*/
 class WsFrameExtractor
 {
    public:
 
       WsFrameExtractor(Data::size_type maxMessage);
       ~WsFrameExtractor();
-      std::unique_ptr<Data> processBytes(UInt8 *input, Data::size_type len, bool& dropConnection);
+
+      /**
+         Consumes bytes read from the connection.
+
+         Returns the next complete message, or 0 if none is available yet.
+         The returned buffer is allocated with MsgHeaderScanner::allocateBuffer,
+         is null terminated at messageLength, and is owned by the caller.
+
+         Processing stops as soon as a message is complete; call again with
+         input == 0 to continue with the rest of the bytes passed in
+         previously, until 0 is returned.  The input buffer must remain
+         unchanged until then.
+      */
+      char* processBytes(const UInt8 *input, Data::size_type len,
+                         Data::size_type& messageLength, bool& dropConnection);
+
+      /**
+         XORs len bytes of src with the 4 byte WebSocket masking key into dst
+         (which may equal src), where src[0] is at offset keyOffset into the
+         masked payload.  Works a machine word at a time.
+      */
+      static void unmask(UInt8* dst, const UInt8* src, Data::size_type len,
+                         const UInt8 key[4], UInt64 keyOffset);
 
    private:
 
@@ -24,10 +52,16 @@ class WsFrameExtractor
 
       Data::size_type mMaxMessage;
 
-      std::queue<Data*> mFrames;
-      std::queue<Data*> mMessages;
-      // for tracking the cumulative size of all full frames
-      // not yet assembled into a message:
+      // bytes handed to processBytes() that have not been consumed yet
+      const UInt8 *mInput;
+      Data::size_type mInputLen;
+      Data::size_type mInputPos;
+
+      // message being assembled; payload of the current frame is written
+      // at mMessage + mMessageSize + mPayloadPos
+      char *mMessage;
+      Data::size_type mMessageCapacity;
+      // cumulative size of all full frames of the current message
       Data::size_type mMessageSize;
 
       bool mHaveHeader;
@@ -37,13 +71,11 @@ class WsFrameExtractor
       bool mFinalFrame;
       bool mMasked;
       UInt8 mWsMaskKey[4];
-      Data::size_type mPayloadLength;
-
-      UInt8 *mPayload;
-      Data::size_type mPayloadPos;
+      UInt64 mPayloadLength;
+      UInt64 mPayloadPos;
 
       int parseHeader();
-      void joinFrames();
+      void reserveMessage(Data::size_type size);
 
 };
 
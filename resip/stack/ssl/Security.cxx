@@ -155,6 +155,11 @@ BaseSecurity::CipherList BaseSecurity::StrongestSuite("HIGH:-COMPLEMENTOFDEFAULT
  */
 long BaseSecurity::OpenSSLCTXSetOptions = SSL_OP_NO_SSLv2 | SSL_OP_NO_SSLv3;
 long BaseSecurity::OpenSSLCTXClearOptions = 0;
+#ifdef SSL_MODE_RELEASE_BUFFERS
+long BaseSecurity::OpenSSLCTXSetMode = SSL_MODE_RELEASE_BUFFERS;
+#else
+long BaseSecurity::OpenSSLCTXSetMode = 0;
+#endif
 
 Security::Security(const CipherList& cipherSuite, const Data& defaultPrivateKeyPassPhrase, const Data& dHParamsFilename) :
    BaseSecurity(cipherSuite, defaultPrivateKeyPassPhrase, dHParamsFilename)
@@ -403,6 +408,7 @@ Security::createDomainCtx(const SSL_METHOD* method, const Data& domain, const Da
    setDHParams(ctx);
    SSL_CTX_set_options(ctx, BaseSecurity::OpenSSLCTXSetOptions);
    SSL_CTX_clear_options(ctx, BaseSecurity::OpenSSLCTXClearOptions);
+   SSL_CTX_set_mode(ctx, BaseSecurity::OpenSSLCTXSetMode);
 
    return ctx;
 }
@@ -1187,6 +1193,7 @@ BaseSecurity::BaseSecurity (const CipherList& cipherSuite, const Data& defaultPr
    setDHParams(mTlsCtx);
    SSL_CTX_set_options(mTlsCtx, BaseSecurity::OpenSSLCTXSetOptions);
    SSL_CTX_clear_options(mTlsCtx, BaseSecurity::OpenSSLCTXClearOptions);
+   SSL_CTX_set_mode(mTlsCtx, BaseSecurity::OpenSSLCTXSetMode);
    
    mSslCtx = SSL_CTX_new( SSLv23_method() );
    resip_assert(mSslCtx);
@@ -1198,6 +1205,7 @@ BaseSecurity::BaseSecurity (const CipherList& cipherSuite, const Data& defaultPr
    setDHParams(mSslCtx);
    SSL_CTX_set_options(mSslCtx, BaseSecurity::OpenSSLCTXSetOptions);
    SSL_CTX_clear_options(mSslCtx, BaseSecurity::OpenSSLCTXClearOptions);
+   SSL_CTX_set_mode(mSslCtx, BaseSecurity::OpenSSLCTXSetMode);
 }
 
 
@@ -89,6 +89,9 @@ class BaseSecurity
        */
       static long OpenSSLCTXSetOptions;
       static long OpenSSLCTXClearOptions;
+      /// passed to SSL_CTX_set_mode(), by default SSL_MODE_RELEASE_BUFFERS
+      /// so idle TLS connections do not hold OpenSSL's read and write buffers
+      static long OpenSSLCTXSetMode;
 
       BaseSecurity(const CipherList& cipherSuite = StrongestSuite, const Data& defaultPrivateKeyPassPhrase = Data::Empty, const Data& dHParamsFilename = Data::Empty);
       virtual ~BaseSecurity();
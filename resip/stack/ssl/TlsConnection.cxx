@@ -577,6 +577,44 @@ TlsConnection::write( const char* buf, int count )
 }
 
 
+int
+TlsConnection::writeBuffers( const WriteBuffer* buffers, int count )
+{
+   // One SSL_write, and so usually one record, for the whole batch.  A
+   // write that has to be retried must be retried with the same buffer and
+   // length, and more messages may have been queued by then, so everything, 
+   // a single message included, goes out through mWriteBatch and a batch 
+   // that did not go out is sent again as it was.  Nothing of it has been 
+   // taken off the queue, so it still matches the front of the queue.
+   if (mWriteBatch.empty())
+   {
+      for (int i = 0; i < count; i++)
+      {
+         mWriteBatch.append(buffers[i].data, buffers[i].size);
+      }
+   }
+
+   int ret = write(mWriteBatch.data(), (int)mWriteBatch.size());
+   if (ret < 0)
+   {
+      mWriteBatch.clear();
+   }
+   else if (ret > 0)
+   {
+      if (ret < (int)mWriteBatch.size())
+      {
+         // only with SSL_MODE_ENABLE_PARTIAL_WRITE; keep sending the rest 
+         // of this batch first
+         mWriteBatch = mWriteBatch.substr(ret);
+      }
+      else
+      {
+         mWriteBatch.clear();
+      }
+   }
+   return ret;
+}
+
 bool 
 TlsConnection::hasDataToRead() // has data that can be read 
 {
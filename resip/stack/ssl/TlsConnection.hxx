@@ -43,6 +43,7 @@ class TlsConnection : public Connection
 
       int read( char* buf, const int count );
       int write( const char* buf, const int count );
+      int writeBuffers( const WriteBuffer* buffers, int count );
       virtual bool hasDataToRead(); // has data that can be read 
       virtual bool isGood(); // has valid connection
       virtual bool isWritable();
@@ -71,6 +72,8 @@ class TlsConnection : public Connection
 
       SSL* mSsl;
       BIO* mBio;
+      /// buffers joined by writeBuffers(), kept until SSL_write takes them
+      Data mWriteBatch;
       std::list<BaseSecurity::PeerName> mPeerNames;
 };
  
@@ -106,8 +106,20 @@ class TestConnection : public ConnectionBase
          mStreamPos += chunk;
          assert(mStreamPos <= mTestStream.size());
          preparseNewBytes(chunk);
+         releaseIdleBuffer();
          return mStreamPos != mTestStream.size();
       }
+
+      // a read that returned no bytes, eg. during a TLS handshake
+      size_t emptyRead(bool release)
+      {
+         getWriteBuffer();
+         if (release)
+         {
+            releaseIdleBuffer();
+         }
+         return getReadBufferSize();
+      }
       
    private:
       unsigned int chooseChunkSize(unsigned int min, unsigned int max)
@@ -184,6 +196,77 @@ testTCPConnection()
    fake.flush();
    return testRxFifo.size() == runs * 3;
 }
+
+bool
+testIdleBuffer()
+{
+   Data bytes("OPTIONS sip:192.168.2.92:5100 SIP/2.0\r\n"
+         "To: <sip:yiwen_AT_meet2talk.com@whistler.gloo.net>\r\n"
+         "From: Jason Fischl<sip:jason_AT_meet2talk.com@whistler.gloo.net>;tag=ba1aee2d\r\n"
+         "Via: SIP/2.0/TCP 192.168.2.15:5100;branch=z9hG4bK-c87542-579667358-1--c87542-\r\n"
+         "Call-ID: 6c64b42fce01b007\r\n"
+         "CSeq: 1 OPTIONS\r\n"
+         "Content-Length: 0\r\n"
+         "\r\n");
+
+   Fifo<TransactionMessage> testRxFifo;
+   FakeTCPTransport fake(testRxFifo, 5060, V4, Data::Empty);
+   Tuple who(fake.getTuple());
+   TestConnection cBase(&fake, who, bytes);
+
+   size_t before = cBase.emptyRead(false);
+   size_t after = cBase.emptyRead(true);
+   cerr << "read buffer per idle connection: " << before << " bytes kept, "
+        << after << " bytes with releaseIdleBuffer()" << endl;
+   if (before != ConnectionBase::ChunkSize || after != 0)
+   {
+      return false;
+   }
+
+   // a partial message keeps its buffer
+   cBase.read(20, 20);
+   if (cBase.getReadBufferSize() == 0)
+   {
+      return false;
+   }
+   while(cBase.read(20, 20));
+   fake.flush();
+   return cBase.getReadBufferSize() == 0 && testRxFifo.size() == 1;
+}
+
+bool
+testSourceRateLimit(unsigned int chunk)
+{
+   Data options("OPTIONS sip:192.168.2.92:5100 SIP/2.0\r\n"
+         "To: <sip:yiwen_AT_meet2talk.com@whistler.gloo.net>\r\n"
+         "From: Jason Fischl<sip:jason_AT_meet2talk.com@whistler.gloo.net>;tag=ba1aee2d\r\n"
+         "Via: SIP/2.0/TCP 192.168.2.15:5100;branch=z9hG4bK-c87542-579667358-1--c87542-\r\n"
+         "Call-ID: 6c64b42fce01b007\r\n"
+         "CSeq: 1 OPTIONS\r\n"
+         "Content-Length: 4\r\n"
+         "\r\n"
+         "body");
+   Data bytes;
+   for (int i = 0; i < 4; ++i)
+   {
+      bytes += options;
+   }
+
+   Fifo<TransactionMessage> testRxFifo;
+   FakeTCPTransport fake(testRxFifo, 5060, V4, Data::Empty);
+   std::shared_ptr<SourceRateLimiter> limiter = std::make_shared<SourceRateLimiter>(1, 2);
+   fake.setSourceRateLimiter(limiter);
+   Tuple who(fake.getTuple());
+   TestConnection cBase(&fake, who, bytes);
+
+   // every message is counted once, whether or not it came in whole
+   while(cBase.read(chunk, chunk));
+   fake.flush();
+   SourceRateLimiter::Stats stats;
+   limiter->getStats(stats);
+   return testRxFifo.size() == 2 && stats.admitted[OPTIONS] == 2 && stats.limited[OPTIONS] == 2;
+}
+
 int
 main(int argc, char** argv)
 {
@@ -192,6 +275,13 @@ main(int argc, char** argv)
    assert(testTCPConnection());
    cerr << "testTCPConnection OK" << endl; 
 
+   assert(testIdleBuffer());
+   cerr << "testIdleBuffer OK" << endl;
+
+   assert(testSourceRateLimit(20));
+   assert(testSourceRateLimit(1000));
+   cerr << "testSourceRateLimit OK" << endl;
+
    cerr << "ALL OK" << endl;
    return 0;
 }
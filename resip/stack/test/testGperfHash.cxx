@@ -9,6 +9,9 @@
 #include "resip/stack/MethodHash.hxx"
 #include "resip/stack/ParameterTypes.hxx"
 #include "resip/stack/ParameterHash.hxx"
+#include "resip/stack/ExtensionHeader.hxx"
+#include "resip/stack/SipMessage.hxx"
+#include "rutil/Timer.hxx"
 
 using namespace std;
 using namespace resip;
@@ -118,6 +121,132 @@ testParameterHash(bool verbose)
   return gotErrors;
 }
 
+static bool
+testUnknownHeaders(bool verbose)
+{
+  bool gotErrors = false;
+  if (verbose)
+    cerr << "Test unknown header lookups" << endl;
+
+  // enough X- headers for the message to index them
+  const int nHeaders = 40;
+  Data txt("OPTIONS sip:bob@example.com SIP/2.0\r\n"
+           "Via: SIP/2.0/UDP 192.0.2.1;branch=z9hG4bK776asdhds\r\n"
+           "To: <sip:bob@example.com>\r\n"
+           "From: <sip:alice@example.com>;tag=1928301774\r\n"
+           "Call-ID: a84b4c76e66710\r\n"
+           "CSeq: 1 OPTIONS\r\n");
+  for (int n = 0; n < nHeaders; n++)
+  {
+    txt += "X-Sbc-Header-" + Data(n) + ": value" + Data(n) + "\r\n";
+  }
+  txt += "x-sbc-header-7: again\r\nContent-Length: 0\r\n\r\n";
+
+  std::unique_ptr<SipMessage> msg(SipMessage::make(txt));
+  assert(msg.get());
+  assert(msg->getRawUnknownHeaders().size() == (size_t)nHeaders);
+
+  std::vector<ExtensionHeader> names;
+  for (int n = 0; n < nHeaders; n++)
+  {
+    names.push_back(ExtensionHeader("x-SBC-header-" + Data(n)));
+  }
+  for (int n = 0; n < nHeaders; n++)
+  {
+    if (!msg->exists(names[n]) ||
+        msg->header(names[n]).front().value() != "value" + Data(n))
+    {
+      if (verbose)
+        cerr << "Missing " << names[n].getName() << endl;
+      gotErrors = true;
+    }
+  }
+  assert(msg->header(names[7]).size() == 2);
+  assert(!msg->exists(ExtensionHeader("X-Sbc-Header-")));
+
+  msg->remove(names[3]);
+  assert(!msg->exists(names[3]));
+  assert(msg->exists(names[4]));
+  msg->header(ExtensionHeader("X-Added")).push_back(StringCategory("added"));
+  assert(msg->exists(ExtensionHeader("x-added")));
+
+  SipMessage copy(*msg);
+  assert(copy.exists(names[nHeaders - 1]));
+  assert(!copy.exists(names[3]));
+  assert(copy.header(ExtensionHeader("X-ADDED")).front().value() == "added");
+
+  // const lookups only read the index the copy built
+  const SipMessage& constCopy(copy);
+  assert(constCopy.exists(names[0]));
+  assert(constCopy.header(names[nHeaders - 1]).front().value() == "value" + Data(nHeaders - 1));
+
+  // removing down below the threshold falls back to scanning the list
+  SipMessage small(*msg);
+  for (int n = 0; n < nHeaders - 2; n++)
+  {
+    small.remove(names[n]);
+  }
+  const SipMessage& constSmall(small);
+  assert(!constSmall.exists(names[0]));
+  assert(constSmall.exists(names[nHeaders - 2]));
+  assert(constSmall.exists(ExtensionHeader("x-added")));
+
+  // timing
+  const int runs = 20000;
+  size_t found = 0;
+  UInt64 start = Timer::getTimeMicroSec();
+  for (int r = 0; r < runs; r++)
+  {
+    for (int n = 0; n < nHeaders; n++)
+    {
+      found += copy.exists(names[n]);
+    }
+  }
+  UInt64 indexed = Timer::getTimeMicroSec() - start;
+
+  start = Timer::getTimeMicroSec();
+  for (int r = 0; r < runs; r++)
+  {
+    for (int n = 0; n < nHeaders; n++)
+    {
+      const SipMessage::UnknownHeaders& unknowns = copy.getRawUnknownHeaders();
+      for (SipMessage::UnknownHeaders::const_iterator i = unknowns.begin(); i != unknowns.end(); ++i)
+      {
+        if (isEqualNoCase(i->first, names[n].getName()))
+        {
+          ++found;
+          break;
+        }
+      }
+    }
+  }
+  UInt64 scanned = Timer::getTimeMicroSec() - start;
+
+  start = Timer::getTimeMicroSec();
+  for (int r = 0; r < runs; r++)
+  {
+    for (int ht = 0; ht < Headers::MAX_HEADERS; ht++)
+    {
+      const Data& hName = Headers::getHeaderName(ht);
+      found += Headers::getType(hName.data(), (int)hName.size());
+    }
+  }
+  UInt64 known = Timer::getTimeMicroSec() - start;
+
+  if (verbose)
+  {
+    const UInt64 lookups = (UInt64)runs * nHeaders;
+    cerr << "extension header lookups among " << nHeaders << ": indexed "
+         << indexed * 1000 / lookups << " ns, list scan "
+         << scanned * 1000 / lookups << " ns" << endl;
+    cerr << "known header name lookups (gperf): "
+         << known * 1000 / ((UInt64)runs * Headers::MAX_HEADERS) << " ns"
+         << " (" << found << ")" << endl;
+  }
+
+  return gotErrors;
+}
+
 int main()
 {
   unsigned errors = 0;
@@ -131,6 +260,9 @@ int main()
   if (testParameterHash(true))
     errors |= 4;
 
+  if (testUnknownHeaders(true))
+    errors |= 8;
+
   if (!errors)
     cerr << "All OK" << endl;
 
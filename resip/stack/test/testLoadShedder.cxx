@@ -0,0 +1,227 @@
+#include "resip/stack/LoadShedder.hxx"
+#include "resip/stack/SipMessage.hxx"
+#include "resip/stack/test/TestSupport.hxx"
+#include "rutil/Logger.hxx"
+
+#include <cassert>
+#include <iostream>
+#include <memory>
+
+using namespace resip;
+using namespace std;
+
+#define CRLF "\r\n"
+
+static const char* invite =
+   "INVITE sip:bob@biloxi.com SIP/2.0" CRLF
+   "Via: SIP/2.0/UDP pc33.atlanta.com;branch=z9hG4bKnashds8" CRLF
+   "v: SIP/2.0/UDP p1.atlanta.com;branch=z9hG4bK1, SIP/2.0/UDP p2.atlanta.com" CRLF
+   "Max-Forwards: 70" CRLF
+   "To: Bob" CRLF
+   " <sip:bob@biloxi.com>" CRLF
+   "From: Alice <sip:alice@atlanta.com>;tag=1928301774" CRLF
+   "i: a84b4c76e66710" CRLF
+   "CSeq: 314159 INVITE" CRLF
+   "Content-Length: 4" CRLF
+   CRLF
+   "body";
+
+static const char* cancel =
+   "CANCEL sip:bob@biloxi.com SIP/2.0" CRLF
+   "Via: SIP/2.0/UDP pc33.atlanta.com;branch=z9hG4bKnashds8" CRLF
+   "To: Bob <sip:bob@biloxi.com>" CRLF
+   "From: Alice <sip:alice@atlanta.com>;tag=1928301774" CRLF
+   "Call-ID: a84b4c76e66710" CRLF
+   "CSeq: 314159 CANCEL" CRLF
+   "Content-Length: 0" CRLF
+   CRLF;
+
+static const char* ack =
+   "ACK sip:bob@biloxi.com SIP/2.0" CRLF
+   "Via: SIP/2.0/UDP pc33.atlanta.com;branch=z9hG4bKnashds8" CRLF
+   "To: Bob <sip:bob@biloxi.com>;tag=1" CRLF
+   "From: Alice <sip:alice@atlanta.com>;tag=1928301774" CRLF
+   "Call-ID: a84b4c76e66710" CRLF
+   "CSeq: 314159 ACK" CRLF
+   "Content-Length: 0" CRLF
+   CRLF;
+
+static const char* ringing =
+   "SIP/2.0 180 Ringing" CRLF
+   "Via: SIP/2.0/UDP pc33.atlanta.com;branch=z9hG4bKnashds8" CRLF
+   "To: Bob <sip:bob@biloxi.com>;tag=1" CRLF
+   "From: Alice <sip:alice@atlanta.com>;tag=1928301774" CRLF
+   "Call-ID: a84b4c76e66710" CRLF
+   "CSeq: 314159 INVITE" CRLF
+   "Content-Length: 0" CRLF
+   CRLF;
+
+static const char* register1 =
+   "REGISTER sip:registrar.biloxi.com SIP/2.0" CRLF
+   "Via: SIP/2.0/TCP bobspc.biloxi.com:5060;branch=z9hG4bKnashds7" CRLF
+   "To: Bob <sip:bob@biloxi.com>" CRLF
+   "From: Bob <sip:bob@biloxi.com>;tag=456248" CRLF
+   "Call-ID: 843817637684230@998sdasdh09" CRLF
+   "CSeq: 1826 REGISTER" CRLF
+   "Contact: <sip:bob@192.0.2.4>" CRLF
+   "l: 0" CRLF
+   CRLF;
+
+static const char* register2 =
+   "REGISTER sip:registrar.biloxi.com SIP/2.0" CRLF
+   "Via: SIP/2.0/TCP bobspc.biloxi.com:5060;branch=z9hG4bKnashds9" CRLF
+   "To: Bob <sip:bob@biloxi.com>" CRLF
+   "From: Bob <sip:bob@biloxi.com>;tag=456248" CRLF
+   "Call-ID: 843817637684230@998sdasdh09" CRLF
+   "CSeq: 1827 REGISTER" CRLF
+   "Contact: <sip:bob@192.0.2.4>" CRLF
+   "Content-Length: 0" CRLF
+   CRLF;
+
+static LoadShedder::Verdict
+classify(LoadShedder& shedder, const Data& msg, bool stream,
+         CongestionManager::RejectionBehavior behavior,
+         Data& response, size_t& used)
+{
+   response.clear();
+   used = 0;
+   return shedder.classify(msg.data(), msg.size(), stream, behavior, 7, response, used);
+}
+
+int
+main()
+{
+   Log::initialize(Log::Cout, Log::Info, "testLoadShedder");
+
+   LoadShedder shedder;
+   Data response;
+   size_t used = 0;
+
+   // nothing is shed when all is well
+   assert(classify(shedder, invite, false, CongestionManager::NORMAL, response, used) == LoadShedder::Admit);
+   assert(shedder.getAdmitted(INVITE) == 0);
+
+   // a new request gets a 503 made of its own header lines
+   assert(classify(shedder, invite, false, CongestionManager::REJECTING_NEW_WORK, response, used) == LoadShedder::Reject);
+   assert(used == strlen(invite));
+   resipCout << response << endl;
+   assert(response == "SIP/2.0 503 Service Unavailable" CRLF
+                      "Via: SIP/2.0/UDP pc33.atlanta.com;branch=z9hG4bKnashds8" CRLF
+                      "v: SIP/2.0/UDP p1.atlanta.com;branch=z9hG4bK1, SIP/2.0/UDP p2.atlanta.com" CRLF
+                      "To: Bob" CRLF
+                      " <sip:bob@biloxi.com>" CRLF
+                      "From: Alice <sip:alice@atlanta.com>;tag=1928301774" CRLF
+                      "i: a84b4c76e66710" CRLF
+                      "CSeq: 314159 INVITE" CRLF
+                      "Retry-After: 7" CRLF
+                      "Content-Length: 0" CRLF
+                      CRLF);
+   {
+      unique_ptr<SipMessage> tryLater(TestSupport::makeMessage(response));
+      assert(tryLater->isResponse());
+      assert(tryLater->header(h_StatusLine).statusCode() == 503);
+      assert(tryLater->header(h_Vias).size() == 3);
+      assert(tryLater->header(h_Vias).front().param(p_branch).getTransactionId() == "nashds8");
+      assert(tryLater->header(h_To).uri().user() == "bob");
+      assert(tryLater->header(h_CallId).value() == "a84b4c76e66710");
+      assert(tryLater->header(h_CSeq).method() == INVITE);
+      assert(tryLater->header(h_RetryAfter).value() == 7);
+   }
+
+   // its retransmissions are dropped
+   assert(classify(shedder, invite, false, CongestionManager::REJECTING_NEW_WORK, response, used) == LoadShedder::Drop);
+   assert(response.empty());
+   assert(used == strlen(invite));
+
+   // a CANCEL shares the branch, but is a transaction of its own
+   assert(classify(shedder, cancel, false, CongestionManager::REJECTING_NEW_WORK, response, used) == LoadShedder::Reject);
+
+   // there is no responding to an ACK
+   assert(classify(shedder, ack, false, CongestionManager::REJECTING_NEW_WORK, response, used) == LoadShedder::Drop);
+   assert(response.empty());
+
+   // responses finish work already under way, until things get really bad
+   assert(classify(shedder, ringing, false, CongestionManager::REJECTING_NEW_WORK, response, used) == LoadShedder::Admit);
+   assert(classify(shedder, ringing, false, CongestionManager::REJECTING_NON_ESSENTIAL, response, used) == LoadShedder::Drop);
+   assert(response.empty());
+
+   // on a stream, only the first message is shed
+   {
+      Data stream(register1);
+      stream += register2;
+      assert(classify(shedder, stream, true, CongestionManager::REJECTING_NEW_WORK, response, used) == LoadShedder::Reject);
+      assert(used == strlen(register1));
+      assert(response.find("CSeq: 1826 REGISTER") != Data::npos);
+
+      Data rest(stream.data() + used, stream.size() - used);
+      assert(classify(shedder, rest, true, CongestionManager::REJECTING_NEW_WORK, response, used) == LoadShedder::Reject);
+      assert(used == strlen(register2));
+      assert(response.find("CSeq: 1827 REGISTER") != Data::npos);
+
+      // not all of the body is here yet
+      Data partial(invite, strlen(invite) - 1);
+      assert(classify(shedder, partial, true, CongestionManager::REJECTING_NEW_WORK, response, used) == LoadShedder::Admit);
+
+      // nor all of the headers
+      Data headers(register2, strlen(register2) - 4);
+      assert(classify(shedder, headers, true, CongestionManager::REJECTING_NEW_WORK, response, used) == LoadShedder::Admit);
+   }
+
+   // what can not be classified is left for the parser
+   {
+      Data noCallId(cancel);
+      noCallId.replace("Call-ID: a84b4c76e66710" CRLF, "");
+      assert(classify(shedder, noCallId, false, CongestionManager::REJECTING_NEW_WORK, response, used) == LoadShedder::Admit);
+
+      Data noLength(register2);
+      noLength.replace("Content-Length: 0" CRLF, "");
+      assert(classify(shedder, noLength, true, CongestionManager::REJECTING_NEW_WORK, response, used) == LoadShedder::Admit);
+
+      assert(classify(shedder, "\x01\x01\x00\x08 junk", false, CongestionManager::REJECTING_NEW_WORK, response, used) == LoadShedder::Admit);
+      assert(classify(shedder, "INVITE sip:bob@biloxi.com HTTP/1.1" CRLF CRLF, false, CongestionManager::REJECTING_NEW_WORK, response, used) == LoadShedder::Admit);
+   }
+
+   // framing, for those that only need the method and the length
+   {
+      MethodTypes method = UNKNOWN;
+      Data stream(register1);
+      stream += invite;
+      assert(LoadShedder::peekFrame(stream.data(), stream.size(), true, method, used));
+      assert(method == REGISTER && used == strlen(register1));
+      assert(LoadShedder::peekFrame(stream.data() + used, stream.size() - used, true, method, used));
+      assert(method == INVITE && used == strlen(invite));
+      assert(!LoadShedder::peekFrame(invite, strlen(invite) - 1, true, method, used));
+
+      assert(LoadShedder::peekFrame(ringing, strlen(ringing), false, method, used));
+      assert(method == RESPONSE && used == strlen(ringing));
+      assert(LoadShedder::peekFrame("\r\n\r\n", 4, false, method, used));
+      assert(method == UNKNOWN && used == 4);
+   }
+
+   assert(shedder.getRejected(INVITE) == 1);
+   assert(shedder.getDropped(INVITE) == 1);
+   assert(shedder.getRejected(CANCEL) == 1);
+   assert(shedder.getDropped(ACK) == 1);
+   assert(shedder.getRejected(REGISTER) == 2);
+   assert(shedder.getAdmitted(RESPONSE) == 1);
+   assert(shedder.getDropped(RESPONSE) == 1);
+   // requests left for the parser are counted too, under what the start
+   // line said
+   assert(shedder.getAdmitted(INVITE) == 1);
+   assert(shedder.getAdmitted(REGISTER) == 2);
+   assert(shedder.getAdmitted(CANCEL) == 1);
+   assert(shedder.getAdmitted(UNKNOWN) == 2);
+
+   {
+      LoadShedder::Stats stats;
+      shedder.addStats(stats);
+      shedder.addStats(stats);
+      assert(stats.admitted[REGISTER] == 4);
+      assert(stats.rejected[REGISTER] == 4);
+      assert(stats.dropped[ACK] == 2);
+      assert(stats.rejected[ACK] == 0);
+   }
+
+   resipCout << "All OK" << endl;
+   return 0;
+}
@@ -0,0 +1,118 @@
+#include <cstdio>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+#include "resip/stack/SipMessage.hxx"
+#include "rutil/BaseException.hxx"
+#include "rutil/Logger.hxx"
+#include "rutil/Timer.hxx"
+
+using namespace resip;
+using namespace std;
+
+// Times parsing of the RFC 4475 torture test messages: every message is
+// preparsed and then has all of its headers parsed, which exercises the
+// ParseBuffer scans under every ParserCategory.
+//
+// usage: testParsePerformance [runs] [file.dat ...]
+// Run from this directory to use the RFC 4475 corpus.
+
+static const char* Corpus[] =
+{
+   "wsinv.dat", "intmeth.dat", "esc01.dat", "escnull.dat", "esc02.dat",
+   "lwsdisp.dat", "longreq.dat", "dblreq.dat", "semiuri.dat", "transports.dat",
+   "mpart01.dat", "unreason.dat", "noreason.dat", "badinv01.dat", "clerr.dat",
+   "ncl.dat", "scalar02.dat", "scalarlg.dat", "quotbal.dat", "ltgtruri.dat",
+   "lwsruri.dat", "lwsstart.dat", "trws.dat", "escruri.dat", "baddate.dat",
+   "regbadct.dat", "badaspec.dat", "baddn.dat", "badvers.dat", "mismatch01.dat",
+   "mismatch02.dat", "bigcode.dat", "badbranch.dat", "bcast.dat", "bext01.dat",
+   "cparam01.dat", "cparam02.dat", "insuf.dat", "inv2543.dat", "invut.dat",
+   "mcl01.dat", "multi01.dat", "novelsc.dat", "regaut01.dat", "regescrt.dat",
+   "sdp01.dat", "unkscm.dat", "unksm2.dat", "zeromf.dat"
+};
+
+static bool
+readFile(const char* name, Data& txt)
+{
+   FILE* fid = fopen(name, "rb");
+   if (!fid)
+   {
+      return false;
+   }
+   char buf[1024];
+   size_t result;
+   while ((result = fread(buf, 1, sizeof(buf), fid)) > 0)
+   {
+      txt += Data(buf, (Data::size_type)result);
+   }
+   fclose(fid);
+   return true;
+}
+
+int
+main(int argc, char* argv[])
+{
+   Log::initialize(Log::Cout, Log::Err, argv[0]);
+
+   const int runs = argc > 1 ? atoi(argv[1]) : 2000;
+   vector<const char*> files;
+   for (int i = 2; i < argc; ++i)
+   {
+      files.push_back(argv[i]);
+   }
+   if (files.empty())
+   {
+      files.assign(Corpus, Corpus + sizeof(Corpus)/sizeof(Corpus[0]));
+   }
+
+   vector<Data> messages;
+   UInt64 bytes = 0;
+   for (size_t i = 0; i < files.size(); ++i)
+   {
+      Data txt;
+      if (!readFile(files[i], txt))
+      {
+         cerr << "Could not read " << files[i] << endl;
+         return 1;
+      }
+      bytes += txt.size();
+      messages.push_back(txt);
+   }
+
+   unsigned int parsed = 0;
+   unsigned int failed = 0;
+   const UInt64 start = Timer::getTimeMicroSec();
+   for (int r = 0; r < runs; ++r)
+   {
+      for (size_t i = 0; i < messages.size(); ++i)
+      {
+         unique_ptr<SipMessage> msg(SipMessage::make(messages[i]));
+         if (!msg.get())
+         {
+            ++failed;
+            continue;
+         }
+         try
+         {
+            msg->parseAllHeaders();
+            ++parsed;
+         }
+         catch (BaseException&)
+         {
+            // several of the torture tests are meant to fail
+            ++failed;
+         }
+      }
+   }
+   const UInt64 elapsed = Timer::getTimeMicroSec() - start;
+
+   const double seconds = elapsed / 1000000.0;
+   const UInt64 total = (UInt64)runs * messages.size();
+   cout << messages.size() << " messages (" << bytes << " bytes) x " << runs << " runs: "
+        << elapsed / 1000 << " ms, "
+        << (seconds > 0 ? (UInt64)(total / seconds) : 0) << " messages/s, "
+        << (seconds > 0 ? (UInt64)(bytes * runs / seconds / (1024 * 1024)) : 0) << " MB/s ("
+        << parsed << " parsed, " << failed << " rejected)" << endl;
+   return 0;
+}
@@ -3136,6 +3136,60 @@ main(int arc, char** argv)
       assert(tok.param(p_encoding) == Symbols::Hex);
    }
 
+   {
+      TR _tr( "Test frozen ParserCategory encoding");
+
+      NameAddr rr(Uri("sip:proxy.example.com;transport=tcp"));
+      rr.uri().param(p_lr);
+      assert(!rr.isFrozen());
+      Data expected(Data::from(rr));
+      assert(expected == "<sip:proxy.example.com;transport=tcp;lr>");
+
+      rr.freeze();
+      assert(rr.isFrozen());
+      assert(Data::from(rr) == expected);
+
+      // const access leaves the cached encoding in place
+      const NameAddr& constRr = rr;
+      assert(constRr.uri().host() == "proxy.example.com");
+      assert(constRr.uri().exists(p_lr));
+      assert(rr.isFrozen());
+
+      // copies carry the cached encoding and the parsed form with them
+      NameAddr copy(rr);
+      assert(copy.isFrozen());
+      assert(Data::from(copy) == expected);
+      NameAddr assigned;
+      assigned = rr;
+      assert(assigned.isFrozen());
+      assert(assigned.uri().host() == "proxy.example.com");
+
+      // non-const access invalidates the cache, but not the original's
+      copy.uri().param(UnknownParameterType("drr"));
+      assert(!copy.isFrozen());
+      assert(Data::from(copy) == "<sip:proxy.example.com;transport=tcp;lr;drr>");
+      assert(Data::from(rr) == expected);
+
+      Via via;
+      via.sentHost() = "192.0.2.1";
+      via.sentPort() = 5060;
+      via.freeze();
+      Data viaEncoded(Data::from(via));
+      assert(viaEncoded.find("192.0.2.1:5060") != Data::npos);
+      via.param(p_branch).reset("z9hG4bK" RESIP_COOKIE "1");
+      assert(!via.isFrozen());
+      assert(Data::from(via) != viaEncoded);
+
+      // parsed off the wire is not the same as frozen
+      Data wire("<sip:edge.example.com;lr>");
+      HeaderFieldValue hfv(wire.data(), wire.size());
+      NameAddr parsed(hfv, Headers::RecordRoute);
+      const NameAddr& constParsed = parsed;
+      assert(constParsed.uri().host() == "edge.example.com");
+      assert(!parsed.isFrozen());
+      assert(Data::from(parsed) == wire);
+   }
+
    assert(!failed);
    resipCerr << "\nTEST OK" << endl;
 
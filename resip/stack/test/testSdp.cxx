@@ -576,6 +576,135 @@ main(int argc, char* argv[])
        CritLog(<< "Received bad Dialogic fmtp line Ok");
     }
 
+   {
+      // Media sections are parsed on demand, and encoded from the original
+      // bytes until they are modified
+      Data audio("m=audio 49170 RTP/AVP 0 8 9 18 96 97 98 99 100 101 102 103 104 105 106 107 108 109 110 111 112 113 114 115\r\n"
+                 "c=IN IP4 192.0.2.10\r\n"
+                 "b=AS:64\r\n");
+      for (int pt = 96; pt <= 115; ++pt)
+      {
+         audio += "a=rtpmap:" + Data(pt) + " dyn" + Data(pt) + "/8000\r\n";
+         audio += "a=fmtp:" + Data(pt) + " mode=" + Data(pt) + "\r\n";
+      }
+      audio += "a=ptime:20\r\n"
+               "a=sendrecv\r\n";
+      Data video("m=video 49172 RTP/AVP 31 34\r\n"
+                 "a=rtpmap:31 H261/90000\r\n"
+                 "a=rtpmap:34 H263/90000\r\n");
+      Data txt("v=0\r\n"
+               "o=alice 2890844526 2890844526 IN IP4 192.0.2.10\r\n"
+               "s=Lazy\r\n"
+               "c=IN IP4 192.0.2.10\r\n"
+               "t=0 0\r\n");
+      txt += audio;
+      txt += video;
+
+      {
+         HeaderFieldValue hfv(txt.data(), txt.size());
+         Mime type("application", "sdp");
+         SdpContents sdp(hfv, type);
+
+         const SdpContents::Session& session = sdp.session();
+         assert(session.media().size() == 2);
+         assert(session.media().front().port() == 49170);
+         assert(session.media().front().getMediumConnections().front().getAddress() == "192.0.2.10");
+         assert(session.media().front().codecs().size() == 24);
+         assert(session.media().back().isUnmodified());
+
+         // modify the session, but none of the media
+         sdp.session().name() = "Modified";
+         assert(sdp.session().media().front().isUnmodified());
+         Data encoded(Data::from(sdp));
+         Data expected(txt);
+         expected.replace("s=Lazy", "s=Modified");
+         assert(encoded == expected);
+
+         // modify one medium; only that section is re-encoded from its parsed form
+         SdpContents::Session::MediumContainer::iterator v = sdp.session().media().begin();
+         ++v;
+         v->setPort(50000);
+         assert(!v->isUnmodified());
+         assert(sdp.session().media().front().isUnmodified());
+         encoded = Data::from(sdp);
+         assert(encoded.find(audio) != Data::npos);
+         assert(encoded.find("m=video 50000 RTP/AVP 31 34\r\n") != Data::npos);
+         assert(encoded.find("a=rtpmap:34 H263/90000\r\n") != Data::npos);
+
+         // copies keep the original bytes of unmodified sections
+         SdpContents copy(sdp);
+         assert(Data::from(copy) == encoded);
+      }
+
+      {
+         // no line terminator at end of body
+         Data noEol(txt.data(), txt.size() - 2);
+         HeaderFieldValue hfv(noEol.data(), noEol.size());
+         Mime type("application", "sdp");
+         SdpContents sdp(hfv, type);
+         sdp.session().name() = "Lazy";
+         assert(Data::from(sdp) == txt);
+         assert(sdp.session().media().back().codecs().size() == 2);
+      }
+
+      {
+         // a malformed media body is reported through isWellFormed(), not by
+         // throwing from the const accessors, and is passed through unchanged
+         Data bad("v=0\r\n"
+                  "o=alice 2890844526 2890844526 IN IP4 192.0.2.10\r\n"
+                  "s=Lazy\r\n"
+                  "c=IN IP4 192.0.2.10\r\n"
+                  "t=0 0\r\n"
+                  "m=audio 49170 RTP/AVP 0 96\r\n"
+                  "c=IN\r\n"
+                  "a=rtpmap:96 dyn96/8000\r\n");
+         bad += video;
+         HeaderFieldValue hfv(bad.data(), bad.size());
+         Mime type("application", "sdp");
+         SdpContents sdp(hfv, type);
+         const SdpContents::Session& session = sdp.session();
+         const SdpContents::Session::Medium& audioMedium = session.media().front();
+         assert(audioMedium.getMediumConnections().empty());
+         assert(!audioMedium.exists("rtpmap"));
+         // only the static payload type survives without its rtpmap line
+         assert(audioMedium.codecs().size() == 1);
+         assert(!audioMedium.isWellFormed());
+         assert(session.media().back().isWellFormed());
+         assert(session.media().back().codecs().size() == 2);
+         assert(Data::from(sdp) == bad);
+         // the SDP itself parsed, but reports the malformed section
+         assert(!sdp.isWellFormed());
+      }
+
+      {
+         // reading through the non-const accessors keeps the original bytes 
+         // as long as nothing is changed
+         HeaderFieldValue hfv(txt.data(), txt.size());
+         Mime type("application", "sdp");
+         SdpContents sdp(hfv, type);
+         SdpContents::Session::Medium& audioMedium = sdp.session().media().front();
+         assert(audioMedium.name() == "audio");
+         assert(audioMedium.port() == 49170);
+         assert(audioMedium.getMediumConnections().size() == 1);
+         assert(audioMedium.codecs().size() == 24);
+         assert(audioMedium.isUnmodified());
+         assert(Data::from(sdp) == txt);
+
+         // changing a value obtained that way is still picked up on encode
+         audioMedium.getMediumConnections().front().setAddress("192.0.2.20");
+         assert(!audioMedium.isUnmodified());
+         Data encoded(Data::from(sdp));
+         assert(encoded.find("m=audio 49170 RTP/AVP") != Data::npos);
+         assert(encoded.find("c=IN IP4 192.0.2.20\r\n") != Data::npos);
+         assert(encoded.find(video) != Data::npos);
+
+         SdpContents::Session::Medium& videoMedium = sdp.session().media().back();
+         videoMedium.port() = 50000;
+         assert(!videoMedium.isUnmodified());
+         assert(Data::from(sdp).find("m=video 50000 RTP/AVP 31 34\r\n") != Data::npos);
+      }
+   }
+
    {
       const char rawInput[] = "m= 1 \nc=IN  /9";
       ParseBuffer input(rawInput, sizeof(rawInput));
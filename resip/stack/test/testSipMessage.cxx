@@ -2319,6 +2319,75 @@ main(int argc, char** argv)
        assert( msg->header(resip::h_PAccessNetworkInfos).size() == 2);
    }
 
+   {
+      resipCerr << "Helper::makeRawResponse" << endl;
+      const char* txt = ("INVITE sip:bob@biloxi.com SIP/2.0" CRLF
+                         "Via: SIP/2.0/UDP pc33.atlanta.com;branch=z9hG4bKnashds8" CRLF
+                         "Via: SIP/2.0/UDP a.b;branch=z9hG4bKx, SIP/2.0/TCP c.d;branch=z9hG4bKy" CRLF
+                         "Max-Forwards: 70" CRLF
+                         "t:   Bob <sip:bob@biloxi.com>" CRLF
+                         "From: Alice <sip:alice@atlanta.com>;tag=1928301774" CRLF
+                         "Call-ID: a84b4c76e66710" CRLF
+                         "CSeq: 314159 INVITE" CRLF
+                         "Content-Length: 0" CRLF
+                         CRLF);
+      unique_ptr<SipMessage> request(TestSupport::makeMessage(txt));
+
+      {
+         // nothing has been parsed yet, so the values are copied from the
+         // receive buffer as they are
+         unique_ptr<SipMessage> untouched(TestSupport::makeMessage(txt));
+         Data raw;
+         Helper::makeRawResponse(raw, *untouched, 486);
+         resipCerr << raw << endl;
+         assert(untouched->getRawHeader(Headers::Via)->getParserContainer() == 0);
+         assert(untouched->getRawHeader(Headers::To)->getParserContainer() == 0);
+         assert(raw == "SIP/2.0 486 Busy Here" CRLF
+                       "Via: SIP/2.0/UDP pc33.atlanta.com;branch=z9hG4bKnashds8" CRLF
+                       "Via: SIP/2.0/UDP a.b;branch=z9hG4bKx" CRLF
+                       "Via: SIP/2.0/TCP c.d;branch=z9hG4bKy" CRLF
+                       "To: Bob <sip:bob@biloxi.com>" CRLF
+                       "From: Alice <sip:alice@atlanta.com>;tag=1928301774" CRLF
+                       "Call-ID: a84b4c76e66710" CRLF
+                       "CSeq: 314159 INVITE" CRLF
+                       "Content-Length: 0" CRLF
+                       CRLF);
+      }
+
+      // the top Via is modified the way the transport stamps it
+      request->header(h_Vias).front().param(p_received) = "192.0.2.1";
+
+      Data raw;
+      Helper::makeRawResponse(raw, *request, 503, "Retry-After: 5" CRLF, "x");
+      resipCerr << raw << endl;
+      assert(raw == "SIP/2.0 503 Service Unavailable" CRLF
+                    "Via: SIP/2.0/UDP pc33.atlanta.com;branch=z9hG4bKnashds8;received=192.0.2.1" CRLF
+                    "Via: SIP/2.0/UDP a.b;branch=z9hG4bKx" CRLF
+                    "Via: SIP/2.0/TCP c.d;branch=z9hG4bKy" CRLF
+                    "To: Bob <sip:bob@biloxi.com>" CRLF
+                    "From: Alice <sip:alice@atlanta.com>;tag=1928301774" CRLF
+                    "Call-ID: a84b4c76e66710" CRLF
+                    "CSeq: 314159 INVITE" CRLF
+                    "Retry-After: 5" CRLF
+                    "Content-Length: 1" CRLF
+                    CRLF
+                    "x");
+
+      // and it parses back into the response makeResponse would build
+      unique_ptr<SipMessage> response(TestSupport::makeMessage(raw));
+      unique_ptr<SipMessage> expected(Helper::makeResponse(*request, 503));
+      assert(response->header(h_StatusLine).statusCode() == 503);
+      assert(response->header(h_Vias).size() == 3);
+      assert(response->header(h_Vias).front().param(p_received) == "192.0.2.1");
+      assert(response->header(h_To).uri() == expected->header(h_To).uri());
+      assert(!response->header(h_To).exists(p_tag));
+      assert(response->header(h_From).uri() == expected->header(h_From).uri());
+      assert(response->header(h_From).param(p_tag) == expected->header(h_From).param(p_tag));
+      assert(response->header(h_CallId).value() == expected->header(h_CallId).value());
+      assert(response->header(h_CSeq).sequence() == expected->header(h_CSeq).sequence());
+      assert(response->header(h_CSeq).method() == INVITE);
+   }
+
    resipCerr << "\nTEST OK" << endl;
    return 0;
 }
@@ -0,0 +1,248 @@
+#include "resip/stack/SourceRateLimiter.hxx"
+#include "resip/stack/Tuple.hxx"
+#include "rutil/Logger.hxx"
+#include "rutil/ThreadIf.hxx"
+#include "rutil/Timer.hxx"
+
+#include <cassert>
+#include <iostream>
+
+using namespace resip;
+using namespace std;
+
+// One Transport's reader: sends from its own block of addresses
+class Reader : public ThreadIf
+{
+   public:
+      Reader(SourceRateLimiter& limiter, UInt32 firstAddress, int sources, int rounds) :
+         mLimiter(limiter),
+         mFirstAddress(firstAddress),
+         mSources(sources),
+         mRounds(rounds),
+         mAdmitted(0)
+      {}
+      virtual ~Reader() { shutdown(); join(); }
+
+      void thread()
+      {
+         for (int r = 0; r < mRounds; ++r)
+         {
+            for (int s = 0; s < mSources; ++s)
+            {
+               in_addr addr;
+               addr.s_addr = htonl(mFirstAddress + s);
+               mAdmitted += mLimiter.admit(Tuple(addr, 5060, TCP), INVITE, 1000000) == SourceRateLimiter::Admit;
+            }
+         }
+      }
+
+      SourceRateLimiter& mLimiter;
+      const UInt32 mFirstAddress;
+      const int mSources;
+      const int mRounds;
+      int mAdmitted;
+};
+
+int
+main()
+{
+   Log::initialize(Log::Cout, Log::Info, "testSourceRateLimiter");
+
+   const Tuple alice("192.0.2.1", 5060, V4, UDP);
+   const Tuple aliceTcp("192.0.2.1", 41234, V4, TCP);
+   const Tuple bob("192.0.2.2", 5060, V4, UDP);
+   const Tuple carol("2001:db8::3", 5060, V6, UDP);
+   UInt64 now = 1000000;
+
+   {
+      // 1 request a second, 3 at once
+      SourceRateLimiter limiter(1, 3);
+      limiter.setMethodRate(INVITE, 2, 2);
+      limiter.setMethodRate(ACK, 0, 0);
+
+      assert(limiter.admit(alice, OPTIONS, now) == SourceRateLimiter::Admit);
+      assert(limiter.admit(alice, REGISTER, now) == SourceRateLimiter::Admit);
+      // the port and transport do not make another source
+      assert(limiter.admit(aliceTcp, SUBSCRIBE, now) == SourceRateLimiter::Admit);
+      assert(limiter.admit(alice, OPTIONS, now) == SourceRateLimiter::Limited);
+      assert(limiter.admit(alice, UNKNOWN, now) == SourceRateLimiter::Limited);
+
+      // INVITE has a bucket of its own
+      assert(limiter.admit(alice, INVITE, now) == SourceRateLimiter::Admit);
+      assert(limiter.admit(alice, INVITE, now) == SourceRateLimiter::Admit);
+      assert(limiter.admit(alice, INVITE, now) == SourceRateLimiter::Limited);
+
+      // ACK is not limited, nor are responses
+      for (int i = 0; i < 100; ++i)
+      {
+         assert(limiter.admit(alice, ACK, now) == SourceRateLimiter::Admit);
+         assert(limiter.admit(alice, RESPONSE, now) == SourceRateLimiter::Admit);
+      }
+
+      // other sources are not affected
+      assert(limiter.admit(bob, OPTIONS, now) == SourceRateLimiter::Admit);
+      assert(limiter.admit(carol, OPTIONS, now) == SourceRateLimiter::Admit);
+
+      // buckets refill at their rate
+      assert(limiter.admit(alice, OPTIONS, now + 999) == SourceRateLimiter::Limited);
+      assert(limiter.admit(alice, OPTIONS, now + 1000) == SourceRateLimiter::Admit);
+      assert(limiter.admit(alice, OPTIONS, now + 1000) == SourceRateLimiter::Limited);
+      assert(limiter.admit(alice, INVITE, now + 500) == SourceRateLimiter::Admit);
+      assert(limiter.admit(alice, INVITE, now + 500) == SourceRateLimiter::Limited);
+      // but never beyond the burst
+      for (int i = 0; i < 3; ++i)
+      {
+         assert(limiter.admit(bob, OPTIONS, now + 3600000) == SourceRateLimiter::Admit);
+      }
+      assert(limiter.admit(bob, OPTIONS, now + 3600000) == SourceRateLimiter::Limited);
+
+      SourceRateLimiter::Stats stats;
+      limiter.getStats(stats);
+      assert(stats.sources == 3);
+      assert(stats.admitted[OPTIONS] == 7);
+      assert(stats.limited[OPTIONS] == 4);
+      assert(stats.admitted[INVITE] == 3);
+      assert(stats.limited[INVITE] == 2);
+      assert(stats.admitted[ACK] == 100);
+      assert(stats.admitted[RESPONSE] == 100);
+      assert(stats.bans == 0);
+      limiter.encodeCurrentState(resipCout);
+
+      limiter.zeroOutStatistics();
+      limiter.getStats(stats);
+      assert(stats.admitted[OPTIONS] == 0 && stats.sources == 3);
+   }
+
+   {
+      // bans
+      SourceRateLimiter limiter(1, 1);
+      limiter.setBan(5, 10000);
+
+      assert(limiter.admit(alice, INVITE, now) == SourceRateLimiter::Admit);
+      for (int i = 0; i < 4; ++i)
+      {
+         assert(limiter.admit(alice, INVITE, now + i) == SourceRateLimiter::Limited);
+      }
+      // a slow trickle over the rate is not enough
+      assert(limiter.admit(alice, INVITE, now + 1500) == SourceRateLimiter::Admit);
+      assert(limiter.admit(alice, INVITE, now + 1500) == SourceRateLimiter::Limited);
+      for (int i = 0; i < 4; ++i)
+      {
+         assert(limiter.admit(alice, INVITE, now + 1501) == SourceRateLimiter::Limited);
+      }
+      // while banned, even its responses are refused
+      assert(limiter.admit(alice, INVITE, now + 5000) == SourceRateLimiter::Banned);
+      assert(limiter.admit(alice, RESPONSE, now + 5000) == SourceRateLimiter::Banned);
+      assert(limiter.admit(bob, INVITE, now + 5000) == SourceRateLimiter::Admit);
+
+      SourceRateLimiter::Stats stats;
+      limiter.getStats(stats);
+      assert(stats.bans == 1);
+      assert(stats.refusedWhileBanned == 2);
+
+      assert(limiter.admit(alice, INVITE, now + 1501 + 10000) == SourceRateLimiter::Admit);
+      assert(limiter.admit(alice, RESPONSE, now + 1501 + 10000) == SourceRateLimiter::Admit);
+   }
+
+   {
+      // the least recently heard from source is forgotten first
+      SourceRateLimiter limiter(1, 1, 2);
+      assert(limiter.admit(alice, OPTIONS, now) == SourceRateLimiter::Admit);
+      assert(limiter.admit(bob, OPTIONS, now) == SourceRateLimiter::Admit);
+      assert(limiter.admit(alice, OPTIONS, now) == SourceRateLimiter::Limited);
+      assert(limiter.admit(carol, OPTIONS, now) == SourceRateLimiter::Admit);
+
+      SourceRateLimiter::Stats stats;
+      limiter.getStats(stats);
+      assert(stats.sources == 2);
+      assert(stats.evictions == 1);
+
+      // alice is remembered, bob starts over
+      assert(limiter.admit(alice, OPTIONS, now) == SourceRateLimiter::Limited);
+      assert(limiter.admit(bob, OPTIONS, now) == SourceRateLimiter::Admit);
+      limiter.getStats(stats);
+      assert(stats.evictions == 2);
+   }
+
+   {
+      // A scanner flooding from one address and a flood spread over many,
+      // 10000 requests a second in all, with a well behaved source sending
+      // 10 a second mixed in.
+      SourceRateLimiter limiter(50, 100, 4096);
+      limiter.setBan(100, 600000);
+      const Tuple scanner("198.51.100.7", 5060, V4, UDP);
+      const int total = 1000000;
+      const int floodSources = 10000;
+      int legitAdmitted = 0;
+      int legitSent = 0;
+      UInt64 legitUs = 0;
+
+      const UInt64 start = Timer::getTimeMicroSec();
+      for (int i = 0; i < total; ++i)
+      {
+         const UInt64 t = now + i/10;
+         if (i % 2)
+         {
+            in_addr addr;
+            addr.s_addr = htonl(0xC6120000 + (i/2) % floodSources); // 198.18.0.0/15
+            limiter.admit(Tuple(addr, 5060, UDP), INVITE, t);
+         }
+         else
+         {
+            limiter.admit(scanner, REGISTER, t);
+         }
+         if (i % 1000 == 0)
+         {
+            const UInt64 before = Timer::getTimeMicroSec();
+            legitAdmitted += limiter.admit(alice, INVITE, t) == SourceRateLimiter::Admit;
+            legitUs += Timer::getTimeMicroSec() - before;
+            ++legitSent;
+         }
+      }
+      const UInt64 elapsed = Timer::getTimeMicroSec() - start;
+
+      SourceRateLimiter::Stats stats;
+      limiter.getStats(stats);
+      resipCout << "flood: " << total << " requests in " << elapsed / 1000 << " ms; legitimate source "
+                << legitAdmitted << "/" << legitSent << " admitted, "
+                << (double)legitUs / legitSent << " us each" << endl;
+      limiter.encodeCurrentState(resipCout);
+      assert(legitAdmitted == legitSent);
+      assert(stats.bans == 1);
+      assert(stats.admitted[REGISTER] < 200);
+      assert(stats.sources == 4096);
+   }
+
+   {
+      // Transports in their own threads share the table; each source gets
+      // exactly its burst, wherever its shard is
+      SourceRateLimiter limiter(1, 5);
+      const int readers = 4;
+      const int sources = 1000;
+      Reader* reader[readers];
+      for (int t = 0; t < readers; ++t)
+      {
+         reader[t] = new Reader(limiter, 0xC6120000 + t * sources, sources, 10);
+      }
+      for (int t = 0; t < readers; ++t)
+      {
+         reader[t]->run();
+      }
+      for (int t = 0; t < readers; ++t)
+      {
+         reader[t]->join();
+         assert(reader[t]->mAdmitted == sources * 5);
+         delete reader[t];
+      }
+
+      SourceRateLimiter::Stats stats;
+      limiter.getStats(stats);
+      assert(stats.sources == readers * sources);
+      assert(stats.admitted[INVITE] == UInt64(readers * sources * 5));
+      assert(stats.limited[INVITE] == UInt64(readers * sources * 5));
+      assert(stats.evictions == 0);
+   }
+
+   resipCout << "All OK" << endl;
+   return 0;
+}
@@ -0,0 +1,129 @@
+#include "resip/stack/ssl/TlsConnection.hxx"
+#include "resip/stack/ssl/TlsTransport.hxx"
+#include "resip/stack/ssl/Security.hxx"
+#include "resip/stack/SendData.hxx"
+#include "resip/stack/TransactionMessage.hxx"
+#include "resip/stack/Tuple.hxx"
+#include "rutil/Fifo.hxx"
+#include "rutil/Logger.hxx"
+
+#include <cassert>
+#include <iostream>
+#include <sys/socket.h>
+#include <unistd.h>
+
+using namespace resip;
+using namespace std;
+
+// A TlsConnection whose write() stands in for SSL_write on a socket that is
+// not writable: it reports WANT_WRITE (0) a given number of times and, like
+// OpenSSL without SSL_MODE_ACCEPT_MOVING_WRITE_BUFFER, insists that the retry
+// passes the same buffer and length.
+class RetryCheckingConnection : public TlsConnection
+{
+   public:
+      RetryCheckingConnection(Transport* transport, const Tuple& who, Socket fd, Security* security)
+         : TlsConnection(transport, who, fd, security, false, Data::Empty,
+                         SecurityTypes::SSLv23, Compression::Disabled),
+           mBlocked(0),
+           mPendingBuffer(0),
+           mPendingCount(0),
+           mBadRetries(0),
+           mWrites(0)
+      {}
+
+      virtual bool isWritable() { return true; }
+      virtual bool transportWrite() { return false; }
+
+      int write(const char* buf, const int count)
+      {
+         if (mPendingBuffer && (buf != mPendingBuffer || count != mPendingCount))
+         {
+            ++mBadRetries;
+            return -1;
+         }
+         if (mBlocked > 0)
+         {
+            --mBlocked;
+            mPendingBuffer = buf;
+            mPendingCount = count;
+            return 0;
+         }
+         mPendingBuffer = 0;
+         mPendingCount = 0;
+         mWire.append(buf, count);
+         ++mWrites;
+         return count;
+      }
+
+      int mBlocked;
+      const char* mPendingBuffer;
+      int mPendingCount;
+      int mBadRetries;
+      int mWrites;
+      Data mWire;
+};
+
+static SendData*
+makeSend(const Tuple& dest, const Data& data)
+{
+   return new SendData(dest, data, Data::Empty, Data::Empty);
+}
+
+int
+main()
+{
+   Log::initialize(Log::Cout, Log::None, "testTlsWriteRetry");
+
+   Security security;
+   Fifo<TransactionMessage> fifo;
+   TlsTransport transport(fifo, 0, V4, "127.0.0.1", security, Data::Empty, SecurityTypes::SSLv23);
+
+   int fds[2];
+   int ret = socketpair(AF_UNIX, SOCK_STREAM, 0, fds);
+   assert(ret == 0);
+   (void)ret;
+   Tuple peer("127.0.0.1", 5061, V4, TLS);
+   RetryCheckingConnection* conn = new RetryCheckingConnection(&transport, peer, fds[0], &security);
+
+   {
+      // a single message that has to be retried is retried as it was, even
+      // though more messages have been queued behind it by then
+      conn->mBlocked = 1;
+      conn->requestWrite(makeSend(peer, "first"));
+      assert(conn->performWrite() == 0);
+      conn->requestWrite(makeSend(peer, "second"));
+      conn->requestWrite(makeSend(peer, "third"));
+      assert(conn->performWrite() == 5);
+      assert(conn->mBadRetries == 0);
+      assert(conn->mWire == "first");
+
+      // the rest goes out as one batch
+      assert(conn->performWrite() == 11);
+      assert(conn->mWire == "firstsecondthird");
+      assert(conn->mWrites == 2);
+   }
+
+   {
+      // the same for a batch that has to be retried more than once, with a
+      // message queued after every attempt
+      conn->mWire.clear();
+      conn->mBlocked = 2;
+      conn->requestWrite(makeSend(peer, "one"));
+      conn->requestWrite(makeSend(peer, "two"));
+      assert(conn->performWrite() == 0);
+      conn->requestWrite(makeSend(peer, "three"));
+      assert(conn->performWrite() == 0);
+      conn->requestWrite(makeSend(peer, "four"));
+      assert(conn->performWrite() == 6);
+      assert(conn->performWrite() == 9);
+      assert(conn->mBadRetries == 0);
+      assert(conn->mWire == "onetwothreefour");
+   }
+
+   delete conn;
+   close(fds[1]);
+
+   resipCout << "All OK" << endl;
+   return 0;
+}
@@ -0,0 +1,275 @@
+#include "resip/stack/Helper.hxx"
+#include "resip/stack/SendData.hxx"
+#include "resip/stack/SipMessage.hxx"
+#include "resip/stack/SipStack.hxx"
+#include "resip/stack/test/TestSupport.hxx"
+#include "rutil/DataStream.hxx"
+#include "rutil/Logger.hxx"
+#include "rutil/Timer.hxx"
+
+#include <cassert>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <new>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+using namespace resip;
+using namespace std;
+
+// Counts the bytes held on the heap so the memory a lingering transaction
+// keeps can be measured.
+static size_t allocated = 0;
+
+void* operator new(size_t size)
+{
+   size_t* p = static_cast<size_t*>(malloc(size + sizeof(max_align_t)));
+   if (!p)
+   {
+      throw bad_alloc();
+   }
+   *p = size;
+   allocated += size;
+   return reinterpret_cast<char*>(p) + sizeof(max_align_t);
+}
+
+void operator delete(void* ptr) noexcept
+{
+   if (ptr)
+   {
+      size_t* p = reinterpret_cast<size_t*>(static_cast<char*>(ptr) - sizeof(max_align_t));
+      allocated -= *p;
+      free(p);
+   }
+}
+
+void* operator new[](size_t size) { return operator new(size); }
+void operator delete[](void* ptr) noexcept { operator delete(ptr); }
+void operator delete(void* ptr, size_t) noexcept { operator delete(ptr); }
+void operator delete[](void* ptr, size_t) noexcept { operator delete(ptr); }
+
+static const int StackPort = 15090;
+
+// A bare UDP socket on loopback standing in for the client
+class WireClient
+{
+   public:
+      WireClient()
+      {
+         mFd = socket(AF_INET, SOCK_DGRAM, 0);
+         assert(mFd >= 0);
+         sockaddr_in addr;
+         memset(&addr, 0, sizeof(addr));
+         addr.sin_family = AF_INET;
+         addr.sin_addr.s_addr = inet_addr("127.0.0.1");
+         addr.sin_port = 0;
+         assert(bind(mFd, (sockaddr*)&addr, sizeof(addr)) == 0);
+         socklen_t len = sizeof(addr);
+         assert(getsockname(mFd, (sockaddr*)&addr, &len) == 0);
+         mPort = ntohs(addr.sin_port);
+      }
+      ~WireClient() { close(mFd); }
+
+      void send(const Data& msg)
+      {
+         sockaddr_in addr;
+         memset(&addr, 0, sizeof(addr));
+         addr.sin_family = AF_INET;
+         addr.sin_addr.s_addr = inet_addr("127.0.0.1");
+         addr.sin_port = htons(StackPort);
+         assert(sendto(mFd, msg.data(), msg.size(), 0, (sockaddr*)&addr, sizeof(addr)) == (ssize_t)msg.size());
+      }
+
+      // Returns the first line of the next datagram, or empty if none is waiting
+      Data receive()
+      {
+         char buf[4096];
+         ssize_t len = recv(mFd, buf, sizeof(buf), MSG_DONTWAIT);
+         if (len <= 0)
+         {
+            return Data::Empty;
+         }
+         Data line(buf, len);
+         return line.substr(0, line.find("\r\n"));
+      }
+
+      int port() const { return mPort; }
+
+   private:
+      int mFd;
+      int mPort;
+};
+
+static Data
+makeRequest(int port, const char* method, const char* branch)
+{
+   Data txt;
+   {
+      DataStream str(txt);
+      str << method << " sip:bob@127.0.0.1:" << StackPort << " SIP/2.0\r\n"
+          << "Via: SIP/2.0/UDP 127.0.0.1:" << port << ";branch=" << branch << ";rport\r\n"
+          << "Max-Forwards: 70\r\n"
+          << "To: Bob <sip:bob@biloxi.com>" << (Data(method) == "ACK" ? ";tag=tu-tag" : "") << "\r\n"
+          << "From: Alice <sip:alice@atlanta.com>;tag=1928301774\r\n"
+          << "Call-ID: a84b4c76e66710@pc33.atlanta.com\r\n"
+          << "CSeq: 314159 " << method << "\r\n"
+          << "Contact: <sip:alice@127.0.0.1:" << port << ">\r\n"
+          << "Content-Length: 0\r\n"
+          << "\r\n";
+   }
+   return txt;
+}
+
+// Runs the stack until the client has seen a datagram starting with firstLine
+static void
+runUntilClientSees(SipStack& stack, WireClient& client, const Data& firstLine)
+{
+   for (int i = 0; i < 500; ++i)
+   {
+      stack.process(10);
+      Data line = client.receive();
+      if (line == firstLine)
+      {
+         return;
+      }
+   }
+   assert(0);
+}
+
+// Drives a server INVITE transaction on UDP through Completed (a 486 sent) and
+// Confirmed (the ACK received) and measures what it holds in each.
+static void
+serverInvite()
+{
+   // Short timers, so that Timer G retransmissions and Timer I come quickly
+   Timer::resetT1(50);
+   Timer::T4 = 200;
+
+   SipStack stack;
+   stack.addTransport(UDP, StackPort, V4, StunDisabled, "127.0.0.1");
+   WireClient client;
+
+   client.send(makeRequest(client.port(), "INVITE", "z9hG4bK-invite-1"));
+   SipMessage* request = 0;
+   for (int i = 0; i < 500 && !request; ++i)
+   {
+      stack.process(10);
+      request = stack.receive();
+   }
+   assert(request && request->isRequest());
+
+   SipMessage* response = Helper::makeResponse(*request, 486);
+   response->header(h_To).param(p_tag) = "tu-tag";
+   delete request;
+   // let the 100 Trying go out and settle
+   for (int i = 0; i < 20; ++i)
+   {
+      stack.process(10);
+      client.receive();
+   }
+
+   Data encoded;
+   {
+      DataStream str(encoded);
+      response->encode(str);
+   }
+   const size_t beforeCopy = allocated;
+   SipMessage* copy = new SipMessage(*response);
+   const size_t responseSize = allocated - beforeCopy;
+   delete copy;
+   stack.send(*response);
+   delete response;
+   runUntilClientSees(stack, client, "SIP/2.0 486 Busy Here");
+
+   // A retransmitted INVITE is answered from the kept encoding
+   client.send(makeRequest(client.port(), "INVITE", "z9hG4bK-invite-1"));
+   runUntilClientSees(stack, client, "SIP/2.0 486 Busy Here");
+   const size_t completed = allocated;
+
+   client.send(makeRequest(client.port(), "ACK", "z9hG4bK-invite-1"));
+   for (int i = 0; i < 5; ++i)
+   {
+      stack.process(10);
+   }
+   const size_t confirmed = allocated;
+
+   // Timer I ends the transaction
+   for (int i = 0; i < 60; ++i)
+   {
+      stack.process(10);
+      while (!client.receive().empty())
+      {
+      }
+   }
+   const size_t terminated = allocated;
+
+   resipCout << "486 encoded: " << encoded.size() << " bytes, as a SipMessage: " << responseSize << " bytes" << endl;
+   resipCout << "server INVITE in Completed: " << completed - terminated << " bytes" << endl;
+   resipCout << "server INVITE in Confirmed: " << confirmed - terminated << " bytes" << endl;
+
+   // Completed keeps the 486 only as its encoding, not as a SipMessage
+   assert(completed - terminated >= encoded.size());
+   assert(completed - terminated < responseSize/4);
+   // Confirmed has nothing left to retransmit
+   assert(confirmed < completed);
+}
+
+int
+main()
+{
+   Log::initialize(Log::Cout, Log::Warning, "testTransactionMemory");
+
+   const char *txt = "REGISTER sip:registrar.biloxi.com SIP/2.0\r\nVia: SIP/2.0/UDP bobspc.biloxi.com:5060;branch=z9hG4bKnashds7\r\nMax-Forwards: 70\r\nTo: Bob <sip:bob@biloxi.com>\r\nFrom: Bob <sip:bob@biloxi.com>;tag=456248\r\nCall-ID: 843817637684230@998sdasdh09\r\nCSeq: 1826 REGISTER\r\nContact: <sip:bob@192.0.2.4>\r\nExpires: 7200\r\nContent-Length: 0\r\n\r\n";
+
+   unique_ptr<SipMessage> request(TestSupport::makeMessage(Data(txt)));
+   // the first response sets up state (random tags and such) that is kept
+   delete Helper::makeResponse(*request, 200);
+   const size_t base = allocated;
+
+   // what a server non-INVITE transaction holds once it has sent its final
+   // response, encoded the way TransportSelector::transmit does it
+   SipMessage* response = Helper::makeResponse(*request, 200);
+   SendData* retransmit = new SendData(Tuple("192.0.2.4", 5060, V4, UDP),
+                                       Data::Empty,
+                                       request->getTransactionId(),
+                                       Data::Empty);
+   retransmit->data.reserve(4096);
+   {
+      DataStream str(retransmit->data);
+      response->encode(str);
+   }
+   const size_t encoded = retransmit->data.size();
+   const size_t full = allocated - base;
+
+   // Completed - the response is gone, the encoding is kept at its size
+   delete response;
+   retransmit->compact();
+   const size_t completed = allocated - base;
+   assert(retransmit->data.size() == encoded);
+
+   // Completed (client) or Confirmed - only the key is left
+   retransmit->release();
+   assert(retransmit->empty());
+   const size_t confirmed = allocated - base;
+   delete retransmit;
+
+   resipCout << "final response encoded: " << encoded << " bytes" << endl;
+   resipCout << "per transaction while sending: " << full << " bytes" << endl;
+   resipCout << "per transaction in Completed: " << completed << " bytes" << endl;
+   resipCout << "per transaction in Confirmed: " << confirmed << " bytes" << endl;
+
+   assert(completed < full);
+   assert(completed < encoded + 2*sizeof(SendData));
+   assert(confirmed <= sizeof(SendData));
+   assert(allocated == base);
+
+   serverInvite();
+
+   resipCout << "All OK" << endl;
+   return 0;
+}
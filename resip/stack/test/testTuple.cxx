@@ -72,6 +72,11 @@ main()
       assert(testTuple.onlyUseExistingConnection == madeTestTupleWithSalt.onlyUseExistingConnection);
       assert(testTuple.mFlowKey == madeTestTupleWithSalt.mFlowKey);
       assert(madeTestTupleWithBadSalt == Tuple());
+#ifdef USE_NETNS
+      // the default netns goes into the token as id 0 and must come back
+      assert(NetNs::getNetNsId(testTuple.getNetNs()) == 0);
+      assert(madeTestTuple.getNetNs() == testTuple.getNetNs());
+#endif
    }
 
 #ifdef USE_IPV6
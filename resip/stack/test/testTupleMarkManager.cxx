@@ -0,0 +1,112 @@
+#include "resip/stack/MarkListener.hxx"
+#include "resip/stack/TupleMarkManager.hxx"
+#include "rutil/Logger.hxx"
+#include "rutil/Timer.hxx"
+
+#include <cassert>
+#include <iostream>
+#include <vector>
+
+using namespace resip;
+using namespace std;
+
+class Listener : public MarkListener
+{
+   public:
+      void onMark(const Tuple& target, UInt64& expiry, TupleMarkManager::MarkType& mark)
+      {
+         marks.push_back(make_pair(target, mark));
+      }
+      vector<pair<Tuple, TupleMarkManager::MarkType> > marks;
+};
+
+int
+main()
+{
+   Log::initialize(Log::Cout, Log::Info, "testTupleMarkManager");
+
+   TupleMarkManager manager;
+   Listener listener;
+   manager.registerMarkListener(&listener);
+
+   const UInt64 now = Timer::getTimeMs();
+   Tuple a("192.0.2.1", 5060, V4, UDP, "a.example.com");
+   Tuple aTcp("192.0.2.1", 5060, V4, TCP, "a.example.com");
+   Tuple aOther("192.0.2.1", 5060, V4, UDP, "other.example.com");
+   Tuple b("192.0.2.2", 5060, V4, UDP, "b.example.com");
+
+   manager.mark(a, now + 60000, TupleMarkManager::GREY);
+   manager.mark(b, now + 1000, TupleMarkManager::BLACK);
+   assert(manager.getMarkType(a) == TupleMarkManager::GREY);
+   assert(manager.getMarkType(b) == TupleMarkManager::BLACK);
+   // the transport and the target domain are part of what is marked
+   assert(manager.getMarkType(aTcp) == TupleMarkManager::OK);
+   assert(manager.getMarkType(aOther) == TupleMarkManager::OK);
+   assert(manager.size() == 2);
+   assert(listener.marks.size() == 2);
+
+   // marking again replaces the mark
+   manager.mark(b, now + 120000, TupleMarkManager::GREY);
+   assert(manager.getMarkType(b) == TupleMarkManager::GREY);
+   assert(manager.size() == 2);
+
+   // the sweep leaves marks alone until they expire, even where an older
+   // mark of the same tuple would have
+   manager.expire(now + 1000);
+   assert(manager.size() == 2);
+   assert(listener.marks.size() == 3);
+
+   manager.expire(now + 60000);
+   assert(manager.size() == 1);
+   assert(listener.marks.size() == 4);
+   assert(listener.marks.back().first == a);
+   assert(listener.marks.back().second == TupleMarkManager::OK);
+   assert(manager.getMarkType(a) == TupleMarkManager::OK);
+
+   manager.expire(now + 120000);
+   assert(manager.size() == 0);
+   assert(listener.marks.size() == 5);
+
+   // marks that expired before a sweep got to them do not apply either
+   manager.mark(a, now - 1, TupleMarkManager::BLACK);
+   assert(manager.getMarkType(a) == TupleMarkManager::OK);
+   assert(manager.size() == 0);
+   manager.expire(now);
+   assert(listener.marks.size() == 7);
+
+   // lots of greylisted targets, as during an outage
+   {
+      const int count = 20000;
+      vector<Tuple> tuples;
+      for (int i = 0; i < count; ++i)
+      {
+         in_addr addr;
+         addr.s_addr = htonl(0xC6120000 + i);
+         tuples.push_back(Tuple(addr, 5060, UDP, "outage.example.com"));
+         manager.mark(tuples.back(), now + 10000 + i, TupleMarkManager::GREY);
+      }
+      assert(manager.size() == count);
+
+      const UInt64 start = Timer::getTimeMicroSec();
+      int grey = 0;
+      for (int r = 0; r < 10; ++r)
+      {
+         for (int i = 0; i < count; ++i)
+         {
+            grey += manager.getMarkType(tuples[i]) == TupleMarkManager::GREY;
+         }
+      }
+      const UInt64 elapsed = Timer::getTimeMicroSec() - start;
+      assert(grey == 10*count);
+      resipCout << count << " marks: " << (double)elapsed * 1000 / (10*count) << " ns per lookup" << endl;
+
+      manager.expire(now + 10000 + count/2 - 1);
+      assert(manager.size() == count/2);
+      manager.expire(now + 10000 + count);
+      assert(manager.size() == 0);
+   }
+
+   manager.unregisterMarkListener(&listener);
+   resipCout << "All OK" << endl;
+   return 0;
+}
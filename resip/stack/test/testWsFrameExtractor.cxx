@@ -0,0 +1,314 @@
+#if defined(HAVE_CONFIG_H)
+#include "config.h"
+#endif
+
+#include <assert.h>
+#include <iostream>
+#include <stdlib.h>
+#include <string.h>
+
+#include "resip/stack/WsFrameExtractor.hxx"
+#include "rutil/Data.hxx"
+#include "rutil/Logger.hxx"
+#include "rutil/Timer.hxx"
+
+using namespace resip;
+using namespace std;
+
+#define RESIPROCATE_SUBSYSTEM Subsystem::TEST
+
+static const UInt8 maskKey[4] = { 0x37, 0xfa, 0x21, 0x3d };
+
+// Appends one WebSocket frame carrying payload to out.
+static void
+addFrame(Data& out, const Data& payload, bool first, bool fin, bool masked)
+{
+   UInt8 header[14];
+   int len = 0;
+   // text frame, or continuation
+   header[len++] = (fin ? 0x80 : 0x00) | (first ? 0x01 : 0x00);
+   UInt8 maskBit = masked ? 0x80 : 0x00;
+   UInt64 size = payload.size();
+   if(size < 126)
+   {
+      header[len++] = maskBit | (UInt8)size;
+   }
+   else if(size < 65536)
+   {
+      header[len++] = maskBit | 126;
+      header[len++] = (UInt8)(size >> 8);
+      header[len++] = (UInt8)size;
+   }
+   else
+   {
+      header[len++] = maskBit | 127;
+      for(int shift = 56; shift >= 0; shift -= 8)
+      {
+         header[len++] = (UInt8)(size >> shift);
+      }
+   }
+   if(masked)
+   {
+      memcpy(header + len, maskKey, 4);
+      len += 4;
+   }
+   out.append((const char*)header, len);
+
+   if(masked)
+   {
+      for(Data::size_type i = 0; i < payload.size(); ++i)
+      {
+         out += (char)(payload[i] ^ maskKey[i & 3]);
+      }
+   }
+   else
+   {
+      out += payload;
+   }
+}
+
+// Appends message to out, split into frames of at most fragmentSize bytes.
+static void
+addMessage(Data& out, const Data& message, Data::size_type fragmentSize, bool masked)
+{
+   Data::size_type pos = 0;
+   do
+   {
+      Data::size_type size = message.size() - pos;
+      if(size > fragmentSize)
+      {
+         size = fragmentSize;
+      }
+      addFrame(out, message.substr(pos, size), pos == 0, pos + size == message.size(), masked);
+      pos += size;
+   }
+   while(pos < message.size());
+}
+
+// Feeds wire to the extractor in reads of readSize bytes, and returns the
+// number of messages extracted; each must equal expected.
+static int
+extract(WsFrameExtractor& extractor, const Data& wire, Data::size_type readSize,
+        const Data& expected, bool& dropConnection)
+{
+   int count = 0;
+   for(Data::size_type pos = 0; pos < wire.size(); pos += readSize)
+   {
+      Data::size_type len = wire.size() - pos;
+      if(len > readSize)
+      {
+         len = readSize;
+      }
+      Data::size_type msgLen = 0;
+      char* msg = extractor.processBytes((const UInt8*)wire.data() + pos, len, msgLen, dropConnection);
+      while(msg)
+      {
+         assert(Data(Data::Share, msg, msgLen) == expected);
+         assert(msg[msgLen] == 0);
+         delete [] msg;
+         ++count;
+         msg = extractor.processBytes(0, 0, msgLen, dropConnection);
+      }
+      if(dropConnection)
+      {
+         break;
+      }
+   }
+   return count;
+}
+
+static void
+benchmark(const Data& message, Data::size_type fragmentSize, int runs)
+{
+   const int messagesPerRead = 16;
+   Data wire;
+   for(int i = 0; i < messagesPerRead; ++i)
+   {
+      addMessage(wire, message, fragmentSize, true);
+   }
+   int framesPerMessage = (int)((message.size() + fragmentSize - 1) / fragmentSize);
+
+   WsFrameExtractor extractor(65536);
+   UInt64 start = Timer::getTimeMs();
+   int count = 0;
+   for(int i = 0; i < runs; ++i)
+   {
+      bool dropConnection = false;
+      Data::size_type msgLen = 0;
+      char* msg = extractor.processBytes((const UInt8*)wire.data(), wire.size(), msgLen, dropConnection);
+      while(msg)
+      {
+         delete [] msg;
+         ++count;
+         msg = extractor.processBytes(0, 0, msgLen, dropConnection);
+      }
+   }
+   UInt64 elapsed = Timer::getTimeMs() - start;
+   assert(count == runs * messagesPerRead);
+   if(elapsed == 0)
+   {
+      elapsed = 1;
+   }
+   CritLog(<< "Extracted " << count << " messages of " << message.size() << " bytes in "
+           << framesPerMessage << " frame(s) each in " << elapsed << " ms: "
+           << (UInt64)count * framesPerMessage * 1000 / elapsed << " frames/s, "
+           << (UInt64)count * 1000 / elapsed << " messages/s");
+}
+
+int
+main(int argc, char* argv[])
+{
+   Log::initialize(Log::Cout, Log::Info, argv[0]);
+
+   int runs = 20000;
+   if(argc > 1)
+   {
+      runs = atoi(argv[1]);
+   }
+
+   Data message("OPTIONS sip:bob@example.com SIP/2.0\r\n"
+                "Via: SIP/2.0/WSS df7jal23ls0d.invalid;branch=z9hG4bK56sdasks\r\n"
+                "From: sip:alice@example.com;tag=tu7ctdoldh\r\n"
+                "To: sip:bob@example.com\r\n"
+                "Call-ID: asidkj3ss\r\n"
+                "CSeq: 1 OPTIONS\r\n"
+                "Max-Forwards: 70\r\n"
+                "Content-Length: 0\r\n"
+                "\r\n");
+
+   // single frames, masked and unmasked, read whole and a byte at a time
+   {
+      Data wire;
+      addMessage(wire, message, 65536, true);
+      addMessage(wire, message, 65536, false);
+      addMessage(wire, message, 65536, true);
+
+      bool dropConnection = false;
+      WsFrameExtractor whole(65536);
+      assert(extract(whole, wire, wire.size(), message, dropConnection) == 3);
+      assert(!dropConnection);
+
+      WsFrameExtractor byByte(65536);
+      assert(extract(byByte, wire, 1, message, dropConnection) == 3);
+      assert(!dropConnection);
+   }
+
+   // fragmented messages, with reads that do not line up with frames
+   {
+      Data wire;
+      addMessage(wire, message, 7, true);
+      addMessage(wire, message, 64, true);
+      addMessage(wire, message, 1, false);
+
+      bool dropConnection = false;
+      WsFrameExtractor extractor(65536);
+      assert(extract(extractor, wire, 13, message, dropConnection) == 3);
+      assert(!dropConnection);
+   }
+
+   // 16 and 64 bit payload lengths
+   {
+      Data big;
+      while(big.size() < 70000)
+      {
+         big += message;
+      }
+      Data wire;
+      addMessage(wire, big, 300, true);
+      addMessage(wire, big, 100000, true);
+
+      bool dropConnection = false;
+      WsFrameExtractor extractor(big.size());
+      assert(extract(extractor, wire, 4096, big, dropConnection) == 2);
+      assert(!dropConnection);
+   }
+
+   // a message bigger than the limit drops the connection, even when
+   // the individual fragments are not
+   {
+      Data wire;
+      addMessage(wire, message, 64, true);
+
+      bool dropConnection = false;
+      WsFrameExtractor extractor(message.size() - 1);
+      assert(extract(extractor, wire, wire.size(), message, dropConnection) == 0);
+      assert(dropConnection);
+   }
+
+   // unmask() matches a byte at a time XOR at every alignment and offset
+   {
+      UInt8 src[64];
+      UInt8 dst[64];
+      for(int i = 0; i < 64; ++i)
+      {
+         src[i] = (UInt8)(i * 7 + 3);
+      }
+      for(int offset = 0; offset < 8; ++offset)
+      {
+         for(int len = 0; len < 40; ++len)
+         {
+            WsFrameExtractor::unmask(dst, src + offset, len, maskKey, offset);
+            for(int i = 0; i < len; ++i)
+            {
+               assert(dst[i] == (src[offset + i] ^ maskKey[(offset + i) & 3]));
+            }
+         }
+      }
+   }
+
+   benchmark(message, 65536, runs);
+   benchmark(message, 64, runs);
+   benchmark(message, 16, runs);
+
+   return 0;
+}
+
+/* ====================================================================
+ * The Vovida Software License, Version 1.0
+ *
+ * Copyright (c) 2000 Vovida Networks, Inc.  All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * 3. The names "VOCAL", "Vovida Open Communication Application Library",
+ *    and "Vovida Open Communication Application Library (VOCAL)" must
+ *    not be used to endorse or promote products derived from this
+ *    software without prior written permission. For written
+ *    permission, please contact vocal@vovida.org.
+ *
+ * 4. Products derived from this software may not be called "VOCAL", nor
+ *    may "VOCAL" appear in their name, without prior written
+ *    permission of Vovida Networks, Inc.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS" AND ANY EXPRESSED OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, TITLE AND
+ * NON-INFRINGEMENT ARE DISCLAIMED.  IN NO EVENT SHALL VOVIDA
+ * NETWORKS, INC. OR ITS CONTRIBUTORS BE LIABLE FOR ANY DIRECT DAMAGES
+ * IN EXCESS OF $1,000, NOR FOR ANY INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+ * USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+ * DAMAGE.
+ *
+ * ====================================================================
+ *
+ * This software consists of voluntary contributions made by Vovida
+ * Networks, Inc. and many individuals on behalf of Vovida Networks,
+ * Inc.  For more information on Vovida Networks, Inc., please see
+ * <http://www.vovida.org/>.
+ *
+ */
@@ -66,14 +66,14 @@ class FifoStatsInterface
          several), 3 might indicate a particular TU's fifo, etc.
          These are intended for use by CongestionManager only.
       */
-      inline UInt8 getRole() const {return mRole;}
+      inline UInt32 getRole() const {return mRole;}
 
       /**
          @internal
          Set this fifo's role-number.
          @see getRole()
       */
-      inline void setRole(UInt8 role) {mRole=role;}
+      inline void setRole(UInt32 role) {mRole=role;}
 
       /**
          Sets the description for this fifo. This is used in the logging for
@@ -94,7 +94,7 @@ class FifoStatsInterface
 
    protected:
       Data mDescription;
-      UInt8 mRole;
+      UInt32 mRole;
 };
 
 /**
@@ -229,6 +229,7 @@ class AbstractFifo : public FifoStatsInterface
          T firstMessage(mFifo.front());
          mFifo.pop_front();
          onMessagePopped();
+         onMessageTaken(firstMessage);
          return firstMessage;
       }
 
@@ -258,6 +259,7 @@ class AbstractFifo : public FifoStatsInterface
               return false;
             toReturn = mFifo.front();
             mFifo.pop_front();
+            onMessageTaken(toReturn);
             return true;
          }
 
@@ -294,6 +296,7 @@ class AbstractFifo : public FifoStatsInterface
          toReturn=mFifo.front();
          mFifo.pop_front();
          onMessagePopped();
+         onMessageTaken(toReturn);
          return true;
       }
 
@@ -472,6 +475,13 @@ class AbstractFifo : public FifoStatsInterface
          mSize-=num;
       }
 
+      /**
+         Called with mMutex held for each message removed by getNext().
+      */
+      virtual void onMessageTaken(const T& msg)
+      {
+      }
+
       virtual void onMessagePushed(int num)
       {
          if(mSize==0)
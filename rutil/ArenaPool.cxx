@@ -0,0 +1,224 @@
+#if defined(HAVE_CONFIG_H)
+#include "config.h"
+#endif
+
+#include <cstddef>
+#include <limits>
+#include <string.h>
+
+#include "rutil/ArenaPool.hxx"
+
+using namespace resip;
+
+// alignment of everything handed out, the same that ::operator new gives
+static const size_t Alignment = alignof(std::max_align_t);
+
+static inline size_t
+roundUp(size_t size)
+{
+   return (size + Alignment - 1) & ~(Alignment - 1);
+}
+
+ArenaPool::ArenaPool(size_t blockSize, size_t maxSize)
+   : mBlockSize(roundUp(blockSize)),
+     mMaxSize(maxSize),
+     mBlocks(0),
+     mNext(0),
+     mEnd(0),
+     mLast(0),
+     mUsedBytes(0),
+     mHighWaterBytes(0),
+     mReservedBytes(0),
+     mBlockCount(0),
+     mHeapBytes(0)
+{
+}
+
+ArenaPool::~ArenaPool()
+{
+   while (mBlocks)
+   {
+      Block* next = mBlocks->mNext;
+      ::operator delete(mBlocks);
+      mBlocks = next;
+   }
+}
+
+void*
+ArenaPool::allocate(size_t size)
+{
+   void* result = allocateInBlocks(size);
+   if (!result)
+   {
+      mHeapBytes += size;
+      result = ::operator new(size);
+   }
+   return result;
+}
+
+void
+ArenaPool::deallocate(void* ptr)
+{
+   if (!ptr)
+   {
+      return;
+   }
+
+   if (ptr == mLast)
+   {
+      mUsedBytes -= mNext - mLast;
+      mNext = mLast;
+      mLast = 0;
+   }
+   else if (!contains(ptr))
+   {
+      ::operator delete(ptr);
+   }
+}
+
+size_t
+ArenaPool::max_size() const
+{
+   return std::numeric_limits<size_t>::max();
+}
+
+Data
+ArenaPool::copy(const Data& data)
+{
+   char* buffer = static_cast<char*>(allocateInBlocks(data.size() + 1));
+   if (!buffer)
+   {
+      // past maxSize, but the copy must last as long as the arena does
+      buffer = newBlock(roundUp(data.size() + 1), true);
+      mUsedBytes += roundUp(data.size() + 1);
+      if (mUsedBytes > mHighWaterBytes)
+      {
+         mHighWaterBytes = mUsedBytes;
+      }
+   }
+   memcpy(buffer, data.data(), data.size());
+   buffer[data.size()] = 0;
+   return Data(Data::Share, buffer, data.size());
+}
+
+void*
+ArenaPool::allocateInBlocks(size_t size)
+{
+   const size_t rounded = roundUp(size ? size : 1);
+   char* result;
+
+   if (rounded <= (size_t)(mEnd - mNext))
+   {
+      result = mNext;
+      mLast = result;
+      mNext += rounded;
+   }
+   else if (rounded > mBlockSize)
+   {
+      // too big to share a block, so it gets one of its own and the current
+      // block is left to be bumped through
+      result = newBlock(rounded);
+      if (!result)
+      {
+         return 0;
+      }
+   }
+   else
+   {
+      result = newBlock(mBlockSize);
+      if (!result)
+      {
+         return 0;
+      }
+      mLast = result;
+      mNext = result + rounded;
+      mEnd = result + mBlockSize;
+   }
+
+   mUsedBytes += rounded;
+   if (mUsedBytes > mHighWaterBytes)
+   {
+      mHighWaterBytes = mUsedBytes;
+   }
+   return result;
+}
+
+char*
+ArenaPool::newBlock(size_t size, bool pastMaxSize)
+{
+   if (!pastMaxSize && mReservedBytes + size > mMaxSize)
+   {
+      return 0;
+   }
+
+   Block* block = static_cast<Block*>(::operator new(roundUp(sizeof(Block)) + size));
+   block->mNext = mBlocks;
+   block->mSize = size;
+   mBlocks = block;
+   mReservedBytes += size;
+   ++mBlockCount;
+   return reinterpret_cast<char*>(block) + roundUp(sizeof(Block));
+}
+
+bool
+ArenaPool::contains(const void* ptr) const
+{
+   const char* p = static_cast<const char*>(ptr);
+   for (const Block* block = mBlocks; block; block = block->mNext)
+   {
+      const char* begin = reinterpret_cast<const char*>(block) + roundUp(sizeof(Block));
+      if (p >= begin && p < begin + block->mSize)
+      {
+         return true;
+      }
+   }
+   return false;
+}
+
+/* ====================================================================
+ * The Vovida Software License, Version 1.0 
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 
+ * 3. The names "VOCAL", "Vovida Open Communication Application Library",
+ *    and "Vovida Open Communication Application Library (VOCAL)" must
+ *    not be used to endorse or promote products derived from this
+ *    software without prior written permission. For written
+ *    permission, please contact vocal@vovida.org.
+ *
+ * 4. Products derived from this software may not be called "VOCAL", nor
+ *    may "VOCAL" appear in their name, without prior written
+ *    permission of Vovida Networks, Inc.
+ * 
+ * THIS SOFTWARE IS PROVIDED "AS IS" AND ANY EXPRESSED OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, TITLE AND
+ * NON-INFRINGEMENT ARE DISCLAIMED.  IN NO EVENT SHALL VOVIDA
+ * NETWORKS, INC. OR ITS CONTRIBUTORS BE LIABLE FOR ANY DIRECT DAMAGES
+ * IN EXCESS OF $1,000, NOR FOR ANY INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+ * USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+ * DAMAGE.
+ * 
+ * ====================================================================
+ * 
+ * This software consists of voluntary contributions made by Vovida
+ * Networks, Inc. and many individuals on behalf of Vovida Networks,
+ * Inc.  For more information on Vovida Networks, Inc., please see
+ * <http://www.vovida.org/>.
+ *
+ */
@@ -0,0 +1,134 @@
+#if !defined(RESIP_ARENAPOOL_HXX)
+#define RESIP_ARENAPOOL_HXX
+
+#include <stddef.h>
+
+#include "rutil/Data.hxx"
+#include "rutil/PoolBase.hxx"
+
+namespace resip
+{
+
+/**
+   A pool for objects that all go away together, such as everything that
+   belongs to one request. Memory is handed out from blocks by bumping a
+   pointer, and all of the blocks go back to the heap at once when the
+   ArenaPool is destroyed. deallocate() only takes back the most recent
+   allocation; anything else stays in use until then.
+
+   Once maxSize bytes are held in blocks, further allocations come from the
+   heap (and deallocate() frees those as usual), so an owner that lives long
+   and keeps allocating can not grow the arena without bound.
+
+   Only memory is looked after; the destructors of objects placed in the
+   arena still have to be run. Not thread safe.
+*/
+class ArenaPool : public PoolBase
+{
+   public:
+      explicit ArenaPool(size_t blockSize=4096, size_t maxSize=65536);
+      virtual ~ArenaPool();
+
+      virtual void* allocate(size_t size);
+      virtual void deallocate(void* ptr);
+      virtual size_t max_size() const;
+
+      /**
+         Copies data into the arena. The returned Data shares the copy
+         (Data::Share), and stays good for as long as the arena does; so
+         does a Data constructed with Data::Share from it. Copies are made
+         in the arena even once maxSize has been reached.
+      */
+      Data copy(const Data& data);
+
+      /// Bytes handed out of the blocks, now and at the most.
+      size_t getUsedBytes() const { return mUsedBytes; }
+      size_t getHighWaterBytes() const { return mHighWaterBytes; }
+      /// Bytes held in blocks, including what has not been handed out.
+      size_t getReservedBytes() const { return mReservedBytes; }
+      size_t getBlockCount() const { return mBlockCount; }
+      /// Bytes that came from the heap because maxSize had been reached.
+      size_t getHeapBytes() const { return mHeapBytes; }
+
+   private:
+      struct Block
+      {
+         Block* mNext;
+         size_t mSize; // of the memory after the header
+      };
+
+      // 0 once maxSize has been reached
+      void* allocateInBlocks(size_t size);
+      char* newBlock(size_t size, bool pastMaxSize=false);
+      bool contains(const void* ptr) const;
+
+      const size_t mBlockSize;
+      const size_t mMaxSize;
+
+      Block* mBlocks;
+      char* mNext;
+      char* mEnd;
+      char* mLast; // start of the most recent allocation, if it can be undone
+
+      size_t mUsedBytes;
+      size_t mHighWaterBytes;
+      size_t mReservedBytes;
+      size_t mBlockCount;
+      size_t mHeapBytes;
+
+      // disabled
+      ArenaPool(const ArenaPool&);
+      ArenaPool& operator=(const ArenaPool&);
+};
+
+}
+
+#endif
+
+/* ====================================================================
+ * The Vovida Software License, Version 1.0 
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 
+ * 3. The names "VOCAL", "Vovida Open Communication Application Library",
+ *    and "Vovida Open Communication Application Library (VOCAL)" must
+ *    not be used to endorse or promote products derived from this
+ *    software without prior written permission. For written
+ *    permission, please contact vocal@vovida.org.
+ *
+ * 4. Products derived from this software may not be called "VOCAL", nor
+ *    may "VOCAL" appear in their name, without prior written
+ *    permission of Vovida Networks, Inc.
+ * 
+ * THIS SOFTWARE IS PROVIDED "AS IS" AND ANY EXPRESSED OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, TITLE AND
+ * NON-INFRINGEMENT ARE DISCLAIMED.  IN NO EVENT SHALL VOVIDA
+ * NETWORKS, INC. OR ITS CONTRIBUTORS BE LIABLE FOR ANY DIRECT DAMAGES
+ * IN EXCESS OF $1,000, NOR FOR ANY INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+ * USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+ * DAMAGE.
+ * 
+ * ====================================================================
+ * 
+ * This software consists of voluntary contributions made by Vovida
+ * Networks, Inc. and many individuals on behalf of Vovida Networks,
+ * Inc.  For more information on Vovida Networks, Inc., please see
+ * <http://www.vovida.org/>.
+ *
+ */
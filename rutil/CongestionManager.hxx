@@ -33,6 +33,12 @@ class FifoStatsInterface;
    - UdpTransport::mTxFifo
    - DnsStub::mCommandFifo
 
+   Media paths can also be monitored; these fifos are short-lived (one per 
+   flow or relay socket), so there may be a large number of them:
+
+   - Flow::mReceivedDataFifo (reflow, see Flow::congestionManager)
+   - AsyncSocketBase::mSendDataQueue (reTurn, see RelayQueueMaxWaitTime)
+
    The following fifos don't see much use, and are therefore not that vital, but they do have descriptions.
 
    - SipStack::mTUFifo
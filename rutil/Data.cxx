@@ -22,6 +22,12 @@
 #include "Winsock2.h"
 #endif
 
+#if !defined(RESIP_DATA_LEGACY_HASH) && !defined(RESIP_DATA_HASH_NO_SIMD) && \
+    (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define RESIP_DATA_HASH_SSE2
+#include <emmintrin.h>
+#endif
+
 using namespace resip;
 using namespace std;
 
@@ -1912,6 +1918,8 @@ resip::operator<<(EncodeStream& strm, const Data& d)
 }
 #endif
 
+#if defined(RESIP_DATA_LEGACY_HASH)
+
 // random permutation of 0..255
 static const unsigned char randomPermutation[256] = 
 {
@@ -1993,6 +2001,138 @@ Data::rawCaseInsensitiveHash(const unsigned char* c, size_t size)
    return ntohl((u_long)st);
 }
 
+#else
+
+// Word-at-a-time hashing.  Each step loads 8 bytes (with memcpy, so alignment
+// does not matter), xors them into the state and mixes with one multiply and
+// a shift that folds the high half of the product back into the low half.
+// The length goes into the initial state, so trailing NULs still change the
+// hash, and a MurmurHash3 style finalizer spreads every input bit over the
+// whole result, including the low bits that hash tables use to pick a bucket.
+//
+// The case-insensitive forms fold each word before mixing it in; the mixing
+// is shared, so all three hashes agree on input that folding leaves alone.
+namespace
+{
+
+const UInt64 WordHashSeed = 0x243F6A8885A308D3ULL;
+const UInt64 WordHashMultiplier = 0x9E3779B97F4A7C15ULL;
+const UInt64 EveryByte = 0x0101010101010101ULL;
+const UInt64 HighBitOfEveryByte = 0x8080808080808080ULL;
+
+inline UInt64
+startWordHash(size_t size)
+{
+   return WordHashSeed ^ ((UInt64)size * WordHashMultiplier);
+}
+
+inline UInt64
+mixWord(UInt64 h, UInt64 word)
+{
+   h = (h ^ word) * WordHashMultiplier;
+   return h ^ (h >> 32);
+}
+
+inline size_t
+finishWordHash(UInt64 h)
+{
+   h ^= h >> 33;
+   h *= 0xFF51AFD7ED558CCDULL;
+   h ^= h >> 33;
+   h *= 0xC4CEB9FE1A85EC53ULL;
+   h ^= h >> 33;
+   return (size_t)h;
+}
+
+struct NoFold
+{
+   static UInt64 fold(UInt64 word) { return word; }
+};
+
+// Lowercases the ASCII letters in word and leaves every other byte alone
+// (including those >= 0x80), just as tolower() does in the "C" locale. No
+// byte can carry into its neighbour: the low 7 bits plus either constant
+// stay below 0x100.
+struct AsciiFold
+{
+   static UInt64 fold(UInt64 word)
+   {
+      const UInt64 ascii = ~word & HighBitOfEveryByte;
+      const UInt64 low7 = word & ~HighBitOfEveryByte;
+      const UInt64 atLeastA = low7 + (0x80 - 'A') * EveryByte;
+      const UInt64 pastZ = low7 + (0x80 - 'Z' - 1) * EveryByte;
+      return word | (((atLeastA ^ pastZ) & ascii) >> 2);
+   }
+};
+
+// Sets bit 5 of every byte; see rawCaseInsensitiveTokenHash.
+struct TokenFold
+{
+   static UInt64 fold(UInt64 word) { return word | (0x20 * EveryByte); }
+};
+
+template<class Fold>
+inline UInt64
+mixWords(UInt64 h, const unsigned char* c, size_t size)
+{
+   const unsigned char* end = c + (size & ~(size_t)7);
+   for ( ; c != end; c += 8)
+   {
+      UInt64 word;
+      memcpy(&word, c, sizeof(word));
+      h = mixWord(h, Fold::fold(word));
+   }
+   if (size & 7)
+   {
+      UInt64 word = 0;
+      memcpy(&word, c, size & 7);
+      h = mixWord(h, Fold::fold(word));
+   }
+   return h;
+}
+
+#if defined(RESIP_DATA_HASH_SSE2)
+// SSE2 version of AsciiFold for 16 bytes at a time. The compares are signed,
+// so bytes >= 0x80 are negative and never taken for capitals.
+inline __m128i
+foldBlock(__m128i block)
+{
+   const __m128i upper = _mm_and_si128(_mm_cmpgt_epi8(block, _mm_set1_epi8('A' - 1)),
+                                       _mm_cmplt_epi8(block, _mm_set1_epi8('Z' + 1)));
+   return _mm_or_si128(block, _mm_and_si128(upper, _mm_set1_epi8(0x20)));
+}
+#endif
+
+}
+
+size_t
+Data::rawHash(const unsigned char* c, size_t size)
+{
+   return finishWordHash(mixWords<NoFold>(startWordHash(size), c, size));
+}
+
+// use only for ascii characters!
+size_t
+Data::rawCaseInsensitiveHash(const unsigned char* c, size_t size)
+{
+   UInt64 h = startWordHash(size);
+#if defined(RESIP_DATA_HASH_SSE2)
+   // Same words, in the same order, as the loop in mixWords; this just folds
+   // two of them at once.
+   const unsigned char* end = c + (size & ~(size_t)15);
+   for ( ; c != end; c += 16)
+   {
+      UInt64 words[2];
+      _mm_storeu_si128((__m128i*)words, foldBlock(_mm_loadu_si128((const __m128i*)c)));
+      h = mixWord(mixWord(h, words[0]), words[1]);
+   }
+   size &= 15;
+#endif
+   return finishWordHash(mixWords<AsciiFold>(h, c, size));
+}
+
+#endif
+
 #if defined(RESIP_BIG_ENDIAN) || (defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__))
 
 #if !defined (get16bits)
@@ -2028,6 +2168,7 @@ Data::rawCaseInsensitiveHash(const unsigned char* c, size_t size)
 #endif
 #endif
 
+#if defined(RESIP_DATA_LEGACY_HASH)
 // This is intended to be a faster case-insensitive hash function that works
 // well when the buffer is a RFC 3261 token.
 // Having non-token characters will not prevent the hash from working, but it 
@@ -2127,6 +2268,22 @@ Data::rawCaseInsensitiveTokenHash(const unsigned char* data, size_t len)
 //   return ntohl((u_long)st);
 }
 
+#else
+
+// Hashes the buffer as though bit 5 (0x20) were set in every byte, which
+// lowercases letters but also makes some other characters look the same.
+// The pairs of _printable_ characters that this hash will not distinguish
+// between are @`, [{, \|, ]} and ^~
+// (Note that, for RFC 3261 tokens, this will not be a problem since @, [, {, \,
+// |, ], } and ^ are not allowed in a token.)
+size_t
+Data::rawCaseInsensitiveTokenHash(const unsigned char* data, size_t len)
+{
+   return finishWordHash(mixWords<TokenFold>(startWordHash(len), data, len));
+}
+
+#endif
+
 Data
 bits(size_t v)
 {
@@ -854,8 +854,10 @@ class Data
       Data base64encode(bool useUrlSafe=false) const;
 
       /**
-        Creates a 32-bit hash based on the contents of the indicated
-        buffer.
+        Creates a hash based on the contents of the indicated buffer. The
+        buffer is consumed 8 bytes at a time and the result uses all the
+        bits of a size_t; building with RESIP_DATA_LEGACY_HASH selects the
+        older byte-at-a-time 32-bit hash instead.
 
         @param c Pointer to the buffer to hash
         @param size Number of bytes to be hashed
@@ -863,13 +865,16 @@ class Data
       static size_t rawHash(const unsigned char* c, size_t size);
 
       /**
-        Creates a 32-bit hash based on the contents of this Data.
+        Creates a hash based on the contents of this Data.
       */
       size_t hash() const;
 
       /**
-        Creates a 32-bit hash based on the contents of the indicated
-        buffer, after normalizing any alphabetic characters to lowercase.
+        Creates a hash based on the contents of the indicated buffer, after
+        normalizing any alphabetic characters to lowercase. Where SSE2 is
+        available the lowercasing is done 16 bytes at a time (unless
+        RESIP_DATA_HASH_NO_SIMD is defined); the result is the same either
+        way.
 
         @param c Pointer to the buffer to hash
         @param size Number of bytes to be hashed
@@ -888,7 +893,7 @@ class Data
       static size_t rawCaseInsensitiveTokenHash(const unsigned char* c, size_t size);
 
       /**
-        Creates a 32-bit hash based on the contents of this Data, after
+        Creates a hash based on the contents of this Data, after
         normalizing any alphabetic characters to lowercase.
       */
       size_t caseInsensitivehash() const;
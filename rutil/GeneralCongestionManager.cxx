@@ -32,17 +32,31 @@ GeneralCongestionManager::registerFifo(resip::FifoStatsInterface* fifo,
    info.fifo=fifo;
    info.metric=metric;
    info.maxTolerance=maxTolerance;
+
+   // Short-lived fifos (such as media receive fifos) come and go all the
+   // time, so reuse the slots vacated by unregisterFifo() instead of growing
+   // mFifos forever.
+   if(!mFreeSlots.empty())
+   {
+      UInt32 slot=mFreeSlots.back();
+      mFreeSlots.pop_back();
+      mFifos[slot]=info;
+      fifo->setRole(slot);
+      return;
+   }
+
    mFifos.push_back(info);
-   fifo->setRole((UInt8)mFifos.size()-1);
+   fifo->setRole((UInt32)(mFifos.size()-1));
 }
 
 void 
 GeneralCongestionManager::unregisterFifo(resip::FifoStatsInterface* fifo)
 {
    Lock lock(mFifosMutex);
-   if(fifo->getRole() < mFifos.size())
+   if(fifo->getRole() < mFifos.size() && mFifos[fifo->getRole()].fifo==fifo)
    {
       mFifos[fifo->getRole()].fifo=0;
+      mFreeSlots.push_back(fifo->getRole());
    }
 }
 
@@ -144,7 +158,11 @@ GeneralCongestionManager::getCongestionPercent(const FifoStatsInterface* fifo) c
    }
 
    const FifoInfo& info = mFifos[fifo->getRole()];
-   resip_assert(info.fifo==fifo);
+   if(info.fifo!=fifo)
+   {
+      // Unregistered, and the slot has since been handed to another fifo
+      return 0;
+   }
    switch(info.metric)
    {
       case SIZE:
@@ -154,6 +154,7 @@ class GeneralCongestionManager : public CongestionManager
       } FifoInfo; // !bwc! TODO pick a better name
 
       std::vector<FifoInfo> mFifos;
+      std::vector<UInt32> mFreeSlots; // indices into mFifos vacated by unregisterFifo()
       // !slg! would love to get rid of the following mutex - but we need to protect  
       //       threads querying the congestion stats and make sure runtime transport 
       //       additions are safe (ie: registerFifo and unregisterFifo being called 
@@ -210,12 +210,12 @@ insert(EncodeStream& s, const HashSet<V,H>& c)
 #endif
 
 // map
-template <class K, class V, class H>
+template <class K, class V, class H, class A>
 EncodeStream&
-insert(EncodeStream& s, const std::map <K, V, H>& c)
+insert(EncodeStream& s, const std::map <K, V, H, A>& c)
 {
    s << leftsqbracket;
-   for (typename std::map<K,V, H>::const_iterator i = c.begin();
+   for (typename std::map<K,V, H, A>::const_iterator i = c.begin();
         i != c.end(); i++) 
    {
       if (i != c.begin()) 
@@ -463,12 +463,12 @@ insertP(EncodeStream& s, const HashSet<V,H>& c)
 #endif
 
 // map
-template <class K, class V, class H>
+template <class K, class V, class H, class A>
 EncodeStream&
-insertP(EncodeStream& s, const std::map <K, V, H>& c)
+insertP(EncodeStream& s, const std::map <K, V, H, A>& c)
 {
    s << leftsqbracket;
-   for (typename std::map<K,V, H>::const_iterator i = c.begin();
+   for (typename std::map<K,V, H, A>::const_iterator i = c.begin();
         i != c.end(); i++) 
    {
       if (i != c.begin()) 
@@ -0,0 +1,343 @@
+#if defined(HAVE_CONFIG_H)
+#include "config.h"
+#endif
+
+#include <atomic>
+#include <string.h>
+
+#include "rutil/LatencyHistogram.hxx"
+#include "rutil/Lock.hxx"
+#include "rutil/ResipAssert.h"
+
+using namespace resip;
+
+LatencyHistogram::LatencyHistogram()
+{
+   zeroOut();
+}
+
+void
+LatencyHistogram::zeroOut()
+{
+   memset(mCounts, 0, sizeof(mCounts));
+   mSum = 0;
+}
+
+void
+LatencyHistogram::add(const LatencyHistogram& rhs)
+{
+   for (unsigned int b = 0; b < BucketCount; ++b)
+   {
+      mCounts[b] += rhs.mCounts[b];
+   }
+   mSum += rhs.mSum;
+}
+
+void
+LatencyHistogram::subtract(const LatencyHistogram& rhs)
+{
+   for (unsigned int b = 0; b < BucketCount; ++b)
+   {
+      mCounts[b] -= rhs.mCounts[b];
+   }
+   mSum -= rhs.mSum;
+}
+
+UInt64
+LatencyHistogram::getCount() const
+{
+   UInt64 count = 0;
+   for (unsigned int b = 0; b < BucketCount; ++b)
+   {
+      count += mCounts[b];
+   }
+   return count;
+}
+
+UInt64
+LatencyHistogram::getMean() const
+{
+   UInt64 count = getCount();
+   return count ? mSum / count : 0;
+}
+
+UInt64
+LatencyHistogram::getPercentile(double percentile) const
+{
+   UInt64 count = getCount();
+   if (count == 0)
+   {
+      return 0;
+   }
+
+   // smallest rank such that at least percentile% of the values are <= it
+   UInt64 rank = (UInt64)(percentile * count / 100.0);
+   if ((double)rank * 100.0 < percentile * count)
+   {
+      ++rank;
+   }
+   if (rank == 0)
+   {
+      rank = 1;
+   }
+
+   UInt64 seen = 0;
+   for (unsigned int b = 0; b < BucketCount; ++b)
+   {
+      seen += mCounts[b];
+      if (seen >= rank)
+      {
+         return bucketUpperBound(b);
+      }
+   }
+   return bucketUpperBound(BucketCount - 1);
+}
+
+UInt64
+LatencyHistogram::getMax() const
+{
+   for (unsigned int b = BucketCount; b > 0; --b)
+   {
+      if (mCounts[b - 1])
+      {
+         return bucketUpperBound(b - 1);
+      }
+   }
+   return 0;
+}
+
+UInt64
+LatencyHistogram::bucketUpperBound(unsigned int bucket)
+{
+   resip_assert(bucket < BucketCount);
+   if (bucket < 2 * SubBuckets)
+   {
+      return bucket;
+   }
+   // bucket == shift * SubBuckets + (value >> shift), where
+   // SubBuckets <= (value >> shift) < 2 * SubBuckets
+   unsigned int shift = bucket / SubBuckets - 1;
+   UInt64 mantissa = bucket - shift * SubBuckets;
+   return ((mantissa + 1) << shift) - 1;
+}
+
+EncodeStream&
+LatencyHistogram::encodeSummary(EncodeStream& strm) const
+{
+   return LatencySummary(*this).encode(strm);
+}
+
+LatencySummary::LatencySummary()
+{
+   zeroOut();
+}
+
+LatencySummary::LatencySummary(const LatencyHistogram& histogram)
+{
+   mCount = histogram.getCount();
+   if (mCount == 0)
+   {
+      zeroOut();
+      return;
+   }
+   mMean = histogram.getMean();
+   mP50 = histogram.getPercentile(50);
+   mP90 = histogram.getPercentile(90);
+   mP99 = histogram.getPercentile(99);
+   mP999 = histogram.getPercentile(99.9);
+   mMax = histogram.getMax();
+}
+
+void
+LatencySummary::zeroOut()
+{
+   mCount = 0;
+   mMean = 0;
+   mP50 = 0;
+   mP90 = 0;
+   mP99 = 0;
+   mP999 = 0;
+   mMax = 0;
+}
+
+EncodeStream&
+LatencySummary::encode(EncodeStream& strm) const
+{
+   strm << "n=" << mCount
+        << " mean=" << mMean
+        << " p50=" << mP50
+        << " p90=" << mP90
+        << " p99=" << mP99
+        << " p99.9=" << mP999
+        << " max=" << mMax;
+   return strm;
+}
+
+// One thread's counters. Only the owning thread writes them, so the
+// increments do not need to be atomic read-modify-writes; the atomics are
+// there so that collect() can read them while they are being written.
+class ConcurrentLatencyHistograms::Shard
+{
+   public:
+      explicit Shard(unsigned int numHistograms)
+         : mCounts(new std::atomic<unsigned int>[numHistograms * LatencyHistogram::BucketCount]()),
+           mSums(new std::atomic<UInt64>[numHistograms]())
+      {}
+
+      ~Shard()
+      {
+         delete [] mCounts;
+         delete [] mSums;
+      }
+
+      void record(unsigned int histogram, UInt64 microSec)
+      {
+         std::atomic<unsigned int>& count =
+            mCounts[histogram * LatencyHistogram::BucketCount + LatencyHistogram::bucketFor(microSec)];
+         count.store(count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+         std::atomic<UInt64>& sum = mSums[histogram];
+         sum.store(sum.load(std::memory_order_relaxed) + microSec, std::memory_order_relaxed);
+      }
+
+      void addTo(unsigned int histogram, LatencyHistogram& out) const
+      {
+         LatencyHistogram mine;
+         const std::atomic<unsigned int>* counts = mCounts + histogram * LatencyHistogram::BucketCount;
+         for (unsigned int b = 0; b < LatencyHistogram::BucketCount; ++b)
+         {
+            mine.mCounts[b] = counts[b].load(std::memory_order_relaxed);
+         }
+         mine.mSum = mSums[histogram].load(std::memory_order_relaxed);
+         out.add(mine);
+      }
+
+   private:
+      std::atomic<unsigned int>* mCounts;
+      std::atomic<UInt64>* mSums;
+
+      Shard(const Shard&);
+      Shard& operator=(const Shard&);
+};
+
+ConcurrentLatencyHistograms::ConcurrentLatencyHistograms(unsigned int numHistograms)
+   : mNumHistograms(numHistograms),
+     mShardKey(0),
+     mBaseline(numHistograms)
+{
+   // Shards are owned by mShards, not by the thread.
+   int err = ThreadIf::tlsKeyCreate(mShardKey, 0);
+   resip_assert(err == 0);
+   (void)err;
+}
+
+ConcurrentLatencyHistograms::~ConcurrentLatencyHistograms()
+{
+   ThreadIf::tlsKeyDelete(mShardKey);
+   for (std::vector<Shard*>::iterator i = mShards.begin(); i != mShards.end(); ++i)
+   {
+      delete *i;
+   }
+}
+
+ConcurrentLatencyHistograms::Shard*
+ConcurrentLatencyHistograms::getShard()
+{
+   Shard* shard = static_cast<Shard*>(ThreadIf::tlsGetValue(mShardKey));
+   if (!shard)
+   {
+      shard = new Shard(mNumHistograms);
+      {
+         Lock lock(mMutex);
+         mShards.push_back(shard);
+      }
+      ThreadIf::tlsSetValue(mShardKey, shard);
+   }
+   return shard;
+}
+
+void
+ConcurrentLatencyHistograms::record(unsigned int histogram, UInt64 microSec)
+{
+   resip_assert(histogram < mNumHistograms);
+   getShard()->record(histogram, microSec);
+}
+
+void
+ConcurrentLatencyHistograms::collect(LatencyHistogram* out) const
+{
+   Lock lock(mMutex);
+   for (unsigned int h = 0; h < mNumHistograms; ++h)
+   {
+      out[h].zeroOut();
+      for (std::vector<Shard*>::const_iterator i = mShards.begin(); i != mShards.end(); ++i)
+      {
+         (*i)->addTo(h, out[h]);
+      }
+      out[h].subtract(mBaseline[h]);
+   }
+}
+
+void
+ConcurrentLatencyHistograms::reset()
+{
+   std::vector<LatencyHistogram> totals(mNumHistograms);
+   Lock lock(mMutex);
+   for (unsigned int h = 0; h < mNumHistograms; ++h)
+   {
+      for (std::vector<Shard*>::const_iterator i = mShards.begin(); i != mShards.end(); ++i)
+      {
+         (*i)->addTo(h, totals[h]);
+      }
+   }
+   mBaseline.swap(totals);
+}
+
+/* ====================================================================
+ * The Vovida Software License, Version 1.0
+ *
+ * Copyright (c) 2000 Vovida Networks, Inc.  All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * 3. The names "VOCAL", "Vovida Open Communication Application Library",
+ *    and "Vovida Open Communication Application Library (VOCAL)" must
+ *    not be used to endorse or promote products derived from this
+ *    software without prior written permission. For written
+ *    permission, please contact vocal@vovida.org.
+ *
+ * 4. Products derived from this software may not be called "VOCAL", nor
+ *    may "VOCAL" appear in their name, without prior written
+ *    permission of Vovida Networks, Inc.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS" AND ANY EXPRESSED OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, TITLE AND
+ * NON-INFRINGEMENT ARE DISCLAIMED.  IN NO EVENT SHALL VOVIDA
+ * NETWORKS, INC. OR ITS CONTRIBUTORS BE LIABLE FOR ANY DIRECT DAMAGES
+ * IN EXCESS OF $1,000, NOR FOR ANY INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+ * USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+ * DAMAGE.
+ *
+ * ====================================================================
+ *
+ * This software consists of voluntary contributions made by Vovida
+ * Networks, Inc. and many individuals on behalf of Vovida Networks,
+ * Inc.  For more information on Vovida Networks, Inc., please see
+ * <http://www.vovida.org/>.
+ *
+ */
@@ -0,0 +1,223 @@
+#if !defined(RESIP_LATENCYHISTOGRAM_HXX)
+#define RESIP_LATENCYHISTOGRAM_HXX
+
+#include <vector>
+
+#include "rutil/compat.hxx"
+#include "rutil/Mutex.hxx"
+#include "rutil/ThreadIf.hxx"
+#include "rutil/resipfaststreams.hxx"
+
+namespace resip
+{
+
+/**
+   @brief A histogram of latencies, in microseconds.
+
+   Values below SubBuckets are counted exactly; above that, each power of two
+   is split into SubBuckets linear buckets, so any value reported back (a
+   percentile, for instance) is within 1/SubBuckets (12.5%) of the true
+   value. Values of 2^32 microseconds (about 71 minutes) and above all land in
+   the last bucket. Recording is a couple of shifts and an increment, and the
+   whole thing is a flat array, so merging and copying are cheap; see
+   LatencySummary for something smaller to pass around.
+
+   Not thread-safe; see ConcurrentLatencyHistograms for that.
+*/
+class LatencyHistogram
+{
+   public:
+      enum
+      {
+         SubBucketBits = 3,
+         SubBuckets = 1 << SubBucketBits,
+         MaxValueBits = 32,
+         BucketCount = (MaxValueBits - SubBucketBits + 1) * SubBuckets
+      };
+
+      LatencyHistogram();
+
+      void record(UInt64 microSec)
+      {
+         ++mCounts[bucketFor(microSec)];
+         mSum += microSec;
+      }
+
+      void add(const LatencyHistogram& rhs);
+      void subtract(const LatencyHistogram& rhs);
+      void zeroOut();
+
+      UInt64 getCount() const;
+      UInt64 getSum() const { return mSum; }
+      /// Mean of everything recorded, or 0 if nothing was.
+      UInt64 getMean() const;
+      /// Upper bound of the bucket holding the given percentile (0-100) of
+      /// the recorded values, or 0 if nothing was recorded.
+      UInt64 getPercentile(double percentile) const;
+      /// Upper bound of the highest non-empty bucket.
+      UInt64 getMax() const;
+
+      unsigned int getBucketCount(unsigned int bucket) const { return mCounts[bucket]; }
+
+      static unsigned int bucketFor(UInt64 microSec)
+      {
+         if (microSec < SubBuckets)
+         {
+            return (unsigned int)microSec;
+         }
+         unsigned int shift = 0;
+         while ((microSec >> shift) >= 2 * SubBuckets)
+         {
+            ++shift;
+         }
+         unsigned int bucket = shift * SubBuckets + (unsigned int)(microSec >> shift);
+         return bucket < BucketCount ? bucket : BucketCount - 1;
+      }
+      /// The largest value that lands in bucket.
+      static UInt64 bucketUpperBound(unsigned int bucket);
+
+      /// One line summary: "n=<count> mean=<us> p50=<us> p90=<us> p99=<us>
+      /// p99.9=<us> max=<us>"
+      EncodeStream& encodeSummary(EncodeStream& strm) const;
+
+   private:
+      friend class ConcurrentLatencyHistograms;
+
+      unsigned int mCounts[BucketCount];
+      UInt64 mSum;
+};
+
+/**
+   @brief The figures LatencyHistogram::encodeSummary() prints, taken from a
+      histogram at one point in time.
+
+   A few dozen bytes instead of a few kilobytes, so this is what gets copied
+   into a StatisticsMessage::Payload rather than the histogram itself.
+*/
+class LatencySummary
+{
+   public:
+      LatencySummary();
+      explicit LatencySummary(const LatencyHistogram& histogram);
+
+      void zeroOut();
+
+      UInt64 getCount() const { return mCount; }
+      UInt64 getMean() const { return mMean; }
+      UInt64 getP50() const { return mP50; }
+      UInt64 getP90() const { return mP90; }
+      UInt64 getP99() const { return mP99; }
+      UInt64 getP999() const { return mP999; }
+      UInt64 getMax() const { return mMax; }
+
+      /// Same format as LatencyHistogram::encodeSummary()
+      EncodeStream& encode(EncodeStream& strm) const;
+
+   private:
+      UInt64 mCount;
+      UInt64 mMean;
+      UInt64 mP50;
+      UInt64 mP90;
+      UInt64 mP99;
+      UInt64 mP999;
+      UInt64 mMax;
+};
+
+/**
+   @brief A fixed set of LatencyHistograms that any number of threads can
+      record into without taking a lock.
+
+   The first time a thread records, it gets its own set of counters (found
+   again through thread-local storage) and registers them here; from then on
+   its samples go only there, with relaxed atomic increments that no other
+   thread writes. collect() sums every thread's counters, so it is the only
+   call that has to look at all of them. reset() does not touch the
+   per-thread counters; it remembers the current totals and collect()
+   subtracts them.
+
+   Per-thread counters are kept until this object is destroyed, so samples
+   from threads that have since exited still count.
+*/
+class ConcurrentLatencyHistograms
+{
+   public:
+      explicit ConcurrentLatencyHistograms(unsigned int numHistograms);
+      ~ConcurrentLatencyHistograms();
+
+      unsigned int size() const { return mNumHistograms; }
+
+      void record(unsigned int histogram, UInt64 microSec);
+
+      /// Overwrites out[0..size()-1] with everything recorded since the last
+      /// reset().
+      void collect(LatencyHistogram* out) const;
+      void reset();
+
+   private:
+      class Shard;
+      Shard* getShard();
+
+      const unsigned int mNumHistograms;
+      ThreadIf::TlsKey mShardKey;
+      mutable Mutex mMutex;
+      std::vector<Shard*> mShards;
+      std::vector<LatencyHistogram> mBaseline;
+
+      // dis-allowed by not implemented
+      ConcurrentLatencyHistograms(const ConcurrentLatencyHistograms&);
+      ConcurrentLatencyHistograms& operator=(const ConcurrentLatencyHistograms&);
+};
+
+}
+
+#endif
+
+/* ====================================================================
+ * The Vovida Software License, Version 1.0
+ *
+ * Copyright (c) 2000 Vovida Networks, Inc.  All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * 3. The names "VOCAL", "Vovida Open Communication Application Library",
+ *    and "Vovida Open Communication Application Library (VOCAL)" must
+ *    not be used to endorse or promote products derived from this
+ *    software without prior written permission. For written
+ *    permission, please contact vocal@vovida.org.
+ *
+ * 4. Products derived from this software may not be called "VOCAL", nor
+ *    may "VOCAL" appear in their name, without prior written
+ *    permission of Vovida Networks, Inc.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS" AND ANY EXPRESSED OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, TITLE AND
+ * NON-INFRINGEMENT ARE DISCLAIMED.  IN NO EVENT SHALL VOVIDA
+ * NETWORKS, INC. OR ITS CONTRIBUTORS BE LIABLE FOR ANY DIRECT DAMAGES
+ * IN EXCESS OF $1,000, NOR FOR ANY INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+ * USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+ * DAMAGE.
+ *
+ * ====================================================================
+ *
+ * This software consists of voluntary contributions made by Vovida
+ * Networks, Inc. and many individuals on behalf of Vovida Networks,
+ * Inc.  For more information on Vovida Networks, Inc., please see
+ * <http://www.vovida.org/>.
+ *
+ */
@@ -184,12 +184,20 @@ int NetNs::getNetNsId(const Data& netNsName, bool shouldAdd)
    }
    else if(shouldAdd)
    {
-      netNsId = netNsName.caseInsensitiveTokenHash();
+      // The id travels in 32 bits of the Tuple binary token, so fold the 
+      // hash into the positive int range.  0 is the default netns and -1 
+      // means not found.
+      UInt64 hash = netNsName.caseInsensitiveTokenHash();
+      netNsId = (int)((hash ^ (hash >> 32)) & 0x7fffffff);
+      if(netNsId == 0)
+      {
+         netNsId = 1;
+      }
       int originalId = netNsId;
       // If hash is not unique, find the next available id
       while(sIdDictionaryToNetNs.find(netNsId) != sIdDictionaryToNetNs.end())
       {
-         netNsId++;
+         netNsId = (netNsId == 0x7fffffff) ? 1 : netNsId + 1;
       }
 
       // This means another netns name had the same hash (i.e. the hash is
@@ -233,9 +241,9 @@ void NetNs::initDictionary()
    if(sIdDictionaryToNetNs.size() == 0 &&
       sNetNsDictionaryToId.size() == 0)
    {
-      Data defaultNetNs("");
-      sIdDictionaryToNetNs[defaultNetNs.caseInsensitiveTokenHash()] = defaultNetNs;
-      sNetNsDictionaryToId[""] = 0;
+      // The default netns always has id 0, whatever "" hashes to
+      sIdDictionaryToNetNs[0] = Data::Empty;
+      sNetNsDictionaryToId[Data::Empty] = 0;
 
       // No locking, so test no one else touched 
       // the dictionary
@@ -6,10 +6,104 @@
 #include "rutil/DataStream.hxx"
 #include "rutil/WinLeakCheck.hxx"
 
+#if !defined(RESIP_PARSEBUFFER_NO_SIMD) && \
+    (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define RESIP_PARSEBUFFER_SSE2
+#include <emmintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
 using namespace resip;
 
 #define RESIPROCATE_SUBSYSTEM Subsystem::SIP
 
+namespace
+{
+
+// Longest character set that the SSE2 scan handles; the sets used by the
+// parsers are between one and six characters.
+const size_t MaxSimdSet = 8;
+
+#if defined(RESIP_PARSEBUFFER_SSE2)
+inline unsigned int
+firstBit(unsigned int mask)
+{
+#ifdef _MSC_VER
+   unsigned long index;
+   _BitScanForward(&index, mask);
+   return index;
+#else
+   return __builtin_ctz(mask);
+#endif
+}
+#endif
+
+// Returns the first position in [pos, end) holding one of the n chars at cs
+// (or, if inSet is false, holding none of them), or end.  Each set char is
+// compared against 16 bytes at a time.
+const char*
+scanSet(const char* pos, const char* end, const char* cs, size_t n, bool inSet)
+{
+#if defined(RESIP_PARSEBUFFER_SSE2)
+   if (n > 0 && n <= MaxSimdSet)
+   {
+      __m128i set[MaxSimdSet];
+      for (size_t i = 0; i < n; ++i)
+      {
+         set[i] = _mm_set1_epi8(cs[i]);
+      }
+      const unsigned int flip = inSet ? 0 : 0xFFFF;
+      for ( ; end - pos >= 16; pos += 16)
+      {
+         const __m128i block = _mm_loadu_si128((const __m128i*)pos);
+         __m128i hit = _mm_cmpeq_epi8(block, set[0]);
+         for (size_t i = 1; i < n; ++i)
+         {
+            hit = _mm_or_si128(hit, _mm_cmpeq_epi8(block, set[i]));
+         }
+         const unsigned int mask = (unsigned int)_mm_movemask_epi8(hit) ^ flip;
+         if (mask)
+         {
+            return pos + firstBit(mask);
+         }
+      }
+   }
+#endif
+   for ( ; pos < end; ++pos)
+   {
+      if ((memchr(cs, *pos, n) != 0) == inSet)
+      {
+         return pos;
+      }
+   }
+   return end;
+}
+
+// Returns the start of the first occurrence of the n chars at sub in
+// [pos, end), or end.  n must not be 0.
+const char*
+findSubstring(const char* pos, const char* end, const char* sub, size_t n)
+{
+   while ((size_t)(end - pos) >= n)
+   {
+      pos = (const char*)memchr(pos, *sub, (end - pos) - n + 1);
+      if (!pos)
+      {
+         break;
+      }
+      if (memcmp(pos + 1, sub + 1, n - 1) == 0)
+      {
+         return pos;
+      }
+      ++pos;
+   }
+   return end;
+}
+
+}
+
 const char* ParseBuffer::ParamTerm = ";?"; // maybe include "@>,"?
 const char* ParseBuffer::Whitespace = " \t\r\n";
 const Data ParseBuffer::Pointer::msg("dereferenced ParseBuffer eof");
@@ -115,41 +209,14 @@ ParseBuffer::CurrentPosition
 ParseBuffer::skipNonWhitespace()
 {
    assertNotEof();
-   while (mPosition < mEnd)
-   {
-      switch (*mPosition)
-      {
-         case ' ' :
-         case '\t' : 
-         case '\r' : 
-         case '\n' : 
-            return CurrentPosition(*this);
-         default : 
-            mPosition++;
-      }
-   }
+   mPosition = scanSet(mPosition, mEnd, Whitespace, 4, true);
    return CurrentPosition(*this);
 }
 
 ParseBuffer::CurrentPosition
 ParseBuffer::skipWhitespace()
 {
-   while (mPosition < mEnd)
-   {
-      switch (*mPosition)
-      {
-         case ' ' :
-         case '\t' : 
-         case '\r' : 
-         case '\n' : 
-         {
-            mPosition++;
-            break;
-         }
-         default : 
-            return CurrentPosition(*this);
-      }
-   }
+   mPosition = scanSet(mPosition, mEnd, Whitespace, 4, false);
    return CurrentPosition(*this);
 }
 
@@ -243,67 +310,27 @@ ParseBuffer::CurrentPosition
 ParseBuffer::skipToChars(const char* cs)
 {
    resip_assert(cs);
-   unsigned int l = (unsigned int)strlen(cs);
-
-   const char* rpos;
-   const char* cpos;
-   // Checking mPosition >= mEnd - l +1 is unnecessary because there won't be
-   // enough bytes left to find [cs].
-   while (mPosition < mEnd - l + 1)
+   size_t l = strlen(cs);
+   if (l == 0)
    {
-      rpos = mPosition;
-      cpos = cs;
-      for (unsigned int i = 0; i < l; i++)
-      {
-         if (*cpos++ != *rpos++)
-         {
-            mPosition++;
-            goto skip;
-         }
-      }
       return CurrentPosition(*this);
-     skip: ;
    }
-   // Advance to the end since we didn't find a match.
-   mPosition = mEnd;
+
+   mPosition = findSubstring(mPosition, mEnd, cs, l);
    return CurrentPosition(*this);
 }
 
 ParseBuffer::CurrentPosition
 ParseBuffer::skipToChars(const Data& sub)
 {
-   const char* begSub = sub.mBuf;
-   const char* endSub = sub.mBuf + sub.mSize;
-   if(begSub == endSub)
+   if(sub.empty())
    {
       fail(__FILE__, __LINE__, "ParseBuffer::skipToChars() called with an "
                                  "empty string. Don't do this!");
    }
 
-   while (true)
-   {
-next:
-     const char* searchPos = mPosition;
-     const char* subPos = sub.mBuf;
-
-     while (subPos != endSub) 
-     {
-         if (searchPos == mEnd)
-         {
-            // nope
-            mPosition = mEnd;
-            return CurrentPosition(*this);
-         }
-         if (*subPos++ != *searchPos++)
-         {
-            // nope, but try the next position
-            ++mPosition;
-            goto next;
-         }
-     }
-     // found a match
-     return CurrentPosition(*this);
-   }
+   mPosition = findSubstring(mPosition, mEnd, sub.data(), sub.size());
+   return CurrentPosition(*this);
 }
 
 bool 
@@ -335,17 +362,7 @@ ParseBuffer::oneOf(char c, const Data& cs)
 ParseBuffer::CurrentPosition
 ParseBuffer::skipToOneOf(const char* cs)
 {
-   while (mPosition < mEnd)
-   {
-      if (oneOf(*mPosition, cs))
-      {
-         return CurrentPosition(*this);
-      }
-      else
-      {
-         mPosition++;
-      }
-   }
+   mPosition = scanSet(mPosition, mEnd, cs, strlen(cs), true);
    return CurrentPosition(*this);
 }
 
@@ -353,6 +370,17 @@ ParseBuffer::CurrentPosition
 ParseBuffer::skipToOneOf(const char* cs1,
                          const char* cs2)
 {
+   const size_t l1 = strlen(cs1);
+   const size_t l2 = strlen(cs2);
+   if (l1 + l2 <= MaxSimdSet)
+   {
+      char cs[MaxSimdSet];
+      memcpy(cs, cs1, l1);
+      memcpy(cs + l1, cs2, l2);
+      mPosition = scanSet(mPosition, mEnd, cs, l1 + l2, true);
+      return CurrentPosition(*this);
+   }
+
    while (mPosition < mEnd)
    {
       if (oneOf(*mPosition, cs1) ||
@@ -371,17 +399,7 @@ ParseBuffer::skipToOneOf(const char* cs1,
 ParseBuffer::CurrentPosition
 ParseBuffer::skipToOneOf(const Data& cs)
 {
-   while (mPosition < mEnd)
-   {
-      if (oneOf(*mPosition, cs))
-      {
-         return CurrentPosition(*this);
-      }
-      else
-      {
-         mPosition++;
-      }
-   }
+   mPosition = scanSet(mPosition, mEnd, cs.data(), cs.size(), true);
    return CurrentPosition(*this);
 }
 
@@ -389,6 +407,15 @@ ParseBuffer::CurrentPosition
 ParseBuffer::skipToOneOf(const Data& cs1,
                          const Data& cs2)
 {
+   if (cs1.size() + cs2.size() <= MaxSimdSet)
+   {
+      char cs[MaxSimdSet];
+      memcpy(cs, cs1.data(), cs1.size());
+      memcpy(cs + cs1.size(), cs2.data(), cs2.size());
+      mPosition = scanSet(mPosition, mEnd, cs, cs1.size() + cs2.size(), true);
+      return CurrentPosition(*this);
+   }
+
    while (mPosition < mEnd)
    {
       if (oneOf(*mPosition, cs1) ||
@@ -407,20 +434,22 @@ ParseBuffer::skipToOneOf(const Data& cs1,
 const char*
 ParseBuffer::skipToEndQuote(char quote)
 {
+   const char cs[2] = { '\\', quote };
    while (mPosition < mEnd)
    {
+      mPosition = scanSet(mPosition, mEnd, cs, 2, true);
+      if (mPosition == mEnd)
+      {
+         break;
+      }
       // !dlb! mark character encoding
       if (*mPosition == '\\')
       {
          mPosition += 2;
       }
-      else if (*mPosition == quote)
-      {
-         return mPosition;
-      }
       else
       {
-         mPosition++;
+         return mPosition;
       }
    }
 
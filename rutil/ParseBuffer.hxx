@@ -153,7 +153,7 @@ class ParseBuffer
       {
          while (mPosition < mEnd)
          {
-            if (cs.test((unsigned char)(*mPosition)))
+            if (cs[(unsigned char)(*mPosition)])
             {
                mPosition++;
             }
@@ -169,7 +169,7 @@ class ParseBuffer
       {
          while (mPosition < mEnd)
          {
-            if (cs.test((unsigned char)(*mPosition)))
+            if (cs[(unsigned char)(*mPosition)])
             {
                return CurrentPosition(*this);
             }
@@ -14,6 +14,7 @@
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <fcntl.h>
+#include <pthread.h>
 #endif
 
 #include "rutil/Random.hxx"
@@ -45,12 +46,52 @@
 #  include <openssl/err.h>
 #endif
 
+#if !defined(WIN32) && !defined(RESIP_RANDOM_THREAD_LOCAL) && \
+    !defined(RESIP_RANDOM_THREAD_MUTEX) && !defined(RESIP_RANDOM_POSIX_RANDOM)
+#  define RESIP_RANDOM_XORSHIFT 1
+#endif
+
 using namespace resip;
 #define RESIPROCATE_SUBSYSTEM Subsystem::SIP
 
 Mutex Random::mMutex;
 bool Random::mIsInitialized = false;
 
+ThreadIf::TlsKey Random::sThreadStateKey = 0;
+std::atomic<bool> Random::sThreadStateKeyCreated(false);
+volatile unsigned int Random::sForkGeneration = 0;
+
+/**
+   What each thread keeps to itself: the xorshift128+ state, and the unused
+   part of the last block of crypto randomness.
+**/
+class Random::ThreadState
+{
+   public:
+      ThreadState()
+         : mForkGeneration(0),
+           mCryptoPos(sizeof(mCrypto))
+      {
+         mState[0] = 0;
+         mState[1] = 0;
+      }
+
+      UInt64 mState[2];
+      unsigned int mForkGeneration;
+      unsigned int mCryptoPos; // sizeof(mCrypto) when empty
+      unsigned char mCrypto[Random::CryptoBufferSize];
+};
+
+// splitmix64; spreads a simple seed out over all 64 bits
+static UInt64
+mixSeed(UInt64 x)
+{
+   x += 0x9E3779B97F4A7C15ULL;
+   x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+   x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+   return x ^ (x >> 31);
+}
+
 #ifdef WIN32
 Random::Initializer Random::mInitializer;
 #ifdef RESIP_RANDOM_WIN32_RTL
@@ -82,8 +123,10 @@ Random::getImplName()
    return "posix_thread_local";
 #elif defined(RESIP_RANDOM_THREAD_MUTEX)
    return "posix_thread_mutex";
-#else
+#elif defined(RESIP_RANDOM_POSIX_RANDOM)
    return "posix_random";
+#else
+   return "posix_thread_xorshift";
 #endif
 #endif // not WIN32
 }
@@ -106,7 +149,7 @@ Random::getSimpleSeed()
       // .kw. previously just used the lower 32bits of getTimeMs()
       strm << ResipClock::getTimeMicroSec() << ":";
       strm << getpid();
-#if defined(RESIP_RANDOM_THREAD_LOCAL)
+#if defined(RESIP_RANDOM_THREAD_LOCAL) || defined(RESIP_RANDOM_XORSHIFT)
       strm << ":" << ThreadIf::selfId();
 #endif
 #endif
@@ -191,8 +234,11 @@ Random::initialize()
          memset( buf, 0, sz);      // .kw. strange segfaults without this
          initstate_r(seed, ((char*)buf)+sizeof(*buf), RANDOM_STATE_SIZE, buf);
          sRandomState = buf;
-#else
+#elif defined(RESIP_RANDOM_POSIX_RANDOM)
          srandom(seed);
+#else
+         // each thread seeds its own generator; see getThreadState()
+         (void)seed;
 #endif
 
 
@@ -301,11 +347,14 @@ Random::getRandom()
       random_r(sRandomState, &ret);
    }
    return ret;
-#else
+#elif defined(RESIP_RANDOM_POSIX_RANDOM)
    // random returns [0,RAN_MAX]. On Linux, this is 31 bits and positive.
    // On some platforms it might be on 15 bits, and will need to do something.
    // assert( RAND_MAX == ((1<<31)-1) );  // ?slg? commented out assert since, RAND_MAX is not used in random(), it applies to rand() only
    return random(); 
+#else
+   // top 31 bits; the high bits of xorshift128+ are the better ones
+   return (int)(next(*getThreadState()) >> 33);
 #endif  // THREAD_LOCAL
 #endif // WIN32
 }
@@ -317,18 +366,7 @@ Random::getCryptoRandom()
 
 #if USE_OPENSSL
    int ret;
-   int e = RAND_bytes( (unsigned char*)&ret , sizeof(ret) );
-   if ( e < 0 )
-   {
-      // error of some type - likely not enough rendomness to dod this 
-      long err = ERR_get_error();
-      
-      char buf[1024];
-      ERR_error_string_n(err,buf,sizeof(buf));
-      
-      ErrLog( << buf );
-      resip_assert(0);
-   }
+   getCryptoRandom((unsigned char*)&ret, sizeof(ret));
    return ret;
 #else
    return getRandom();
@@ -343,14 +381,24 @@ Random::getRandom(unsigned int len)
    
    union 
    {
-         char cbuf[Random::maxLength+1];
-         unsigned int  ibuf[(Random::maxLength+1)/sizeof(int)];
+         char cbuf[Random::maxLength+8];
+         unsigned int  ibuf[(Random::maxLength+8)/sizeof(int)];
+         UInt64 lbuf[(Random::maxLength+8)/sizeof(UInt64)];
    };
    
+#if defined(RESIP_RANDOM_XORSHIFT)
+   // all 64 bits of each step, rather than 31 bits per getRandom()
+   ThreadState& state = *getThreadState();
+   for (unsigned int count=0; count<(len+sizeof(UInt64)-1)/sizeof(UInt64); ++count)
+   {
+      lbuf[count] = next(state);
+   }
+#else
    for (unsigned int count=0; count<(len+sizeof(int)-1)/sizeof(int); ++count)
    {
       ibuf[count] = Random::getRandom();
    }
+#endif
    return Data(cbuf, len);
 }
 
@@ -450,17 +498,37 @@ Random::getCryptoRandom(unsigned char* buf, unsigned int numBytes)
 
 #if USE_OPENSSL
    initialize();
-   int e = RAND_bytes( (unsigned char*)buf , numBytes );
-   if ( e < 0 )
+   ThreadState& state = *getThreadState();
+   while (numBytes > 0)
    {
-      // error of some type - likely not enough rendomness to dod this 
-      long err = ERR_get_error();
-      
-      char buf[1024];
-      ERR_error_string_n(err,buf,sizeof(buf));
-      
-      ErrLog( << buf );
-      resip_assert(0);
+      if (state.mCryptoPos == sizeof(state.mCrypto))
+      {
+         int e = RAND_bytes(state.mCrypto, sizeof(state.mCrypto));
+         if ( e != 1 )
+         {
+            // error of some type - likely not enough rendomness to dod this 
+            long err = ERR_get_error();
+
+            char errbuf[1024];
+            ERR_error_string_n(err,errbuf,sizeof(errbuf));
+
+            ErrLog( << errbuf );
+            resip_assert(0);
+         }
+         state.mCryptoPos = 0;
+      }
+
+      unsigned int n = (unsigned int)sizeof(state.mCrypto) - state.mCryptoPos;
+      if (n > numBytes)
+      {
+         n = numBytes;
+      }
+      memcpy(buf, state.mCrypto + state.mCryptoPos, n);
+      // don't leave handed-out bytes lying around
+      memset(state.mCrypto + state.mCryptoPos, 0, n);
+      state.mCryptoPos += n;
+      buf += n;
+      numBytes -= n;
    }
 #else
    // !bwc! Should optimize this.
@@ -469,6 +537,109 @@ Random::getCryptoRandom(unsigned char* buf, unsigned int numBytes)
 #endif
 }
 
+Random::ThreadState*
+Random::getThreadState()
+{
+   // the acquire pairs with the release below, so a thread that sees the flag
+   // set also sees sThreadStateKey
+   if (!sThreadStateKeyCreated.load(std::memory_order_acquire))
+   {
+      Lock lock(mMutex);
+      if (!sThreadStateKeyCreated.load(std::memory_order_relaxed))
+      {
+         ThreadIf::tlsKeyCreate(sThreadStateKey, &Random::deleteThreadState);
+#ifndef WIN32
+         pthread_atfork(0, 0, &Random::afterFork);
+#endif
+         sThreadStateKeyCreated.store(true, std::memory_order_release);
+      }
+   }
+
+   ThreadState* state = (ThreadState*)ThreadIf::tlsGetValue(sThreadStateKey);
+   if (state == 0)
+   {
+      state = new ThreadState;
+      seed(*state);
+      ThreadIf::tlsSetValue(sThreadStateKey, state);
+   }
+   else if (state->mForkGeneration != sForkGeneration)
+   {
+      // we are a child process, and would otherwise repeat the parent
+      seed(*state);
+   }
+   return state;
+}
+
+void
+Random::deleteThreadState(void* state)
+{
+   ThreadState* threadState = (ThreadState*)state;
+   memset(threadState->mCrypto, 0, sizeof(threadState->mCrypto));
+   delete threadState;
+}
+
+void
+Random::seed(ThreadState& state)
+{
+   UInt64 seed[2] = {0, 0};
+#if USE_OPENSSL
+   if (RAND_bytes((unsigned char*)seed, sizeof(seed)) != 1)
+   {
+      ErrLog( << "Could not seed random number generator from OpenSSL" );
+   }
+#elif !defined(WIN32)
+   int fd = open("/dev/urandom", O_RDONLY);
+   if ( fd != -1 )
+   {
+      if (read(fd, seed, sizeof(seed)) != sizeof(seed))
+      {
+         ErrLog( << "System is short of randomness" );
+      }
+      ::close(fd);
+   }
+   else
+   {
+      ErrLog( << "Could not open /dev/urandom" );
+   }
+#endif
+
+   // Mix in the time, pid and thread (getSimpleSeed()) and where our state
+   // lives, so that no two threads or forked processes share a sequence even
+   // when the above gave us nothing. No locking here; we may be in a child
+   // that forked while another thread held mMutex.
+   state.mState[0] = seed[0] ^ mixSeed(getSimpleSeed());
+   state.mState[1] = seed[1] ^ mixSeed(((UInt64)(size_t)&state << 16) ^ sForkGeneration);
+   if (state.mState[0] == 0 && state.mState[1] == 0)
+   {
+      state.mState[1] = 1;
+   }
+
+   state.mForkGeneration = sForkGeneration;
+   // don't hand out the same crypto bytes as the parent either
+   memset(state.mCrypto, 0, sizeof(state.mCrypto));
+   state.mCryptoPos = sizeof(state.mCrypto);
+}
+
+UInt64
+Random::next(ThreadState& state)
+{
+   // xorshift128+
+   UInt64 s1 = state.mState[0];
+   const UInt64 s0 = state.mState[1];
+   state.mState[0] = s0;
+   s1 ^= s1 << 23;
+   state.mState[1] = s1 ^ s0 ^ (s1 >> 17) ^ (s0 >> 26);
+   return state.mState[1] + s0;
+}
+
+#ifndef WIN32
+void
+Random::afterFork()
+{
+   ++sForkGeneration;
+}
+#endif
+
 #ifdef WIN32
 Random::Initializer::Initializer()  : mThreadStorage(::TlsAlloc())
 { 
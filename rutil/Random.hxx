@@ -1,6 +1,8 @@
 #if !defined(RESIP_RANDOM_HXX)
 #define RESIP_RANDOM_HXX 
 
+#include <atomic>
+
 #include "rutil/Mutex.hxx"
 #include "rutil/Data.hxx"
 #include "rutil/ThreadIf.hxx"     // for ThreadLocalStorage
@@ -28,14 +30,26 @@ struct random_data;
 // #define RESIP_RANDOM_THREAD_LOCAL 1
 
 /**
- * By default, on POSIX, the standard srandom() and random()
- * functions will be used. This shares the generator state with
+ * Define below to use the standard srandom() and random()
+ * functions. This shares the generator state with
  * others libraries running in the same application. Under Linux
  * random() obtains a mutex so is threadsafe.
  * NOTE: See http://evanjones.ca/random-thread-safe.html for some good info.
  * WATCHOUT: Some other library can call srandom() in a stupid way,
  * causing duplicate callids and such.
  */
+// #define RESIP_RANDOM_POSIX_RANDOM 1
+
+/**
+ * By default, on POSIX, each thread has its own xorshift128+ generator,
+ * seeded from OpenSSL or /dev/urandom when the thread first asks for a
+ * number, and reseeded in the child after a fork(). getRandom() then takes
+ * no lock and makes no system call.
+ *
+ * Independent of the above, when built with OpenSSL the getCryptoRandom()
+ * family hands out bytes from a per-thread buffer that is refilled from
+ * RAND_bytes() CryptoBufferSize bytes at a time.
+ */
 
 
 namespace resip
@@ -86,9 +100,23 @@ class Random
 
       static const char* getImplName();
 
+      enum {CryptoBufferSize = 4096};
+
    private:
       static Mutex mMutex;
       static bool  mIsInitialized;
+
+      class ThreadState;
+      static ThreadState* getThreadState();
+      static void deleteThreadState(void* state);
+      static void seed(ThreadState& state);
+      static UInt64 next(ThreadState& state);
+      static ThreadIf::TlsKey sThreadStateKey;
+      static std::atomic<bool> sThreadStateKeyCreated;
+      static volatile unsigned int sForkGeneration;
+#ifndef WIN32
+      static void afterFork();
+#endif
       
 #ifdef WIN32
       // ensure each thread is initialized since windows requires you to call srand for each thread
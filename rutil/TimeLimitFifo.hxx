@@ -4,6 +4,8 @@
 #include "rutil/ResipAssert.h"
 #include <memory>
 #include "rutil/AbstractFifo.hxx"
+#include "rutil/LatencyHistogram.hxx"
+#include "rutil/Timer.hxx"
 #include <iostream>
 #if defined( WIN32 )
 #include <time.h>
@@ -24,18 +26,22 @@ template<typename Payload>
 class Timestamped
 {
    public:
-      Timestamped(const Payload& msg, time_t n)
+      Timestamped(const Payload& msg, time_t n, UInt64 microSec = 0)
          : mMsg(msg),
-           mTime(n)
+           mTime(n),
+           mTimeMicroSec(microSec)
       {}
 
       inline const Payload& getMsg() const { return mMsg;} 
       inline void setMsg(const Payload& pMsg) { mMsg = pMsg;}
       inline const time_t& getTime() const { return mTime;} 
+      /// only set if the fifo is measuring wait times
+      inline UInt64 getTimeMicroSec() const { return mTimeMicroSec;} 
 
    private:
       Payload mMsg;
       time_t mTime;
+      UInt64 mTimeMicroSec;
 };
 
 /**
@@ -206,6 +212,17 @@ class TimeLimitFifo : public AbstractFifo< Timestamped<Msg*> >
       */
       virtual void setTimeDepthTolerance(unsigned int maxSecs);
 
+      /**
+      @brief record how long each message waits in the FIFO
+      @param recorder receives the wait of every message taken out by
+      getNext(), in microseconds, in the given histogram; 0 stops recording.
+      */
+      void setWaitTimeRecorder(ConcurrentLatencyHistograms* recorder,
+                               unsigned int histogram);
+
+   protected:
+      virtual void onMessageTaken(const Timestamped<Msg*>& tm);
+
    private:
       time_t timeDepthInternal() const;
       inline bool wouldAcceptInteral(DepthUsage usage) const;
@@ -215,6 +232,8 @@ class TimeLimitFifo : public AbstractFifo< Timestamped<Msg*> >
       time_t mMaxDurationSecs;
       unsigned int mMaxSize;
       unsigned int mUnreservedMaxSize;
+      ConcurrentLatencyHistograms* mWaitTimeRecorder;
+      unsigned int mWaitTimeHistogram;
 };
 
 template <class Msg>
@@ -223,7 +242,9 @@ TimeLimitFifo<Msg>::TimeLimitFifo(unsigned int maxDurationSecs,
    : AbstractFifo< Timestamped<Msg*> >(),
      mMaxDurationSecs(maxDurationSecs),
      mMaxSize(maxSize),
-     mUnreservedMaxSize((int)((maxSize*8)/10)) // !dlb! random guess
+     mUnreservedMaxSize((int)((maxSize*8)/10)), // !dlb! random guess
+     mWaitTimeRecorder(0),
+     mWaitTimeHistogram(0)
 {}
 
 template <class Msg>
@@ -243,7 +264,8 @@ TimeLimitFifo<Msg>::add(Msg* msg,
    if (wouldAcceptInteral(usage))
    {
       time_t n = time(0);
-      mFifo.push_back(Timestamped<Msg*>(msg, n));
+      mFifo.push_back(Timestamped<Msg*>(msg, n,
+                                        mWaitTimeRecorder ? Timer::getTimeMicroSec() : 0));
       onMessagePushed(1);
       mCondition.signal();
       return true;
@@ -283,6 +305,31 @@ TimeLimitFifo<Msg>::getNext(int ms)
    return 0;
 }
 
+template <class Msg>
+void
+TimeLimitFifo<Msg>::setWaitTimeRecorder(ConcurrentLatencyHistograms* recorder,
+                                        unsigned int histogram)
+{
+   Lock lock(mMutex); (void)lock;
+   mWaitTimeRecorder = recorder;
+   mWaitTimeHistogram = histogram;
+}
+
+template <class Msg>
+void
+TimeLimitFifo<Msg>::onMessageTaken(const Timestamped<Msg*>& tm)
+{
+   // Called by getNext() with mMutex held, so setWaitTimeRecorder() cannot 
+   // clear the recorder underneath us. Messages added before the recorder 
+   // was set carry no time.
+   if (mWaitTimeRecorder && tm.getTimeMicroSec() != 0)
+   {
+      UInt64 now = Timer::getTimeMicroSec();
+      mWaitTimeRecorder->record(mWaitTimeHistogram,
+                                now > tm.getTimeMicroSec() ? now - tm.getTimeMicroSec() : 0);
+   }
+}
+
 template <class Msg>
 time_t
 TimeLimitFifo<Msg>::timeDepthInternal() const
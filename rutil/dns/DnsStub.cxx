@@ -6,6 +6,7 @@
 //	MS non-consistent declaration of time_t. we defined _USE_32BIT_TIME_T
 //	in all projects and that solved the issue with beta compiler, however
 //	release version messes time_t definition again
+#include <algorithm>
 #include <set>
 #include <vector>
 #include "rutil/ResipAssert.h"
@@ -25,6 +26,7 @@
 #include "rutil/BaseException.hxx"
 #include "rutil/Data.hxx"
 #include "rutil/Inserter.hxx"
+#include "rutil/Timer.hxx"
 #include "rutil/dns/DnsStub.hxx"
 #include "rutil/dns/ExternalDns.hxx"
 #include "rutil/dns/ExternalDnsFactory.hxx"
@@ -86,6 +88,7 @@ DnsStub::DnsStub(const NameserverList& additional,
    mInterruptorHandle(0),
    mCommandFifo(&mSelectInterruptor),
    mTransform(0),
+   mNextTimerHandlerRun(0),
    mDnsProvider(ExternalDnsFactory::createExternalDns()),
    mPollGrp(0),
    mAsyncProcessHandler(asyncProcessHandler)
@@ -124,7 +127,17 @@ unsigned int
 DnsStub::getTimeTillNextProcessMS()
 {
     if(mCommandFifo.size() > 0) return 0;
-    return mDnsProvider->getTimeTillNextProcessMS();
+    unsigned int ms = mDnsProvider->getTimeTillNextProcessMS();
+    if (!mTimerHandlers.empty())
+    {
+       const UInt64 now = Timer::getTimeMs();
+       const UInt64 tillHandlers = mNextTimerHandlerRun > now ? mNextTimerHandlerRun - now : 0;
+       if (tillHandlers < ms)
+       {
+          ms = (unsigned int)tillHandlers;
+       }
+    }
+    return ms;
 }
 
 void
@@ -159,6 +172,26 @@ DnsStub::processTimers()
    // the fifo is captures as a timer within getTimeTill... above
    processFifo();
    mDnsProvider->processTimers();
+   processTimerHandlers();
+}
+
+void
+DnsStub::processTimerHandlers()
+{
+   if (mTimerHandlers.empty())
+   {
+      return;
+   }
+   const UInt64 now = Timer::getTimeMs();
+   if (now < mNextTimerHandlerRun)
+   {
+      return;
+   }
+   mNextTimerHandlerRun = now + TimerHandlerIntervalMs;
+   for (vector<TimerHandler*>::iterator it = mTimerHandlers.begin(); it != mTimerHandlers.end(); ++it)
+   {
+      (*it)->onDnsTimer(now);
+   }
 }
 
 void 
@@ -387,6 +420,18 @@ DnsStub::removeResultTransform()
    mTransform = 0;
 }
 
+void
+DnsStub::addTimerHandler(TimerHandler* handler)
+{
+   mTimerHandlers.push_back(handler);
+}
+
+void
+DnsStub::removeTimerHandler(TimerHandler* handler)
+{
+   mTimerHandlers.erase(std::remove(mTimerHandlers.begin(), mTimerHandlers.end(), handler), mTimerHandlers.end());
+}
+
 void 
 DnsStub::setPollGrp(FdPollGrp* pollGrp)
 {
@@ -130,6 +130,15 @@ class DnsStub : public ExternalDnsHandler
             virtual void transform(const Data& target, int rrType, DnsResourceRecordsByPtr& src) = 0;
       };
 
+      class TimerHandler
+      {
+         public:
+            virtual ~TimerHandler() {}
+            /// Called about once every TimerHandlerIntervalMs from
+            /// processTimers(), in the thread that processes the DnsStub.
+            virtual void onDnsTimer(UInt64 now) = 0;
+      };
+
       class DnsStubException final : public BaseException
       {
          public:
@@ -159,6 +168,12 @@ class DnsStub : public ExternalDnsHandler
       void setResultTransform(ResultTransform*);
       void removeResultTransform();
 
+      // Not thread safe; add before the DnsStub is processed, and remove
+      // once it no longer is.
+      void addTimerHandler(TimerHandler*);
+      void removeTimerHandler(TimerHandler*);
+      static const UInt64 TimerHandlerIntervalMs = 1000;
+
       /*!
          @param enumSuffixes If the uri is enum searchable, this is the list of
                   enum suffixes (for example "e164.arpa") that will be used in
@@ -213,6 +228,7 @@ class DnsStub : public ExternalDnsHandler
 
   private:
       void processFifo();
+      void processTimerHandlers();
 
    protected:
       void cache(const Data& key, in_addr addr);
@@ -464,6 +480,8 @@ class DnsStub : public ExternalDnsHandler
       Data errorMessage(int status);
 
       ResultTransform* mTransform;
+      std::vector<TimerHandler*> mTimerHandlers;
+      UInt64 mNextTimerHandlerRun;
       ExternalDns* mDnsProvider;
       FdPollGrp* mPollGrp;
       std::set<Query*> mQueries;
@@ -53,7 +53,7 @@ RRVip::RRVip()
 
 RRVip::~RRVip()
 {
-   for (map<MapKey, Transform*>::iterator it = mTransforms.begin(); it != mTransforms.end(); ++it)
+   for (TransformMap::iterator it = mTransforms.begin(); it != mTransforms.end(); ++it)
    {
       delete (*it).second;
    }
@@ -248,6 +248,11 @@ bool RRVip::MapKey::operator<(const MapKey& rhs) const
    }
 }
 
+bool RRVip::MapKey::operator==(const MapKey& rhs) const
+{
+   return mRRType == rhs.mRRType && mTarget == rhs.mTarget;
+}
+
 /* ====================================================================
  * The Vovida Software License, Version 1.0 
  * 
@@ -1,6 +1,7 @@
 #ifndef RESIP_RRVIP_HXX
 #define RESIP_RRVIP_HXX
 
+#include "rutil/HashMap.hxx"
 #include "rutil/dns/DnsStub.hxx"
 
 namespace resip
@@ -55,11 +56,19 @@ class RRVip : public DnsStub::ResultTransform
             MapKey();
             MapKey(const Data& target, int rrType);
             bool operator<(const MapKey&) const;
+            bool operator==(const MapKey&) const;
+            size_t hash() const { return mTarget.hash() * 31 + mRRType; }
          private:
             Data mTarget;
             int mRRType;
       };
 
+      class MapKeyHash
+      {
+         public:
+            size_t operator()(const MapKey& key) const { return key.hash(); }
+      };
+
       class TransformFactory
       {
          public:
@@ -88,7 +97,7 @@ class RRVip : public DnsStub::ResultTransform
       typedef std::map<int, TransformFactory*> TransformFactoryMap;
       TransformFactoryMap  mFactories;
 
-      typedef std::map<MapKey, Transform*> TransformMap;
+      typedef HashMap<MapKey, Transform*, MapKeyHash> TransformMap;
       TransformMap mTransforms;  
 };
 
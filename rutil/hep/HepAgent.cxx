@@ -2,19 +2,305 @@
 #include "config.h"
 #endif
 
+#include <atomic>
 #include <stdexcept>
 
 #include "rutil/hep/ResipHep.hxx"
 #include "rutil/hep/HepAgent.hxx"
+#include "rutil/Condition.hxx"
 #include "rutil/DataStream.hxx"
+#include "rutil/Lock.hxx"
 #include "rutil/Logger.hxx"
+#include "rutil/Mutex.hxx"
+#include "rutil/ThreadIf.hxx"
+#include "rutil/Timer.hxx"
+
+#if !defined(WIN32)
+#include <sys/socket.h>
+#endif
 
 using namespace resip;
 using namespace std;
 
 #define RESIPROCATE_SUBSYSTEM Subsystem::TRANSPORT
 
-HepAgent::HepAgent(const Data &captureHost, int capturePort, int captureAgentID)
+/*
+   The queue is a ring of preallocated slots shared by any number of
+   producers (the threads calling sendToHOMER()) and the one sender thread,
+   after Dmitry Vyukov's bounded MPMC queue. Each slot has a sequence number:
+   a producer may claim the slot for ticket t when its sequence is t, and
+   marks it ready with t+1 once the packet is built; the sender thread sends
+   it and hands the slot back for ticket t+size. Producers only ever contend
+   on the compare-and-swap that takes a ticket, and the sender thread only
+   takes a lock to go to sleep when there is nothing to send.
+*/
+class HepAgent::Sender : public ThreadIf
+{
+   public:
+      Sender(Socket socket, const GenericIPAddress& destination, unsigned int queueSize);
+      virtual ~Sender();
+
+      Data* claim(size_t& ticket);
+      void queue(size_t ticket, bool send);
+
+      virtual void thread();
+      virtual void shutdown();
+
+      std::atomic<UInt64> mSent;
+      std::atomic<UInt64> mDropped;
+      std::atomic<UInt64> mFailed;
+
+   private:
+      enum
+      {
+         BatchSize = 32,
+         InitialBufferSize = 4096,
+         IdleWaitMs = 100,
+         DropReportIntervalMs = 10000
+      };
+
+      struct Slot
+      {
+         std::atomic<size_t> mSequence;
+         Data mBuffer;
+         bool mSend;
+
+         Slot() : mSequence(0), mBuffer(InitialBufferSize, Data::Preallocate), mSend(false) {}
+      };
+
+      bool ready(size_t pos) const
+      {
+         return mSlots[pos & mMask].mSequence.load() == pos + 1;
+      }
+      /// Sends up to BatchSize ready packets and frees their slots. Returns
+      /// the number of slots freed.
+      unsigned int sendBatch();
+      void sendPackets(Slot** slots, unsigned int count);
+
+      Socket mSocket;
+      GenericIPAddress mDestination;
+      size_t mMask;
+      Slot* mSlots;
+      std::atomic<size_t> mEnqueuePos;
+      // only touched by the sender thread
+      size_t mDequeuePos;
+
+      std::atomic<bool> mSleeping;
+      Mutex mMutex;
+      Condition mWakeup;
+};
+
+HepAgent::Sender::Sender(Socket socket, const GenericIPAddress& destination, unsigned int queueSize)
+   : mSent(0),
+     mDropped(0),
+     mFailed(0),
+     mSocket(socket),
+     mDestination(destination),
+     mMask(0),
+     mSlots(0),
+     mEnqueuePos(0),
+     mDequeuePos(0),
+     mSleeping(false)
+{
+   size_t size = 1;
+   while(size < queueSize)
+   {
+      size <<= 1;
+   }
+   mMask = size - 1;
+   mSlots = new Slot[size];
+   for(size_t i = 0; i < size; ++i)
+   {
+      mSlots[i].mSequence.store(i, std::memory_order_relaxed);
+   }
+}
+
+HepAgent::Sender::~Sender()
+{
+   delete [] mSlots;
+}
+
+Data*
+HepAgent::Sender::claim(size_t& ticket)
+{
+   size_t pos = mEnqueuePos.load(std::memory_order_relaxed);
+   for(;;)
+   {
+      Slot& slot = mSlots[pos & mMask];
+      size_t seq = slot.mSequence.load(std::memory_order_acquire);
+      ptrdiff_t dif = (ptrdiff_t)seq - (ptrdiff_t)pos;
+      if(dif == 0)
+      {
+         if(mEnqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+         {
+            ticket = pos;
+            return &slot.mBuffer;
+         }
+      }
+      else if(dif < 0)
+      {
+         // the sender thread has not got round to this slot yet
+         mDropped.fetch_add(1, std::memory_order_relaxed);
+         return 0;
+      }
+      else
+      {
+         pos = mEnqueuePos.load(std::memory_order_relaxed);
+      }
+   }
+}
+
+void
+HepAgent::Sender::queue(size_t ticket, bool send)
+{
+   Slot& slot = mSlots[ticket & mMask];
+   slot.mSend = send;
+   // sequentially consistent, along with mSleeping, so that either we see the
+   // sender thread going to sleep or it sees this packet
+   slot.mSequence.store(ticket + 1);
+   if(mSleeping.load())
+   {
+      Lock lock(mMutex);
+      mWakeup.signal();
+   }
+}
+
+void
+HepAgent::Sender::shutdown()
+{
+   ThreadIf::shutdown();
+   Lock lock(mMutex);
+   mWakeup.signal();
+}
+
+void
+HepAgent::Sender::thread()
+{
+   UInt64 droppedReported = 0;
+   UInt64 nextDropReport = Timer::getTimeMs() + DropReportIntervalMs;
+   while(!isShutdown())
+   {
+      if(sendBatch() == 0)
+      {
+         Lock lock(mMutex);
+         mSleeping.store(true);
+         if(!ready(mDequeuePos) && !isShutdown())
+         {
+            mWakeup.wait(mMutex, IdleWaitMs);
+         }
+         mSleeping.store(false);
+      }
+
+      UInt64 now = Timer::getTimeMs();
+      if(now >= nextDropReport)
+      {
+         UInt64 dropped = mDropped.load(std::memory_order_relaxed);
+         if(dropped != droppedReported)
+         {
+            WarningLog(<< "HEP capture queue full, dropped " << (dropped - droppedReported)
+                       << " packets in the last " << DropReportIntervalMs / 1000 << "s");
+            droppedReported = dropped;
+         }
+         nextDropReport = now + DropReportIntervalMs;
+      }
+   }
+
+   // send what has already been built
+   while(sendBatch() > 0)
+   {
+   }
+}
+
+unsigned int
+HepAgent::Sender::sendBatch()
+{
+   Slot* batch[BatchSize];
+   unsigned int count = 0;
+   unsigned int freed = 0;
+   while(freed < BatchSize && ready(mDequeuePos + freed))
+   {
+      Slot& slot = mSlots[(mDequeuePos + freed) & mMask];
+      if(slot.mSend)
+      {
+         batch[count++] = &slot;
+      }
+      ++freed;
+   }
+
+   if(count > 0)
+   {
+      sendPackets(batch, count);
+   }
+
+   for(unsigned int i = 0; i < freed; ++i)
+   {
+      mSlots[mDequeuePos & mMask].mSequence.store(mDequeuePos + mMask + 1, std::memory_order_release);
+      ++mDequeuePos;
+   }
+   return freed;
+}
+
+void
+HepAgent::Sender::sendPackets(Slot** slots, unsigned int count)
+{
+   unsigned int sent = 0;
+#if defined(HAVE_SENDMMSG)
+   struct mmsghdr msgs[BatchSize];
+   struct iovec iovs[BatchSize];
+   memset(msgs, 0, sizeof(struct mmsghdr) * count);
+   for(unsigned int i = 0; i < count; ++i)
+   {
+      iovs[i].iov_base = (void*)slots[i]->mBuffer.data();
+      iovs[i].iov_len = slots[i]->mBuffer.size();
+      msgs[i].msg_hdr.msg_name = (void*)&mDestination.address;
+      msgs[i].msg_hdr.msg_namelen = mDestination.length();
+      msgs[i].msg_hdr.msg_iov = &iovs[i];
+      msgs[i].msg_hdr.msg_iovlen = 1;
+   }
+   while(sent < count)
+   {
+      int n = sendmmsg(mSocket, msgs + sent, count - sent, 0);
+      if(n < 0)
+      {
+         int e = getErrno();
+         if(e == EINTR)
+         {
+            continue;
+         }
+         ErrLog(<< "sending to HOMER " << mDestination << " failed (" << e << "): " << strerror(e));
+         // skip the packet that failed and carry on with the rest
+         mFailed.fetch_add(1, std::memory_order_relaxed);
+         ++sent;
+         continue;
+      }
+      mSent.fetch_add(n, std::memory_order_relaxed);
+      sent += n;
+   }
+   DebugLog(<< count << " packets sent to HOMER " << mDestination);
+#else
+   for( ; sent < count; ++sent)
+   {
+      const Data& buf = slots[sent]->mBuffer;
+      if(sendto(mSocket, buf.data(), buf.size(), 0, &mDestination.address, mDestination.length()) < 0)
+      {
+         int e = getErrno();
+#if defined(WIN32)
+         ErrLog(<< "sending to HOMER " << mDestination << " failed (" << e << ")");
+#else
+         ErrLog(<< "sending to HOMER " << mDestination << " failed (" << e << "): " << strerror(e));
+#endif
+         mFailed.fetch_add(1, std::memory_order_relaxed);
+      }
+      else
+      {
+         mSent.fetch_add(1, std::memory_order_relaxed);
+         DebugLog(<< "packet sent to HOMER " << mDestination);
+      }
+   }
+#endif
+}
+
+HepAgent::HepAgent(const Data &captureHost, int capturePort, int captureAgentID, unsigned int queueSize)
    : mCaptureHost(captureHost), mCapturePort(capturePort), mCaptureAgentID(captureAgentID)
 {
 #ifdef USE_IPV6
@@ -49,14 +335,10 @@ HepAgent::HepAgent(const Data &captureHost, int capturePort, int captureAgentID)
       throw std::runtime_error("Failed to create socket");
    }
 
-   // make it non-blocking
-   // FIXME - HEP messages are lost if the transmit buffer fills up
-   // Messages should be queued and sent as part of the main loop
-   if(!makeSocketNonBlocking(mSocket))
-   {
-      ErrLog(<<"Failed to set O_NONBLOCK");
-      throw std::runtime_error("Failed to set O_NONBLOCK");
-   }
+   // The socket is left blocking: only the sender thread uses it, and if
+   // the transmit buffer fills up it is better for that thread to wait than
+   // to lose packets that are already built. SIP processing never waits on
+   // it; packets are dropped at the queue instead.
 
    if(::bind(mSocket, ( struct sockaddr *) &myaddr, sizeof(myaddr)) < 0) {
       ErrLog(<<"bind failed");
@@ -93,11 +375,50 @@ HepAgent::HepAgent(const Data &captureHost, int capturePort, int captureAgentID)
          throw std::runtime_error("unsupported address family");
    }
    freeaddrinfo(rset);
+
+   mSender.reset(new Sender(mSocket, mDestination, queueSize));
+   mSender->run();
    InfoLog(<<"HEP capture agent ready to send to " << mDestination);
 }
 
 HepAgent::~HepAgent()
 {
+   mSender->shutdown();
+   mSender->join();
+   InfoLog(<<"HEP capture agent stopping, sent " << getSentPackets() << " packets, dropped "
+           << getDroppedPackets() << ", failed to send " << getFailedPackets());
+   mSender.reset();
+   closeSocket(mSocket);
+}
+
+Data*
+HepAgent::claimBuffer(size_t& ticket)
+{
+   return mSender->claim(ticket);
+}
+
+void
+HepAgent::queueBuffer(size_t ticket, bool send)
+{
+   mSender->queue(ticket, send);
+}
+
+UInt64
+HepAgent::getSentPackets() const
+{
+   return mSender->mSent.load(std::memory_order_relaxed);
+}
+
+UInt64
+HepAgent::getDroppedPackets() const
+{
+   return mSender->mDropped.load(std::memory_order_relaxed);
+}
+
+UInt64
+HepAgent::getFailedPackets() const
+{
+   return mSender->mFailed.load(std::memory_order_relaxed);
 }
 
 /* ====================================================================
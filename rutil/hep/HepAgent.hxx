@@ -9,11 +9,23 @@
 #include "rutil/DataStream.hxx"
 #include "rutil/Logger.hxx"
 
+#include <memory>
+
 #define RESIPROCATE_SUBSYSTEM Subsystem::TRANSPORT
 
 namespace resip
 {
 
+/**
+   @brief Sends HEP3 capture packets to a HOMER server.
+
+   sendToHOMER() builds each packet in one of a fixed set of preallocated
+   buffers and hands it to a dedicated sender thread, which sends whatever
+   has queued up with as few system calls as it can (sendmmsg where
+   available). The thread calling sendToHOMER() never waits on the network or
+   on a lock: if every buffer is still waiting to be sent, the packet is
+   dropped and counted instead (see getDroppedPackets()).
+*/
 class HepAgent
 {
    public:
@@ -23,10 +35,94 @@ class HepAgent
          RTCP_JSON = 5
       } HEPEventType;
 
-      HepAgent(const Data &captureHost, int capturePort, int captureAgentID);
+      enum
+      {
+         DefaultQueueSize = 1024
+      };
+
+      /**
+         @param queueSize number of packets that can wait to be sent; rounded
+            up to a power of two
+      */
+      HepAgent(const Data &captureHost, int capturePort, int captureAgentID, unsigned int queueSize = DefaultQueueSize);
       virtual ~HepAgent();
       template <class T>
       void sendToHOMER(const TransportType type, const GenericIPAddress& source, const GenericIPAddress& destination, const HEPEventType eventType, const T& msg, const Data& correlationId)
+      {
+         /* PROTOCOL */
+         UInt8 ipProto;
+         switch(type)
+         {
+            case TLS:
+               ipProto = IPPROTO_IDP; // FIXME
+               break;
+            case TCP:
+               ipProto = IPPROTO_TCP;
+               break;
+            case UDP:
+               ipProto = IPPROTO_UDP;
+               break;
+#if !defined(WIN32) || (defined(WIN32) && (_WIN32_WINNT >= 0x0600))
+            case SCTP:
+               ipProto = IPPROTO_SCTP;
+               break;
+#endif
+            case WS:
+            case WSS:
+               ipProto = IPPROTO_TCP; // FIXME
+               break;
+            default:
+               ErrLog(<<"unhandled TransportType");
+               return;
+         }
+
+         switch(source.address.sa_family)
+         {
+            case AF_INET:
+#ifdef USE_IPV6
+            case AF_INET6:
+#endif
+               break;
+            default:
+               ErrLog(<<"unhandled address family");
+               return;
+         }
+
+         size_t ticket;
+         Data* packet = claimBuffer(ticket);
+         if(!packet)
+         {
+            // queue full, already counted as a drop
+            return;
+         }
+         bool built = false;
+         try
+         {
+            built = buildPacket(*packet, ipProto, source, destination, eventType, msg, correlationId);
+         }
+         catch(...)
+         {
+            // the sender thread waits for every claimed slot in turn, so the
+            // slot has to be released even if encoding msg failed
+            queueBuffer(ticket, false);
+            throw;
+         }
+         queueBuffer(ticket, built);
+      }
+
+      /// Packets sent so far.
+      UInt64 getSentPackets() const;
+      /// Packets discarded so far because the queue was full.
+      UInt64 getDroppedPackets() const;
+      /// Packets the sender thread failed to send so far.
+      UInt64 getFailedPackets() const;
+
+   private:
+      /// Builds the packet in buf, which is reused from an earlier packet.
+      /// The DataStream writing into buf is gone by the time this returns,
+      /// so the caller can hand buf to the sender thread.
+      template <class T>
+      bool buildPacket(Data& buf, UInt8 ipProto, const GenericIPAddress& source, const GenericIPAddress& destination, const HEPEventType eventType, const T& msg, const Data& correlationId)
       {
          struct hep_generic *hg;
          hep_chunk_ip4_t src_ip4, dst_ip4;
@@ -36,14 +132,14 @@ class HepAgent
          hep_chunk_ip6_t src_ip6, dst_ip6;
 #endif
 
-         char *data = new char[sizeof(struct hep_generic)];
-         Data buf(Data::Take, data, sizeof(struct hep_generic));
+         buf.clear();
+         struct hep_generic header;
+         memset(&header, 0, sizeof(struct hep_generic));
+         buf.append((const char*)&header, sizeof(struct hep_generic));
          hg = (struct hep_generic *)buf.data();
          DebugLog(<< "buf.size() == " << buf.size());
          DataStream stream(buf);
 
-         memset(hg, 0, sizeof(struct hep_generic));
-
          /* header set */
          memcpy(hg->header.id, "\x48\x45\x50\x33", 4);
 
@@ -106,40 +202,16 @@ class HepAgent
 #endif
             {
             default:
-               ErrLog(<<"unhandled address family");
-               return;
+               // checked by sendToHOMER()
+               return false;
             }
          }
          stream.flush();
          DebugLog(<< "buf.size() == " << buf.size());
          hg = (struct hep_generic *)buf.data();
 
-         /* PROTOCOL */
-         switch(type)
-         {
-            case TLS:
-               hg->ip_proto.data = IPPROTO_IDP; // FIXME
-               break;
-            case TCP:
-               hg->ip_proto.data = IPPROTO_TCP;
-               break;
-            case UDP:
-               hg->ip_proto.data = IPPROTO_UDP;
-               break;
-#if !defined(WIN32) || (defined(WIN32) && (_WIN32_WINNT >= 0x0600))
-            case SCTP:
-               hg->ip_proto.data = IPPROTO_SCTP;
-               break;
-#endif
-            case WS:
-            case WSS:
-               hg->ip_proto.data = IPPROTO_TCP; // FIXME
-               break;
-            default:
-               ErrLog(<<"unhandled TransportType");
-               return;
-         }
          /* Proto ID */
+         hg->ip_proto.data = ipProto;
          hg->ip_proto.chunk.vendor_id = htons(0x0000);
          hg->ip_proto.chunk.type_id   = htons(0x0002);
          hg->ip_proto.chunk.length = htons(sizeof(hg->ip_proto));
@@ -215,27 +287,26 @@ class HepAgent
          hg = (struct hep_generic *)buf.data();
          hg->header.length = htons(afterPayload);
 
-         if(sendto(mSocket, buf.data(), buf.size(), 0, &mDestination.address, mDestination.length()) < 0)
-         {
-            int e = getErrno();
-#if defined(WIN32)
-            ErrLog(<< "sending to HOMER " << mDestination << " failed (" << e << ")");
-#else
-            ErrLog(<< "sending to HOMER " << mDestination << " failed (" << e << "): " << strerror(e));
-#endif
-         }
-         else
-         {
-            DebugLog(<< "packet sent to HOMER " << mDestination);
-         }
+         return true;
       }
 
-   private:
+      /// Returns an empty buffer to build a packet in, or 0 if the queue is
+      /// full. The buffer must be handed back with queueBuffer().
+      Data* claimBuffer(size_t& ticket);
+      void queueBuffer(size_t ticket, bool send);
+
+      class Sender;
+
       Data mCaptureHost;
       int mCapturePort;
       int mCaptureAgentID;
       GenericIPAddress mDestination;
       Socket mSocket;
+      std::unique_ptr<Sender> mSender;
+
+      // dis-allowed by not implemented
+      HepAgent(const HepAgent&);
+      HepAgent& operator=(const HepAgent&);
 };
 
 
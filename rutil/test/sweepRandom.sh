@@ -3,15 +3,16 @@ set -e
 
 # Basic idea to use on POSIX platforms:
 # 1. Build default tree (rutil & rutil/tests) with optmization
-# 2. cp tests/testRandomThread to tests/testRandomThread.random
-# 3. Change Random.hxx to define THREAD_MUTEX, rebuild and copy to testRandomThread.mutex
-# 3. Change Random.hxx to define THREAD_LOCAL, rebuild and copy to testRandomThread.local
+# 2. cp tests/testRandomThread to tests/testRandomThread.xorshift
+# 3. Change Random.hxx to define POSIX_RANDOM, rebuild and copy to testRandomThread.random
+# 4. Change Random.hxx to define THREAD_MUTEX, rebuild and copy to testRandomThread.mutex
+# 5. Change Random.hxx to define THREAD_LOCAL, rebuild and copy to testRandomThread.local
 
 numCycles=10
 
 ProgBase=./testRandomThread
-KnownFlavors="none random mutex local"
-RunFlavors="random mutex local"
+KnownFlavors="none xorshift random mutex local"
+RunFlavors="xorshift random mutex local"
 
 for flavor in $KnownFlavors; do
     if [ "$1" = $flavor ] ; then
@@ -0,0 +1,164 @@
+#include <assert.h>
+#include <cstddef>
+#include <iostream>
+#include <list>
+#include <map>
+
+#include "rutil/ArenaPool.hxx"
+#include "rutil/Data.hxx"
+#include "rutil/StlPoolAllocator.hxx"
+
+using namespace resip;
+using namespace std;
+
+class Counted
+{
+   public:
+      Counted(int& count) : mCount(count), mName("a name too long for the local buffer") { ++mCount; }
+      ~Counted() { --mCount; }
+
+      int& mCount;
+      Data mName;
+};
+
+int
+main()
+{
+   {
+      ArenaPool arena(1024, 4096);
+      assert(arena.getBlockCount() == 0);
+
+      // allocations come out of one block, suitably aligned
+      char* a = static_cast<char*>(arena.allocate(10));
+      char* b = static_cast<char*>(arena.allocate(1));
+      assert(arena.getBlockCount() == 1);
+      assert(arena.getReservedBytes() == 1024);
+      assert(b > a && b - a < 64);
+      assert(((size_t)a % alignof(std::max_align_t)) == 0);
+      assert(((size_t)b % alignof(std::max_align_t)) == 0);
+      size_t used = arena.getUsedBytes();
+
+      // only the most recent allocation is given back
+      arena.deallocate(a);
+      assert(arena.getUsedBytes() == used);
+      arena.deallocate(b);
+      assert(arena.getUsedBytes() < used);
+      assert(arena.allocate(1) == b);
+      assert(arena.getHighWaterBytes() == used);
+
+      // big ones get a block of their own
+      void* big = arena.allocate(2000);
+      assert(arena.getBlockCount() == 2);
+      assert(arena.allocate(16) == b + (b - a));
+      arena.deallocate(big);
+
+      // beyond the limit, the heap is used
+      void* some[10];
+      for (int i = 0; i < 10; ++i)
+      {
+         some[i] = arena.allocate(512);
+      }
+      assert(arena.getReservedBytes() <= 4096);
+      assert(arena.getHeapBytes() > 0);
+      for (int i = 0; i < 10; ++i)
+      {
+         arena.deallocate(some[i]); // those from the heap are freed
+      }
+      assert(arena.getHighWaterBytes() <= arena.getReservedBytes());
+   }
+
+   // copies of Data live in the arena, or on the heap once it is full
+   {
+      ArenaPool arena(256, 256);
+      Data original("z9hG4bK-524287-1---7a6b3c2d1e0f9a8b");
+      Data copy(arena.copy(original));
+      assert(copy == original);
+      assert(copy.data() != original.data());
+      assert(arena.getUsedBytes() >= original.size() + 1);
+
+      Data large(Data::Take, new char[300], 300);
+      Data shared(Data::Share, arena.copy(large));
+      assert(shared == large);
+      assert(arena.getHeapBytes() == 0);
+      assert(arena.getReservedBytes() > 256);
+   }
+
+   // containers and objects can be placed in it, and are freed with it
+   {
+      int count = 0;
+      ArenaPool arena;
+      {
+         typedef std::map<Data, Counted*, std::less<Data>,
+                          StlPoolAllocator<std::pair<const Data, Counted*>, PoolBase> > Map;
+         StlPoolAllocator<int, PoolBase> allocator(&arena);
+         Map map(std::less<Data>(), allocator);
+         std::list<int, StlPoolAllocator<int, PoolBase> > list(allocator);
+         for (int i = 0; i < 20; ++i)
+         {
+            Counted* c = new (&arena) Counted(count);
+            map[arena.copy(Data(i))] = c;
+            list.push_back(i);
+         }
+         assert(count == 20);
+         assert(arena.getBlockCount() == 1);
+         assert(arena.getHeapBytes() == 0);
+         for (Map::iterator i = map.begin(); i != map.end(); ++i)
+         {
+            i->second->~Counted();
+            arena.deallocate(i->second);
+         }
+      }
+      assert(count == 0);
+   }
+
+   cerr << "All OK" << endl;
+   return 0;
+}
+
+/* ====================================================================
+ * The Vovida Software License, Version 1.0 
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 
+ * 3. The names "VOCAL", "Vovida Open Communication Application Library",
+ *    and "Vovida Open Communication Application Library (VOCAL)" must
+ *    not be used to endorse or promote products derived from this
+ *    software without prior written permission. For written
+ *    permission, please contact vocal@vovida.org.
+ *
+ * 4. Products derived from this software may not be called "VOCAL", nor
+ *    may "VOCAL" appear in their name, without prior written
+ *    permission of Vovida Networks, Inc.
+ * 
+ * THIS SOFTWARE IS PROVIDED "AS IS" AND ANY EXPRESSED OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, TITLE AND
+ * NON-INFRINGEMENT ARE DISCLAIMED.  IN NO EVENT SHALL VOVIDA
+ * NETWORKS, INC. OR ITS CONTRIBUTORS BE LIABLE FOR ANY DIRECT DAMAGES
+ * IN EXCESS OF $1,000, NOR FOR ANY INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+ * USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+ * DAMAGE.
+ * 
+ * ====================================================================
+ * 
+ * This software consists of voluntary contributions made by Vovida
+ * Networks, Inc. and many individuals on behalf of Vovida Networks,
+ * Inc.  For more information on Vovida Networks, Inc., please see
+ * <http://www.vovida.org/>.
+ *
+ */
@@ -5,12 +5,71 @@
 #include <iostream>
 #include <limits>
 #include <math.h>
+#include <set>
+#include <vector>
 
 using namespace resip;
 using namespace std;
 
 #define DOUBLE_EQUALITY(a, b) essentiallyEqual(a, b, std::numeric_limits<double>::epsilon())
 
+enum HashKind
+{
+   PlainHash,
+   CaseInsensitiveHash,
+   TokenHash
+};
+
+static size_t
+hashOf(const Data& d, HashKind kind)
+{
+   switch (kind)
+   {
+      case CaseInsensitiveHash:
+         return d.caseInsensitivehash();
+      case TokenHash:
+         return d.caseInsensitiveTokenHash();
+      default:
+         return d.hash();
+   }
+}
+
+// Number of keys whose hash (truncated to 32 bits) was already taken by an
+// earlier key.
+static unsigned int
+countCollisions(const std::vector<Data>& keys, HashKind kind)
+{
+   std::set<UInt32> seen;
+   unsigned int collisions = 0;
+   for (size_t i = 0; i < keys.size(); ++i)
+   {
+      if (!seen.insert((UInt32)hashOf(keys[i], kind)).second)
+      {
+         ++collisions;
+      }
+   }
+   return collisions;
+}
+
+// Chi-squared statistic for the keys spread over numBuckets by the low bits
+// of their hash, as a power-of-two sized hash table would.
+static double
+bucketChiSquared(const std::vector<Data>& keys, HashKind kind, unsigned int numBuckets)
+{
+   std::vector<unsigned int> buckets(numBuckets, 0);
+   for (size_t i = 0; i < keys.size(); ++i)
+   {
+      ++buckets[hashOf(keys[i], kind) & (numBuckets - 1)];
+   }
+   const double expected = (double)keys.size() / numBuckets;
+   double chi = 0;
+   for (unsigned int i = 0; i < numBuckets; ++i)
+   {
+      chi += (buckets[i] - expected) * (buckets[i] - expected) / expected;
+   }
+   return chi;
+}
+
 // for friends
 class TestData
 {
@@ -1490,6 +1549,108 @@ class TestData
             assert(u4.caseInsensitiveTokenCompare(u3));
             assert(u4.caseInsensitiveTokenCompare(u4));
          }
+
+         // hash folding agrees with folding the data first, for every byte
+         // value, at every length and alignment (exercises both the 8-byte
+         // and 16-byte at a time paths, and the partial word at the end)
+         {
+            unsigned char buf[64 + 8];
+            for (unsigned int value = 0; value < 256; ++value)
+            {
+               for (size_t len = 1; len <= 64; ++len)
+               {
+                  for (size_t offset = 0; offset < 8; offset += 3)
+                  {
+                     for (size_t i = 0; i < len; ++i)
+                     {
+                        // mixed case filler around the byte under test
+                        buf[offset + i] = (i % 3 == 0) ? (unsigned char)value : (unsigned char)('A' + (i * 7 + value) % 26 + (i % 2) * 32);
+                     }
+                     Data d(Data::Share, (const char*)buf + offset, len);
+                     Data lower(d);
+                     Data token(d);
+                     for (size_t i = 0; i < len; ++i)
+                     {
+                        char& l = lower[i];
+                        if (l >= 'A' && l <= 'Z')
+                        {
+                           l += 'a' - 'A';
+                        }
+                        token[i] |= 0x20;
+                     }
+                     assert(d.caseInsensitivehash() == lower.hash());
+                     assert(d.caseInsensitivehash() == lower.caseInsensitivehash());
+                     assert(d.caseInsensitiveTokenHash() == token.caseInsensitiveTokenHash());
+                  }
+               }
+            }
+
+            // only ASCII letters are folded by caseInsensitivehash
+            assert(Data("a@b").caseInsensitivehash() != Data("a`b").caseInsensitivehash());
+            assert(Data("a[b").caseInsensitivehash() != Data("a{b").caseInsensitivehash());
+            assert(Data("\xC9t\xC9").caseInsensitivehash() != Data("\xE9t\xE9").caseInsensitivehash());
+            assert(Data("@").caseInsensitiveTokenHash() == Data("`").caseInsensitiveTokenHash());
+         }
+
+         // flipping any one bit changes the hash; so does length alone
+         {
+            Data base("z9hG4bK-524287-1---3f5e1c6b9d5b8a4c");
+            for (size_t len = 1; len <= base.size(); ++len)
+            {
+               Data d(base.data(), len);
+               const size_t h = d.hash();
+               for (size_t i = 0; i < len; ++i)
+               {
+                  for (int bit = 0; bit < 8; ++bit)
+                  {
+                     Data flipped(d);
+                     flipped[i] ^= (char)(1 << bit);
+                     assert(flipped.hash() != h);
+                     if (bit != 5)
+                     {
+                        assert(flipped.caseInsensitiveTokenHash() != d.caseInsensitiveTokenHash());
+                     }
+                  }
+               }
+            }
+            assert(Data("a").hash() != Data("a", 2).hash());
+            assert(Data::Empty.hash() != Data("", 1).hash());
+            assert(Data("12345678").hash() != Data("123456789").hash());
+         }
+
+         // collisions and distribution for the sort of keys the stack hashes:
+         // branches, tags and short counters
+         {
+            std::vector<Data> keys;
+            for (int i = 0; i < 20000; ++i)
+            {
+               keys.push_back(Data("z9hG4bK-524287-1---") + Data(i));
+               keys.push_back(Data(i).md5().substr(0, 8));
+               keys.push_back(Data(i));
+            }
+
+            const HashKind kinds[] = {PlainHash, CaseInsensitiveHash, TokenHash};
+            for (int k = 0; k < 3; ++k)
+            {
+               // 60000 keys in 2^32: about 0.4 collisions expected
+               unsigned int collisions = countCollisions(keys, kinds[k]);
+               cerr << "hash kind " << k << ": " << collisions << " collisions in " << keys.size() << " keys";
+#if defined(RESIP_DATA_LEGACY_HASH)
+               // the legacy token hash puts a quarter of the branches above
+               // on hashes that are already taken; just report it
+               const bool check = (kinds[k] != TokenHash);
+#else
+               const bool check = true;
+#endif
+               assert(!check || collisions <= 4);
+
+               // 1023 degrees of freedom: mean 1023, standard deviation 45
+               double chi = bucketChiSquared(keys, kinds[k], 1024);
+               cerr << ", chi-squared over 1024 buckets " << chi << endl;
+               assert(!check || chi < 1023 + 6 * 45);
+            }
+         }
+
          std::cerr << "All OK" << endl;
          return 0;
       }
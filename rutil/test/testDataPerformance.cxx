@@ -1,7 +1,70 @@
 #include "rutil/DataStream.hxx"
 #include "rutil/Random.hxx"
+#include "rutil/Timer.hxx"
+
+#include <iostream>
 
 using namespace resip;
+using namespace std;
+
+// A byte-at-a-time hash (FNV-1a) to compare the Data hashes against.
+static size_t
+byteAtATimeHash(const Data& d)
+{
+   UInt32 h = 2166136261U;
+   const unsigned char* c = (const unsigned char*)d.data();
+   const unsigned char* end = c + d.size();
+   for ( ; c != end; ++c)
+   {
+      h = (h ^ *c) * 16777619U;
+   }
+   return h;
+}
+
+enum HashKind
+{
+   ByteAtATime,
+   PlainHash,
+   CaseInsensitiveHash,
+   TokenHash
+};
+
+static void
+timeHash(HashKind kind, const char* name, const Data* keys, int numKeys, int runs)
+{
+   size_t sink = 0;
+   UInt64 bytes = 0;
+   UInt64 start = Timer::getTimeMicroSec();
+   for (int r = 0; r < runs; ++r)
+   {
+      for (int k = 0; k < numKeys; ++k)
+      {
+         switch (kind)
+         {
+            case ByteAtATime:
+               sink += byteAtATimeHash(keys[k]);
+               break;
+            case PlainHash:
+               sink += keys[k].hash();
+               break;
+            case CaseInsensitiveHash:
+               sink += keys[k].caseInsensitivehash();
+               break;
+            case TokenHash:
+               sink += keys[k].caseInsensitiveTokenHash();
+               break;
+         }
+         bytes += keys[k].size();
+      }
+   }
+   UInt64 elapsed = Timer::getTimeMicroSec() - start;
+   if (elapsed == 0)
+   {
+      elapsed = 1;
+   }
+   cerr << "   " << name << ": " << (elapsed * 1000) / ((UInt64)numKeys * runs) << " ns/key, "
+        << bytes / elapsed << " MB/s" << (sink == 0 ? " " : "") << endl;
+}
 
 int 
 main()
@@ -19,6 +82,31 @@ main()
          strm << "chars";
       }
    }
+
+   // Hash throughput for key sizes typical of tags, branches and Call-IDs,
+   // and for longer ones. Build with RESIP_DATA_LEGACY_HASH to compare
+   // against the older byte-at-a-time hashes.
+#if defined(RESIP_DATA_LEGACY_HASH)
+   cerr << "Hash throughput (legacy hashes)" << endl;
+#else
+   cerr << "Hash throughput (word-at-a-time hashes)" << endl;
+#endif
+   const int numKeys = 1024;
+   const size_t keySizes[] = {8, 16, 32, 64, 256};
+   for (int s = 0; s < 5; ++s)
+   {
+      Data keys[numKeys];
+      for (int k = 0; k < numKeys; ++k)
+      {
+         keys[k] = Random::getRandomHex((int)(keySizes[s] + 1) / 2).substr(0, keySizes[s]);
+      }
+      const int runs = (int)(16 * 1024 * 1024 / (keySizes[s] * numKeys));
+      cerr << " " << keySizes[s] << " byte keys" << endl;
+      timeHash(ByteAtATime, "byte-at-a-time reference", keys, numKeys, runs);
+      timeHash(PlainHash, "hash", keys, numKeys, runs);
+      timeHash(CaseInsensitiveHash, "caseInsensitivehash", keys, numKeys, runs);
+      timeHash(TokenHash, "caseInsensitiveTokenHash", keys, numKeys, runs);
+   }
    return 0;
 }
 /* ====================================================================
@@ -0,0 +1,211 @@
+#include <assert.h>
+#include <iostream>
+
+#include "rutil/LatencyHistogram.hxx"
+#include "rutil/TimeLimitFifo.hxx"
+#include "rutil/ThreadIf.hxx"
+#include "rutil/Data.hxx"
+#include "rutil/DataStream.hxx"
+
+using namespace resip;
+using namespace std;
+
+class Recorder : public ThreadIf
+{
+   public:
+      Recorder(ConcurrentLatencyHistograms& histograms, unsigned int histogram, int count)
+         : mHistograms(histograms),
+           mHistogram(histogram),
+           mCount(count)
+      {}
+
+      virtual ~Recorder()
+      {
+         shutdown();
+         join();
+      }
+
+      void thread()
+      {
+         for (int i = 0; i < mCount; ++i)
+         {
+            mHistograms.record(mHistogram, (UInt64)(i % 1000));
+         }
+      }
+
+   private:
+      ConcurrentLatencyHistograms& mHistograms;
+      unsigned int mHistogram;
+      int mCount;
+};
+
+int
+main()
+{
+   // every value lands in a bucket whose upper bound is no smaller, and
+   // within 1/SubBuckets of it
+   {
+      unsigned int last = 0;
+      for (UInt64 v = 0; v < 100000; ++v)
+      {
+         unsigned int b = LatencyHistogram::bucketFor(v);
+         assert(b >= last);
+         last = b;
+         UInt64 upper = LatencyHistogram::bucketUpperBound(b);
+         assert(upper >= v);
+         assert(upper - v <= v / LatencyHistogram::SubBuckets);
+         assert(b == 0 || LatencyHistogram::bucketUpperBound(b - 1) < v);
+      }
+      assert(LatencyHistogram::bucketFor(0xFFFFFFFFULL) == LatencyHistogram::BucketCount - 1);
+      assert(LatencyHistogram::bucketFor(0xFFFFFFFFFFFFULL) == LatencyHistogram::BucketCount - 1);
+      assert(LatencyHistogram::bucketUpperBound(LatencyHistogram::BucketCount - 1) == 0xFFFFFFFFULL);
+   }
+
+   // percentiles
+   {
+      LatencyHistogram h;
+      assert(h.getCount() == 0);
+      assert(h.getPercentile(99) == 0);
+      assert(h.getMax() == 0);
+
+      for (UInt64 v = 1; v <= 1000; ++v)
+      {
+         h.record(v);
+      }
+      assert(h.getCount() == 1000);
+      assert(h.getMean() == 500);
+      UInt64 p50 = h.getPercentile(50);
+      assert(p50 >= 500 && p50 <= 500 + 500 / LatencyHistogram::SubBuckets);
+      UInt64 p99 = h.getPercentile(99);
+      assert(p99 >= 990 && p99 <= 990 + 990 / LatencyHistogram::SubBuckets);
+      assert(h.getPercentile(100) == h.getMax());
+      assert(h.getMax() >= 1000 && h.getMax() <= 1000 + 1000 / LatencyHistogram::SubBuckets);
+      assert(h.getPercentile(0) == 1);
+
+      LatencyHistogram other;
+      other.record(1000000);
+      h.add(other);
+      assert(h.getCount() == 1001);
+      assert(h.getMax() >= 1000000);
+      h.subtract(other);
+      assert(h.getCount() == 1000);
+
+      Data summary;
+      {
+         DataStream str(summary);
+         h.encodeSummary(str);
+      }
+      assert(summary.prefix("n=1000 mean=500 p50="));
+
+      LatencySummary brief(h);
+      assert(brief.getCount() == 1000);
+      assert(brief.getMean() == 500);
+      assert(brief.getP50() == h.getPercentile(50));
+      assert(brief.getMax() == h.getMax());
+      Data briefSummary;
+      {
+         DataStream str(briefSummary);
+         brief.encode(str);
+      }
+      assert(briefSummary == summary);
+      assert(LatencySummary(LatencyHistogram()).getMax() == 0);
+   }
+
+   // several threads recording into the same histograms
+   {
+      ConcurrentLatencyHistograms histograms(2);
+      {
+         Recorder r1(histograms, 0, 100000);
+         Recorder r2(histograms, 0, 100000);
+         Recorder r3(histograms, 1, 50000);
+         r1.run();
+         r2.run();
+         r3.run();
+      }
+      histograms.record(1, 5);
+
+      LatencyHistogram collected[2];
+      histograms.collect(collected);
+      assert(collected[0].getCount() == 200000);
+      assert(collected[1].getCount() == 50001);
+      assert(collected[0].getSum() == 2 * 100 * (999 * 1000 / 2));
+
+      histograms.reset();
+      histograms.collect(collected);
+      assert(collected[0].getCount() == 0);
+      assert(collected[1].getCount() == 0);
+
+      histograms.record(1, 7);
+      histograms.collect(collected);
+      assert(collected[1].getCount() == 1);
+      assert(collected[1].getSum() == 7);
+   }
+
+   // a TimeLimitFifo measuring how long messages wait
+   {
+      ConcurrentLatencyHistograms histograms(1);
+      TimeLimitFifo<Data> fifo(60, 100);
+      fifo.add(new Data("before"), TimeLimitFifo<Data>::InternalElement);
+      fifo.setWaitTimeRecorder(&histograms, 0);
+      fifo.add(new Data("after"), TimeLimitFifo<Data>::InternalElement);
+      delete fifo.getNext();
+      delete fifo.getNext(10);
+
+      LatencyHistogram collected;
+      histograms.collect(&collected);
+      assert(collected.getCount() == 1);
+   }
+
+   cerr << "All OK" << endl;
+   return 0;
+}
+
+/* ====================================================================
+ * The Vovida Software License, Version 1.0
+ *
+ * Copyright (c) 2000 Vovida Networks, Inc.  All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * 3. The names "VOCAL", "Vovida Open Communication Application Library",
+ *    and "Vovida Open Communication Application Library (VOCAL)" must
+ *    not be used to endorse or promote products derived from this
+ *    software without prior written permission. For written
+ *    permission, please contact vocal@vovida.org.
+ *
+ * 4. Products derived from this software may not be called "VOCAL", nor
+ *    may "VOCAL" appear in their name, without prior written
+ *    permission of Vovida Networks, Inc.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS" AND ANY EXPRESSED OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, TITLE AND
+ * NON-INFRINGEMENT ARE DISCLAIMED.  IN NO EVENT SHALL VOVIDA
+ * NETWORKS, INC. OR ITS CONTRIBUTORS BE LIABLE FOR ANY DIRECT DAMAGES
+ * IN EXCESS OF $1,000, NOR FOR ANY INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+ * USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+ * DAMAGE.
+ *
+ * ====================================================================
+ *
+ * This software consists of voluntary contributions made by Vovida
+ * Networks, Inc. and many individuals on behalf of Vovida Networks,
+ * Inc.  For more information on Vovida Networks, Inc., please see
+ * <http://www.vovida.org/>.
+ *
+ */
@@ -42,6 +42,20 @@ int getInterfaces(HashMap<Data, DataVector> & interfaces)
    return(interfaceCount);
 }
 
+void testNetNsIds()
+{
+   // the default netns is id 0 in both directions
+   assert(NetNs::getNetNsId("") == 0);
+   assert(NetNs::getNetNsName(0) == "");
+
+   int id = NetNs::getNetNsId("testNetNsIds", true);
+   assert(id > 0);
+   assert(NetNs::getNetNsId("testNetNsIds") == id);
+   assert(NetNs::getNetNsName(id) == "testNetNsIds");
+   assert(NetNs::getNetNsId("") == 0);
+   assert(NetNs::getNetNsId("notAddedNetNs") == -1);
+}
+
 bool testPublicNetNs()
 {
    vector<Data> publicNetNs;
@@ -96,6 +110,7 @@ bool testPublicNetNs()
 
 int main(int argc, const char* argv[])
 {
+    testNetNsIds();
     assert(!testPublicNetNs());
 
     resipCerr << "ALL OK" << std::endl;
@@ -559,6 +559,83 @@ main(int argc, char** argv)
       }
    }
 
+   {
+      // the character scans look at 16 bytes at a time where they can;
+      // compare them with a byte at a time on every length and offset
+      const char alphabet[] = "ab \t\r\n;:@,\"\\\0\xff";
+      const char* sets[] = { ";", ":@", ";?", " \t\r\n", ";?>,", "@;>\"\\,", "abcdefghij" };
+      for (int run = 0; run < 2000; ++run)
+      {
+         char buf[80];
+         const size_t len = run % 80;
+         for (size_t i = 0; i < len; ++i)
+         {
+            buf[i] = alphabet[(run * 7 + i * 13 + (i * i) / 3) % (sizeof(alphabet) - 1)];
+         }
+         const char* end = buf + len;
+         for (size_t s = 0; s < sizeof(sets)/sizeof(sets[0]); ++s)
+         {
+            for (size_t start = 0; start <= len; start += 5)
+            {
+               const char* expected = buf + start;
+               while (expected < end && !(*expected && strchr(sets[s], *expected)))
+               {
+                  ++expected;
+               }
+               ParseBuffer pb(buf, len);
+               pb.reset(buf + start);
+               assert(pb.skipToOneOf(sets[s]) == expected);
+               pb.reset(buf + start);
+               assert(pb.skipToOneOf(Data(sets[s])) == expected);
+               const Data first(sets[s], 1);
+               const Data rest(sets[s] + 1);
+               pb.reset(buf + start);
+               assert(pb.skipToOneOf(first.c_str(), rest.c_str()) == expected);
+               pb.reset(buf + start);
+               assert(pb.skipToOneOf(first, rest) == expected);
+
+               const char* white = buf + start;
+               while (white < end && strchr(ParseBuffer::Whitespace, *white) && *white)
+               {
+                  ++white;
+               }
+               pb.reset(buf + start);
+               assert(pb.skipWhitespace() == white);
+
+               const char* found = buf + start;
+               const size_t subLen = strlen(sets[s]);
+               while (found + subLen <= end && memcmp(found, sets[s], subLen) != 0)
+               {
+                  ++found;
+               }
+               if (found + subLen > end)
+               {
+                  found = end;
+               }
+               pb.reset(buf + start);
+               assert(pb.skipToChars(sets[s]) == found);
+               pb.reset(buf + start);
+               assert(pb.skipToChars(Data(sets[s])) == found);
+
+               const char* quote = buf + start;
+               while (quote < end && *quote != '"')
+               {
+                  quote += (*quote == '\\') ? 2 : 1;
+               }
+               pb.reset(buf + start);
+               try
+               {
+                  assert(pb.skipToEndQuote() == quote);
+               }
+               catch (ParseException&)
+               {
+                  assert(quote >= end);
+               }
+            }
+         }
+      }
+   }
+
    std::cerr << "All OK" << std::endl;
    return 0;
 }
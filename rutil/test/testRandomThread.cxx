@@ -4,6 +4,7 @@
 
 **/
 #include <cstdlib>
+#include <cstring>
 #include <cmath>        // for sqrt
 #include <iostream>
 #include <vector>
@@ -18,6 +19,16 @@
 #define RANDINT_PER_CYCLE (1000000)
 #define RANDSEQ_PER_CYCLE (1000)
 
+// What each thread generates when timing
+typedef enum
+{
+   KindInt,     // Random::getRandom(), one million per cycle
+   KindHex,     // Random::getRandomHex(8), like a tag or branch; RANDINT_PER_CYCLE/10 per cycle
+   KindCrypto   // Random::getCryptoRandom(16), like a nonce; RANDINT_PER_CYCLE/10 per cycle
+} RandomKind;
+
+static const char* KindNames[] = { "int", "hex", "crypto" };
+
 using namespace std;
 using namespace resip;
 
@@ -82,14 +93,14 @@ typedef std::set<Data> DataSet;
 class TestRandomThread : public ThreadIf
 {
    public:
-      TestRandomThread(int runs, Barrier& barrier, int storeBytes)
+      TestRandomThread(int runs, Barrier& barrier, int storeBytes, RandomKind kind)
 	 : mNumRuns(runs), mBarrier(barrier), mStoreBytes(storeBytes),
-         mDupCnt(0)
+         mKind(kind), mDupCnt(0)
       { };
       ~TestRandomThread() { };
 
       virtual void thread();
-      static void makeRandoms(int numCycles);
+      static void makeRandoms(int numCycles, RandomKind kind);
       void makeAndStoreRandoms(int numCycles);
       const DataSet& getRandoms() const { return mRandoms; };
       int getDupCnt() const { return mDupCnt; }
@@ -98,21 +109,40 @@ class TestRandomThread : public ThreadIf
       int mNumRuns;
       Barrier& mBarrier;
       int mStoreBytes;
+      RandomKind mKind;
       DataSet mRandoms;
       int mDupCnt;
 };
 
 
 void
-TestRandomThread::makeRandoms(int numCycles)
+TestRandomThread::makeRandoms(int numCycles, RandomKind kind)
 {
    int idx, cidx;
+   unsigned char buf[16];
    for (cidx=0; cidx < numCycles; cidx++)
    {
-      for (idx = 0; idx < RANDINT_PER_CYCLE; idx++)
+      switch (kind)
       {
-	 int val = Random::getRandom();
-	 (void)val;
+         case KindInt:
+            for (idx = 0; idx < RANDINT_PER_CYCLE; idx++)
+            {
+               int val = Random::getRandom();
+               (void)val;
+            }
+            break;
+         case KindHex:
+            for (idx = 0; idx < RANDINT_PER_CYCLE/10; idx++)
+            {
+               Data val = Random::getRandomHex(8);
+            }
+            break;
+         case KindCrypto:
+            for (idx = 0; idx < RANDINT_PER_CYCLE/10; idx++)
+            {
+               Random::getCryptoRandom(buf, sizeof(buf));
+            }
+            break;
       }
    }
 }
@@ -125,7 +155,9 @@ TestRandomThread::makeAndStoreRandoms(int numCycles)
    {
       for (idx = 0; idx < RANDSEQ_PER_CYCLE; idx++)
       {
-         Data foo = Random::getRandomHex(mStoreBytes);
+         Data foo = mKind==KindCrypto
+            ? Random::getCryptoRandomHex(mStoreBytes)
+            : Random::getRandomHex(mStoreBytes);
          if (mRandoms.insert(foo).second == false )
          {
             ++mDupCnt;
@@ -148,7 +180,7 @@ TestRandomThread::thread()
 
    if (mStoreBytes == 0 )
    {
-      makeRandoms(mNumRuns);
+      makeRandoms(mNumRuns, mKind);
    }
    else
    {
@@ -158,11 +190,13 @@ TestRandomThread::thread()
    mBarrier.sync(2);
 }
 
+static int sDupCnt = 0;
+
 static UInt64
-doSingleTest(int numCycles)
+doSingleTest(int numCycles, RandomKind kind)
 {
    UInt64 startUs = ResipClock::getTimeMicroSec();
-   TestRandomThread::makeRandoms(numCycles);
+   TestRandomThread::makeRandoms(numCycles, kind);
    UInt64 doneUs = ResipClock::getTimeMicroSec();
    return doneUs - startUs;
 }
@@ -190,14 +224,14 @@ mergeCheckRandoms(DataSet& all, const DataSet& more)
 }
 
 static UInt64
-doThreadedTest(int numCycles, int numThreads, int storeBytes)
+doThreadedTest(int numCycles, int numThreads, int storeBytes, RandomKind kind)
 {
    std::vector<TestRandomThread*> threadList;
    Barrier bar(numThreads);
    int pidx;
    for (pidx=0; pidx < numThreads; pidx++)
    {
-      TestRandomThread* rth = new TestRandomThread(numCycles,bar, storeBytes);
+      TestRandomThread* rth = new TestRandomThread(numCycles,bar, storeBytes, kind);
       rth->run();
       threadList.push_back(rth);
    }
@@ -235,12 +269,13 @@ doThreadedTest(int numCycles, int numThreads, int storeBytes)
    {
       std::cout << "Found "<<interDupCnt<< " inter-thread and "
          <<intraDupCnt<<" intra-thread duplicates." << std::endl;
+      sDupCnt += interDupCnt + intraDupCnt;
    }
    return doneUs - startUs;
 }
 
 static void
-doVariationTest(int numCycles, int numThreads, int numPass, int storeBytes)
+doVariationTest(int numCycles, int numThreads, int numPass, int storeBytes, RandomKind kind)
 {
    UInt64 msMin = 0, msMax = 0;
    UInt64 msSum = 0;
@@ -249,8 +284,8 @@ doVariationTest(int numCycles, int numThreads, int numPass, int storeBytes)
    for (passIdx=0; passIdx < numPass; passIdx++)
    {
       UInt64 usTot = numThreads<=0
-         ?  doSingleTest(numCycles) 
-         : doThreadedTest(numCycles, numThreads, storeBytes);
+         ?  doSingleTest(numCycles, kind) 
+         : doThreadedTest(numCycles, numThreads, storeBytes, kind);
       UInt64 usPerCycle = usTot/numCycles;
 #if 0
       std::cerr << numCycles << " cycles/thread (1M plain 32-bit ints)"
@@ -270,8 +305,8 @@ doVariationTest(int numCycles, int numThreads, int numPass, int storeBytes)
    double msVar = msSumSq/(numPass+0.0) - msAvg*msAvg;
    double msStd = sqrt(msVar);
    double msStdPct = msStd/msAvg*100;
-   fprintf(stderr,"RESULT:plain:%s:cycles=%d,threads=%d,passes=%d:min=%d,avg=%d,max=%d,std=%.1f(%.1f%%)[ms/cycle]\n",
-         Random::getImplName(),
+   fprintf(stderr,"RESULT:%s:%s:cycles=%d,threads=%d,passes=%d:min=%d,avg=%d,max=%d,std=%.1f(%.1f%%)[ms/cycle]\n",
+         KindNames[kind], Random::getImplName(),
          numCycles, numThreads, numPass,
          (int)msMin,(int)msAvg,(int)msMax, msStd, msStdPct);
 }
@@ -284,6 +319,7 @@ int main(int argc, char** argv)
    int numThreads = 3;
    int numPass = 10;
    int storeBytes = 0;
+   int kindIdx = -1;   // all of them
 
    {
       doSweep = false;
@@ -295,6 +331,20 @@ int main(int argc, char** argv)
          numPass = atoi(argv[3]);
       if(argc >= 5)
          storeBytes = atoi(argv[4]);
+      if(argc >= 6)
+      {
+         for (int k = 0; k < (int)(sizeof(KindNames)/sizeof(KindNames[0])); ++k)
+         {
+            if (strcmp(argv[5], KindNames[k]) == 0)
+            {
+               kindIdx = k;
+            }
+         }
+         if (kindIdx < 0 && strcmp(argv[5], "all") != 0)
+         {
+            numCycles = 0; // show usage
+         }
+      }
    }
 
    if (numCycles <= 0 || numThreads < -1 || numPass < 1)
@@ -315,6 +365,9 @@ int main(int argc, char** argv)
            << "    and check for duplicates. Mainly to check for thread safety." << std::endl
            << "    Timing numbers in this case are not so useful." << std::endl
            << "    0 ==> [default] Don't store, just time." << std::endl
+           << "kind is what to generate: int, hex (getRandomHex(8), like a tag" << std::endl
+           << "    or branch), crypto (getCryptoRandom(16), like a nonce), or all [default]" << std::endl
+           << "    hex and crypto cycles are one hundred thousand values each" << std::endl
            ;
       exit(-1);
    }
@@ -328,8 +381,25 @@ int main(int argc, char** argv)
 
    std::cerr << "Starting..." << std::endl;
 
+   for (int k = 0; k < (int)(sizeof(KindNames)/sizeof(KindNames[0])); ++k)
+   {
+      if (kindIdx < 0 || kindIdx == k)
+      {
+         doVariationTest(numCycles, numThreads, numPass, storeBytes, (RandomKind)k);
+      }
+   }
+
+   if (argc == 1)
    {
-      doVariationTest(numCycles, numThreads, numPass, storeBytes);
+      // Threads must not share a generator (or a seed): nothing any two of
+      // them produce should collide.
+      doThreadedTest(numCycles, numThreads, 8, KindHex);
+      doThreadedTest(numCycles, numThreads, 8, KindCrypto);
+      if (sDupCnt > 0)
+      {
+         std::cerr << "Failed: duplicates found." << std::endl;
+         return 1;
+      }
    }
 
    std::cerr << "Success." << std::endl;